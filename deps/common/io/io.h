@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #ifndef __COMMON_IO_IO_H__
 #define __COMMON_IO_IO_H__
 
+#include <sys/types.h>
 #include <string>
 #include <vector>
 
@@ -61,5 +62,11 @@ int getFileSize(const char *filePath, u64_t &fileLen);
 int writen(int fd, const void *buf, int size);
 int readn(int fd, void *buf, int size);
 
+/**
+ * 在指定位置读写，不移动文件的偏移量，多个线程可以同时使用同一个fd
+ */
+int pwriten(int fd, const void *buf, int size, off_t offset);
+int preadn(int fd, void *buf, int size, off_t offset);
+
 }  // namespace common
 #endif /* __COMMON_IO_IO_H__ */
@@ -0,0 +1,100 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/09.
+//
+
+#ifndef __COMMON_LANG_RW_LATCH_H__
+#define __COMMON_LANG_RW_LATCH_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+
+namespace common {
+
+/**
+ * 轻量级的读写锁，只有一个32位的原子变量，适合嵌入到每个页面中保护很短的临界区。
+ * 等待时先自旋，再让出CPU，不会进入内核睡眠。
+ * 写锁优先：写者先设置写标记，阻止新的读者进入，然后等待已有的读者退出。
+ * 不可重入。
+ */
+class RWLatch
+{
+public:
+  void lock_shared()
+  {
+    for (int spins = 0; !try_lock_shared(); spins++) {
+      backoff(spins);
+    }
+  }
+
+  bool try_lock_shared()
+  {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    return (state & WRITER) == 0 &&
+           state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  void unlock_shared()
+  {
+    state_.fetch_sub(1, std::memory_order_release);
+  }
+
+  void lock()
+  {
+    int spins = 0;
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while ((state & WRITER) != 0 ||
+           !state_.compare_exchange_weak(state, state | WRITER, std::memory_order_acquire, std::memory_order_relaxed)) {
+      backoff(spins++);
+      state = state_.load(std::memory_order_relaxed);
+    }
+
+    // 等待已经进入的读者退出
+    while (state_.load(std::memory_order_acquire) != WRITER) {
+      backoff(spins++);
+    }
+  }
+
+  bool try_lock()
+  {
+    uint32_t state = 0;
+    return state_.compare_exchange_strong(state, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  void unlock()
+  {
+    state_.store(0, std::memory_order_release);
+  }
+
+private:
+  static void backoff(int spins)
+  {
+    if (spins < SPIN_NUM) {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  static const uint32_t WRITER = 1U << 31;
+  static const int SPIN_NUM = 64;
+
+  std::atomic<uint32_t> state_{0};
+};
+
+}  // namespace common
+
+#endif  // __COMMON_LANG_RW_LATCH_H__
@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 
 #include <ctype.h>
 #include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <algorithm>
@@ -70,6 +72,45 @@ std::string size_to_pad_str(int size, int pad)
   return ss.str();
 }
 
+bool str_to_bytes(const std::string &str, size_t &bytes)
+{
+  std::string tmp = str;
+  strip(tmp);
+  if (tmp.empty()) {
+    return false;
+  }
+
+  size_t unit = 1;
+  switch (tmp.back()) {
+    case 'k': case 'K': unit = 1UL << 10; break;
+    case 'm': case 'M': unit = 1UL << 20; break;
+    case 'g': case 'G': unit = 1UL << 30; break;
+    case 't': case 'T': unit = 1UL << 40; break;
+    default: break;
+  }
+  if (unit != 1) {
+    tmp.pop_back();
+  }
+
+  if (tmp.empty() || !isdigit(tmp[0])) {
+    return false;
+  }
+
+  char *end = nullptr;
+  errno = 0;
+  unsigned long long value = strtoull(tmp.c_str(), &end, 10);
+  if (errno != 0 || *end != '\0') {
+    return false;
+  }
+  // 乘上单位之后不能溢出，比如 99999999999G
+  if (value > SIZE_MAX / unit) {
+    return false;
+  }
+
+  bytes = static_cast<size_t>(value * unit);
+  return true;
+}
+
 std::string &str_to_upper(std::string &s)
 {
   std::transform(s.begin(), s.end(), s.begin(), (int (*)(int)) & std::toupper);
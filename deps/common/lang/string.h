@@ -99,6 +99,15 @@ char *hex_to_bin(const char *s, char *bin_buff, int *dest_len);
 template <class T>
 bool str_to_val(const std::string &str, T &val, std::ios_base &(*radix)(std::ios_base &) = std::dec);
 
+/**
+ * Convert a size string like "512", "64K", "256M" or "2G" to bytes.
+ * The suffix is case insensitive and means a power of 1024.
+ * @param[in]   str     input size string
+ * @param[out]  bytes   output size in bytes
+ * @return \c true if the string was successfully converted, \c false otherwise
+ */
+bool str_to_bytes(const std::string &str, size_t &bytes);
+
 /**
  * Convert a numeric value into its string representation
  * @param[in]   val     numeric value
@@ -0,0 +1,252 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/07.
+//
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define CRC32C_HAVE_SSE42
+#endif
+
+#include "common/math/crc32c.h"
+
+namespace common {
+
+static const uint32_t CRC32C_POLY = 0x82F63B78;  // 反转之后的Castagnoli多项式
+
+// 硬件实现中每次用三个独立的crc32指令并行计算三段数据，然后合并。
+// 合并时需要把前一段的校验和"移过"后面一段数据的长度，这个操作可以预先算成查找表
+static const size_t CRC32C_LONG = 8192;
+static const size_t CRC32C_SHORT = 256;
+
+namespace {
+
+/**
+ * GF(2)上的矩阵乘以向量，矩阵的每一列是一个32位的整数
+ */
+uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec)
+{
+  uint32_t sum = 0;
+  while (vec != 0) {
+    if (vec & 1) {
+      sum ^= *mat;
+    }
+    vec >>= 1;
+    mat++;
+  }
+  return sum;
+}
+
+void gf2_matrix_square(uint32_t *square, const uint32_t *mat)
+{
+  for (int n = 0; n < 32; n++) {
+    square[n] = gf2_matrix_times(mat, mat[n]);
+  }
+}
+
+/**
+ * 构造在校验和后面追加len个0字节的操作矩阵，len必须是2的幂
+ */
+void crc32c_zeros_op(uint32_t *even, size_t len)
+{
+  uint32_t odd[32];
+
+  // 一个0位的操作
+  odd[0] = CRC32C_POLY;
+  uint32_t row = 1;
+  for (int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+
+  gf2_matrix_square(even, odd);  // 两个0位
+  gf2_matrix_square(odd, even);  // 四个0位
+
+  // 第一次平方之后even中是一个0字节的操作，之后每次平方长度翻倍
+  do {
+    gf2_matrix_square(even, odd);
+    len >>= 1;
+    if (len == 0) {
+      return;
+    }
+    gf2_matrix_square(odd, even);
+    len >>= 1;
+  } while (len != 0);
+
+  for (int n = 0; n < 32; n++) {
+    even[n] = odd[n];
+  }
+}
+
+struct Crc32cTables {
+  uint32_t software[8][256];  // slice-by-8 查找表
+  uint32_t long_zeros[4][256];
+  uint32_t short_zeros[4][256];
+  bool hardware = false;
+
+  Crc32cTables()
+  {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t crc = n;
+      for (int k = 0; k < 8; k++) {
+        crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+      }
+      software[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t crc = software[0][n];
+      for (int k = 1; k < 8; k++) {
+        crc = software[0][crc & 0xff] ^ (crc >> 8);
+        software[k][n] = crc;
+      }
+    }
+
+    init_zeros(long_zeros, CRC32C_LONG);
+    init_zeros(short_zeros, CRC32C_SHORT);
+
+#ifdef CRC32C_HAVE_SSE42
+    __builtin_cpu_init();
+    hardware = __builtin_cpu_supports("sse4.2");
+#endif
+  }
+
+  static void init_zeros(uint32_t zeros[][256], size_t len)
+  {
+    uint32_t op[32];
+    crc32c_zeros_op(op, len);
+    for (uint32_t n = 0; n < 256; n++) {
+      zeros[0][n] = gf2_matrix_times(op, n);
+      zeros[1][n] = gf2_matrix_times(op, n << 8);
+      zeros[2][n] = gf2_matrix_times(op, n << 16);
+      zeros[3][n] = gf2_matrix_times(op, n << 24);
+    }
+  }
+};
+
+const Crc32cTables &crc32c_tables()
+{
+  static Crc32cTables tables;
+  return tables;
+}
+
+inline uint32_t crc32c_shift(const uint32_t zeros[][256], uint32_t crc)
+{
+  return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff] ^ zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
+}
+
+#ifdef CRC32C_HAVE_SSE42
+__attribute__((target("sse4.2"))) uint32_t crc32c_hardware(
+    const Crc32cTables &tables, uint32_t crc, const unsigned char *next, size_t len)
+{
+  uint64_t crc0 = crc ^ 0xffffffff;
+
+  // 先把地址对齐到8字节
+  while (len > 0 && (reinterpret_cast<uintptr_t>(next) & 7) != 0) {
+    crc0 = _mm_crc32_u8(static_cast<uint32_t>(crc0), *next);
+    next++;
+    len--;
+  }
+
+  // 三段数据并行计算，然后合并
+  const size_t block_sizes[2] = {CRC32C_LONG, CRC32C_SHORT};
+  const uint32_t(*zeros[2])[256] = {tables.long_zeros, tables.short_zeros};
+  for (int i = 0; i < 2; i++) {
+    const size_t block_size = block_sizes[i];
+    while (len >= block_size * 3) {
+      uint64_t crc1 = 0;
+      uint64_t crc2 = 0;
+      const unsigned char *end = next + block_size;
+      do {
+        crc0 = _mm_crc32_u64(crc0, *reinterpret_cast<const uint64_t *>(next));
+        crc1 = _mm_crc32_u64(crc1, *reinterpret_cast<const uint64_t *>(next + block_size));
+        crc2 = _mm_crc32_u64(crc2, *reinterpret_cast<const uint64_t *>(next + block_size * 2));
+        next += 8;
+      } while (next < end);
+      crc0 = crc32c_shift(zeros[i], static_cast<uint32_t>(crc0)) ^ crc1;
+      crc0 = crc32c_shift(zeros[i], static_cast<uint32_t>(crc0)) ^ crc2;
+      next += block_size * 2;
+      len -= block_size * 3;
+    }
+  }
+
+  const unsigned char *end = next + (len - (len & 7));
+  while (next < end) {
+    crc0 = _mm_crc32_u64(crc0, *reinterpret_cast<const uint64_t *>(next));
+    next += 8;
+  }
+  len &= 7;
+
+  while (len > 0) {
+    crc0 = _mm_crc32_u8(static_cast<uint32_t>(crc0), *next);
+    next++;
+    len--;
+  }
+  return static_cast<uint32_t>(crc0) ^ 0xffffffff;
+}
+#endif
+
+uint32_t crc32c_software(const Crc32cTables &tables, uint32_t crc, const unsigned char *next, size_t len)
+{
+  const uint32_t(*table)[256] = tables.software;
+  crc = ~crc;
+  while (len > 0 && (reinterpret_cast<uintptr_t>(next) & 7) != 0) {
+    crc = table[0][(crc ^ *next) & 0xff] ^ (crc >> 8);
+    next++;
+    len--;
+  }
+
+  // 一次处理8个字节，要求是小端
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, next, sizeof(word));
+    word ^= crc;
+    crc = table[7][word & 0xff] ^ table[6][(word >> 8) & 0xff] ^ table[5][(word >> 16) & 0xff] ^
+          table[4][(word >> 24) & 0xff] ^ table[3][(word >> 32) & 0xff] ^ table[2][(word >> 40) & 0xff] ^
+          table[1][(word >> 48) & 0xff] ^ table[0][word >> 56];
+    next += 8;
+    len -= 8;
+  }
+
+  while (len > 0) {
+    crc = table[0][(crc ^ *next) & 0xff] ^ (crc >> 8);
+    next++;
+    len--;
+  }
+  return ~crc;
+}
+
+}  // namespace
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t size)
+{
+  const Crc32cTables &tables = crc32c_tables();
+#ifdef CRC32C_HAVE_SSE42
+  if (tables.hardware) {
+    return crc32c_hardware(tables, crc, static_cast<const unsigned char *>(data), size);
+  }
+#endif
+  return crc32c_software(tables, crc, static_cast<const unsigned char *>(data), size);
+}
+
+uint32_t crc32c_software(uint32_t crc, const void *data, size_t size)
+{
+  return crc32c_software(crc32c_tables(), crc, static_cast<const unsigned char *>(data), size);
+}
+
+bool crc32c_hardware_enabled()
+{
+  return crc32c_tables().hardware;
+}
+
+}  // namespace common
@@ -0,0 +1,42 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/07.
+//
+
+#ifndef __COMMON_MATH_CRC32C_H__
+#define __COMMON_MATH_CRC32C_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace common {
+
+/**
+ * CRC32C(Castagnoli)校验和。
+ * x86-64上如果CPU支持SSE4.2，就使用crc32指令计算，否则使用查表法
+ * @param crc 上一段数据的校验和，第一段数据传0
+ */
+uint32_t crc32c(uint32_t crc, const void *data, size_t size);
+
+/**
+ * 查表法，与crc32c的结果相同，性能测试对比使用
+ */
+uint32_t crc32c_software(uint32_t crc, const void *data, size_t size);
+
+/**
+ * crc32c是否使用了CPU指令
+ */
+bool crc32c_hardware_enabled();
+
+}  // namespace common
+
+#endif  // __COMMON_MATH_CRC32C_H__
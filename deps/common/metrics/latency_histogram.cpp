@@ -0,0 +1,89 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/14.
+//
+
+#include "common/metrics/latency_histogram.h"
+
+namespace common {
+
+LatencyHistogram::LatencyHistogram()
+{
+  for (std::atomic<long> &bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::record(long us)
+{
+  if (us < 0) {
+    us = 0;
+  }
+
+  int bucket = us < 2 ? 0 : 63 - __builtin_clzl(static_cast<unsigned long>(us));
+  if (bucket >= BUCKET_NUM) {
+    bucket = BUCKET_NUM - 1;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_us_.fetch_add(us, std::memory_order_relaxed);
+
+  long max_us = max_us_.load(std::memory_order_relaxed);
+  while (us > max_us && !max_us_.compare_exchange_weak(max_us, us, std::memory_order_relaxed)) {
+  }
+}
+
+double LatencyHistogram::mean_us() const
+{
+  const long count = this->count();
+  return count > 0 ? static_cast<double>(sum_us()) / count : 0.0;
+}
+
+long LatencyHistogram::percentile_us(double quantile) const
+{
+  long counts[BUCKET_NUM];
+  long total = 0;
+  for (int i = 0; i < BUCKET_NUM; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  if (quantile < 0) {
+    quantile = 0;
+  } else if (quantile > 1) {
+    quantile = 1;
+  }
+  long rank = static_cast<long>(quantile * total + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  }
+
+  long seen = 0;
+  for (int i = 0; i < BUCKET_NUM; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      // 桶的上界不会超过记录到的最大值，最后一个桶没有上界
+      if (i == BUCKET_NUM - 1) {
+        return max_us();
+      }
+      const long upper = (1L << (i + 1)) - 1;
+      const long max_us = this->max_us();
+      return upper < max_us ? upper : max_us;
+    }
+  }
+  return max_us();
+}
+
+}  // namespace common
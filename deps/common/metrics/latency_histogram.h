@@ -0,0 +1,58 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/14.
+//
+
+#ifndef __COMMON_METRICS_LATENCY_HISTOGRAM_H__
+#define __COMMON_METRICS_LATENCY_HISTOGRAM_H__
+
+#include <atomic>
+
+namespace common {
+
+/**
+ * 延迟直方图，按照2的幂次分桶，第i个桶记录[2^i, 2^(i+1))微秒的次数(第0个桶包含0)。
+ * 记录时只有几次原子加，没有锁也不需要采样，可以放在读写页面这样的热点路径上。
+ * Histogram/Timer要保存样本再排序，代价比较高，不适合每次IO都记录。
+ * 分位数只精确到所在的桶，返回桶的上界
+ */
+class LatencyHistogram
+{
+public:
+  static const int BUCKET_NUM = 32;
+
+public:
+  LatencyHistogram();
+
+  void record(long us);
+
+  long count() const { return count_.load(std::memory_order_relaxed); }
+  long sum_us() const { return sum_us_.load(std::memory_order_relaxed); }
+  long max_us() const { return max_us_.load(std::memory_order_relaxed); }
+  double mean_us() const;
+
+  /**
+   * @param quantile 取值范围[0, 1]
+   * @return 没有记录时返回0
+   */
+  long percentile_us(double quantile) const;
+
+private:
+  std::atomic<long> buckets_[BUCKET_NUM];
+  std::atomic<long> count_{0};
+  std::atomic<long> sum_us_{0};
+  std::atomic<long> max_us_{0};
+};
+
+}  // namespace common
+
+#endif  // __COMMON_METRICS_LATENCY_HISTOGRAM_H__
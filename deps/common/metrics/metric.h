@@ -21,6 +21,8 @@ namespace common {
 
 class Metric {
 public:
+  virtual ~Metric() = default;
+
   virtual void snapshot() = 0;
 
   virtual Snapshot *get_snapshot()
@@ -29,7 +31,7 @@ public:
   }
 
 protected:
-  Snapshot *snapshot_value_;
+  Snapshot *snapshot_value_ = nullptr;
 };
 
 }  // namespace common
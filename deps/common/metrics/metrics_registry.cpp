@@ -26,6 +26,7 @@ MetricsRegistry &get_metrics_registry()
 
 void MetricsRegistry::register_metric(const std::string &tag, Metric *metric)
 {
+  std::lock_guard<std::mutex> lock_guard(lock_);
   std::map<std::string, Metric *>::iterator it = metrics.find(tag);
   if (it != metrics.end()) {
     LOG_WARN("%s has been registered!", tag.c_str());
@@ -39,6 +40,7 @@ void MetricsRegistry::register_metric(const std::string &tag, Metric *metric)
 
 void MetricsRegistry::unregister(const std::string &tag)
 {
+  std::lock_guard<std::mutex> lock_guard(lock_);
   unsigned int num = metrics.erase(tag);
   if (num == 0) {
     LOG_WARN("There is no %s metric!", tag.c_str());
@@ -49,6 +51,7 @@ void MetricsRegistry::unregister(const std::string &tag)
 
 void MetricsRegistry::snapshot()
 {
+  std::lock_guard<std::mutex> lock_guard(lock_);
   std::map<std::string, Metric *>::iterator it = metrics.begin();
   for (; it != metrics.end(); it++) {
     it->second->snapshot();
@@ -57,6 +60,7 @@ void MetricsRegistry::snapshot()
 
 void MetricsRegistry::report()
 {
+  std::lock_guard<std::mutex> lock_guard(lock_);
   for (std::list<Reporter *>::iterator reporterIt = reporters.begin(); reporterIt != reporters.end(); reporterIt++) {
     for (std::map<std::string, Metric *>::iterator it = metrics.begin(); it != metrics.end(); it++) {
 
@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include <string>
 #include <map>
 #include <list>
+#include <mutex>
 
 #include "common/metrics/metric.h"
 #include "common/metrics/reporter.h"
@@ -42,6 +43,8 @@ public:
   }
 
 protected:
+  // 文件打开和关闭时会注册和删除指标，和MetricsStage定时输出指标不在一个线程
+  std::mutex lock_;
   std::map<std::string, Metric *> metrics;
   std::list<Reporter *> reporters;
 };
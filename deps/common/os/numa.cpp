@@ -0,0 +1,187 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/10.
+//
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if __has_include(<linux/mempolicy.h>)
+#include <linux/mempolicy.h>
+#define MINIOB_HAVE_MBIND 1
+#endif
+#endif
+
+#include "common/os/numa.h"
+#include "common/log/log.h"
+
+namespace common {
+
+namespace {
+
+/**
+ * 解析 "0-3,8,10-11" 这样的列表
+ */
+std::vector<int> parse_list(const std::string &str)
+{
+  std::vector<int> result;
+  const char *p = str.c_str();
+  while (*p != '\0' && *p != '\n') {
+    char *end = nullptr;
+    const long first = strtol(p, &end, 10);
+    if (end == p) {
+      break;
+    }
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      last = strtol(p + 1, &end, 10);
+      p = end;
+    }
+    for (long i = first; i <= last; i++) {
+      result.push_back(static_cast<int>(i));
+    }
+    if (*p == ',') {
+      p++;
+    }
+  }
+  return result;
+}
+
+std::string read_line(const std::string &file_name)
+{
+  std::ifstream ifs(file_name);
+  std::string line;
+  std::getline(ifs, line);
+  return line;
+}
+
+struct NumaTopology {
+  std::vector<std::vector<int>> node_cpus;  // 节点编号 -> CPU列表
+  std::vector<int>              cpu_nodes;  // CPU编号 -> 节点编号
+
+  NumaTopology()
+  {
+#if defined(__linux__)
+    const std::string node_dir = "/sys/devices/system/node/";
+    std::vector<int> nodes = parse_list(read_line(node_dir + "online"));
+    for (int node : nodes) {
+      if (node < 0 || node >= 1024) {
+        continue;
+      }
+      if (node_cpus.size() <= static_cast<size_t>(node)) {
+        node_cpus.resize(node + 1);
+      }
+      node_cpus[node] = parse_list(read_line(node_dir + "node" + std::to_string(node) + "/cpulist"));
+      for (int cpu : node_cpus[node]) {
+        if (cpu_nodes.size() <= static_cast<size_t>(cpu)) {
+          cpu_nodes.resize(cpu + 1, 0);
+        }
+        cpu_nodes[cpu] = node;
+      }
+    }
+#endif
+    if (node_cpus.empty()) {
+      node_cpus.resize(1);
+    }
+  }
+};
+
+const NumaTopology &topology()
+{
+  static NumaTopology topology;
+  return topology;
+}
+
+thread_local int bound_node = -1;
+
+}  // namespace
+
+int numa_node_num()
+{
+  return static_cast<int>(topology().node_cpus.size());
+}
+
+int numa_node_of_cpu(int cpu)
+{
+  const std::vector<int> &cpu_nodes = topology().cpu_nodes;
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_nodes.size()) {
+    return 0;
+  }
+  return cpu_nodes[cpu];
+}
+
+int numa_current_node()
+{
+  if (bound_node >= 0) {
+    return bound_node;
+  }
+#if defined(__linux__)
+  return numa_node_of_cpu(sched_getcpu());
+#else
+  return 0;
+#endif
+}
+
+bool numa_bind_thread(int node)
+{
+  const NumaTopology &topo = topology();
+  if (node < 0 || static_cast<size_t>(node) >= topo.node_cpus.size() || topo.node_cpus[node].empty()) {
+    return false;
+  }
+
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : topo.node_cpus[node]) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+  if (0 != sched_setaffinity(0, sizeof(cpu_set), &cpu_set)) {
+    LOG_WARN("failed to bind thread to numa node %d. error=%s", node, strerror(errno));
+    return false;
+  }
+  bound_node = node;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool numa_bind_memory(void *addr, size_t size, int node)
+{
+#ifdef MINIOB_HAVE_MBIND
+  const int bits = static_cast<int>(sizeof(unsigned long) * 8);
+  if (node < 0 || node >= numa_node_num() || node >= bits) {
+    return false;
+  }
+  unsigned long node_mask = 1UL << node;
+  if (0 != syscall(__NR_mbind, addr, size, MPOL_PREFERRED, &node_mask, bits + 1, 0)) {
+    LOG_WARN("failed to bind memory to numa node %d. addr=%p, size=%lu, error=%s", node, addr, size, strerror(errno));
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace common
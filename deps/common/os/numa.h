@@ -0,0 +1,56 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/10.
+//
+
+#ifndef __COMMON_OS_NUMA_H__
+#define __COMMON_OS_NUMA_H__
+
+#include <stddef.h>
+
+namespace common {
+
+/**
+ * NUMA相关的简单封装。拓扑从/sys/devices/system/node中读取，内存绑定直接使用mbind系统调用，
+ * 不依赖libnuma。不支持NUMA的系统上当作只有一个节点，绑定操作什么都不做。
+ */
+
+/**
+ * 在线的NUMA节点个数，至少是1
+ */
+int numa_node_num();
+
+/**
+ * CPU所在的节点，未知时返回0
+ */
+int numa_node_of_cpu(int cpu);
+
+/**
+ * 当前线程所在的节点。绑定过节点的线程直接返回绑定的节点，否则根据当前运行的CPU查找
+ */
+int numa_current_node();
+
+/**
+ * 将当前线程绑定到节点的所有CPU上
+ * @return 节点不存在或者绑定失败时返回false
+ */
+bool numa_bind_thread(int node);
+
+/**
+ * 这段内存优先从节点node上分配物理内存(MPOL_PREFERRED)，节点内存不足时可以从其它节点分配。
+ * 只影响还没有分配物理内存的页面，需要在第一次访问之前调用。addr需要按照操作系统页面对齐
+ * @return 节点不存在或者系统不支持时返回false
+ */
+bool numa_bind_memory(void *addr, size_t size, int node);
+
+}  // namespace common
+#endif  // __COMMON_OS_NUMA_H__
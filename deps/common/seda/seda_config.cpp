@@ -255,7 +255,10 @@ SedaConfig::status_t SedaConfig::init_thread_pool()
         return INITFAIL;
       }
 
-      Threadpool *thread_pool = new Threadpool(thread_count, thread_name);
+      key = NUMA_BIND;
+      const bool numa_bind = get_properties()->get(key, "false", thread_name) == "true";
+
+      Threadpool *thread_pool = new Threadpool(thread_count, thread_name, numa_bind);
       if (thread_pool == NULL) {
         LOG_ERROR("Failed to new %s threadpool\n", thread_name.c_str());
         return INITFAIL;
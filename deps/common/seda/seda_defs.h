@@ -23,6 +23,7 @@ See the Mulan PSL v2 for more details. */
 #define MAX_EVENT_HISTORY_NUM "MaxEventHistoryNum"
 
 #define COUNT "count"
+#define NUMA_BIND "numa_bind"
 
 #define THREAD_POOL_ID "ThreadId"
 
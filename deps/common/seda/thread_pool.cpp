@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/mutex.h"
 #include "common/log/log.h"
+#include "common/os/numa.h"
 #include "common/seda/stage.h"
 namespace common {
 
@@ -30,14 +31,15 @@ extern bool &get_event_history_flag();
  *
  * @post thread pool has <i>threads</i> threads running
  */
-Threadpool::Threadpool(unsigned int threads, const std::string &name)
+Threadpool::Threadpool(unsigned int threads, const std::string &name, bool numa_bind)
     : run_queue_(),
       eventhist_(get_event_history_flag()),
       nthreads_(0),
       threads_to_kill_(0),
       n_idles_(0),
       killer_("KillThreads"),
-      name_(name)
+      name_(name),
+      numa_bind_(numa_bind)
 {
   LOG_TRACE("Enter, thread number:%d", threads);
   MUTEX_INIT(&run_mutex_, NULL);
@@ -262,6 +264,15 @@ void *Threadpool::run_thread(void *pool_ptr)
   pthread_setname_np(pthread_self(), pool->get_name().c_str());
 #endif
 
+  // threads are spread over the numa nodes, and the pages they load first
+  // will be placed on their nodes by the buffer pool
+  if (pool->numa_bind_ && numa_node_num() > 1) {
+    const int node = static_cast<int>(pool->thread_seq_++ % numa_node_num());
+    if (numa_bind_thread(node)) {
+      LOG_INFO("bind thread %llx of %s to numa node %d", threadid, pool->get_name().c_str(), node);
+    }
+  }
+
   // enter a loop where we continuously look for events from Stages on
   // the run_queue_ and handle the event.
   while (1) {
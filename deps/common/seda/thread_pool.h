@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #ifndef __COMMON_SEDA_THREAD_POOL_H__
 #define __COMMON_SEDA_THREAD_POOL_H__
 
+#include <atomic>
 #include <deque>
 
 #include "common/defs.h"
@@ -53,10 +54,11 @@ public:
    * Constructor
    * @param[in] threads The number of threads to create.
    * @param[in] name    Name of the thread pool.
+   * @param[in] numa_bind Bind the threads to numa nodes in round robin.
    *
    * @post thread pool has <i>threads</i> threads running
    */
-  Threadpool(unsigned int threads, const std::string &name = std::string());
+  Threadpool(unsigned int threads, const std::string &name = std::string(), bool numa_bind = false);
 
   /**
    * Destructor
@@ -157,6 +159,8 @@ private:
   unsigned int n_idles_;          //< number of idle threads
   KillThreadStage killer_;        //< used to kill threads
   std::string name_;              //< name of threadpool
+  bool numa_bind_;                //< bind threads to numa nodes
+  std::atomic<unsigned int> thread_seq_{0};  //< used to choose the numa node of a new thread
 
   // key of thread specific to store thread pool pointer
   static pthread_key_t pool_ptr_key_;
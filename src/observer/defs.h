@@ -14,5 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <stdint.h>
+
 using PageNum = int32_t;
 using SlotNum = int32_t;
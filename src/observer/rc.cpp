@@ -69,6 +69,7 @@ const char *strrc(RC rc)
     RC_CASE_STRING(BUFFERPOOL_PAGE_PINNED);
     RC_CASE_STRING(BUFFERPOOL_OPEN_TOO_MANY_FILES);
     RC_CASE_STRING(BUFFERPOOL_ILLEGAL_FILE_ID);
+    RC_CASE_STRING(BUFFERPOOL_PAGE_CORRUPTED);
 
     RC_CASE_STRING(RECORD_CLOSED);
     RC_CASE_STRING(RECORD_OPENNED);
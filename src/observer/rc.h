@@ -30,6 +30,7 @@ enum RCBufferPool {
   BP_PAGE_PINNED,
   BP_OPEN_TOO_MANY_FILES,
   BP_ILLEGAL_FILE_ID,
+  BP_PAGE_CORRUPTED,
 };
 
 enum RCRecord {
@@ -242,6 +243,8 @@ enum RC {
       (BUFFERPOOL | (RCBufferPool::BP_OPEN_TOO_MANY_FILES << 8)),
   BUFFERPOOL_ILLEGAL_FILE_ID =
       (BUFFERPOOL | (RCBufferPool::BP_ILLEGAL_FILE_ID << 8)),
+  BUFFERPOOL_PAGE_CORRUPTED =
+      (BUFFERPOOL | (RCBufferPool::BP_PAGE_CORRUPTED << 8)),
 
   /* record part */
   RECORD_CLOSED = (RECORD | (RCRecord::RD_CLOSED << 8)),
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "session/session.h"
 #include "storage/trx/trx.h"
+#include "common/log/log.h"
 #include "storage/common/db.h"
 #include "storage/default/default_handler.h"
 
@@ -23,7 +24,11 @@ Session &Session::default_session()
   return session;
 }
 
-Session::Session(const Session &other) : db_(other.db_)
+Session::Session(const Session &other)
+    : db_(other.db_),
+      buffer_pool_(other.buffer_pool_),
+      page_size_(other.page_size_),
+      record_format_(other.record_format_)
 {}
 
 Session::~Session()
@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 
 #include <string>
 
+#include "storage/record/record.h"
+
 class Trx;
 class Db;
 
@@ -41,8 +43,29 @@ public:
 
   Trx *current_trx();
 
+  /**
+   * 之后创建的表和索引使用的缓冲池，空表示默认的缓冲池
+   */
+  void set_buffer_pool(const std::string &buffer_pool) { buffer_pool_ = buffer_pool; }
+  const char *buffer_pool() const { return buffer_pool_.c_str(); }
+
+  /**
+   * 之后创建的表的数据文件和索引文件的页面大小，0表示默认的页面大小
+   */
+  void set_page_size(int page_size) { page_size_ = page_size; }
+  int page_size() const { return page_size_; }
+
+  /**
+   * 之后创建的表的记录存放格式
+   */
+  void set_record_format(RecordFormat record_format) { record_format_ = record_format; }
+  RecordFormat record_format() const { return record_format_; }
+
 private:
   Db *db_ = nullptr;
   Trx *trx_ = nullptr;
   bool trx_multi_operation_mode_ = false;  // 当前事务的模式，是否多语句模式. 单语句模式自动提交
+  std::string buffer_pool_;
+  int page_size_ = 0;
+  RecordFormat record_format_ = RecordFormat::FIXED;
 };
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "execute_stage.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -44,6 +45,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/common/field.h"
 #include "storage/common/table.h"
 #include "storage/default/default_handler.h"
+#include "storage/default/disk_buffer_pool.h"
 #include "storage/index/index.h"
 #include "storage/trx/trx.h"
 
@@ -206,6 +208,12 @@ void ExecuteStage::handle_request(common::StageEvent *event) {
         session->set_trx_multi_operation_mode(false);
         session_event->set_response(strrc(rc));
       } break;
+      case SCF_SET_VARIABLE: {
+        do_set_variable(sql_event);
+      } break;
+      case SCF_SHOW_BUFFER_POOL: {
+        do_show_buffer_pool(sql_event);
+      } break;
       case SCF_EXIT: {
         // do nothing
         const char *response = "Unsupported\n";
@@ -443,7 +451,7 @@ RC ExecuteStage::do_select(SQLStageEvent *sql_event) {
     std::vector<TableScanOperator *> table_scan_operator_vector;
     for (Table *table : table_vector) {
       // std::cout << " | " << table->name() << std::endl;
-      TableScanOperator *scan_oper = new TableScanOperator(table);
+      TableScanOperator *scan_oper = new TableScanOperator(table, true);
       table_scan_operator_vector.push_back(scan_oper);
     }
 
@@ -516,7 +524,7 @@ RC ExecuteStage::do_select(SQLStageEvent *sql_event) {
     Operator *scan_oper =
         try_to_create_index_scan_operator(select_stmt->filter_stmt());
     if (nullptr == scan_oper) {
-      scan_oper = new TableScanOperator(select_stmt->tables()[0]);
+      scan_oper = new TableScanOperator(select_stmt->tables()[0], true);
     }
     // Operator *scan_oper = new TableScanOperator(select_stmt->tables()[0]);
     DEFER([&]() { delete scan_oper; });
@@ -572,7 +580,12 @@ RC ExecuteStage::do_help(SQLStageEvent *sql_event) {
       "insert into `table` values(`value1`,`value2`);\n"
       "update `table` set column=value [where `column`=`value`];\n"
       "delete from `table` [where `column`=`value`];\n"
-      "select [ * | `columns` ] from `table`;\n";
+      "select [ * | `columns` ] from `table`;\n"
+      "set buffer_pool_size = `bytes` | '`size`[K|M|G]';\n"
+      "set buffer_pool = '`pool name`';\n"
+      "set page_size = `bytes` | '`size`K';\n"
+      "set record_format = 'fixed' | 'slotted';\n"
+      "show bufferpool status;\n";
   session_event->set_response(response);
   return RC::SUCCESS;
 }
@@ -583,7 +596,8 @@ RC ExecuteStage::do_create_table(SQLStageEvent *sql_event) {
   Db *db = session_event->session()->get_current_db();
   RC rc =
       db->create_table(create_table.relation_name, create_table.attribute_count,
-                       create_table.attributes);
+                       create_table.attributes, session_event->session()->buffer_pool(),
+                       session_event->session()->page_size(), session_event->session()->record_format());
   if (rc == RC::SUCCESS) {
     session_event->set_response("SUCCESS\n");
   } else {
@@ -619,7 +633,8 @@ RC ExecuteStage::do_create_index(SQLStageEvent *sql_event) {
     attr_names.push_back(create_index.attribute_name[i]);
   }
   RC rc =
-      table->create_index(nullptr, create_index.index_name, attr_names, false);
+      table->create_index(nullptr, create_index.index_name, attr_names, false,
+                          session_event->session()->buffer_pool(), session_event->session()->page_size());
   sql_event->session_event()->set_response(rc == RC::SUCCESS ? "SUCCESS\n"
                                                              : "FAILURE\n");
   return rc;
@@ -641,7 +656,8 @@ RC ExecuteStage::do_create_unique_index(SQLStageEvent *sql_event) {
     attr_names.push_back(create_unique_index.attribute_name[i]);
   }
   RC rc = table->create_index(nullptr, create_unique_index.index_name,
-                              attr_names, true);
+                              attr_names, true, session_event->session()->buffer_pool(),
+                              session_event->session()->page_size());
   sql_event->session_event()->set_response(rc == RC::SUCCESS ? "SUCCESS\n"
                                                              : "FAILURE\n");
   return rc;
@@ -775,40 +791,31 @@ RC ExecuteStage::do_insert(SQLStageEvent *sql_event) {
   Table *table = insert_stmt->table();
   int value_length = insert_stmt->value_amount();
   int insert_num= insert_stmt->value_insert_num();
-  RC rc = RC::SUCCESS;
-  // 循环插入语句即可 -----
-  for (int i = 0; i < insert_num; i++) {
-    const Value *value_insert = &insert_stmt->values()[i * value_length];
-    
+  // 一条语句中的所有行批量插入，只提交一次日志
+  RC rc = table->insert_records(trx, value_length, insert_stmt->values(), insert_num);
+  if (rc != RC::SUCCESS) {
+    session_event->set_response("FAILURE\n");
+    return rc;
+  }
 
-    RC rc = table->insert_record(trx, value_length, value_insert);
-    if (rc == RC::SUCCESS) {
-      if (!session->is_trx_multi_operation_mode()) {
-        CLogRecord *clog_record = nullptr;
-        rc = clog_manager->clog_gen_record(CLogType::REDO_MTR_COMMIT,
-                                           trx->get_current_id(), clog_record);
-        if (rc != RC::SUCCESS || clog_record == nullptr) {
-          session_event->set_response("FAILURE\n");
-          return rc;
-        }
-
-        rc = clog_manager->clog_append_record(clog_record);
-        if (rc != RC::SUCCESS) {
-          session_event->set_response("FAILURE\n");
-          return rc;
-        }
-
-        trx->next_current_id();
-        session_event->set_response("SUCCESS\n");
-      } else {
-        session_event->set_response("SUCCESS\n");
-      }
-    } else {
+  if (!session->is_trx_multi_operation_mode()) {
+    CLogRecord *clog_record = nullptr;
+    rc = clog_manager->clog_gen_record(CLogType::REDO_MTR_COMMIT,
+                                       trx->get_current_id(), clog_record);
+    if (rc != RC::SUCCESS || clog_record == nullptr) {
       session_event->set_response("FAILURE\n");
+      return rc;
     }
-  }
 
-  // ------
+    rc = clog_manager->clog_append_record(clog_record);
+    if (rc != RC::SUCCESS) {
+      session_event->set_response("FAILURE\n");
+      return rc;
+    }
+
+    trx->next_current_id();
+  }
+  session_event->set_response("SUCCESS\n");
   return rc;
 }
 
@@ -932,3 +939,100 @@ RC ExecuteStage::do_clog_sync(SQLStageEvent *sql_event) {
 
   return rc;
 }
+
+RC ExecuteStage::do_set_variable(SQLStageEvent *sql_event) {
+  const SetVariable &set_variable = sql_event->query()->sstr.set_variable;
+  SessionEvent *session_event = sql_event->session_event();
+
+  RC rc = RC::SUCCESS;
+  if (0 == strcasecmp(set_variable.name, "buffer_pool_size")) {
+    const Value &value = set_variable.value;
+    size_t bytes = 0;
+    if (value.type == INTS && *(int *)value.data > 0) {
+      bytes = *(int *)value.data;
+    } else if (value.type != CHARS || !str_to_bytes((const char *)value.data, bytes)) {
+      rc = RC::INVALID_ARGUMENT;
+    }
+
+    if (rc == RC::SUCCESS) {
+      rc = BufferPoolManager::instance().resize(bytes);
+    }
+  } else if (0 == strcasecmp(set_variable.name, "buffer_pool")) {
+    // 之后在这个会话中创建的表和索引使用指定的缓冲池
+    const Value &value = set_variable.value;
+    if (value.type != CHARS || BufferPoolManager::instance().find_pool((const char *)value.data) == nullptr) {
+      LOG_WARN("no such buffer pool");
+      rc = RC::INVALID_ARGUMENT;
+    } else {
+      session_event->session()->set_buffer_pool((const char *)value.data);
+    }
+  } else if (0 == strcasecmp(set_variable.name, "page_size")) {
+    // 之后在这个会话中创建的表和索引使用指定的页面大小，0表示默认的页面大小
+    const Value &value = set_variable.value;
+    size_t page_size = 0;
+    if (value.type == INTS && *(int *)value.data >= 0) {
+      page_size = *(int *)value.data;
+    } else if (value.type != CHARS || !str_to_bytes((const char *)value.data, page_size)) {
+      rc = RC::INVALID_ARGUMENT;
+    }
+
+    if (rc == RC::SUCCESS && page_size != 0 && !BPFileHeader::valid_page_size(static_cast<int>(page_size))) {
+      LOG_WARN("invalid page size %lu", page_size);
+      rc = RC::INVALID_ARGUMENT;
+    }
+    if (rc == RC::SUCCESS) {
+      session_event->session()->set_page_size(static_cast<int>(page_size));
+    }
+  } else if (0 == strcasecmp(set_variable.name, "record_format")) {
+    // 之后在这个会话中创建的表使用的记录格式，slotted格式的字符串字段按实际长度存放
+    const Value &value = set_variable.value;
+    RecordFormat record_format = RecordFormat::FIXED;
+    if (value.type != CHARS || !record_format_from_name((const char *)value.data, record_format)) {
+      LOG_WARN("invalid record format");
+      rc = RC::INVALID_ARGUMENT;
+    } else {
+      session_event->session()->set_record_format(record_format);
+    }
+  } else {
+    LOG_WARN("unknown variable %s", set_variable.name);
+    rc = RC::INVALID_ARGUMENT;
+  }
+
+  if (rc != RC::SUCCESS) {
+    session_event->set_response("FAILURE\n");
+  } else {
+    session_event->set_response("SUCCESS\n");
+  }
+  return rc;
+}
+
+RC ExecuteStage::do_show_buffer_pool(SQLStageEvent *sql_event) {
+  SessionEvent *session_event = sql_event->session_event();
+
+  // 每个数据文件和索引文件一行，按照文件名排序
+  std::vector<std::pair<std::string, std::string>> rows;
+  BufferPoolManager::instance().foreach_buffer_pool([&rows](DiskBufferPool &bp) {
+    const DiskBufferPool::Stats &stats = bp.stats();
+    const long hits = stats.hits.load();
+    const long misses = stats.misses.load();
+    char hit_rate[32];
+    snprintf(hit_rate, sizeof(hit_rate), "%.2lf%%", hits + misses > 0 ? hits * 100.0 / (hits + misses) : 0.0);
+
+    std::stringstream ss;
+    ss << bp.file_name() << " | " << bp.pool_name() << " | " << bp.page_size() << " | " << hits << " | " << misses << " | " << hit_rate << " | "
+       << stats.prefetched.load() << " | " << stats.evictions.load() << " | " << stats.dirty_writes.load() << " | "
+       << stats.mapped_reads.load() << " | " << (long)stats.read_latency.mean_us() << " | " << stats.read_latency.percentile_us(0.99) << " | "
+       << (long)stats.write_latency.mean_us() << " | " << stats.write_latency.percentile_us(0.99);
+    rows.emplace_back(bp.file_name(), ss.str());
+  });
+  std::sort(rows.begin(), rows.end());
+
+  std::stringstream ss;
+  ss << "FILE | POOL | PAGE_SIZE | HITS | MISSES | HIT_RATE | PREFETCHED | EVICTIONS | DIRTY_WRITES | MAPPED_READS | "
+     << "READ_AVG_US | READ_P99_US | WRITE_AVG_US | WRITE_P99_US" << std::endl;
+  for (const auto &row : rows) {
+    ss << row.second << std::endl;
+  }
+  session_event->set_response(ss.str().c_str());
+  return RC::SUCCESS;
+}
@@ -54,6 +54,8 @@ protected:
   RC do_clog_sync(SQLStageEvent *sql_event);
   RC do_drop_table(SQLStageEvent *sql_event);
   RC do_update(SQLStageEvent *sql_event);
+  RC do_set_variable(SQLStageEvent *sql_event);
+  RC do_show_buffer_pool(SQLStageEvent *sql_event);
 
 protected:
 private:
@@ -0,0 +1,55 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its
+affiliates. All rights reserved. miniob is licensed under Mulan PSL v2. You can
+use this software according to the terms and conditions of the Mulan PSL v2. You
+may obtain a copy of Mulan PSL v2 at: http://license.coscl.org.cn/MulanPSL2 THIS
+SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/16.
+//
+
+#include "sql/expr/tuple.h"
+
+#include <string.h>
+
+#include "storage/common/table.h"
+
+RC RowTuple::find_cell(const Field &field, TupleCell &cell) const {
+  char *table_name = (char *)field.table_name();
+  if (0 != strcmp(table_name, table_->name())) {
+    return RC::NOTFOUND;
+  }
+
+  const char *field_name = field.field_name();
+  for (size_t i = 0; i < speces_.size(); ++i) {
+    const FieldExpr *field_expr = (const FieldExpr *)speces_[i]->expression();
+    const Field &field_tmp = field_expr->field();
+    if (0 == strcmp(field_name, field_tmp.field_name())) {  // TO CHECK
+      return cell_at(i, cell);
+    }
+  }
+  return RC::NOTFOUND;
+}
+
+bool RowTuple::is_tuple_empty() { return table_->is_table_empty(); }
+
+RC RowTuple::text_cell_at(const FieldMeta &field_meta, TupleCell &cell) const {
+  const char *field_data = this->record_->data() + field_meta.offset();
+  CachedText &cached = texts_[field_meta.offset()];
+  if (!cached.valid || cached.rid != record_->rid() || memcmp(cached.text_ref, field_data, TEXT_FIELD_LENGTH) != 0) {
+    RC rc = table_->read_text(field_meta, this->record_->data(), cached.text);
+    if (rc != RC::SUCCESS) {
+      cached.valid = false;
+      return rc;
+    }
+    cached.valid = true;
+    cached.rid = record_->rid();
+    memcpy(cached.text_ref, field_data, TEXT_FIELD_LENGTH);
+  }
+  cell.set_data(cached.text.data());
+  cell.set_length(cached.text.size());
+  return RC::SUCCESS;
+}
@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "common/log/log.h"
@@ -79,10 +81,14 @@ class RowTuple : public Tuple {
     speces_.clear();
   }
 
-  void set_record(Record *record) { this->record_ = record; }
+  void set_record(Record *record) {
+    this->record_ = record;
+    texts_.clear();
+  }
 
   void set_schema(const Table *table, const std::vector<FieldMeta> *fields) {
     table_ = table;
+    texts_.clear();
     this->speces_.reserve(
         fields->size());  // 声明speces_至少保留fields->size()个元素
     for (const FieldMeta &field : *fields) {
@@ -102,27 +108,15 @@ class RowTuple : public Tuple {
     FieldExpr *field_expr = (FieldExpr *)spec->expression();
     const FieldMeta *field_meta = field_expr->field().meta();
     cell.set_type(field_meta->type());
+    if (field_meta->overflow_text()) {
+      return text_cell_at(*field_meta, cell);
+    }
     cell.set_data(this->record_->data() + field_meta->offset());
     cell.set_length(field_meta->len());
     return RC::SUCCESS;
   }
 
-  RC find_cell(const Field &field, TupleCell &cell) const override {
-    char *table_name = (char *)field.table_name();
-    if (0 != strcmp(table_name, table_->name())) {
-      return RC::NOTFOUND;
-    }
-
-    const char *field_name = field.field_name();
-    for (size_t i = 0; i < speces_.size(); ++i) {
-      const FieldExpr *field_expr = (const FieldExpr *)speces_[i]->expression();
-      const Field &field_tmp = field_expr->field();
-      if (0 == strcmp(field_name, field_tmp.field_name())) {  // TO CHECK
-        return cell_at(i, cell);
-      }
-    }
-    return RC::NOTFOUND;
-  }
+  RC find_cell(const Field &field, TupleCell &cell) const override;
 
   RC cell_spec_at(int index, const TupleCellSpec *&spec) const override {
     if (index < 0 || index >= static_cast<int>(speces_.size())) {
@@ -163,12 +157,27 @@ class RowTuple : public Tuple {
 
   std::vector<TupleCellSpec *> get_speces() { return speces_; }
 
-  bool is_tuple_empty() { return table_->is_table_empty(); }
+  bool is_tuple_empty();
 
  private:
+  /**
+   * TEXT字段只有在投影或者比较的时候才读取溢出页面。扫描时同一个Record对象会被反复使用，
+   * 读出来的文本按照记录中的TextRef缓存，记录变化之后重新读取
+   */
+  RC text_cell_at(const FieldMeta &field_meta, TupleCell &cell) const;
+
+ private:
+  struct CachedText {
+    bool valid = false;
+    RID rid;
+    char text_ref[TEXT_FIELD_LENGTH];
+    std::string text;
+  };
+
   Record *record_ = nullptr;
   const Table *table_ = nullptr;
   std::vector<TupleCellSpec *> speces_;
+  mutable std::unordered_map<int, CachedText> texts_;
 };
 
 class CompositeTuple : public Tuple {
@@ -106,6 +106,10 @@ int TupleCell::compare(const TupleCell &other) const {
   } else if (this->attr_type_ == FLOATS && other.attr_type_ == INTS) {
     float other_data = *(int *)other.data_;
     return compare_float(data_, &other_data);
+  } else if ((this->attr_type_ == CHARS || this->attr_type_ == TEXTS) &&
+             (other.attr_type_ == CHARS || other.attr_type_ == TEXTS)) {
+    // TEXT字段和字符串常量比较
+    return compare_string(this->data_, this->length_, other.data_, other.length_);
   } else if (this->attr_type_ == CHARS) {
     std::string this_chars_ptr = std::string(this->data_, this->length_);
     float this_result = std::atof(this_chars_ptr.c_str());
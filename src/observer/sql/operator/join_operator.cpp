@@ -80,7 +80,8 @@ RC JoinOperator::next() {
   else if ((rc = left_operator->next()) != RC::RECORD_EOF) {
     TableScanOperator *scan_oper_tmp =
         new TableScanOperator(  //感觉是这个地方出了问题
-            ((TableScanOperator *)right_operator)->table_external);
+            ((TableScanOperator *)right_operator)->table_external,
+            ((TableScanOperator *)right_operator)->readonly());
 
     rc = scan_oper_tmp->open();
     this->set_right_operator(scan_oper_tmp);
@@ -17,7 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/common/table.h"
 
 RC TableScanOperator::open() {
-  RC rc = table_->get_record_scanner(record_scanner_);
+  RC rc = table_->get_record_scanner(record_scanner_, readonly_);
   if (rc == RC::SUCCESS) {
     tuple_.set_schema(table_, table_->table_meta().field_metas());
   }
@@ -35,7 +35,7 @@ RC TableScanOperator::next() {
 RC TableScanOperator::fresh() {
   RC rc = RC::SUCCESS;
   record_scanner_.close_scan();
-  rc = table_->get_record_scanner(record_scanner_);
+  rc = table_->get_record_scanner(record_scanner_, readonly_);
   if (rc == RC::SUCCESS) {
     tuple_.set_schema(table_, table_->table_meta().field_metas());
   }
@@ -21,7 +21,10 @@ class Table;
 
 class TableScanOperator : public Operator {
  public:
-  TableScanOperator(Table *table) : table_(table) {
+  /**
+   * @param readonly 只用于查询，扫描出来的记录不会被修改
+   */
+  TableScanOperator(Table *table, bool readonly = false) : table_(table), readonly_(readonly) {
     opertype_ = OperType::SCAN_OPERATOR;
     table_external = table;
   }
@@ -37,6 +40,7 @@ class TableScanOperator : public Operator {
     tuple = &tuple_;
     return RC::SUCCESS;
   }
+  bool readonly() const { return readonly_; }
   RC get_table(Table *&table) {
     table = table_;
     return RC::SUCCESS;
@@ -58,7 +62,7 @@ class TableScanOperator : public Operator {
   }
   // reset_scanner_to_top() 负责刷新内部的record_scanner到表头
   RC reset_scanner_to_top() {
-    RC rc = table_->get_record_scanner(record_scanner_);
+    RC rc = table_->get_record_scanner(record_scanner_, readonly_);
     if (rc == RC::SUCCESS) {
       tuple_.set_schema(table_, table_->table_meta().field_metas());
     }
@@ -85,6 +89,7 @@ class TableScanOperator : public Operator {
 
  private:
   Table *table_ = nullptr;
+  bool readonly_ = false;
   bool dirty_flag = false;  // 用来标记当前Operator是否已经访问过
   RecordFileScanner record_scanner_;
   Record current_record_;
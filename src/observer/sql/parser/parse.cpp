@@ -61,11 +61,7 @@ void value_init_string(Value *value, const char *v, int len)
   if (len > 24) {
     // if(len>4096)
     value->type = TEXTS;
-    const int text_size = 4096;
-    char *tmp = new char[text_size];
-    memset(tmp, 0, text_size);
-    memcpy(tmp, v, text_size);
-    value->data = tmp;
+    value->data = strdup(v);
   } else {
     value->type = CHARS;
     value->data = strdup(v);
@@ -147,7 +143,7 @@ void attr_info_init(AttrInfo *attr_info, const char *name, AttrType type, size_t
   attr_info->name = strdup(name);
   attr_info->type = type;
   if (type == AttrType::TEXTS) {
-    attr_info->length = 4096;
+    attr_info->length = TEXT_FIELD_LENGTH;
   } else {
     attr_info->length = length;
   }
@@ -430,6 +426,19 @@ void load_data_destroy(LoadData *load_data)
   load_data->file_name = nullptr;
 }
 
+void set_variable_init(SetVariable *set_variable, const char *name, Value *value)
+{
+  set_variable->name = strdup(name);
+  set_variable->value = *value;
+}
+
+void set_variable_destroy(SetVariable *set_variable)
+{
+  free(set_variable->name);
+  set_variable->name = nullptr;
+  value_destroy(&set_variable->value);
+}
+
 void query_init(Query *query)
 {
   query->flag = SCF_ERROR;
@@ -484,6 +493,7 @@ void query_reset(Query *query)
     case SCF_SYNC: {
     } break;
     case SCF_SHOW_TABLES:
+    case SCF_SHOW_BUFFER_POOL:
       break;
 
     case SCF_DESC_TABLE: {
@@ -493,6 +503,9 @@ void query_reset(Query *query)
     case SCF_LOAD_DATA: {
       load_data_destroy(&query->sstr.load_data);
     } break;
+    case SCF_SET_VARIABLE: {
+      set_variable_destroy(&query->sstr.set_variable);
+    } break;
     case SCF_CLOG_SYNC:
     case SCF_BEGIN:
     case SCF_COMMIT:
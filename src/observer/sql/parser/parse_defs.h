@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #define MAX_ATTR_NAME 20
 #define MAX_ERROR_MESSAGE 20
 #define MAX_DATA 50
+#define MAX_VALUE_NUM 1024  // 一条语句中最多的值个数，多行insert的所有行加起来不能超过这个数
 
 //属性结构体
 typedef struct {
@@ -40,6 +41,9 @@ typedef enum {
   NO_OP
 } CompOp;
 
+#define TEXT_FIELD_LENGTH 64    // TEXT字段在记录中占用的长度，参考TextRef
+#define TEXT_MAX_LENGTH 65535   // TEXT字段的最大长度
+
 //属性值类型
 typedef enum
 {
@@ -85,7 +89,7 @@ typedef struct {
   char *relation_name;    // Relation to insert into
   size_t value_num;       // Length of values
   size_t value_insert_length; // the number of insert
-  Value values[MAX_NUM];  // values to insert
+  Value values[MAX_VALUE_NUM];  // values to insert
 } Inserts;
 
 // struct of delete
@@ -162,6 +166,12 @@ typedef struct {
   const char *file_name;
 } LoadData;
 
+// struct of set variable, like `set buffer_pool_size = '512M'`
+typedef struct {
+  char *name;   // variable name
+  Value value;  // variable value
+} SetVariable;
+
 union Queries {
   Selects selection;
   Inserts insertion;
@@ -175,6 +185,7 @@ union Queries {
   ShowIndex show_index;
   DescTable desc_table;
   LoadData load_data;
+  SetVariable set_variable;
   char *errors;
 };
 
@@ -200,7 +211,9 @@ enum SqlCommandFlag {
   SCF_ROLLBACK,
   SCF_LOAD_DATA,
   SCF_HELP,
-  SCF_EXIT
+  SCF_EXIT,
+  SCF_SET_VARIABLE,
+  SCF_SHOW_BUFFER_POOL
 };
 // struct of flag and sql_struct
 typedef struct Query {
@@ -293,6 +306,9 @@ void load_data_init(LoadData *load_data, const char *relation_name,
                     const char *file_name);
 void load_data_destroy(LoadData *load_data);
 
+void set_variable_init(SetVariable *set_variable, const char *name, Value *value);
+void set_variable_destroy(SetVariable *set_variable);
+
 void query_init(Query *query);
 Query *query_create();  // create and init
 void query_reset(Query *query);
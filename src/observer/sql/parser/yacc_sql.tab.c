@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2020 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -45,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.7"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -86,7 +86,7 @@ typedef struct ParserContext {
   size_t from_length;
   size_t value_length;
   size_t value_list_length;
-  Value values[MAX_NUM];
+  Value values[MAX_VALUE_NUM];
   Condition conditions[MAX_NUM];
   CompOp comp;
 	char id[MAX_NUM];
@@ -124,8 +124,17 @@ ParserContext *get_context(yyscan_t scanner)
 
 #define CONTEXT get_context(scanner)
 
+// values已经放满时报错退出，不能再写入
+#define CHECK_VALUE_NUM()                                   \
+  do {                                                      \
+    if (CONTEXT->value_length >= MAX_VALUE_NUM) {           \
+      yyerror(scanner, "too many values");                  \
+      YYABORT;                                              \
+    }                                                       \
+  } while (0)
 
-#line 129 "yacc_sql.tab.c"
+
+#line 138 "yacc_sql.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -217,40 +226,42 @@ enum yysymbol_kind_t
   YYSYMBOL_command = 61,                   /* command  */
   YYSYMBOL_exit = 62,                      /* exit  */
   YYSYMBOL_help = 63,                      /* help  */
-  YYSYMBOL_sync = 64,                      /* sync  */
-  YYSYMBOL_begin = 65,                     /* begin  */
-  YYSYMBOL_commit = 66,                    /* commit  */
-  YYSYMBOL_rollback = 67,                  /* rollback  */
-  YYSYMBOL_drop_table = 68,                /* drop_table  */
-  YYSYMBOL_show_tables = 69,               /* show_tables  */
-  YYSYMBOL_desc_table = 70,                /* desc_table  */
-  YYSYMBOL_create_index = 71,              /* create_index  */
-  YYSYMBOL_create_unique_index = 72,       /* create_unique_index  */
-  YYSYMBOL_drop_index = 73,                /* drop_index  */
-  YYSYMBOL_show_index = 74,                /* show_index  */
-  YYSYMBOL_create_table = 75,              /* create_table  */
-  YYSYMBOL_attr_def_list = 76,             /* attr_def_list  */
-  YYSYMBOL_attr_def = 77,                  /* attr_def  */
-  YYSYMBOL_number = 78,                    /* number  */
-  YYSYMBOL_type = 79,                      /* type  */
-  YYSYMBOL_ID_get = 80,                    /* ID_get  */
-  YYSYMBOL_insert = 81,                    /* insert  */
-  YYSYMBOL_value_info = 82,                /* value_info  */
-  YYSYMBOL_value_list = 83,                /* value_list  */
-  YYSYMBOL_value = 84,                     /* value  */
-  YYSYMBOL_delete = 85,                    /* delete  */
-  YYSYMBOL_update = 86,                    /* update  */
-  YYSYMBOL_select = 87,                    /* select  */
-  YYSYMBOL_select_attr = 88,               /* select_attr  */
-  YYSYMBOL_attr_list = 89,                 /* attr_list  */
-  YYSYMBOL_index_attr_list = 90,           /* index_attr_list  */
-  YYSYMBOL_unique_index_attr_list = 91,    /* unique_index_attr_list  */
-  YYSYMBOL_rel_list = 92,                  /* rel_list  */
-  YYSYMBOL_where = 93,                     /* where  */
-  YYSYMBOL_condition_list = 94,            /* condition_list  */
-  YYSYMBOL_condition = 95,                 /* condition  */
-  YYSYMBOL_comOp = 96,                     /* comOp  */
-  YYSYMBOL_load_data = 97                  /* load_data  */
+  YYSYMBOL_set_variable = 64,              /* set_variable  */
+  YYSYMBOL_show_buffer_pool = 65,          /* show_buffer_pool  */
+  YYSYMBOL_sync = 66,                      /* sync  */
+  YYSYMBOL_begin = 67,                     /* begin  */
+  YYSYMBOL_commit = 68,                    /* commit  */
+  YYSYMBOL_rollback = 69,                  /* rollback  */
+  YYSYMBOL_drop_table = 70,                /* drop_table  */
+  YYSYMBOL_show_tables = 71,               /* show_tables  */
+  YYSYMBOL_desc_table = 72,                /* desc_table  */
+  YYSYMBOL_create_index = 73,              /* create_index  */
+  YYSYMBOL_create_unique_index = 74,       /* create_unique_index  */
+  YYSYMBOL_drop_index = 75,                /* drop_index  */
+  YYSYMBOL_show_index = 76,                /* show_index  */
+  YYSYMBOL_create_table = 77,              /* create_table  */
+  YYSYMBOL_attr_def_list = 78,             /* attr_def_list  */
+  YYSYMBOL_attr_def = 79,                  /* attr_def  */
+  YYSYMBOL_number = 80,                    /* number  */
+  YYSYMBOL_type = 81,                      /* type  */
+  YYSYMBOL_ID_get = 82,                    /* ID_get  */
+  YYSYMBOL_insert = 83,                    /* insert  */
+  YYSYMBOL_value_info = 84,                /* value_info  */
+  YYSYMBOL_value_list = 85,                /* value_list  */
+  YYSYMBOL_value = 86,                     /* value  */
+  YYSYMBOL_delete = 87,                    /* delete  */
+  YYSYMBOL_update = 88,                    /* update  */
+  YYSYMBOL_select = 89,                    /* select  */
+  YYSYMBOL_select_attr = 90,               /* select_attr  */
+  YYSYMBOL_attr_list = 91,                 /* attr_list  */
+  YYSYMBOL_index_attr_list = 92,           /* index_attr_list  */
+  YYSYMBOL_unique_index_attr_list = 93,    /* unique_index_attr_list  */
+  YYSYMBOL_rel_list = 94,                  /* rel_list  */
+  YYSYMBOL_where = 95,                     /* where  */
+  YYSYMBOL_condition_list = 96,            /* condition_list  */
+  YYSYMBOL_condition = 97,                 /* condition  */
+  YYSYMBOL_comOp = 98,                     /* comOp  */
+  YYSYMBOL_load_data = 99                  /* load_data  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -294,6 +305,18 @@ typedef int_least16_t yytype_int16;
 typedef short yytype_int16;
 #endif
 
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
 #if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
 typedef __UINT_LEAST8_TYPE__ yytype_uint8;
 #elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
@@ -391,17 +414,23 @@ typedef int yy_state_fast_t;
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                            \
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
     _Pragma ("GCC diagnostic push")                                     \
     _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
 # define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
@@ -560,16 +589,16 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   191
+#define YYLAST   199
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  59
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  39
+#define YYNNTS  41
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  93
+#define YYNRULES  97
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  205
+#define YYNSTATES  215
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   313
@@ -621,19 +650,19 @@ static const yytype_int8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   148,   148,   150,   154,   155,   156,   157,   158,   159,
-     160,   161,   162,   163,   164,   165,   166,   167,   168,   169,
-     170,   171,   172,   176,   181,   186,   192,   198,   204,   210,
-     216,   222,   229,   237,   245,   252,   260,   269,   271,   275,
-     286,   299,   302,   303,   304,   305,   306,   309,   319,   334,
-     335,   339,   342,   344,   349,   352,   356,   364,   371,   381,
-     391,   410,   415,   420,   426,   428,   435,   445,   448,   458,
-     461,   470,   472,   476,   482,   484,   490,   492,   497,   518,
-     538,   558,   580,   601,   622,   645,   646,   647,   648,   649,
-     650,   651,   652,   658
+       0,   157,   157,   159,   163,   164,   165,   166,   167,   168,
+     169,   170,   171,   172,   173,   174,   175,   176,   177,   178,
+     179,   180,   181,   182,   183,   187,   192,   197,   205,   219,
+     225,   231,   237,   243,   249,   255,   262,   270,   278,   285,
+     293,   302,   304,   308,   319,   332,   335,   336,   337,   338,
+     339,   342,   352,   367,   368,   372,   375,   377,   382,   386,
+     391,   400,   408,   418,   428,   447,   452,   457,   463,   465,
+     472,   482,   485,   495,   498,   507,   509,   513,   519,   521,
+     527,   529,   534,   555,   575,   595,   617,   638,   659,   682,
+     683,   684,   685,   686,   687,   688,   689,   695
 };
 #endif
 
@@ -657,13 +686,14 @@ static const char *const yytname[] =
   "FROM", "WHERE", "AND", "SET", "ON", "LOAD", "DATA", "INFILE", "EQ",
   "LT", "GT", "LE", "GE", "NE", "LIKE", "NOT", "INNER", "JOIN", "NUMBER",
   "FLOAT", "ID", "PATH", "SSS", "DATE_STR", "STAR", "STRING_V", "$accept",
-  "commands", "command", "exit", "help", "sync", "begin", "commit",
-  "rollback", "drop_table", "show_tables", "desc_table", "create_index",
-  "create_unique_index", "drop_index", "show_index", "create_table",
-  "attr_def_list", "attr_def", "number", "type", "ID_get", "insert",
-  "value_info", "value_list", "value", "delete", "update", "select",
-  "select_attr", "attr_list", "index_attr_list", "unique_index_attr_list",
-  "rel_list", "where", "condition_list", "condition", "comOp", "load_data", YY_NULLPTR
+  "commands", "command", "exit", "help", "set_variable",
+  "show_buffer_pool", "sync", "begin", "commit", "rollback", "drop_table",
+  "show_tables", "desc_table", "create_index", "create_unique_index",
+  "drop_index", "show_index", "create_table", "attr_def_list", "attr_def",
+  "number", "type", "ID_get", "insert", "value_info", "value_list",
+  "value", "delete", "update", "select", "select_attr", "attr_list",
+  "index_attr_list", "unique_index_attr_list", "rel_list", "where",
+  "condition_list", "condition", "comOp", "load_data", YY_NULLPTR
 };
 
 static const char *
@@ -673,21 +703,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_int16 yytoknum[] =
-{
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,   302,   303,   304,
-     305,   306,   307,   308,   309,   310,   311,   312,   313
-};
-#endif
-
-#define YYPACT_NINF (-158)
+#define YYPACT_NINF (-166)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -697,185 +713,190 @@ static const yytype_int16 yytoknum[] =
 #define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-    -158,     5,  -158,    39,    43,   -29,   -45,    15,    32,    19,
-       9,     0,    70,    71,    76,    81,    87,    57,  -158,  -158,
-    -158,  -158,  -158,  -158,  -158,  -158,  -158,  -158,  -158,  -158,
-    -158,  -158,  -158,  -158,  -158,  -158,  -158,  -158,    49,    55,
-      99,    63,    64,     2,   100,    85,   117,   118,    89,  -158,
-      72,    73,    91,  -158,  -158,  -158,  -158,  -158,    83,   107,
-      92,    75,   127,   128,    79,    80,  -158,  -158,    82,  -158,
-    -158,    84,   102,   104,    86,    90,    93,    94,   103,  -158,
-    -158,    11,   100,   -13,   133,   124,    30,   139,   108,   112,
-    -158,   125,    88,   131,    97,    98,  -158,  -158,   101,   105,
-     104,  -158,    54,    10,  -158,  -158,    16,  -158,  -158,    24,
-     121,  -158,    54,   146,    93,   135,  -158,  -158,  -158,  -158,
-    -158,   140,   106,   141,   100,   -13,   109,   157,   142,  -158,
-     147,   110,  -158,  -158,  -158,  -158,  -158,  -158,  -158,   119,
-      36,    42,    30,  -158,   104,   114,   125,   162,   120,   149,
-     116,  -158,  -158,   136,  -158,    54,   152,    54,    24,  -158,
-    -158,  -158,   144,  -158,   121,   169,   172,  -158,  -158,  -158,
-     158,   126,   159,   161,    30,   142,  -158,   142,    48,   129,
-    -158,  -158,  -158,  -158,   149,   175,   130,   163,   121,  -158,
-     166,   155,  -158,  -158,  -158,  -158,   161,   183,   -13,  -158,
-     134,  -158,  -158,  -158,  -158
+    -166,     8,  -166,    58,    43,   -26,   -38,    -3,    13,     1,
+      19,   -15,    45,    51,    52,    62,    70,    39,    59,  -166,
+    -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,
+    -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,
+    -166,    66,    67,    96,    68,    69,    -5,    92,    90,   121,
+     122,    93,    74,  -166,    75,    76,    94,  -166,  -166,  -166,
+    -166,  -166,    95,    97,   114,    98,    79,   130,   131,    85,
+      86,  -166,  -166,    87,  -166,  -166,    88,   139,   111,   110,
+      99,    16,   100,   101,   103,   108,  -166,  -166,     5,    92,
+      -8,   143,  -166,   132,    38,   144,   107,  -166,  -166,  -166,
+    -166,   147,   120,  -166,   134,    91,   140,   105,   106,  -166,
+    -166,   109,   113,   110,  -166,    16,     7,    15,    35,   125,
+    -166,    16,  -166,   155,   101,   146,  -166,  -166,  -166,  -166,
+    -166,   148,   115,   149,    92,    -8,   116,   164,   151,  -166,
+     154,   119,  -166,  -166,  -166,  -166,  -166,  -166,  -166,   126,
+      44,    50,    38,  -166,   110,   123,   134,   171,   124,   158,
+     127,  -166,  -166,   141,  -166,    16,   161,    16,    35,  -166,
+    -166,  -166,   152,  -166,   125,   178,   180,  -166,  -166,  -166,
+     166,   133,   167,   168,    38,   151,  -166,   151,    57,   135,
+    -166,  -166,  -166,  -166,   158,   186,   137,   173,   125,  -166,
+     174,   163,  -166,  -166,  -166,  -166,   168,   191,    -8,  -166,
+     142,  -166,  -166,  -166,  -166
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
        2,     0,     1,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     3,    22,
-      21,    16,    17,    18,    19,     9,    10,    11,    12,    13,
-      14,    15,     8,     5,     7,     6,     4,    20,     0,     0,
-       0,     0,     0,    64,    64,     0,     0,     0,     0,    25,
-       0,     0,     0,    26,    27,    28,    24,    23,     0,     0,
-       0,     0,     0,     0,     0,     0,    62,    61,     0,    31,
-      30,     0,     0,    74,     0,     0,     0,     0,     0,    29,
-      34,    64,    64,    71,     0,    49,     0,     0,     0,     0,
-      47,    37,     0,     0,     0,     0,    65,    63,     0,     0,
-      74,    35,     0,     0,    54,    55,     0,    57,    56,     0,
-      76,    58,     0,     0,     0,     0,    42,    43,    44,    45,
-      46,    40,     0,     0,    64,    71,     0,     0,    52,    48,
-       0,     0,    85,    86,    87,    88,    89,    90,    91,     0,
-       0,     0,     0,    75,    74,     0,    37,     0,     0,    67,
-       0,    66,    72,     0,    60,     0,     0,     0,     0,    92,
-      80,    78,    81,    79,    76,     0,     0,    38,    36,    41,
-       0,     0,     0,    69,     0,    52,    50,    52,     0,     0,
-      77,    59,    93,    39,    67,     0,     0,     0,    76,    53,
-       0,     0,    82,    83,    68,    32,    69,     0,    71,    51,
-       0,    70,    33,    73,    84
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     3,
+      22,    21,    23,    24,    16,    17,    18,    19,     9,    10,
+      11,    12,    13,    14,    15,     8,     5,     7,     6,     4,
+      20,     0,     0,     0,     0,     0,    68,    68,     0,     0,
+       0,     0,     0,    29,     0,     0,     0,    30,    31,    32,
+      26,    25,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    66,    65,     0,    35,    34,     0,     0,     0,    78,
+       0,     0,     0,     0,     0,     0,    33,    38,    68,    68,
+      75,     0,    28,    53,     0,     0,     0,    58,    59,    61,
+      60,     0,     0,    51,    41,     0,     0,     0,     0,    69,
+      67,     0,     0,    78,    39,     0,     0,     0,     0,    80,
+      62,     0,    27,     0,     0,     0,    46,    47,    48,    49,
+      50,    44,     0,     0,    68,    75,     0,     0,    56,    52,
+       0,     0,    89,    90,    91,    92,    93,    94,    95,     0,
+       0,     0,     0,    79,    78,     0,    41,     0,     0,    71,
+       0,    70,    76,     0,    64,     0,     0,     0,     0,    96,
+      84,    82,    85,    83,    80,     0,     0,    42,    40,    45,
+       0,     0,     0,    73,     0,    56,    54,    56,     0,     0,
+      81,    63,    97,    43,    71,     0,     0,     0,    80,    57,
+       0,     0,    86,    87,    72,    36,    73,     0,    75,    55,
+       0,    74,    37,    77,    88
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-    -158,  -158,  -158,  -158,  -158,  -158,  -158,  -158,  -158,  -158,
-    -158,  -158,  -158,  -158,  -158,  -158,  -158,    44,    74,  -158,
-    -158,  -158,  -158,  -158,   -99,  -101,  -158,  -158,  -158,  -158,
-     -44,     7,    -7,  -123,   -96,  -157,  -130,  -106,  -158
+    -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,
+    -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,  -166,    40,
+      73,  -166,  -166,  -166,  -166,  -166,  -100,   -81,  -166,  -166,
+    -166,  -166,   -46,     4,    -7,  -133,  -107,  -165,  -145,  -115,
+    -166
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int16 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,     1,    18,    19,    20,    21,    22,    23,    24,    25,
-      26,    27,    28,    29,    30,    31,    32,   115,    91,   170,
-     121,    92,    33,   103,   156,   109,    34,    35,    36,    45,
-      66,   172,   187,   100,    87,   143,   110,   140,    37
+       0,     1,    19,    20,    21,    22,    23,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,   125,
+     104,   180,   131,   105,    36,   116,   166,   118,    37,    38,
+      39,    48,    71,   182,   197,   113,    95,   153,   119,   150,
+      40
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      67,   128,   152,   141,   127,     2,    98,   180,    46,     3,
-       4,   144,   164,   129,     5,     6,     7,     8,     9,    10,
-      11,    64,    47,    48,    43,    12,    13,    14,    44,   130,
-      64,   198,    65,    15,    16,    49,    99,    96,    97,   161,
-     163,    95,    51,    17,   188,    38,   131,    39,   165,    41,
-      50,    42,   178,    52,   175,    40,   177,   132,   133,   134,
-     135,   136,   137,   138,   139,   132,   133,   134,   135,   136,
-     137,   138,   139,    53,    54,   203,   189,   192,   190,    55,
-     151,   104,   105,   106,    56,   107,   108,   104,   105,   160,
-      57,   107,   108,   104,   105,   162,    58,   107,   108,   104,
-     105,   191,    59,   107,   108,   104,   105,    61,    60,   107,
-     108,   116,   117,   118,   119,   120,    62,    63,    68,    64,
-      69,    70,    71,    75,    76,    72,    73,    74,    78,    77,
-      79,    80,    81,    82,    85,    83,   101,    84,    86,    88,
-      94,   102,   111,   113,   114,    89,    90,    93,   122,   112,
-     123,   124,   145,   147,   125,   126,   142,   148,   150,   149,
-     154,   155,   153,   158,   157,   168,   159,   166,   171,   173,
-     176,   169,   181,   174,   179,   182,   183,   185,   195,   184,
-     186,   197,   193,   196,   199,   200,   202,   204,   146,   201,
-     167,   194
+     101,    72,   162,   151,    50,    51,   137,   174,     2,   190,
+     139,   111,     3,     4,    69,    49,    53,     5,     6,     7,
+       8,     9,    10,    11,    69,    70,   140,    46,    12,    13,
+      14,    47,    54,   208,   138,   108,    15,    16,    56,   198,
+     154,   112,   109,   110,    17,   141,    18,   175,    57,    44,
+      52,    45,    55,   188,    58,    59,   142,   143,   144,   145,
+     146,   147,   148,   149,    41,    60,    42,    97,    98,   171,
+     173,    99,   100,    61,    43,   213,   142,   143,   144,   145,
+     146,   147,   148,   149,   185,   199,   187,   200,   161,    97,
+      98,   117,    62,    99,   100,    97,    98,   170,    63,    99,
+     100,    97,    98,   172,    66,    99,   100,   202,    97,    98,
+     201,    69,    99,   100,   126,   127,   128,   129,   130,    64,
+      65,    67,    68,    73,    74,    75,    76,    77,    78,    79,
+      80,    83,    85,    86,    87,    84,    81,    82,    88,    89,
+      90,    91,    92,    93,    94,   107,   114,   120,   121,   115,
+     122,   123,    96,   124,   103,   102,   106,   132,   133,   134,
+     152,   155,   135,   136,   157,   158,   160,   164,   159,   163,
+     165,   167,   168,   169,   178,   179,   176,   181,   184,   186,
+     183,   191,   189,   192,   193,   195,   194,   196,   203,   205,
+     206,   207,   209,   210,   212,   214,   177,   156,   204,   211
 };
 
 static const yytype_uint8 yycheck[] =
 {
-      44,   102,   125,   109,   100,     0,    19,   164,    53,     4,
-       5,   112,   142,     3,     9,    10,    11,    12,    13,    14,
-      15,    19,     7,     8,    53,    20,    21,    22,    57,    19,
-      19,   188,    30,    28,    29,     3,    49,    81,    82,   140,
-     141,    30,    33,    38,   174,     6,    30,     8,   144,     6,
-      31,     8,   158,    53,   155,    16,   157,    41,    42,    43,
-      44,    45,    46,    47,    48,    41,    42,    43,    44,    45,
-      46,    47,    48,     3,     3,   198,   175,   178,   177,     3,
-     124,    51,    52,    53,     3,    55,    56,    51,    52,    53,
-       3,    55,    56,    51,    52,    53,    39,    55,    56,    51,
-      52,    53,    53,    55,    56,    51,    52,     8,    53,    55,
-      56,    23,    24,    25,    26,    27,    53,    53,    33,    19,
-       3,     3,    33,    40,    17,    53,    53,    36,    53,    37,
-       3,     3,    53,    53,    32,    53,     3,    53,    34,    53,
-      37,    17,     3,    31,    19,    55,    53,    53,    17,    41,
-      53,    53,     6,    18,    53,    50,    35,    17,    17,    53,
-       3,    19,    53,    53,    17,     3,    47,    53,    19,    53,
-      18,    51,     3,    37,    30,     3,    18,    18,     3,    53,
-      19,    18,    53,    53,    18,    30,     3,    53,   114,   196,
-     146,   184
+      81,    47,   135,   118,     7,     8,   113,   152,     0,   174,
+       3,    19,     4,     5,    19,    53,     3,     9,    10,    11,
+      12,    13,    14,    15,    19,    30,    19,    53,    20,    21,
+      22,    57,    31,   198,   115,    30,    28,    29,    53,   184,
+     121,    49,    88,    89,    36,    30,    38,   154,     3,     6,
+      53,     8,    33,   168,     3,     3,    41,    42,    43,    44,
+      45,    46,    47,    48,     6,     3,     8,    51,    52,   150,
+     151,    55,    56,     3,    16,   208,    41,    42,    43,    44,
+      45,    46,    47,    48,   165,   185,   167,   187,   134,    51,
+      52,    53,    53,    55,    56,    51,    52,    53,    39,    55,
+      56,    51,    52,    53,     8,    55,    56,   188,    51,    52,
+      53,    19,    55,    56,    23,    24,    25,    26,    27,    53,
+      53,    53,    53,    33,     3,     3,    33,    53,    53,    53,
+      36,    17,    53,     3,     3,    37,    41,    40,    53,    53,
+      53,    53,     3,    32,    34,    37,     3,     3,    41,    17,
+       3,    31,    53,    19,    53,    55,    53,    17,    53,    53,
+      35,     6,    53,    50,    18,    17,    17,     3,    53,    53,
+      19,    17,    53,    47,     3,    51,    53,    19,    37,    18,
+      53,     3,    30,     3,    18,    18,    53,    19,    53,     3,
+      53,    18,    18,    30,     3,    53,   156,   124,   194,   206
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
        0,    60,     0,     4,     5,     9,    10,    11,    12,    13,
-      14,    15,    20,    21,    22,    28,    29,    38,    61,    62,
-      63,    64,    65,    66,    67,    68,    69,    70,    71,    72,
-      73,    74,    75,    81,    85,    86,    87,    97,     6,     8,
-      16,     6,     8,    53,    57,    88,    53,     7,     8,     3,
-      31,    33,    53,     3,     3,     3,     3,     3,    39,    53,
-      53,     8,    53,    53,    19,    30,    89,    89,    33,     3,
-       3,    33,    53,    53,    36,    40,    17,    37,    53,     3,
-       3,    53,    53,    53,    53,    32,    34,    93,    53,    55,
-      53,    77,    80,    53,    37,    30,    89,    89,    19,    49,
-      92,     3,    17,    82,    51,    52,    53,    55,    56,    84,
-      95,     3,    41,    31,    19,    76,    23,    24,    25,    26,
-      27,    79,    17,    53,    53,    53,    50,    93,    84,     3,
+      14,    15,    20,    21,    22,    28,    29,    36,    38,    61,
+      62,    63,    64,    65,    66,    67,    68,    69,    70,    71,
+      72,    73,    74,    75,    76,    77,    83,    87,    88,    89,
+      99,     6,     8,    16,     6,     8,    53,    57,    90,    53,
+       7,     8,    53,     3,    31,    33,    53,     3,     3,     3,
+       3,     3,    53,    39,    53,    53,     8,    53,    53,    19,
+      30,    91,    91,    33,     3,     3,    33,    53,    53,    53,
+      36,    41,    40,    17,    37,    53,     3,     3,    53,    53,
+      53,    53,     3,    32,    34,    95,    53,    51,    52,    55,
+      56,    86,    55,    53,    79,    82,    53,    37,    30,    91,
+      91,    19,    49,    94,     3,    17,    84,    53,    86,    97,
+       3,    41,     3,    31,    19,    78,    23,    24,    25,    26,
+      27,    81,    17,    53,    53,    53,    50,    95,    86,     3,
       19,    30,    41,    42,    43,    44,    45,    46,    47,    48,
-      96,    96,    35,    94,    84,     6,    77,    18,    17,    53,
-      17,    89,    92,    53,     3,    19,    83,    17,    53,    47,
-      53,    84,    53,    84,    95,    93,    53,    76,     3,    51,
-      78,    19,    90,    53,    37,    84,    18,    84,    96,    30,
-      94,     3,     3,    18,    53,    18,    19,    91,    95,    83,
-      83,    53,    84,    53,    90,     3,    53,    18,    94,    18,
-      30,    91,     3,    92,    53
+      98,    98,    35,    96,    86,     6,    79,    18,    17,    53,
+      17,    91,    94,    53,     3,    19,    85,    17,    53,    47,
+      53,    86,    53,    86,    97,    95,    53,    78,     3,    51,
+      80,    19,    92,    53,    37,    86,    18,    86,    98,    30,
+      96,     3,     3,    18,    53,    18,    19,    93,    97,    85,
+      85,    53,    86,    53,    92,     3,    53,    18,    96,    18,
+      30,    93,     3,    94,    53
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
        0,    59,    60,    60,    61,    61,    61,    61,    61,    61,
       61,    61,    61,    61,    61,    61,    61,    61,    61,    61,
-      61,    61,    61,    62,    63,    64,    65,    66,    67,    68,
-      69,    70,    71,    72,    73,    74,    75,    76,    76,    77,
-      77,    78,    79,    79,    79,    79,    79,    80,    81,    82,
-      82,    82,    83,    83,    84,    84,    84,    84,    85,    86,
-      87,    88,    88,    88,    89,    89,    89,    90,    90,    91,
-      91,    92,    92,    92,    93,    93,    94,    94,    95,    95,
-      95,    95,    95,    95,    95,    96,    96,    96,    96,    96,
-      96,    96,    96,    97
+      61,    61,    61,    61,    61,    62,    63,    64,    65,    66,
+      67,    68,    69,    70,    71,    72,    73,    74,    75,    76,
+      77,    78,    78,    79,    79,    80,    81,    81,    81,    81,
+      81,    82,    83,    84,    84,    84,    85,    85,    86,    86,
+      86,    86,    87,    88,    89,    90,    90,    90,    91,    91,
+      91,    92,    92,    93,    93,    94,    94,    94,    95,    95,
+      96,    96,    97,    97,    97,    97,    97,    97,    97,    98,
+      98,    98,    98,    98,    98,    98,    98,    99
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     0,     2,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     2,     2,     2,     2,     2,     2,     4,
-       3,     3,    10,    11,     4,     5,     8,     0,     3,     5,
-       2,     1,     1,     1,     1,     1,     1,     1,     6,     0,
-       4,     6,     0,     3,     1,     1,     1,     1,     5,     8,
-       7,     2,     2,     4,     0,     3,     5,     0,     3,     0,
-       3,     0,     3,     7,     0,     3,     0,     3,     3,     3,
-       3,     3,     5,     5,     7,     1,     1,     1,     1,     1,
-       1,     1,     2,     8
+       1,     1,     1,     1,     1,     2,     2,     5,     4,     2,
+       2,     2,     2,     4,     3,     3,    10,    11,     4,     5,
+       8,     0,     3,     5,     2,     1,     1,     1,     1,     1,
+       1,     1,     6,     0,     4,     6,     0,     3,     1,     1,
+       1,     1,     5,     8,     7,     2,     2,     4,     0,     3,
+       5,     0,     3,     0,     3,     0,     3,     7,     0,     3,
+       0,     3,     3,     3,     3,     3,     5,     5,     7,     1,
+       1,     1,     1,     1,     1,     1,     2,     8
 };
 
 
@@ -887,6 +908,7 @@ enum { YYENOMEM = -2 };
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -927,10 +949,7 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-# ifndef YY_LOCATION_PRINT
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
+
 
 
 # define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
@@ -954,16 +973,12 @@ yy_symbol_value_print (FILE *yyo,
                        yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, void *scanner)
 {
   FILE *yyoutput = yyo;
-  YYUSE (yyoutput);
-  YYUSE (scanner);
+  YY_USE (yyoutput);
+  YY_USE (scanner);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yykind < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yykind], *yyvaluep);
-# endif
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yykind);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -1077,14 +1092,14 @@ static void
 yydestruct (const char *yymsg,
             yysymbol_kind_t yykind, YYSTYPE *yyvaluep, void *scanner)
 {
-  YYUSE (yyvaluep);
-  YYUSE (scanner);
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
   if (!yymsg)
     yymsg = "Deleting";
   YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yykind);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -1153,6 +1168,7 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
   YYDPRINTF ((stderr, "Starting parse\n"));
 
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
 
@@ -1178,7 +1194,7 @@ yysetstate:
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
@@ -1206,7 +1222,7 @@ yysetstate:
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
@@ -1217,7 +1233,7 @@ yysetstate:
           YY_CAST (union yyalloc *,
                    YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1239,6 +1255,7 @@ yysetstate:
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
@@ -1350,118 +1367,144 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 23: /* exit: EXIT SEMICOLON  */
-#line 176 "yacc_sql.y"
+  case 25: /* exit: EXIT SEMICOLON  */
+#line 187 "yacc_sql.y"
                    {
         CONTEXT->ssql->flag=SCF_EXIT;//"exit";
     }
-#line 1359 "yacc_sql.tab.c"
+#line 1376 "yacc_sql.tab.c"
     break;
 
-  case 24: /* help: HELP SEMICOLON  */
-#line 181 "yacc_sql.y"
+  case 26: /* help: HELP SEMICOLON  */
+#line 192 "yacc_sql.y"
                    {
         CONTEXT->ssql->flag=SCF_HELP;//"help";
     }
-#line 1367 "yacc_sql.tab.c"
+#line 1384 "yacc_sql.tab.c"
+    break;
+
+  case 27: /* set_variable: SET ID EQ value SEMICOLON  */
+#line 197 "yacc_sql.y"
+                              {
+      CONTEXT->ssql->flag = SCF_SET_VARIABLE;
+      set_variable_init(&CONTEXT->ssql->sstr.set_variable, (yyvsp[-3].string), &CONTEXT->values[CONTEXT->value_length - 1]);
+      CONTEXT->value_length = 0;
+    }
+#line 1394 "yacc_sql.tab.c"
+    break;
+
+  case 28: /* show_buffer_pool: SHOW ID ID SEMICOLON  */
+#line 205 "yacc_sql.y"
+                         {
+      // bufferpool和status不是关键字，避免和同名的表或者字段冲突
+      int valid = 0 == strcasecmp((yyvsp[-2].string), "bufferpool") && 0 == strcasecmp((yyvsp[-1].string), "status");
+      free((yyvsp[-2].string));
+      free((yyvsp[-1].string));
+      if (!valid) {
+        yyerror(scanner, "unknown show command");
+        YYABORT;
+      }
+      CONTEXT->ssql->flag = SCF_SHOW_BUFFER_POOL;
+    }
+#line 1410 "yacc_sql.tab.c"
     break;
 
-  case 25: /* sync: SYNC SEMICOLON  */
-#line 186 "yacc_sql.y"
+  case 29: /* sync: SYNC SEMICOLON  */
+#line 219 "yacc_sql.y"
                    {
       CONTEXT->ssql->flag = SCF_SYNC;
     }
-#line 1375 "yacc_sql.tab.c"
+#line 1418 "yacc_sql.tab.c"
     break;
 
-  case 26: /* begin: TRX_BEGIN SEMICOLON  */
-#line 192 "yacc_sql.y"
+  case 30: /* begin: TRX_BEGIN SEMICOLON  */
+#line 225 "yacc_sql.y"
                         {
       CONTEXT->ssql->flag = SCF_BEGIN;
     }
-#line 1383 "yacc_sql.tab.c"
+#line 1426 "yacc_sql.tab.c"
     break;
 
-  case 27: /* commit: TRX_COMMIT SEMICOLON  */
-#line 198 "yacc_sql.y"
+  case 31: /* commit: TRX_COMMIT SEMICOLON  */
+#line 231 "yacc_sql.y"
                          {
       CONTEXT->ssql->flag = SCF_COMMIT;
     }
-#line 1391 "yacc_sql.tab.c"
+#line 1434 "yacc_sql.tab.c"
     break;
 
-  case 28: /* rollback: TRX_ROLLBACK SEMICOLON  */
-#line 204 "yacc_sql.y"
+  case 32: /* rollback: TRX_ROLLBACK SEMICOLON  */
+#line 237 "yacc_sql.y"
                            {
       CONTEXT->ssql->flag = SCF_ROLLBACK;
     }
-#line 1399 "yacc_sql.tab.c"
+#line 1442 "yacc_sql.tab.c"
     break;
 
-  case 29: /* drop_table: DROP TABLE ID SEMICOLON  */
-#line 210 "yacc_sql.y"
+  case 33: /* drop_table: DROP TABLE ID SEMICOLON  */
+#line 243 "yacc_sql.y"
                             {
         CONTEXT->ssql->flag = SCF_DROP_TABLE;//"drop_table";
         drop_table_init(&CONTEXT->ssql->sstr.drop_table, (yyvsp[-1].string));
     }
-#line 1408 "yacc_sql.tab.c"
+#line 1451 "yacc_sql.tab.c"
     break;
 
-  case 30: /* show_tables: SHOW TABLES SEMICOLON  */
-#line 216 "yacc_sql.y"
+  case 34: /* show_tables: SHOW TABLES SEMICOLON  */
+#line 249 "yacc_sql.y"
                           {
       CONTEXT->ssql->flag = SCF_SHOW_TABLES;
     }
-#line 1416 "yacc_sql.tab.c"
+#line 1459 "yacc_sql.tab.c"
     break;
 
-  case 31: /* desc_table: DESC ID SEMICOLON  */
-#line 222 "yacc_sql.y"
+  case 35: /* desc_table: DESC ID SEMICOLON  */
+#line 255 "yacc_sql.y"
                       {
       CONTEXT->ssql->flag = SCF_DESC_TABLE;
       desc_table_init(&CONTEXT->ssql->sstr.desc_table, (yyvsp[-1].string));
     }
-#line 1425 "yacc_sql.tab.c"
+#line 1468 "yacc_sql.tab.c"
     break;
 
-  case 32: /* create_index: CREATE INDEX ID ON ID LBRACE ID index_attr_list RBRACE SEMICOLON  */
-#line 230 "yacc_sql.y"
+  case 36: /* create_index: CREATE INDEX ID ON ID LBRACE ID index_attr_list RBRACE SEMICOLON  */
+#line 263 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_CREATE_INDEX;//"create_index";
 			create_index_init(&CONTEXT->ssql->sstr.create_index, (yyvsp[-7].string), (yyvsp[-5].string), (yyvsp[-3].string));
 		}
-#line 1434 "yacc_sql.tab.c"
+#line 1477 "yacc_sql.tab.c"
     break;
 
-  case 33: /* create_unique_index: CREATE UNIQUE INDEX ID ON ID LBRACE ID unique_index_attr_list RBRACE SEMICOLON  */
-#line 238 "yacc_sql.y"
+  case 37: /* create_unique_index: CREATE UNIQUE INDEX ID ON ID LBRACE ID unique_index_attr_list RBRACE SEMICOLON  */
+#line 271 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_CREATE_UNIQUE_INDEX;//"create_index";
 			create_unique_index_init(&CONTEXT->ssql->sstr.create_unique_index, (yyvsp[-7].string), (yyvsp[-5].string), (yyvsp[-3].string));
 		}
-#line 1443 "yacc_sql.tab.c"
+#line 1486 "yacc_sql.tab.c"
     break;
 
-  case 34: /* drop_index: DROP INDEX ID SEMICOLON  */
-#line 246 "yacc_sql.y"
+  case 38: /* drop_index: DROP INDEX ID SEMICOLON  */
+#line 279 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag=SCF_DROP_INDEX;//"drop_index";
 			drop_index_init(&CONTEXT->ssql->sstr.drop_index, (yyvsp[-1].string));
 		}
-#line 1452 "yacc_sql.tab.c"
+#line 1495 "yacc_sql.tab.c"
     break;
 
-  case 35: /* show_index: SHOW INDEX FROM ID SEMICOLON  */
-#line 253 "yacc_sql.y"
+  case 39: /* show_index: SHOW INDEX FROM ID SEMICOLON  */
+#line 286 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_SHOW_INDEX;
 			show_index_init(&CONTEXT->ssql->sstr.show_index, (yyvsp[-1].string));
 		}
-#line 1461 "yacc_sql.tab.c"
+#line 1504 "yacc_sql.tab.c"
     break;
 
-  case 36: /* create_table: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE SEMICOLON  */
-#line 261 "yacc_sql.y"
+  case 40: /* create_table: CREATE TABLE ID LBRACE attr_def attr_def_list RBRACE SEMICOLON  */
+#line 294 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag=SCF_CREATE_TABLE;//"create_table";
 			// CONTEXT->ssql->sstr.create_table.attribute_count = CONTEXT->value_length;
@@ -1469,17 +1512,17 @@ yyreduce:
 			//临时变量清零	
 			CONTEXT->value_length = 0;
 		}
-#line 1473 "yacc_sql.tab.c"
+#line 1516 "yacc_sql.tab.c"
     break;
 
-  case 38: /* attr_def_list: COMMA attr_def attr_def_list  */
-#line 271 "yacc_sql.y"
+  case 42: /* attr_def_list: COMMA attr_def attr_def_list  */
+#line 304 "yacc_sql.y"
                                    {    }
-#line 1479 "yacc_sql.tab.c"
+#line 1522 "yacc_sql.tab.c"
     break;
 
-  case 39: /* attr_def: ID_get type LBRACE number RBRACE  */
-#line 276 "yacc_sql.y"
+  case 43: /* attr_def: ID_get type LBRACE number RBRACE  */
+#line 309 "yacc_sql.y"
                 {
 			AttrInfo attribute;
 			attr_info_init(&attribute, CONTEXT->id, (yyvsp[-3].number), (yyvsp[-1].number));
@@ -1490,11 +1533,11 @@ yyreduce:
 			// CONTEXT->ssql->sstr.create_table.attributes[CONTEXT->value_length].length = $4;
 			CONTEXT->value_length++;
 		}
-#line 1494 "yacc_sql.tab.c"
+#line 1537 "yacc_sql.tab.c"
     break;
 
-  case 40: /* attr_def: ID_get type  */
-#line 287 "yacc_sql.y"
+  case 44: /* attr_def: ID_get type  */
+#line 320 "yacc_sql.y"
                 {
 			AttrInfo attribute;
 			attr_info_init(&attribute, CONTEXT->id, (yyvsp[0].number), 4);
@@ -1505,56 +1548,56 @@ yyreduce:
 			// CONTEXT->ssql->sstr.create_table.attributes[CONTEXT->value_length].length=4; // default attribute length
 			CONTEXT->value_length++;
 		}
-#line 1509 "yacc_sql.tab.c"
+#line 1552 "yacc_sql.tab.c"
     break;
 
-  case 41: /* number: NUMBER  */
-#line 299 "yacc_sql.y"
+  case 45: /* number: NUMBER  */
+#line 332 "yacc_sql.y"
                        {(yyval.number) = (yyvsp[0].number);}
-#line 1515 "yacc_sql.tab.c"
+#line 1558 "yacc_sql.tab.c"
     break;
 
-  case 42: /* type: INT_T  */
-#line 302 "yacc_sql.y"
+  case 46: /* type: INT_T  */
+#line 335 "yacc_sql.y"
               { (yyval.number)=INTS; }
-#line 1521 "yacc_sql.tab.c"
+#line 1564 "yacc_sql.tab.c"
     break;
 
-  case 43: /* type: STRING_T  */
-#line 303 "yacc_sql.y"
+  case 47: /* type: STRING_T  */
+#line 336 "yacc_sql.y"
                   { (yyval.number)=CHARS; }
-#line 1527 "yacc_sql.tab.c"
+#line 1570 "yacc_sql.tab.c"
     break;
 
-  case 44: /* type: FLOAT_T  */
-#line 304 "yacc_sql.y"
+  case 48: /* type: FLOAT_T  */
+#line 337 "yacc_sql.y"
                  { (yyval.number)=FLOATS; }
-#line 1533 "yacc_sql.tab.c"
+#line 1576 "yacc_sql.tab.c"
     break;
 
-  case 45: /* type: DATE_T  */
-#line 305 "yacc_sql.y"
+  case 49: /* type: DATE_T  */
+#line 338 "yacc_sql.y"
                     {(yyval.number)=DATES; }
-#line 1539 "yacc_sql.tab.c"
+#line 1582 "yacc_sql.tab.c"
     break;
 
-  case 46: /* type: TEXT_T  */
-#line 306 "yacc_sql.y"
+  case 50: /* type: TEXT_T  */
+#line 339 "yacc_sql.y"
                     {(yyval.number)=TEXTS; }
-#line 1545 "yacc_sql.tab.c"
+#line 1588 "yacc_sql.tab.c"
     break;
 
-  case 47: /* ID_get: ID  */
-#line 310 "yacc_sql.y"
+  case 51: /* ID_get: ID  */
+#line 343 "yacc_sql.y"
         {
 		char *temp=(yyvsp[0].string); 
 		snprintf(CONTEXT->id, sizeof(CONTEXT->id), "%s", temp);
 	}
-#line 1554 "yacc_sql.tab.c"
+#line 1597 "yacc_sql.tab.c"
     break;
 
-  case 48: /* insert: INSERT INTO ID VALUES value_info SEMICOLON  */
-#line 320 "yacc_sql.y"
+  case 52: /* insert: INSERT INTO ID VALUES value_info SEMICOLON  */
+#line 353 "yacc_sql.y"
                 {
 			// CONTEXT->values[CONTEXT->value_length++] = *$6;
 
@@ -1569,71 +1612,75 @@ yyreduce:
       //临时变量清零
       CONTEXT->value_length=0;
     }
-#line 1573 "yacc_sql.tab.c"
+#line 1616 "yacc_sql.tab.c"
     break;
 
-  case 50: /* value_info: LBRACE value value_list RBRACE  */
-#line 335 "yacc_sql.y"
+  case 54: /* value_info: LBRACE value value_list RBRACE  */
+#line 368 "yacc_sql.y"
                                          {
 		CONTEXT->value_list_length++;
 	}
-#line 1581 "yacc_sql.tab.c"
+#line 1624 "yacc_sql.tab.c"
     break;
 
-  case 51: /* value_info: value_info COMMA LBRACE value value_list RBRACE  */
-#line 339 "yacc_sql.y"
+  case 55: /* value_info: value_info COMMA LBRACE value value_list RBRACE  */
+#line 372 "yacc_sql.y"
                                                           {
 		CONTEXT->value_list_length++;
 	}
-#line 1589 "yacc_sql.tab.c"
+#line 1632 "yacc_sql.tab.c"
     break;
 
-  case 53: /* value_list: COMMA value value_list  */
-#line 344 "yacc_sql.y"
+  case 57: /* value_list: COMMA value value_list  */
+#line 377 "yacc_sql.y"
                               { 
   		// CONTEXT->values[CONTEXT->value_length++] = *$2;
 	  }
-#line 1597 "yacc_sql.tab.c"
+#line 1640 "yacc_sql.tab.c"
     break;
 
-  case 54: /* value: NUMBER  */
-#line 349 "yacc_sql.y"
+  case 58: /* value: NUMBER  */
+#line 382 "yacc_sql.y"
           {	
+  		CHECK_VALUE_NUM();
   		value_init_integer(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].number));
 		}
-#line 1605 "yacc_sql.tab.c"
+#line 1649 "yacc_sql.tab.c"
     break;
 
-  case 55: /* value: FLOAT  */
-#line 352 "yacc_sql.y"
+  case 59: /* value: FLOAT  */
+#line 386 "yacc_sql.y"
           {
+  		CHECK_VALUE_NUM();
   		value_init_float(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].floats));
 		}
-#line 1613 "yacc_sql.tab.c"
+#line 1658 "yacc_sql.tab.c"
     break;
 
-  case 56: /* value: DATE_STR  */
-#line 356 "yacc_sql.y"
+  case 60: /* value: DATE_STR  */
+#line 391 "yacc_sql.y"
                  {
 		// 去掉两边的 ''
+		CHECK_VALUE_NUM();
 			(yyvsp[0].string)=substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
 		value_init_date(&CONTEXT->values[CONTEXT->value_length++],(yyvsp[0].string));
 
 	}
-#line 1624 "yacc_sql.tab.c"
+#line 1670 "yacc_sql.tab.c"
     break;
 
-  case 57: /* value: SSS  */
-#line 364 "yacc_sql.y"
+  case 61: /* value: SSS  */
+#line 400 "yacc_sql.y"
          {
+			CHECK_VALUE_NUM();
 			(yyvsp[0].string) = substr((yyvsp[0].string),1,strlen((yyvsp[0].string))-2);
   			value_init_string(&CONTEXT->values[CONTEXT->value_length++], (yyvsp[0].string),strlen((yyvsp[0].string)));
 		}
-#line 1633 "yacc_sql.tab.c"
+#line 1680 "yacc_sql.tab.c"
     break;
 
-  case 58: /* delete: DELETE FROM ID where SEMICOLON  */
-#line 372 "yacc_sql.y"
+  case 62: /* delete: DELETE FROM ID where SEMICOLON  */
+#line 409 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_DELETE;//"delete";
 			deletes_init_relation(&CONTEXT->ssql->sstr.deletion, (yyvsp[-2].string));
@@ -1641,11 +1688,11 @@ yyreduce:
 					CONTEXT->conditions, CONTEXT->condition_length);
 			CONTEXT->condition_length = 0;	
     }
-#line 1645 "yacc_sql.tab.c"
+#line 1692 "yacc_sql.tab.c"
     break;
 
-  case 59: /* update: UPDATE ID SET ID EQ value where SEMICOLON  */
-#line 382 "yacc_sql.y"
+  case 63: /* update: UPDATE ID SET ID EQ value where SEMICOLON  */
+#line 419 "yacc_sql.y"
                 {
 			CONTEXT->ssql->flag = SCF_UPDATE;//"update";
 			Value *value = &CONTEXT->values[0];
@@ -1653,11 +1700,11 @@ yyreduce:
 					CONTEXT->conditions, CONTEXT->condition_length);
 			CONTEXT->condition_length = 0;
 		}
-#line 1657 "yacc_sql.tab.c"
+#line 1704 "yacc_sql.tab.c"
     break;
 
-  case 60: /* select: SELECT select_attr FROM ID rel_list where SEMICOLON  */
-#line 392 "yacc_sql.y"
+  case 64: /* select: SELECT select_attr FROM ID rel_list where SEMICOLON  */
+#line 429 "yacc_sql.y"
                 {
 			// CONTEXT->ssql->sstr.selection.relations[CONTEXT->from_length++]=$4;
 			selects_append_relation(&CONTEXT->ssql->sstr.selection, (yyvsp[-3].string));
@@ -1673,41 +1720,41 @@ yyreduce:
 			CONTEXT->select_length=0;
 			CONTEXT->value_length = 0;
 	}
-#line 1677 "yacc_sql.tab.c"
+#line 1724 "yacc_sql.tab.c"
     break;
 
-  case 61: /* select_attr: STAR attr_list  */
-#line 410 "yacc_sql.y"
+  case 65: /* select_attr: STAR attr_list  */
+#line 447 "yacc_sql.y"
                    {
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, "*");
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 1687 "yacc_sql.tab.c"
+#line 1734 "yacc_sql.tab.c"
     break;
 
-  case 62: /* select_attr: ID attr_list  */
-#line 415 "yacc_sql.y"
+  case 66: /* select_attr: ID attr_list  */
+#line 452 "yacc_sql.y"
                    {
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, (yyvsp[-1].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 1697 "yacc_sql.tab.c"
+#line 1744 "yacc_sql.tab.c"
     break;
 
-  case 63: /* select_attr: ID DOT ID attr_list  */
-#line 420 "yacc_sql.y"
+  case 67: /* select_attr: ID DOT ID attr_list  */
+#line 457 "yacc_sql.y"
                               {
 			RelAttr attr;
 			relation_attr_init(&attr, (yyvsp[-3].string), (yyvsp[-1].string));
 			selects_append_attribute(&CONTEXT->ssql->sstr.selection, &attr);
 		}
-#line 1707 "yacc_sql.tab.c"
+#line 1754 "yacc_sql.tab.c"
     break;
 
-  case 65: /* attr_list: COMMA ID attr_list  */
-#line 428 "yacc_sql.y"
+  case 69: /* attr_list: COMMA ID attr_list  */
+#line 465 "yacc_sql.y"
                          {
 			RelAttr attr;
 			relation_attr_init(&attr, NULL, (yyvsp[-1].string));
@@ -1715,11 +1762,11 @@ yyreduce:
      	  // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length].relation_name = NULL;
         // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length++].attribute_name=$2;
       }
-#line 1719 "yacc_sql.tab.c"
+#line 1766 "yacc_sql.tab.c"
     break;
 
-  case 66: /* attr_list: COMMA ID DOT ID attr_list  */
-#line 435 "yacc_sql.y"
+  case 70: /* attr_list: COMMA ID DOT ID attr_list  */
+#line 472 "yacc_sql.y"
                                 {
 			RelAttr attr;
 			relation_attr_init(&attr, (yyvsp[-3].string), (yyvsp[-1].string));
@@ -1727,19 +1774,19 @@ yyreduce:
         // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length].attribute_name=$4;
         // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length++].relation_name=$2;
   	  }
-#line 1731 "yacc_sql.tab.c"
+#line 1778 "yacc_sql.tab.c"
     break;
 
-  case 67: /* index_attr_list: %empty  */
-#line 445 "yacc_sql.y"
+  case 71: /* index_attr_list: %empty  */
+#line 482 "yacc_sql.y"
                 {
 		create_index_reset(&CONTEXT->ssql->sstr.create_index);
 	}
-#line 1739 "yacc_sql.tab.c"
+#line 1786 "yacc_sql.tab.c"
     break;
 
-  case 68: /* index_attr_list: COMMA ID index_attr_list  */
-#line 448 "yacc_sql.y"
+  case 72: /* index_attr_list: COMMA ID index_attr_list  */
+#line 485 "yacc_sql.y"
                                {
 			// RelAttr attr;
 			// relation_attr_init(&attr, NULL, $2);
@@ -1747,19 +1794,19 @@ yyreduce:
      	  // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length].relation_name = NULL;
         // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length++].attribute_name=$2;
       }
-#line 1751 "yacc_sql.tab.c"
+#line 1798 "yacc_sql.tab.c"
     break;
 
-  case 69: /* unique_index_attr_list: %empty  */
-#line 458 "yacc_sql.y"
+  case 73: /* unique_index_attr_list: %empty  */
+#line 495 "yacc_sql.y"
                 {
 		create_unique_index_reset(&CONTEXT->ssql->sstr.create_unique_index);
 	}
-#line 1759 "yacc_sql.tab.c"
+#line 1806 "yacc_sql.tab.c"
     break;
 
-  case 70: /* unique_index_attr_list: COMMA ID unique_index_attr_list  */
-#line 461 "yacc_sql.y"
+  case 74: /* unique_index_attr_list: COMMA ID unique_index_attr_list  */
+#line 498 "yacc_sql.y"
                                       {
 			// RelAttr attr;
 			// relation_attr_init(&attr, NULL, $2);
@@ -1767,44 +1814,44 @@ yyreduce:
      	  // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length].relation_name = NULL;
         // CONTEXT->ssql->sstr.selection.attributes[CONTEXT->select_length++].attribute_name=$2;
       }
-#line 1771 "yacc_sql.tab.c"
+#line 1818 "yacc_sql.tab.c"
     break;
 
-  case 72: /* rel_list: COMMA ID rel_list  */
-#line 472 "yacc_sql.y"
+  case 76: /* rel_list: COMMA ID rel_list  */
+#line 509 "yacc_sql.y"
                         {	
 				selects_append_relation(&CONTEXT->ssql->sstr.selection, (yyvsp[-1].string));
 		  }
-#line 1779 "yacc_sql.tab.c"
+#line 1826 "yacc_sql.tab.c"
     break;
 
-  case 73: /* rel_list: INNER JOIN ID ON condition condition_list rel_list  */
-#line 477 "yacc_sql.y"
+  case 77: /* rel_list: INNER JOIN ID ON condition condition_list rel_list  */
+#line 514 "yacc_sql.y"
         {
 		selects_append_relation(&CONTEXT->ssql->sstr.selection, (yyvsp[-4].string));
 
 	}
-#line 1788 "yacc_sql.tab.c"
+#line 1835 "yacc_sql.tab.c"
     break;
 
-  case 75: /* where: WHERE condition condition_list  */
-#line 484 "yacc_sql.y"
+  case 79: /* where: WHERE condition condition_list  */
+#line 521 "yacc_sql.y"
                                      {	
 				// CONTEXT->conditions[CONTEXT->condition_length++]=*$2;
 			}
-#line 1796 "yacc_sql.tab.c"
+#line 1843 "yacc_sql.tab.c"
     break;
 
-  case 77: /* condition_list: AND condition condition_list  */
-#line 492 "yacc_sql.y"
+  case 81: /* condition_list: AND condition condition_list  */
+#line 529 "yacc_sql.y"
                                    {
 				// CONTEXT->conditions[CONTEXT->condition_length++]=*$2;
 			}
-#line 1804 "yacc_sql.tab.c"
+#line 1851 "yacc_sql.tab.c"
     break;
 
-  case 78: /* condition: ID comOp value  */
-#line 498 "yacc_sql.y"
+  case 82: /* condition: ID comOp value  */
+#line 535 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, NULL, (yyvsp[-2].string));
@@ -1824,11 +1871,11 @@ yyreduce:
 			// $$->right_attr.attribute_name = NULL;
 			// $$->right_value = *$3;
 		}
-#line 1828 "yacc_sql.tab.c"
+#line 1875 "yacc_sql.tab.c"
     break;
 
-  case 79: /* condition: value comOp value  */
-#line 519 "yacc_sql.y"
+  case 83: /* condition: value comOp value  */
+#line 556 "yacc_sql.y"
                 {
 			Value *left_value = &CONTEXT->values[CONTEXT->value_length - 2];
 			Value *right_value = &CONTEXT->values[CONTEXT->value_length - 1];
@@ -1848,11 +1895,11 @@ yyreduce:
 			// $$->right_value = *$3;
 
 		}
-#line 1852 "yacc_sql.tab.c"
+#line 1899 "yacc_sql.tab.c"
     break;
 
-  case 80: /* condition: ID comOp ID  */
-#line 539 "yacc_sql.y"
+  case 84: /* condition: ID comOp ID  */
+#line 576 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, NULL, (yyvsp[-2].string));
@@ -1872,11 +1919,11 @@ yyreduce:
 			// $$->right_attr.attribute_name=$3;
 
 		}
-#line 1876 "yacc_sql.tab.c"
+#line 1923 "yacc_sql.tab.c"
     break;
 
-  case 81: /* condition: value comOp ID  */
-#line 559 "yacc_sql.y"
+  case 85: /* condition: value comOp ID  */
+#line 596 "yacc_sql.y"
                 {
 			Value *left_value = &CONTEXT->values[CONTEXT->value_length - 1];
 			RelAttr right_attr;
@@ -1898,11 +1945,11 @@ yyreduce:
 			// $$->right_attr.attribute_name=$3;
 		
 		}
-#line 1902 "yacc_sql.tab.c"
+#line 1949 "yacc_sql.tab.c"
     break;
 
-  case 82: /* condition: ID DOT ID comOp value  */
-#line 581 "yacc_sql.y"
+  case 86: /* condition: ID DOT ID comOp value  */
+#line 618 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, (yyvsp[-4].string), (yyvsp[-2].string));
@@ -1923,11 +1970,11 @@ yyreduce:
 			// $$->right_value =*$5;			
 							
     }
-#line 1927 "yacc_sql.tab.c"
+#line 1974 "yacc_sql.tab.c"
     break;
 
-  case 83: /* condition: value comOp ID DOT ID  */
-#line 602 "yacc_sql.y"
+  case 87: /* condition: value comOp ID DOT ID  */
+#line 639 "yacc_sql.y"
                 {
 			Value *left_value = &CONTEXT->values[CONTEXT->value_length - 1];
 
@@ -1948,11 +1995,11 @@ yyreduce:
 			// $$->right_attr.attribute_name = $5;
 									
     }
-#line 1952 "yacc_sql.tab.c"
+#line 1999 "yacc_sql.tab.c"
     break;
 
-  case 84: /* condition: ID DOT ID comOp ID DOT ID  */
-#line 623 "yacc_sql.y"
+  case 88: /* condition: ID DOT ID comOp ID DOT ID  */
+#line 660 "yacc_sql.y"
                 {
 			RelAttr left_attr;
 			relation_attr_init(&left_attr, (yyvsp[-6].string), (yyvsp[-4].string));
@@ -1971,68 +2018,68 @@ yyreduce:
 			// $$->right_attr.relation_name=$5;
 			// $$->right_attr.attribute_name=$7;
     }
-#line 1975 "yacc_sql.tab.c"
+#line 2022 "yacc_sql.tab.c"
     break;
 
-  case 85: /* comOp: EQ  */
-#line 645 "yacc_sql.y"
+  case 89: /* comOp: EQ  */
+#line 682 "yacc_sql.y"
              { CONTEXT->comp = EQUAL_TO; }
-#line 1981 "yacc_sql.tab.c"
+#line 2028 "yacc_sql.tab.c"
     break;
 
-  case 86: /* comOp: LT  */
-#line 646 "yacc_sql.y"
+  case 90: /* comOp: LT  */
+#line 683 "yacc_sql.y"
          { CONTEXT->comp = LESS_THAN; }
-#line 1987 "yacc_sql.tab.c"
+#line 2034 "yacc_sql.tab.c"
     break;
 
-  case 87: /* comOp: GT  */
-#line 647 "yacc_sql.y"
+  case 91: /* comOp: GT  */
+#line 684 "yacc_sql.y"
          { CONTEXT->comp = GREAT_THAN; }
-#line 1993 "yacc_sql.tab.c"
+#line 2040 "yacc_sql.tab.c"
     break;
 
-  case 88: /* comOp: LE  */
-#line 648 "yacc_sql.y"
+  case 92: /* comOp: LE  */
+#line 685 "yacc_sql.y"
          { CONTEXT->comp = LESS_EQUAL; }
-#line 1999 "yacc_sql.tab.c"
+#line 2046 "yacc_sql.tab.c"
     break;
 
-  case 89: /* comOp: GE  */
-#line 649 "yacc_sql.y"
+  case 93: /* comOp: GE  */
+#line 686 "yacc_sql.y"
          { CONTEXT->comp = GREAT_EQUAL; }
-#line 2005 "yacc_sql.tab.c"
+#line 2052 "yacc_sql.tab.c"
     break;
 
-  case 90: /* comOp: NE  */
-#line 650 "yacc_sql.y"
+  case 94: /* comOp: NE  */
+#line 687 "yacc_sql.y"
          { CONTEXT->comp = NOT_EQUAL; }
-#line 2011 "yacc_sql.tab.c"
+#line 2058 "yacc_sql.tab.c"
     break;
 
-  case 91: /* comOp: LIKE  */
-#line 651 "yacc_sql.y"
+  case 95: /* comOp: LIKE  */
+#line 688 "yacc_sql.y"
            { CONTEXT->comp = LIKE_THE; }
-#line 2017 "yacc_sql.tab.c"
+#line 2064 "yacc_sql.tab.c"
     break;
 
-  case 92: /* comOp: NOT LIKE  */
-#line 652 "yacc_sql.y"
+  case 96: /* comOp: NOT LIKE  */
+#line 689 "yacc_sql.y"
                { CONTEXT->comp = NOT_LIKE_THE; }
-#line 2023 "yacc_sql.tab.c"
+#line 2070 "yacc_sql.tab.c"
     break;
 
-  case 93: /* load_data: LOAD DATA INFILE SSS INTO TABLE ID SEMICOLON  */
-#line 659 "yacc_sql.y"
+  case 97: /* load_data: LOAD DATA INFILE SSS INTO TABLE ID SEMICOLON  */
+#line 696 "yacc_sql.y"
                 {
 		  CONTEXT->ssql->flag = SCF_LOAD_DATA;
 			load_data_init(&CONTEXT->ssql->sstr.load_data, (yyvsp[-1].string), (yyvsp[-4].string));
 		}
-#line 2032 "yacc_sql.tab.c"
+#line 2079 "yacc_sql.tab.c"
     break;
 
 
-#line 2036 "yacc_sql.tab.c"
+#line 2083 "yacc_sql.tab.c"
 
       default: break;
     }
@@ -2114,6 +2161,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2174,7 +2222,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -2182,24 +2230,22 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (scanner, YY_("memory exhausted"));
   yyresult = 2;
-  goto yyreturn;
-#endif
+  goto yyreturnlab;
 
 
-/*-------------------------------------------------------.
-| yyreturn -- parsing is finished, clean up and return.  |
-`-------------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -2226,7 +2272,7 @@ yyreturn:
   return yyresult;
 }
 
-#line 664 "yacc_sql.y"
+#line 701 "yacc_sql.y"
 
 //_____________________________________________________________________
 extern void scan_string(const char *str, yyscan_t scanner);
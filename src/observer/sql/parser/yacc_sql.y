@@ -17,7 +17,7 @@ typedef struct ParserContext {
   size_t from_length;
   size_t value_length;
   size_t value_list_length;
-  Value values[MAX_NUM];
+  Value values[MAX_VALUE_NUM];
   Condition conditions[MAX_NUM];
   CompOp comp;
 	char id[MAX_NUM];
@@ -55,6 +55,15 @@ ParserContext *get_context(yyscan_t scanner)
 
 #define CONTEXT get_context(scanner)
 
+// values已经放满时报错退出，不能再写入
+#define CHECK_VALUE_NUM()                                   \
+  do {                                                      \
+    if (CONTEXT->value_length >= MAX_VALUE_NUM) {           \
+      yyerror(scanner, "too many values");                  \
+      YYABORT;                                              \
+    }                                                       \
+  } while (0)
+
 %}
 
 %define api.pure full
@@ -170,6 +179,8 @@ command:
 	| load_data
 	| help
 	| exit
+	| set_variable
+	| show_buffer_pool
     ;
 
 exit:			
@@ -182,6 +193,28 @@ help:
         CONTEXT->ssql->flag=SCF_HELP;//"help";
     };
 
+set_variable:
+    SET ID EQ value SEMICOLON {
+      CONTEXT->ssql->flag = SCF_SET_VARIABLE;
+      set_variable_init(&CONTEXT->ssql->sstr.set_variable, $2, &CONTEXT->values[CONTEXT->value_length - 1]);
+      CONTEXT->value_length = 0;
+    }
+    ;
+
+show_buffer_pool:
+    SHOW ID ID SEMICOLON {
+      // bufferpool和status不是关键字，避免和同名的表或者字段冲突
+      int valid = 0 == strcasecmp($2, "bufferpool") && 0 == strcasecmp($3, "status");
+      free($2);
+      free($3);
+      if (!valid) {
+        yyerror(scanner, "unknown show command");
+        YYABORT;
+      }
+      CONTEXT->ssql->flag = SCF_SHOW_BUFFER_POOL;
+    }
+    ;
+
 sync:
     SYNC SEMICOLON {
       CONTEXT->ssql->flag = SCF_SYNC;
@@ -347,14 +380,17 @@ value_list:
     ;
 value:
     NUMBER{	
+  		CHECK_VALUE_NUM();
   		value_init_integer(&CONTEXT->values[CONTEXT->value_length++], $1);
 		}
     |FLOAT{
+  		CHECK_VALUE_NUM();
   		value_init_float(&CONTEXT->values[CONTEXT->value_length++], $1);
 		}
 
 	|DATE_STR{
 		// 去掉两边的 ''
+		CHECK_VALUE_NUM();
 			$1=substr($1,1,strlen($1)-2);
 		value_init_date(&CONTEXT->values[CONTEXT->value_length++],$1);
 
@@ -362,6 +398,7 @@ value:
 	// SSS是字符串
 	// 2022-3-1 -> str -> date
     |SSS {
+			CHECK_VALUE_NUM();
 			$1 = substr($1,1,strlen($1)-2);
   			value_init_string(&CONTEXT->values[CONTEXT->value_length++], $1,strlen($1));
 		} // 如果是日期类型
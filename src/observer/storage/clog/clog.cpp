@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 // Created by huhaosheng.hhs on 2022
 //
 
+#include <algorithm>
+
 #include "common/log/log.h"
 #include "clog.h"
 
@@ -37,7 +39,9 @@ CLogRecord::CLogRecord(CLogType flag, int32_t trx_id, const char *table_name /*
       log_record_.mtr.hdr_.logrec_len_ = sizeof(CLogMTRRecord);
       log_record_.mtr.hdr_.lsn_ = CLogManager::get_next_lsn(log_record_.mtr.hdr_.logrec_len_);
     } break;
-    case REDO_INSERT: {
+    case REDO_INSERT:
+    case REDO_OVERFLOW:
+    case REDO_INSERT_BATCH: {
       if (!rec || !rec->data()) {
         LOG_ERROR("Record is null");
       } else {
@@ -79,7 +83,9 @@ CLogRecord::CLogRecord(char *data)
     case REDO_MTR_COMMIT: {
       log_record_.mtr.hdr_ = *hdr;
     } break;
-    case REDO_INSERT: {
+    case REDO_INSERT:
+    case REDO_OVERFLOW:
+    case REDO_INSERT_BATCH: {
       log_record_.ins.hdr_ = *hdr;
       data += sizeof(CLogRecordHeader);
       strcpy(log_record_.ins.table_name_, data);
@@ -106,7 +112,7 @@ CLogRecord::CLogRecord(char *data)
 
 CLogRecord::~CLogRecord()
 {
-  if (REDO_INSERT == flag_) {
+  if (REDO_INSERT == flag_ || REDO_OVERFLOW == flag_ || REDO_INSERT_BATCH == flag_) {
     delete[] log_record_.ins.data_;
   }
 }
@@ -116,7 +122,7 @@ RC CLogRecord::copy_record(void *dest, int start_off, int copy_len)
   CLogRecords *log_rec = &log_record_;
   if (start_off + copy_len > get_logrec_len()) {
     return RC::GENERIC_ERROR;
-  } else if (flag_ != REDO_INSERT) {
+  } else if (flag_ != REDO_INSERT && flag_ != REDO_OVERFLOW && flag_ != REDO_INSERT_BATCH) {
     memcpy(dest, (char *)log_rec + start_off, copy_len);
   } else {
     if (start_off > CLOG_INS_REC_NODATA_SIZE) {
@@ -143,6 +149,8 @@ int CLogRecord::cmp_eq(CLogRecord *other)
       case REDO_MTR_COMMIT:
         return log_record_.mtr == other_logrec->mtr;
       case REDO_INSERT:
+      case REDO_OVERFLOW:
+      case REDO_INSERT_BATCH:
         return log_record_.ins == other_logrec->ins;
       case REDO_DELETE:
         return log_record_.del == other_logrec->del;
@@ -208,7 +216,8 @@ RC CLogBuffer::append_log_record(CLogRecord *log_rec, int &start_off)
       start_off += logrec_left_len;
     } else {                                               //需要跨block
       if (log_block->log_block_hdr_.log_data_len_ == 0) {  //当前为新block
-        log_block->log_block_hdr_.first_rec_offset_ = CLOG_BLOCK_SIZE;
+        // 记录从这个block开头开始时first_rec_offset_指向它，否则恢复时会当作上一条记录的一部分
+        log_block->log_block_hdr_.first_rec_offset_ = start_off == 0 ? CLOG_BLOCK_HDR_SIZE : CLOG_BLOCK_SIZE;
       }
       int32_t block_left_len = CLOG_BLOCK_DATA_SIZE - log_block->log_block_hdr_.log_data_len_;
       log_rec->copy_record(&(buffer_[write_offset_]), start_off, block_left_len);
@@ -254,12 +263,25 @@ RC CLogBuffer::block_copy(int32_t offset, CLogBlock *log_block)
   return RC::SUCCESS;
 }
 
+int32_t CLogBuffer::next_record_block_no()
+{
+  if (write_offset_ == 0 && write_block_offset_ == 0) {  // 缓冲区是空的，会分配一个新的block
+    return current_block_no_ + CLOG_BLOCK_SIZE;
+  }
+  CLogBlock *log_block = (CLogBlock *)&buffer_[write_block_offset_];
+  if (log_block->log_block_hdr_.log_data_len_ == CLOG_BLOCK_DATA_SIZE) {  // 当前block已写满
+    return current_block_no_ + CLOG_BLOCK_SIZE;
+  }
+  return current_block_no_;
+}
+
 //
 CLogFile::CLogFile(const char *path)
 {
   log_file_ = new PersistHandler();
   RC rc = RC::SUCCESS;
   std::string clog_file_path = std::string(path) + common::FILE_PATH_SPLIT_STR + CLOG_FILE_NAME;
+  memset(&log_fhd_, 0, sizeof(log_fhd_));
   rc = log_file_->create_file(clog_file_path.c_str());
   if (rc == RC::SUCCESS) {
     log_file_->open_file();
@@ -278,7 +300,7 @@ CLogFile::~CLogFile()
   }
 }
 
-RC CLogFile::update_log_fhd(int32_t current_file_lsn)
+RC CLogFile::update_log_fhd(int64_t current_file_lsn)
 {
   log_fhd_.hdr_.current_file_lsn_ = current_file_lsn;
   log_fhd_.hdr_.current_file_real_offset_ = CLOG_FILE_HDR_SIZE;
@@ -286,6 +308,13 @@ RC CLogFile::update_log_fhd(int32_t current_file_lsn)
   return rc;
 }
 
+RC CLogFile::update_checkpoint(int64_t checkpoint_lsn, int32_t checkpoint_block_no)
+{
+  log_fhd_.hdr_.checkpoint_lsn_ = checkpoint_lsn;
+  log_fhd_.hdr_.checkpoint_block_no_ = checkpoint_block_no;
+  return log_file_->write_at(0, CLOG_BLOCK_SIZE, (char *)&log_fhd_);
+}
+
 RC CLogFile::append(int data_len, char *data)
 {
   RC rc = log_file_->append(data_len, data);
@@ -298,29 +327,60 @@ RC CLogFile::write(uint64_t offset, int data_len, char *data)
   return rc;
 }
 
-RC CLogFile::recover(CLogMTRManager *mtr_mgr, CLogBuffer *log_buffer)
+RC CLogFile::recover(CLogMTRManager *mtr_mgr, CLogBuffer *log_buffer, int &read_num)
 {
   char redo_buffer[CLOG_REDO_BUFFER_SIZE];
   CLogRecordBuf logrec_buf;
   memset(&logrec_buf, 0, sizeof(CLogRecordBuf));
   CLogRecord *log_rec = nullptr;
+  read_num = 0;
 
   uint64_t offset = CLOG_BLOCK_SIZE;  // 第一个block为文件头
   int64_t read_size = 0;
+  int32_t checkpoint_block_no = log_fhd_.hdr_.checkpoint_block_no_;
+  if (checkpoint_block_no >= CLOG_BLOCK_SIZE && checkpoint_block_no % CLOG_BLOCK_SIZE == 0) {
+    // 每个block的头中都记录了自己在文件中的偏移，用来确认检查点指向的是一个有效的block
+    CLogBlockHeader block_hdr;
+    memset(&block_hdr, 0, sizeof(block_hdr));
+    log_file_->read_at(checkpoint_block_no, sizeof(block_hdr), (char *)&block_hdr, &read_size);
+    if (read_size == 0 || block_hdr.log_block_no == checkpoint_block_no) {
+      offset = checkpoint_block_no;
+    } else {
+      LOG_WARN("Invalid checkpoint in clog file header, recover from the beginning. block no=%d",
+               checkpoint_block_no);
+      checkpoint_block_no = 0;
+    }
+  } else {
+    checkpoint_block_no = 0;
+  }
+  LOG_INFO("Recover clog from offset %lu, checkpoint lsn=%ld", offset,
+           checkpoint_block_no == 0 ? 0 : log_fhd_.hdr_.checkpoint_lsn_);
+  if (checkpoint_block_no != 0) {
+    // 同一个进程中可能已经生成过更大的LSN，不能回退
+    CLogManager::gloabl_lsn_ = std::max(CLogManager::gloabl_lsn_.load(), log_fhd_.hdr_.checkpoint_lsn_);
+  }
+  // 检查点之后还没有写过日志时，从检查点的block接着写
+  log_buffer->set_current_block_no(offset - CLOG_BLOCK_SIZE);
+
   log_file_->read_at(offset, CLOG_REDO_BUFFER_SIZE, redo_buffer, &read_size);
   while (read_size != 0) {
     int32_t buffer_offset = 0;
-    while (buffer_offset < CLOG_REDO_BUFFER_SIZE) {
+    while (buffer_offset < read_size) {
       CLogBlock *log_block = (CLogBlock *)&redo_buffer[buffer_offset];
       log_buffer->set_current_block_no(log_block->log_block_hdr_.log_block_no);
 
       int16_t rec_offset = CLOG_BLOCK_HDR_SIZE;
+      if (offset + buffer_offset == (uint64_t)checkpoint_block_no) {
+        // 检查点所在的block开头可能是上一条日志记录的后半部分，跳过
+        rec_offset = log_block->log_block_hdr_.first_rec_offset_;
+      }
       while (rec_offset < CLOG_BLOCK_HDR_SIZE + log_block->log_block_hdr_.log_data_len_) {
         block_recover(log_block, rec_offset, &logrec_buf, log_rec);
         if (log_rec != nullptr) {
-          CLogManager::gloabl_lsn_ = log_rec->get_lsn() + log_rec->get_logrec_len();
+          CLogManager::gloabl_lsn_ = std::max(CLogManager::gloabl_lsn_.load(), log_rec->get_lsn() + log_rec->get_logrec_len());
           mtr_mgr->log_record_manage(log_rec);
           log_rec = nullptr;
+          read_num++;
         }
       }
 
@@ -340,6 +400,7 @@ done:
   if (logrec_buf.write_offset_ != 0) {
     log_rec = new CLogRecord((char *)logrec_buf.buffer_);
     mtr_mgr->log_record_manage(log_rec);
+    read_num++;
   }
   return RC::SUCCESS;
 }
@@ -354,30 +415,26 @@ RC CLogFile::block_recover(CLogBlock *block, int16_t &offset, CLogRecordBuf *log
         block->log_block_hdr_.first_rec_offset_ - CLOG_BLOCK_HDR_SIZE);
     logrec_buf->write_offset_ += block->log_block_hdr_.first_rec_offset_ - CLOG_BLOCK_HDR_SIZE;
     offset += block->log_block_hdr_.first_rec_offset_ - CLOG_BLOCK_HDR_SIZE;
+  } else if (logrec_buf->write_offset_ != 0) {
+    // 跨block的记录已经拼完整了。要先处理它，再读后面的记录，否则后面记录的头部被截断时会接在它的后面
+    log_rec = new CLogRecord((char *)logrec_buf->buffer_);
+    memset(logrec_buf, 0, sizeof(CLogRecordBuf));
+  } else if (CLOG_BLOCK_SIZE - offset < sizeof(CLogRecordHeader)) {  // 一定是跨block的第一部分
+    // 此时无法确定log record的长度
+    // 开始写入logrec_buf
+    memcpy(&logrec_buf->buffer_[logrec_buf->write_offset_], (char *)block + (int)offset, CLOG_BLOCK_SIZE - offset);
+    logrec_buf->write_offset_ += CLOG_BLOCK_SIZE - offset;
+    offset = CLOG_BLOCK_SIZE;
   } else {
-    if (CLOG_BLOCK_SIZE - offset < sizeof(CLogRecordHeader)) {  // 一定是跨block的第一部分
-      // 此时无法确定log record的长度
+    CLogRecordHeader *logrec_hdr = (CLogRecordHeader *)((char *)block + (int)offset);
+    if (logrec_hdr->logrec_len_ <= CLOG_BLOCK_SIZE - offset) {
+      log_rec = new CLogRecord((char *)block + (int)offset);
+      offset += logrec_hdr->logrec_len_;
+    } else {  //此时为跨block的第一部分
       // 开始写入logrec_buf
       memcpy(&logrec_buf->buffer_[logrec_buf->write_offset_], (char *)block + (int)offset, CLOG_BLOCK_SIZE - offset);
       logrec_buf->write_offset_ += CLOG_BLOCK_SIZE - offset;
       offset = CLOG_BLOCK_SIZE;
-    } else {
-      if (logrec_buf->write_offset_ != 0) {
-        log_rec = new CLogRecord((char *)logrec_buf->buffer_);
-        memset(logrec_buf, 0, sizeof(CLogRecordBuf));
-      } else {
-        CLogRecordHeader *logrec_hdr = (CLogRecordHeader *)((char *)block + (int)offset);
-        if (logrec_hdr->logrec_len_ <= CLOG_BLOCK_SIZE - offset) {
-          log_rec = new CLogRecord((char *)block + (int)offset);
-          offset += logrec_hdr->logrec_len_;
-        } else {  //此时为跨block的第一部分
-          // 开始写入logrec_buf
-          memcpy(
-              &logrec_buf->buffer_[logrec_buf->write_offset_], (char *)block + (int)offset, CLOG_BLOCK_SIZE - offset);
-          logrec_buf->write_offset_ += CLOG_BLOCK_SIZE - offset;
-          offset = CLOG_BLOCK_SIZE;
-        }
-      }
     }
   }
   return RC::SUCCESS;
@@ -397,7 +454,7 @@ void CLogMTRManager::log_record_manage(CLogRecord *log_rec)
 }
 
 ////////////////////
-std::atomic<int32_t> CLogManager::gloabl_lsn_(0);
+std::atomic<int64_t> CLogManager::gloabl_lsn_(0);
 CLogManager::CLogManager(const char *path)
 {
   log_buffer_ = new CLogBuffer();
@@ -410,6 +467,8 @@ CLogManager::~CLogManager()
   if (log_buffer_) {
     delete log_buffer_;
   }
+  delete log_file_;
+  delete log_mtr_mgr_;
 }
 
 RC CLogManager::clog_gen_record(CLogType flag, int32_t trx_id, CLogRecord *&log_rec,
@@ -427,11 +486,19 @@ RC CLogManager::clog_gen_record(CLogType flag, int32_t trx_id, CLogRecord *&log_
 
 RC CLogManager::clog_append_record(CLogRecord *log_rec)
 {
+  std::lock_guard<std::mutex> lock_guard(lock_);
   RC rc = RC::SUCCESS;
+  const int32_t block_no = log_buffer_->next_record_block_no();
+  if (block_lsns_.empty() || block_lsns_.back().block_no != block_no) {
+    block_lsns_.push_back(BlockLsn{block_no, log_rec->get_lsn()});
+  } else {
+    block_lsns_.back().max_lsn = std::max(block_lsns_.back().max_lsn, log_rec->get_lsn());
+  }
+
   int start_offset = 0;
   rc = log_buffer_->append_log_record(log_rec, start_offset);
   if (rc == RC::LOGBUF_FULL || log_rec->get_log_type() == REDO_MTR_COMMIT) {
-    clog_sync();
+    clog_sync_locked();
     if (start_offset != log_rec->get_logrec_len()) {  // 当前日志记录还没写完
       log_buffer_->append_log_record(log_rec, start_offset);
     }
@@ -441,6 +508,12 @@ RC CLogManager::clog_append_record(CLogRecord *log_rec)
 }
 
 RC CLogManager::clog_sync()
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  return clog_sync_locked();
+}
+
+RC CLogManager::clog_sync_locked()
 {
   RC rc = RC::SUCCESS;
   rc = log_buffer_->flush_buffer(log_file_);
@@ -449,7 +522,33 @@ RC CLogManager::clog_sync()
 
 RC CLogManager::recover()
 {
-  log_file_->recover(log_mtr_mgr_, log_buffer_);
+  log_file_->recover(log_mtr_mgr_, log_buffer_, recovered_records_);
+  return RC::SUCCESS;
+}
+
+RC CLogManager::checkpoint(int64_t min_recovery_lsn)
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  min_recovery_lsn = std::max(min_recovery_lsn, log_file_->checkpoint_lsn());
+
+  // 检查点指向的日志必须已经写到文件中
+  RC rc = clog_sync_locked();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to sync clog before checkpoint. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+
+  while (!block_lsns_.empty() && block_lsns_.front().max_lsn < min_recovery_lsn) {
+    block_lsns_.pop_front();
+  }
+  // 之后的日志都还没有写，从下一条日志所在的block开始
+  const int32_t block_no = block_lsns_.empty() ? log_buffer_->next_record_block_no() : block_lsns_.front().block_no;
+  rc = log_file_->update_checkpoint(min_recovery_lsn, block_no);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to write checkpoint to clog file header. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+  LOG_DEBUG("Checkpoint clog. lsn=%ld, block no=%d", min_recovery_lsn, block_no);
   return RC::SUCCESS;
 }
 
@@ -458,9 +557,7 @@ CLogMTRManager *CLogManager::get_mtr_manager()
   return log_mtr_mgr_;
 }
 
-int32_t CLogManager::get_next_lsn(int32_t rec_len)
+int64_t CLogManager::get_next_lsn(int32_t rec_len)
 {
-  int32_t res_lsn = CLogManager::gloabl_lsn_;
-  CLogManager::gloabl_lsn_ += rec_len;  // 当前不考虑溢出
-  return res_lsn;
+  return CLogManager::gloabl_lsn_.fetch_add(rec_len);
 }
@@ -21,6 +21,8 @@ See the Mulan PSL v2 for more details. */
 #include <stdint.h>
 #include <list>
 #include <atomic>
+#include <deque>
+#include <mutex>
 #include <unordered_map>
 
 #include "storage/record/record.h"
@@ -43,10 +45,24 @@ struct CLogBlockHeader;
 struct CLogBlock;
 struct CLogMTRManager;
 
-enum CLogType { REDO_ERROR = 0, REDO_MTR_BEGIN, REDO_MTR_COMMIT, REDO_INSERT, REDO_DELETE };
+/**
+ * REDO_OVERFLOW 记录溢出页面(参考OverflowFileHandler)中的一段数据，格式与REDO_INSERT相同，
+ * rid_.page_num是溢出文件中的页号，rid_.slot_num是数据在页面中的偏移
+ * REDO_INSERT_BATCH 记录批量插入到同一个页面中的多条记录(参考Table::insert_records)，格式与REDO_INSERT相同，
+ * rid_.page_num是页号，rid_.slot_num是记录条数，数据是所有记录的槽位号(SlotNum)后面跟着所有记录的内容
+ */
+enum CLogType {
+  REDO_ERROR = 0,
+  REDO_MTR_BEGIN,
+  REDO_MTR_COMMIT,
+  REDO_INSERT,
+  REDO_DELETE,
+  REDO_OVERFLOW,
+  REDO_INSERT_BATCH
+};
 
 struct CLogRecordHeader {
-  int32_t lsn_;
+  int64_t lsn_;
   int32_t trx_id_;
   int type_;
   int logrec_len_;
@@ -121,7 +137,7 @@ public:
   {
     return log_record_.mtr.hdr_.logrec_len_;
   }
-  int32_t get_lsn()
+  int64_t get_lsn()
   {
     return log_record_.mtr.hdr_.lsn_;
   }
@@ -164,6 +180,11 @@ public:
 
   RC block_copy(int32_t offset, CLogBlock *log_block);
 
+  /**
+   * 下一条日志记录从哪个block开始写(block在文件中的偏移)
+   */
+  int32_t next_record_block_no();
+
 protected:
   int32_t current_block_no_;
   int32_t write_block_offset_;
@@ -178,6 +199,8 @@ protected:
 #define CLOG_BLOCK_DATA_SIZE (CLOG_BLOCK_SIZE - sizeof(CLogBlockHeader))
 #define CLOG_BLOCK_HDR_SIZE (sizeof(CLogBlockHeader))
 #define CLOG_REDO_BUFFER_SIZE 8 * CLOG_BLOCK_SIZE
+// 一条REDO_OVERFLOW/REDO_INSERT_BATCH日志最多携带的数据长度，整条日志记录不能超过CLOG_REDO_BUFFER_SIZE
+#define CLOG_OVERFLOW_CHUNK_SIZE (6 * CLOG_BLOCK_SIZE)
 
 struct CLogRecordBuf {
   int32_t write_offset_;
@@ -188,7 +211,9 @@ struct CLogRecordBuf {
 struct CLogFileHeader {
   int32_t current_file_real_offset_;
   // TODO: 用于文件组，当前没用
-  int32_t current_file_lsn_;
+  int64_t current_file_lsn_;
+  int64_t checkpoint_lsn_;       // 最近一次检查点的最小恢复LSN，之前的日志修改的页面都已经落盘
+  int32_t checkpoint_block_no_;  // 恢复时从这个block开始读日志，0表示从头开始
 };
 
 struct CLogFHDBlock {
@@ -212,12 +237,22 @@ public:
   CLogFile(const char *path);
   ~CLogFile();
 
-  RC update_log_fhd(int32_t current_file_lsn);
+  RC update_log_fhd(int64_t current_file_lsn);
+  RC update_checkpoint(int64_t checkpoint_lsn, int32_t checkpoint_block_no);
   RC append(int data_len, char *data);
   RC write(uint64_t offset, int data_len, char *data);
-  RC recover(CLogMTRManager *mtr_mgr, CLogBuffer *log_buffer);
+  /**
+   * 从检查点记录的block开始读取日志，之前的日志不再需要回放
+   * @param read_num 读出来的日志记录个数
+   */
+  RC recover(CLogMTRManager *mtr_mgr, CLogBuffer *log_buffer, int &read_num);
   RC block_recover(CLogBlock *block, int16_t &offset, CLogRecordBuf *logrec_buf, CLogRecord *&log_rec);
 
+  int64_t checkpoint_lsn() const
+  {
+    return log_fhd_.hdr_.checkpoint_lsn_;
+  }
+
 protected:
   CLogFHDBlock log_fhd_;
   PersistHandler *log_file_;
@@ -243,21 +278,68 @@ public:
       int data_len = 0, Record *rec = nullptr);
   //追加写到log_buffer
   RC clog_append_record(CLogRecord *log_rec);
-  // 通常不需要在外部调用
+  // 通常不需要在外部调用。缓冲池写脏页之前会调用，保证WAL
   RC clog_sync();
   // TODO: 优化回放过程，对同一位置的修改可以用哈希聚合
   RC recover();
 
+  /**
+   * 模糊检查点，不需要停止写入。
+   * 缓冲池保证min_recovery_lsn之前的日志修改的页面都已经落盘，这里把日志刷盘之后，
+   * 将这个LSN和它所在的block写到日志文件头中，下次恢复时从这里开始回放
+   * @param min_recovery_lsn 缓冲池中脏页的最小恢复LSN。比上一次检查点小时不会后退
+   */
+  RC checkpoint(int64_t min_recovery_lsn);
+  int64_t checkpoint_lsn() const
+  {
+    return log_file_->checkpoint_lsn();
+  }
+
+  /**
+   * 最近一次recover读出来的日志记录个数
+   */
+  int recovered_records() const
+  {
+    return recovered_records_;
+  }
+
   CLogMTRManager *get_mtr_manager();
 
-  static int32_t get_next_lsn(int32_t rec_len);
+  /**
+   * 分配一条长度为rec_len的日志记录的LSN，多个线程可以同时生成日志记录
+   */
+  static int64_t get_next_lsn(int32_t rec_len);
+
+  /**
+   * 下一条日志记录的LSN，缓冲池用它记录页面的恢复LSN
+   */
+  static int64_t next_lsn()
+  {
+    return gloabl_lsn_.load();
+  }
 
-  static std::atomic<int32_t> gloabl_lsn_;
+  static std::atomic<int64_t> gloabl_lsn_;
 
 protected:
+  RC clog_sync_locked();
+
+protected:
+  /**
+   * 日志文件中的一段，从block_no开始，到下一段开始为止。
+   * LSN在生成日志记录时分配，追加到缓冲区的顺序不一定和LSN的顺序相同，所以记录每一段中最大的LSN，
+   * 检查点时从第一个包含不小于检查点LSN的日志的段开始回放
+   */
+  struct BlockLsn {
+    int32_t block_no;
+    int64_t max_lsn;
+  };
+
   CLogBuffer *log_buffer_;
   CLogFile *log_file_;
   CLogMTRManager *log_mtr_mgr_;
+  std::mutex lock_;  // 后台刷脏线程在写页面之前也会调用clog_sync
+  std::deque<BlockLsn> block_lsns_;  // 受lock_保护，检查点之前的段会被删掉
+  int recovered_records_ = 0;
 };
 
 #endif  // __OBSERVER_STORAGE_REDO_REDOLOG_H_
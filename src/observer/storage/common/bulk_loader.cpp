@@ -0,0 +1,375 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/20.
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "storage/common/bulk_loader.h"
+#include "common/log/log.h"
+#include "storage/common/table.h"
+#include "storage/common/field_meta.h"
+#include "storage/record/record_manager.h"
+
+static const char FIELD_DELIM = '|';
+
+static bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static void strip(const char *&begin, const char *&end)
+{
+  while (begin < end && is_space(*begin)) {
+    begin++;
+  }
+  while (end > begin && is_space(*(end - 1))) {
+    end--;
+  }
+}
+
+BulkLoader::BulkLoader(Table *table, int thread_num, int64_t chunk_size)
+    : table_(table), thread_num_(thread_num), chunk_size_(chunk_size)
+{
+  if (thread_num_ <= 0) {
+    thread_num_ = std::min(std::max(static_cast<int>(std::thread::hardware_concurrency()), 1), 8);
+  }
+  if (chunk_size_ <= 0) {
+    chunk_size_ = DEFAULT_CHUNK_SIZE;
+  }
+  // 解析线程最多领先主线程这么多个chunk，限制解析出来还没有插入的记录占用的内存
+  window_ = thread_num_ * 2;
+}
+
+BulkLoader::~BulkLoader()
+{
+  stop_workers();
+  unmap_file();
+}
+
+RC BulkLoader::map_file(const char *file_name)
+{
+  fd_ = ::open(file_name, O_RDONLY);
+  if (fd_ < 0) {
+    errmsg_ = std::string("Failed to open file: ") + file_name + ". system error=" + strerror(errno);
+    return RC::FILE_OPEN;
+  }
+
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    errmsg_ = std::string("Failed to stat file: ") + file_name + ". system error=" + strerror(errno);
+    return RC::IOERR_ACCESS;
+  }
+  file_size_ = st.st_size;
+  if (file_size_ == 0) {
+    return RC::SUCCESS;
+  }
+
+  void *addr = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (addr == MAP_FAILED) {
+    errmsg_ = std::string("Failed to map file: ") + file_name + ". system error=" + strerror(errno);
+    return RC::IOERR_READ;
+  }
+  file_data_ = static_cast<char *>(addr);
+  madvise(file_data_, file_size_, MADV_SEQUENTIAL);
+  return RC::SUCCESS;
+}
+
+void BulkLoader::unmap_file()
+{
+  if (file_data_ != nullptr) {
+    munmap(file_data_, file_size_);
+    file_data_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+void BulkLoader::split_chunks()
+{
+  const char *p = file_data_;
+  const char *file_end = file_data_ + file_size_;
+  while (p < file_end) {
+    const char *end = p + std::min(chunk_size_, static_cast<int64_t>(file_end - p));
+    if (end < file_end) {
+      // chunk在换行符处结束，一行不会分到两个chunk中
+      const char *newline = static_cast<const char *>(memchr(end, '\n', file_end - end));
+      end = newline == nullptr ? file_end : newline + 1;
+    }
+    Chunk chunk;
+    chunk.begin = p;
+    chunk.end = end;
+    chunks_.push_back(std::move(chunk));
+    p = end;
+  }
+}
+
+void BulkLoader::start_workers()
+{
+  if (thread_num_ <= 1) {
+    return;
+  }
+  for (int i = 0; i < thread_num_; i++) {
+    workers_.emplace_back(&BulkLoader::worker, this);
+  }
+}
+
+void BulkLoader::stop_workers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  worker_cond_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void BulkLoader::worker()
+{
+  while (true) {
+    size_t index = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      worker_cond_.wait(lock, [this] {
+        return stop_ || next_chunk_ >= chunks_.size() || next_chunk_ < consumed_chunk_ + window_;
+      });
+      if (stop_ || next_chunk_ >= chunks_.size()) {
+        return;
+      }
+      index = next_chunk_++;
+    }
+
+    Chunk &chunk = chunks_[index];
+    parse_chunk(chunk);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      chunk.done = true;
+    }
+    consumer_cond_.notify_one();
+  }
+}
+
+void BulkLoader::parse_chunk(Chunk &chunk)
+{
+  const char *p = chunk.begin;
+  while (p < chunk.end) {
+    const char *newline = static_cast<const char *>(memchr(p, '\n', chunk.end - p));
+    const char *line_end = newline == nullptr ? chunk.end : newline;
+    const char *next = newline == nullptr ? chunk.end : newline + 1;
+
+    const char *begin = p;
+    const char *end = line_end;
+    strip(begin, end);
+    if (begin == end) {
+      chunk.line_num++;
+      p = next;
+      continue;
+    }
+
+    // 兼容windows的换行符，CHARS字段不去掉前后的空格
+    end = line_end;
+    if (end > p && *(end - 1) == '\r') {
+      end--;
+    }
+    const size_t offset = chunk.records.size();
+    chunk.records.resize(offset + record_size_);
+    RC rc = parse_line(p, end, chunk.records.data() + offset, chunk.errmsg);
+    if (rc != RC::SUCCESS) {
+      chunk.records.resize(offset);
+      chunk.rc = rc;
+      return;
+    }
+    chunk.line_num++;
+    chunk.row_num++;
+    p = next;
+  }
+}
+
+RC BulkLoader::parse_line(const char *begin, const char *end, char *record, std::string &errmsg)
+{
+  const TableMeta &table_meta = table_->table_meta();
+  const int sys_field_num = table_meta.sys_field_num();
+  const int field_num = table_meta.field_num() - sys_field_num;
+
+  const char *p = begin;
+  for (int i = 0; i < field_num; i++) {
+    if (p > end) {
+      errmsg = "need " + std::to_string(field_num) + " fields but got " + std::to_string(i);
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    const char *delim = static_cast<const char *>(memchr(p, FIELD_DELIM, end - p));
+    const char *value_begin = p;
+    const char *value_end = delim == nullptr ? end : delim;
+    p = value_end + 1;
+
+    const FieldMeta *field = table_meta.field(i + sys_field_num);
+    char *field_data = record + field->offset();
+    switch (field->type()) {
+      case INTS: {
+        strip(value_begin, value_end);
+        std::string value(value_begin, value_end);
+        char *parse_end = nullptr;
+        errno = 0;
+        long int_value = strtol(value.c_str(), &parse_end, 10);
+        if (value.empty() || *parse_end != '\0' || errno == ERANGE || int_value > INT_MAX || int_value < INT_MIN) {
+          errmsg = "need an integer but got '" + value + "' (field index:" + std::to_string(i) + ")";
+          return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+        }
+        int v = static_cast<int>(int_value);
+        memcpy(field_data, &v, sizeof(v));
+      } break;
+      case FLOATS: {
+        strip(value_begin, value_end);
+        std::string value(value_begin, value_end);
+        char *parse_end = nullptr;
+        float float_value = strtof(value.c_str(), &parse_end);
+        if (value.empty() || *parse_end != '\0') {
+          errmsg = "need a float number but got '" + value + "'(field index:" + std::to_string(i) + ")";
+          return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+        }
+        memcpy(field_data, &float_value, sizeof(float_value));
+      } break;
+      case CHARS: {
+        // 记录已经清零，短的字符串后面补0，超过字段长度的截断
+        const size_t len = std::min(static_cast<size_t>(value_end - value_begin), static_cast<size_t>(field->len()));
+        memcpy(field_data, value_begin, len);
+      } break;
+      default: {
+        errmsg = "Unsupported field type to loading: " + std::to_string(field->type());
+        return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+      } break;
+    }
+  }
+  if (p <= end) {
+    // 字段比表的列多，和字段不够一样当作错误的行
+    errmsg = "need " + std::to_string(field_num) + " fields but got more";
+    return RC::SCHEMA_FIELD_REDUNDAN;
+  }
+  return RC::SUCCESS;
+}
+
+RC BulkLoader::check_table_empty(bool &empty)
+{
+  RecordFileScanner scanner;
+  RC rc = table_->get_record_scanner(scanner, true);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  empty = !scanner.has_next();
+  scanner.close_scan();
+  return RC::SUCCESS;
+}
+
+RC BulkLoader::consume_chunk(Chunk &chunk, bool with_indexes, int64_t base_line)
+{
+  RC rc = RC::SUCCESS;
+  if (chunk.row_num > 0) {
+    rc = table_->append_records(chunk.records.data(), chunk.row_num, with_indexes);
+    if (rc != RC::SUCCESS) {
+      // 整个chunk都没有插入
+      error_line_ = base_line + 1;
+      errmsg_ = "failed to append records of line " + std::to_string(base_line + 1) + "-" +
+                std::to_string(base_line + chunk.line_num);
+      return rc;
+    }
+    row_num_ += chunk.row_num;
+  }
+  line_num_ += chunk.line_num;
+  byte_num_ += chunk.end - chunk.begin;
+
+  if (chunk.rc != RC::SUCCESS) {
+    line_num_++;
+    error_line_ = line_num_;
+    errmsg_ = chunk.errmsg;
+    rc = chunk.rc;
+  }
+  std::vector<char>().swap(chunk.records);
+  return rc;
+}
+
+RC BulkLoader::load(const char *file_name)
+{
+  RC rc = map_file(file_name);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  bool table_empty = false;
+  rc = check_table_empty(table_empty);
+  if (rc != RC::SUCCESS) {
+    errmsg_ = "failed to scan table";
+    return rc;
+  }
+  record_size_ = table_->table_meta().record_size();
+
+  split_chunks();
+  start_workers();
+
+  // 按照文件中的顺序插入，出错时前面的行都已经导入
+  for (size_t i = 0; i < chunks_.size() && rc == RC::SUCCESS; i++) {
+    Chunk &chunk = chunks_[i];
+    if (workers_.empty()) {
+      parse_chunk(chunk);
+    } else {
+      std::unique_lock<std::mutex> lock(mutex_);
+      consumer_cond_.wait(lock, [&chunk] { return chunk.done; });
+    }
+
+    rc = consume_chunk(chunk, !table_empty, line_num_);
+
+    if (!workers_.empty()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        consumed_chunk_++;
+      }
+      worker_cond_.notify_all();
+    }
+  }
+  stop_workers();
+
+  // 空表最后统一构建索引
+  if (table_empty && row_num_ > 0) {
+    RC build_rc = table_->build_indexes();
+    if (build_rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to build indexes after loading. table=%s, rc=%d:%s", table_->name(), build_rc, strrc(build_rc));
+      errmsg_ = "failed to build indexes, all loaded records are removed";
+      error_line_ = 0;
+      row_num_ = 0;
+      rc = build_rc;
+    }
+  }
+
+  RC sync_rc = table_->sync_data();
+  if (sync_rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to sync table after loading. table=%s, rc=%d:%s", table_->name(), sync_rc, strrc(sync_rc));
+    if (rc == RC::SUCCESS) {
+      errmsg_ = "failed to sync table";
+      rc = sync_rc;
+    }
+  }
+  unmap_file();
+  return rc;
+}
@@ -0,0 +1,107 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/20.
+//
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rc.h"
+
+class Table;
+
+/**
+ * LOAD DATA使用的导入器。
+ * 把文件映射到内存中，按照换行符切分成大块(chunk)，多个线程并行解析，每一行直接转换成记录格式；
+ * 主线程按照文件中的顺序把解析好的记录整页追加到表中(Table::append_records)。
+ * 导入空表时先不插入索引项，全部导入之后再自底向上构建索引。
+ * 导入的数据不记录日志，结束时把表的数据刷盘。
+ * 文件中每行一条记录，字段之间使用'|'分隔。遇到错误的行时，前面的行已经导入，后面的行不再处理
+ */
+class BulkLoader {
+public:
+  static const int64_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+public:
+  /**
+   * @param thread_num 解析线程的个数，0表示按照CPU个数决定。1表示在当前线程中解析
+   */
+  explicit BulkLoader(Table *table, int thread_num = 0, int64_t chunk_size = DEFAULT_CHUNK_SIZE);
+  ~BulkLoader();
+
+  RC load(const char *file_name);
+
+  int64_t line_num() const { return line_num_; }
+  int64_t row_num() const { return row_num_; }
+  int64_t byte_num() const { return byte_num_; }
+
+  /**
+   * 解析失败或者插入失败的行号(从1开始)，以及错误信息
+   */
+  int64_t error_line() const { return error_line_; }
+  const std::string &errmsg() const { return errmsg_; }
+
+private:
+  struct Chunk {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+
+    std::vector<char> records;  //! 解析出来的记录，连续存放
+    int line_num = 0;           //! 处理过的行数。出错时不包括出错的行
+    int row_num = 0;
+    RC rc = RC::SUCCESS;
+    std::string errmsg;
+    bool done = false;
+  };
+
+  RC map_file(const char *file_name);
+  void unmap_file();
+  void split_chunks();
+  void start_workers();
+  void stop_workers();
+  void worker();
+
+  void parse_chunk(Chunk &chunk);
+  RC parse_line(const char *begin, const char *end, char *record, std::string &errmsg);
+  RC consume_chunk(Chunk &chunk, bool with_indexes, int64_t base_line);
+  RC check_table_empty(bool &empty);
+
+private:
+  Table *table_ = nullptr;
+  int thread_num_ = 1;
+  int64_t chunk_size_ = DEFAULT_CHUNK_SIZE;
+  int record_size_ = 0;
+
+  int fd_ = -1;
+  char *file_data_ = nullptr;
+  int64_t file_size_ = 0;
+
+  std::vector<Chunk> chunks_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable worker_cond_;    //! 解析线程等待可以解析的chunk
+  std::condition_variable consumer_cond_;  //! 主线程等待chunk解析完成
+  size_t next_chunk_ = 0;                  //! 下一个要解析的chunk
+  size_t consumed_chunk_ = 0;              //! 已经追加到表中的chunk个数，解析线程最多领先window_个
+  size_t window_ = 0;
+  bool stop_ = false;
+
+  int64_t line_num_ = 0;
+  int64_t row_num_ = 0;
+  int64_t byte_num_ = 0;
+  int64_t error_line_ = 0;
+  std::string errmsg_;
+};
@@ -15,19 +15,67 @@ See the Mulan PSL v2 for more details. */
 
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <time.h>
 
+#include <limits>
 #include <vector>
 
 #include "common/lang/string.h"
 #include "common/log/log.h"
+#include "common/metrics/metrics.h"
+#include "common/metrics/metrics_registry.h"
 #include "common/os/path.h"
 #include "storage/clog/clog.h"
 #include "storage/common/meta_util.h"
 #include "storage/common/table.h"
 #include "storage/common/table_meta.h"
+#include "storage/default/disk_buffer_pool.h"
 #include "storage/trx/trx.h"
 
+using namespace common;
+
+/**
+ * 恢复只在启动时做一次，指标的值不再变化
+ */
+class RecoveryGauge : public Gauge
+{
+public:
+  RecoveryGauge(std::string value)
+  {
+    SnapshotBasic<std::string> *snapshot = new SnapshotBasic<std::string>();
+    snapshot->setValue(value);
+    set_snapshot(snapshot);
+  }
+
+  virtual ~RecoveryGauge()
+  {
+    delete snapshot_value_;
+  }
+
+  void snapshot() override
+  {}
+};
+
+static std::string recovery_metric_tag(const std::string &db_name)
+{
+  return "CLog." + db_name + ".recovery";
+}
+
 Db::~Db() {
+  // 最后做一次检查点，下次启动时不需要回放已经落盘的日志
+  if (clog_manager_ != nullptr) {
+    int flushed_num = 0;
+    BufferPoolManager::instance().checkpoint(flushed_num);
+  }
+  BufferPoolManager::instance().unregister_log_checkpointer(name_);
+  if (recovery_gauge_ != nullptr) {
+    get_metrics_registry().unregister(recovery_metric_tag(name_));
+    delete recovery_gauge_;
+    recovery_gauge_ = nullptr;
+  }
+  BufferPoolManager::instance().unregister_log_syncer(name_);
+  BufferPoolManager::instance().set_direct_io_dir(path_, false);
+  BufferPoolManager::instance().set_mmap_scan_dir(path_, false);
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
@@ -54,11 +102,31 @@ RC Db::init(const char *name, const char *dbpath) {
   name_ = name;
   path_ = dbpath;
 
+  // 表和索引的页面只缓存在缓冲池中，不经过操作系统的page cache
+  BufferPoolManager &bpm = BufferPoolManager::instance();
+  if (bpm.direct_io_configured(name)) {
+    LOG_INFO("Db %s uses direct io", name);
+    bpm.set_direct_io_dir(path_, true);
+  }
+  // 只读扫描直接访问文件映射，不把页面复制到缓冲池中
+  if (bpm.mmap_scan_configured(name)) {
+    LOG_INFO("Db %s uses mmap for read only scans", name);
+    bpm.set_mmap_scan_dir(path_, true);
+  }
+
+  // 页面第一次变脏时记下当前的LSN，作为它的恢复LSN
+  BufferPoolManager::set_lsn_source(&CLogManager::next_lsn);
+
+  // 缓冲池写脏页之前先把日志刷盘
+  CLogManager *clog_manager = clog_manager_;
+  BufferPoolManager::instance().register_log_syncer(name_, [clog_manager]() { return clog_manager->clog_sync(); });
+
   return open_all_tables();
 }
 
 RC Db::create_table(const char *table_name, int attribute_count,
-                    const AttrInfo *attributes) {
+                    const AttrInfo *attributes, const char *buffer_pool, int page_size,
+                    RecordFormat record_format) {
   RC rc = RC::SUCCESS;
   // check table_name
   if (opened_tables_.count(table_name) != 0) {
@@ -70,7 +138,8 @@ RC Db::create_table(const char *table_name, int attribute_count,
   std::string table_file_path = table_meta_file(path_.c_str(), table_name);
   Table *table = new Table();
   rc = table->create(table_file_path.c_str(), table_name, path_.c_str(),
-                     attribute_count, attributes, get_clog_manager());
+                     attribute_count, attributes, get_clog_manager(), buffer_pool, page_size,
+                     record_format);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s.", table_name);
     delete table;
@@ -175,25 +244,30 @@ RC Db::sync() {
 }
 
 RC Db::recover() {
+  struct timespec begin, end;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+
+  int replayed_num = 0;
+  int skipped_num = 0;
   RC rc = RC::SUCCESS;
   if ((rc = clog_manager_->recover()) == RC::SUCCESS) {
     uint32_t max_trx_id = 0;
+    BufferPoolManager::begin_redo();
     CLogMTRManager *mtr_manager = clog_manager_->get_mtr_manager();
     for (auto it = mtr_manager->log_redo_list.begin();
          it != mtr_manager->log_redo_list.end(); it++) {
       CLogRecord *clog_record = *it;
       if (clog_record->get_log_type() != CLogType::REDO_INSERT &&
-          clog_record->get_log_type() != CLogType::REDO_DELETE) {
+          clog_record->get_log_type() != CLogType::REDO_DELETE &&
+          clog_record->get_log_type() != CLogType::REDO_OVERFLOW &&
+          clog_record->get_log_type() != CLogType::REDO_INSERT_BATCH) {
         delete clog_record;
         continue;
       }
       auto find_iter =
           mtr_manager->trx_commited.find(clog_record->get_trx_id());
-      if (find_iter == mtr_manager->trx_commited.end()) {
-        LOG_ERROR("CLog record without commit message! ");  // unexpected error
-        delete clog_record;
-        return RC::GENERIC_ERROR;
-      } else if (find_iter->second == false) {
+      if (find_iter == mtr_manager->trx_commited.end() || find_iter->second == false) {
+        // 事务的BEGIN可能在检查点之前，没有读到；只要没有读到COMMIT就是没有提交的事务
         delete clog_record;
         continue;
       }
@@ -204,6 +278,25 @@ RC Db::recover() {
         continue;
       }
 
+      // 页面刷盘时的LSN比日志的大，说明这条日志的修改已经在页面中了
+      const PageNum page_num = clog_record->get_log_type() == CLogType::REDO_DELETE
+                                   ? clog_record->log_record_.del.rid_.page_num
+                                   : clog_record->log_record_.ins.rid_.page_num;
+      int64_t page_lsn = 0;
+      rc = table->page_lsn(clog_record->get_log_type() == CLogType::REDO_OVERFLOW, page_num, page_lsn);
+      if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to get page lsn. table=%s, page=%d, rc=%s", table->name(), page_num, strrc(rc));
+        break;
+      }
+      if (clog_record->get_lsn() < page_lsn) {
+        if (max_trx_id < clog_record->get_trx_id()) {
+          max_trx_id = clog_record->get_trx_id();
+        }
+        skipped_num++;
+        delete clog_record;
+        continue;
+      }
+
       switch (clog_record->get_log_type()) {
         case CLogType::REDO_INSERT: {
           char *record_data = new char[clog_record->log_record_.ins.data_len_];
@@ -221,6 +314,14 @@ RC Db::recover() {
           record.set_rid(clog_record->log_record_.del.rid_);
           rc = table->recover_delete_record(&record);
         } break;
+        case CLogType::REDO_OVERFLOW: {
+          const CLogInsertRecord &ins = clog_record->log_record_.ins;
+          rc = table->recover_overflow_page(ins.rid_.page_num, ins.rid_.slot_num, ins.data_, ins.data_len_);
+        } break;
+        case CLogType::REDO_INSERT_BATCH: {
+          const CLogInsertRecord &ins = clog_record->log_record_.ins;
+          rc = table->recover_insert_records(ins.rid_.page_num, ins.rid_.slot_num, ins.data_, ins.data_len_);
+        } break;
         default: {
           rc = RC::SUCCESS;
         }
@@ -234,14 +335,44 @@ RC Db::recover() {
       if (max_trx_id < clog_record->get_trx_id()) {
         max_trx_id = clog_record->get_trx_id();
       }
+      replayed_num++;
       delete clog_record;
     }
 
+    BufferPoolManager::end_redo();
+
     if (rc == RC::SUCCESS && max_trx_id > 0) {
       Trx::set_trx_id(max_trx_id);
     }
   }
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  // 回放修改的页面落盘之后，才能把检查点推进到当前的日志位置
+  BufferPoolManager &bpm = BufferPoolManager::instance();
+  bpm.flush_frames_before(std::numeric_limits<int64_t>::max());
+  rc = clog_manager_->checkpoint(bpm.min_recovery_lsn());
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to checkpoint after recovery. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
 
+  CLogManager *clog_manager = clog_manager_;
+  bpm.register_log_checkpointer(name_, [clog_manager](int64_t min_recovery_lsn) {
+    return clog_manager->checkpoint(min_recovery_lsn);
+  });
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  const long duration_ms = (end.tv_sec - begin.tv_sec) * 1000L + (end.tv_nsec - begin.tv_nsec) / 1000000;
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "duration_ms=%ld, read_records=%d, replayed_records=%d, skipped_records=%d, checkpoint_lsn=%ld",
+           duration_ms, clog_manager_->recovered_records(), replayed_num, skipped_num, clog_manager_->checkpoint_lsn());
+  LOG_INFO("Recover db %s done. %s", name_.c_str(), buf);
+
+  recovery_gauge_ = new RecoveryGauge(std::string(buf));
+  get_metrics_registry().register_metric(recovery_metric_tag(name_), recovery_gauge_);
   return rc;
 }
 
@@ -21,6 +21,11 @@ See the Mulan PSL v2 for more details. */
 
 #include "rc.h"
 #include "sql/parser/parse_defs.h"
+#include "storage/record/record.h"
+
+namespace common {
+class Gauge;
+}  // namespace common
 
 class Table;
 class CLogManager;
@@ -32,7 +37,14 @@ public:
 
   RC init(const char *name, const char *dbpath);
 
-  RC create_table(const char *table_name, int attribute_count, const AttrInfo *attributes);
+  /**
+   * @param buffer_pool 表使用的缓冲池，空表示默认的缓冲池
+   * @param page_size 数据文件的页面大小，0表示默认的页面大小
+   * @param record_format 记录在数据页面中的存放格式
+   */
+  RC create_table(const char *table_name, int attribute_count, const AttrInfo *attributes,
+                  const char *buffer_pool = nullptr, int page_size = 0,
+                  RecordFormat record_format = RecordFormat::FIXED);
 
   RC drop_table(const char *table_name);
 
@@ -44,6 +56,10 @@ public:
 
   RC sync();
 
+  /**
+   * 从日志文件头记录的检查点开始回放日志，回放的页面刷盘之后做一次检查点，
+   * 之后由BufferPoolManager周期性地推进检查点
+   */
   RC recover();
 
   CLogManager *get_clog_manager();
@@ -56,6 +72,7 @@ private:
   std::string path_;
   std::unordered_map<std::string, Table *> opened_tables_;
   CLogManager *clog_manager_ = nullptr;
+  common::Gauge *recovery_gauge_ = nullptr;  //! 最近一次恢复的耗时和回放的日志个数
 };
 
 #endif  // __OBSERVER_STORAGE_COMMON_DB_H__
\ No newline at end of file
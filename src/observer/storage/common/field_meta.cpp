@@ -95,6 +95,11 @@ bool FieldMeta::visible() const
   return visible_;
 }
 
+bool FieldMeta::overflow_text() const
+{
+  return attr_type_ == TEXTS && attr_len_ == TEXT_FIELD_LENGTH;
+}
+
 void FieldMeta::desc(std::ostream &os) const
 {
   os << "field name=" << name_ << ", type=" << attr_type_to_string(attr_type_) << ", len=" << attr_len_
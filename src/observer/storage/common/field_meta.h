@@ -39,6 +39,12 @@ class FieldMeta {
   int len() const;
   bool visible() const;
 
+  /**
+   * TEXT字段在记录中是否按照TextRef存放，长文本放在溢出页面中。
+   * 以前创建的表中TEXT字段固定占用4096字节，直接存放在记录中
+   */
+  bool overflow_text() const;
+
  public:
   void desc(std::ostream &os) const;
 
@@ -24,6 +24,7 @@ See the Mulan PSL v2 for more details. */
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
 const static Json::StaticString FIELD_IS_UNIQUE("is_unique");
+const static Json::StaticString FIELD_BUFFER_POOL("buffer_pool");
 
 RC IndexMeta::init(const char *name, const std::vector<FieldMeta> &fields, const bool &is_unique)
 {
@@ -45,6 +46,9 @@ void IndexMeta::to_json(Json::Value &json_value) const
   json_value[FIELD_NAME] = name_;
   json_value[FIELD_FIELD_NAME] = union_with(fields_, '_');
   json_value[FIELD_IS_UNIQUE] = is_unique_ ? "1" : "0";
+  if (!buffer_pool_.empty()) {
+    json_value[FIELD_BUFFER_POOL] = buffer_pool_;
+  }
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index)
@@ -76,7 +80,16 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     fields_meta.push_back(*field_meta);
   }
 
-  return index.init(name_value.asCString(), fields_meta, is_unique.asString() == "1");
+  RC rc = index.init(name_value.asCString(), fields_meta, is_unique.asString() == "1");
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  const Json::Value &buffer_pool_value = json_value[FIELD_BUFFER_POOL];
+  if (buffer_pool_value.isString()) {
+    index.set_buffer_pool(buffer_pool_value.asCString());
+  }
+  return RC::SUCCESS;
   // return index.init(name_value.asCString(), *field, false);
 }
 
@@ -37,6 +37,12 @@ public:
   const std::vector<std::string> fields() const;
   const bool is_unique() const;
 
+  /**
+   * 索引的页面缓存在哪个缓冲池中，空表示默认的缓冲池
+   */
+  void set_buffer_pool(const char *buffer_pool) { buffer_pool_ = buffer_pool == nullptr ? "" : buffer_pool; }
+  const char *buffer_pool() const { return buffer_pool_.c_str(); }
+
   void desc(std::ostream &os) const;
 
 public:
@@ -47,5 +53,6 @@ protected:
   std::string name_;   // index's name
   std::vector<std::string> fields_;  // field's name
   bool is_unique_;
+  std::string buffer_pool_;
 };
 #endif  // __OBSERVER_STORAGE_COMMON_INDEX_META_H__
\ No newline at end of file
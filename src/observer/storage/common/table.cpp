@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <limits.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <algorithm>
 
@@ -28,6 +29,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/default/disk_buffer_pool.h"
 #include "storage/index/bplus_tree_index.h"
 #include "storage/index/index.h"
+#include "storage/record/overflow_manager.h"
 #include "storage/record/record_manager.h"
 #include "storage/trx/trx.h"
 #include "util/util.h"
@@ -42,9 +44,19 @@ Table::~Table() {
     data_buffer_pool_->close_file();
     data_buffer_pool_ = nullptr;
   }
-  // if (overflow_file_!=nullptr){
-  //   fclose(overflow_file_);
-  // }
+  if (fsm_buffer_pool_ != nullptr) {
+    fsm_buffer_pool_->close_file();
+    fsm_buffer_pool_ = nullptr;
+  }
+
+  if (overflow_handler_ != nullptr) {
+    delete overflow_handler_;
+    overflow_handler_ = nullptr;
+  }
+  if (overflow_buffer_pool_ != nullptr) {
+    overflow_buffer_pool_->close_file();
+    overflow_buffer_pool_ = nullptr;
+  }
 
   for (std::vector<Index *>::iterator it = indexes_.begin();
        it != indexes_.end(); ++it) {
@@ -58,7 +70,8 @@ Table::~Table() {
 
 RC Table::create(const char *path, const char *name, const char *base_dir,
                  int attribute_count, const AttrInfo attributes[],
-                 CLogManager *clog_manager) {
+                 CLogManager *clog_manager, const char *buffer_pool, int page_size,
+                 RecordFormat record_format) {
   if (common::is_blank(name)) {
     LOG_WARN("Name cannot be empty");
     return RC::INVALID_ARGUMENT;
@@ -90,7 +103,6 @@ RC Table::create(const char *path, const char *name, const char *base_dir,
   }
 
   close(fd);
-  // 使用 table_name.overflow 记录一个表的溢出数据
 
   // 创建文件
   if ((rc = table_meta_.init(name, attribute_count, attributes)) !=
@@ -98,6 +110,8 @@ RC Table::create(const char *path, const char *name, const char *base_dir,
     LOG_ERROR("Failed to init table meta. name:%s, ret:%d", name, rc);
     return rc;  // delete table file
   }
+  table_meta_.set_buffer_pool(buffer_pool);
+  table_meta_.set_record_format(record_format);
 
   std::fstream fs;
   fs.open(path, std::ios_base::out | std::ios_base::binary);
@@ -113,13 +127,32 @@ RC Table::create(const char *path, const char *name, const char *base_dir,
 
   std::string data_file = table_data_file(base_dir, name);
   BufferPoolManager &bpm = BufferPoolManager::instance();
-  rc = bpm.create_file(data_file.c_str());
+  rc = bpm.create_file(data_file.c_str(), page_size > 0 ? page_size : BP_PAGE_SIZE);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create disk buffer pool of data file. file name=%s",
               data_file.c_str());
     return rc;
   }
 
+  // 使用 table_name.fsm 记录数据文件中每个页面的空闲空间，打开表时不用遍历数据文件
+  std::string fsm_file = table_fsm_file(base_dir, name);
+  rc = bpm.create_file(fsm_file.c_str(), page_size > 0 ? page_size : BP_PAGE_SIZE);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to create disk buffer pool of free space map file. file name=%s", fsm_file.c_str());
+    return rc;
+  }
+
+  // 使用 table_name.overflow 记录一个表的溢出数据，页面大小和数据文件相同
+  if (has_overflow_text()) {
+    std::string overflow_file = table_overflow_file(base_dir, name);
+    rc = bpm.create_file(overflow_file.c_str(), page_size > 0 ? page_size : BP_PAGE_SIZE);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to create disk buffer pool of overflow file. file name=%s",
+                overflow_file.c_str());
+      return rc;
+    }
+  }
+
   rc = init_record_handler(base_dir);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s due to init record handler failed.",
@@ -129,7 +162,6 @@ RC Table::create(const char *path, const char *name, const char *base_dir,
   }
 
   base_dir_ = base_dir;
-  // overflow_file_ =fopen(overflow_file_)
   clog_manager_ = clog_manager;
   LOG_INFO("Successfully create table %s:%s", base_dir, name);
   return rc;
@@ -167,6 +199,32 @@ RC Table::destory(const char *base_dir) {
     return RC::GENERIC_ERROR;
   }
   rc = BufferPoolManager::instance().close_file(data_file.c_str());
+  data_buffer_pool_ = nullptr;
+
+  // 删除空闲空间表，先关掉record handler，它一直pin着空闲空间表的根页面
+  if (fsm_buffer_pool_ != nullptr) {
+    record_handler_->close();
+    fsm_buffer_pool_ = nullptr;
+    std::string fsm_file = table_fsm_file(base_dir, name());
+    BufferPoolManager::instance().close_file(fsm_file.c_str());
+    if (unlink(fsm_file.c_str()) != 0) {
+      LOG_ERROR("Failed to remove free space map file=%s,errno=%d", fsm_file.c_str(), errno);
+      return RC::GENERIC_ERROR;
+    }
+  }
+
+  // 删除溢出文件
+  if (overflow_buffer_pool_ != nullptr) {
+    delete overflow_handler_;
+    overflow_handler_ = nullptr;
+    overflow_buffer_pool_ = nullptr;
+    std::string overflow_file = table_overflow_file(base_dir, name());
+    BufferPoolManager::instance().close_file(overflow_file.c_str());
+    if (unlink(overflow_file.c_str()) != 0) {
+      LOG_ERROR("Failed to remove overflow file=%s,errno=%d", overflow_file.c_str(), errno);
+      return RC::GENERIC_ERROR;
+    }
+  }
 
   // 删除索引
   const int index_num = table_meta_.index_num();
@@ -255,16 +313,14 @@ RC Table::open(const char *meta_file, const char *base_dir,
 }
 
 RC Table::commit_insert(Trx *trx, const RID &rid) {
-  Record record;
-  // 报错了 原因是就没有record了
-  RC rc = record_handler_->get_record(&rid, &record);
+  // 修改记录中的事务字段，变长格式的记录需要写回页面
+  RC rc = record_handler_->update_record_in_place(
+      &rid, [this, trx](Record &record) { return trx->commit_insert(this, record); });
   if (rc != RC::SUCCESS) {
-    LOG_ERROR("Failed to get record %s: %s", this->name(),
-              rid.to_string().c_str());
-    return rc;
+    LOG_ERROR("Failed to commit insert %s: %s. rc=%s", this->name(),
+              rid.to_string().c_str(), strrc(rc));
   }
-
-  return trx->commit_insert(this, record);
+  return rc;
 }
 
 RC Table::rollback_insert(Trx *trx, const RID &rid) {
@@ -286,7 +342,7 @@ RC Table::rollback_insert(Trx *trx, const RID &rid) {
     return rc;
   }
 
-  rc = record_handler_->delete_record(&rid);
+  rc = delete_record_data(rid, record.data());
   return rc;
 }
 
@@ -388,7 +444,7 @@ RC Table::insert_record(Trx *trx, int value_num, const Value *values) {
   }
 
   char *record_data;
-  RC rc = make_record(value_num, values, record_data);  // <= G!
+  RC rc = make_record(trx, value_num, values, record_data);  // <= G!
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create a record. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -397,17 +453,255 @@ RC Table::insert_record(Trx *trx, int value_num, const Value *values) {
   Record record;
   record.set_data(record_data);
   rc = insert_record(trx, &record);  // <= G!
+  if (rc != RC::SUCCESS) {
+    delete_texts(record_data);
+  }
   if (is_empty) is_empty = false;
 
   delete[] record_data;
   return rc;
 }
 
+RC Table::insert_records(Trx *trx, int value_num, const Value *values, int row_num) {
+  if (value_num <= 0 || nullptr == values || row_num <= 0) {
+    LOG_ERROR("Invalid argument. table name: %s, value num=%d, values=%p, row num=%d",
+              name(), value_num, values, row_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 所有行连续放在一块内存中，记录管理器和索引都按批处理
+  const int record_size = table_meta_.record_size();
+  std::vector<char> records(static_cast<size_t>(record_size) * row_num, 0);
+  RC rc = RC::SUCCESS;
+  int filled = 0;
+  for (; filled < row_num; filled++) {
+    char *record_data = records.data() + static_cast<size_t>(filled) * record_size;
+    rc = fill_record(trx, value_num, values + filled * value_num, record_data);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to create a record. row=%d, rc=%d:%s", filled, rc, strrc(rc));
+      break;
+    }
+    if (trx != nullptr) {
+      Record record;
+      record.set_data(record_data);
+      trx->init_trx_info(this, record);
+    }
+  }
+  if (rc != RC::SUCCESS) {
+    for (int i = 0; i < filled; i++) {
+      delete_texts(records.data() + static_cast<size_t>(i) * record_size);
+    }
+    return rc;
+  }
+
+  std::vector<RID> rids(row_num);
+  rc = record_handler_->insert_records(records.data(), row_num, record_size, rids.data());
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Insert records failed. table name=%s, row num=%d, rc=%d:%s",
+              table_meta_.name(), row_num, rc, strrc(rc));
+    for (int i = 0; i < row_num; i++) {
+      delete_texts(records.data() + static_cast<size_t>(i) * record_size);
+    }
+    return rc;
+  }
+
+  int registered = 0;
+  if (trx != nullptr) {
+    for (; registered < row_num; registered++) {
+      Record record;
+      record.set_data(records.data() + static_cast<size_t>(registered) * record_size);
+      record.set_rid(rids[registered]);
+      rc = trx->insert_record(this, &record);
+      if (rc != RC::SUCCESS) {
+        LOG_ERROR("Failed to log operation(insertion) to trx");
+        break;
+      }
+    }
+  }
+
+  if (rc == RC::SUCCESS) {
+    rc = insert_entries_of_indexes(records.data(), row_num, rids.data());
+  }
+
+  if (rc != RC::SUCCESS) {
+    for (int i = 0; i < row_num; i++) {
+      Record record;
+      record.set_data(records.data() + static_cast<size_t>(i) * record_size);
+      record.set_rid(rids[i]);
+      if (i < registered) {
+        RC rc2 = trx->delete_record(this, &record);
+        if (rc2 != RC::SUCCESS) {
+          LOG_PANIC("Failed to rollback trx operation when insert records failed. table name=%s, rc=%d:%s",
+                    name(), rc2, strrc(rc2));
+        }
+      }
+      RC rc2 = delete_record_data(rids[i], record.data());
+      if (rc2 != RC::SUCCESS) {
+        LOG_PANIC("Failed to rollback record data when insert records failed. table name=%s, rc=%d:%s",
+                  name(), rc2, strrc(rc2));
+      }
+    }
+    return rc;
+  }
+  if (is_empty) is_empty = false;
+
+  return log_insert_records(trx, records.data(), row_num, rids.data());
+}
+
+RC Table::append_records(const char *records, int record_num, bool with_indexes) {
+  std::vector<RID> rids(record_num);
+  RC rc = record_handler_->insert_records(records, record_num, table_meta_.record_size(), rids.data(), true);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Append records failed. table name=%s, record num=%d, rc=%d:%s",
+              name(), record_num, rc, strrc(rc));
+    return rc;
+  }
+
+  if (with_indexes) {
+    rc = insert_entries_of_indexes(records, record_num, rids.data());
+    if (rc != RC::SUCCESS) {
+      for (const RID &rid : rids) {
+        record_handler_->delete_record(&rid);
+      }
+      return rc;
+    }
+  }
+  if (is_empty) is_empty = false;
+  return RC::SUCCESS;
+}
+
+RC Table::build_indexes() {
+  RC rc = RC::SUCCESS;
+  size_t built = 0;
+  for (; built < indexes_.size(); built++) {
+    Index *index = indexes_[built];
+    RecordFileScanner scanner;
+    rc = get_record_scanner(scanner, true);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to open scanner while building index. table=%s, rc=%d:%s", name(), rc, strrc(rc));
+      break;
+    }
+    rc = index->build(scanner);
+    scanner.close_scan();
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to build index. table=%s, index=%s, rc=%d:%s",
+                name(), index->index_meta().name(), rc, strrc(rc));
+      break;
+    }
+  }
+  if (rc == RC::SUCCESS) {
+    return rc;
+  }
+
+  // 比如唯一索引有重复的键值。导入之前是空表，删除已经构建的索引项和所有记录
+  std::vector<RID> rids;
+  RecordFileScanner scanner;
+  if (get_record_scanner(scanner, true) == RC::SUCCESS) {
+    Record record;
+    while (scanner.has_next() && scanner.next(record) == RC::SUCCESS) {
+      for (size_t i = 0; i < built; i++) {
+        indexes_[i]->delete_entry(record.data(), &record.rid());
+      }
+      rids.push_back(record.rid());
+    }
+    scanner.close_scan();
+  }
+  for (const RID &rid : rids) {
+    record_handler_->delete_record(&rid);
+  }
+  return rc;
+}
+
+RC Table::log_insert_records(Trx *trx, const char *records, int record_num, const RID *rids) {
+  if (trx == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  // 一条日志记录不能超过CLOG_REDO_BUFFER_SIZE，同一个页面上的记录按照CLOG_OVERFLOW_CHUNK_SIZE拆成多条日志
+  const int record_size = table_meta_.record_size();
+  const int batch_max = CLOG_OVERFLOW_CHUNK_SIZE / static_cast<int>(sizeof(SlotNum) + record_size);
+  std::vector<char> buffer;
+  for (int i = 0; i < record_num;) {
+    int count = 1;
+    while (count < batch_max && i + count < record_num && rids[i + count].page_num == rids[i].page_num) {
+      count++;
+    }
+
+    Record record;
+    CLogRecord *clog_record = nullptr;
+    RC rc = RC::SUCCESS;
+    if (count == 1) {
+      record.set_rid(rids[i]);
+      record.set_data(const_cast<char *>(records + static_cast<size_t>(i) * record_size));
+      rc = clog_manager_->clog_gen_record(
+          CLogType::REDO_INSERT, trx->get_current_id(), clog_record, name(), record_size, &record);
+    } else {
+      buffer.resize(count * (sizeof(SlotNum) + record_size));
+      for (int k = 0; k < count; k++) {
+        memcpy(buffer.data() + k * sizeof(SlotNum), &rids[i + k].slot_num, sizeof(SlotNum));
+      }
+      memcpy(buffer.data() + count * sizeof(SlotNum), records + static_cast<size_t>(i) * record_size,
+             static_cast<size_t>(count) * record_size);
+      record.set_rid(rids[i].page_num, count);
+      record.set_data(buffer.data());
+      rc = clog_manager_->clog_gen_record(CLogType::REDO_INSERT_BATCH, trx->get_current_id(), clog_record, name(),
+                                          static_cast<int>(buffer.size()), &record);
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to create a clog record. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+    rc = clog_manager_->clog_append_record(clog_record);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    i += count;
+  }
+  return RC::SUCCESS;
+}
+
+RC Table::recover_insert_records(PageNum page_num, int record_num, const char *data, int len) {
+  const int record_size = table_meta_.record_size();
+  if (record_num <= 0 || len != record_num * static_cast<int>(sizeof(SlotNum) + record_size)) {
+    LOG_ERROR("Invalid batch insert log. table name=%s, record num=%d, len=%d, record size=%d",
+              name(), record_num, len, record_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  std::vector<char> record_data(record_size);
+  const char *records = data + record_num * sizeof(SlotNum);
+  for (int i = 0; i < record_num; i++) {
+    SlotNum slot_num;
+    memcpy(&slot_num, data + i * sizeof(SlotNum), sizeof(slot_num));
+    memcpy(record_data.data(), records + static_cast<size_t>(i) * record_size, record_size);
+
+    Record record;
+    record.set_data(record_data.data());
+    record.set_rid(page_num, slot_num);
+    RC rc = recover_insert_record(&record);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 const char *Table::name() const { return table_meta_.name(); }
 
 const TableMeta &Table::table_meta() const { return table_meta_; }
 
-RC Table::make_record(int value_num, const Value *values, char *&record_out) {
+RC Table::make_record(Trx *trx, int value_num, const Value *values, char *&record_out) {
+  char *record = new char[table_meta_.record_size()];
+  RC rc = fill_record(trx, value_num, values, record);
+  if (rc != RC::SUCCESS) {
+    delete[] record;
+    return rc;
+  }
+  record_out = record;
+  return RC::SUCCESS;
+}
+
+RC Table::fill_record(Trx *trx, int value_num, const Value *values, char *record) {
   // 检查字段类型是否一致
   if (value_num + table_meta_.sys_field_num() != table_meta_.field_num()) {
     LOG_WARN("Input values don't match the table's schema, table name:%s",
@@ -433,15 +727,26 @@ RC Table::make_record(int value_num, const Value *values, char *&record_out) {
   }
 
   // 复制所有字段的值
-  int record_size = table_meta_.record_size();
-  char *record = new char[record_size];
-
   memset(record, 0, table_meta_.field(normal_field_start_index)->offset());
   for (int i = 0; i < value_num; i++) {
     const FieldMeta *field = table_meta_.field(i + normal_field_start_index);
     const Value &value = values[i];
     size_t copy_len = field->len();
 
+    if (field->overflow_text()) {
+      RC rc = write_text(trx, (const char *)value.data, record + field->offset());
+      if (rc != RC::SUCCESS) {
+        // 释放前面字段已经写入的溢出页面
+        for (int j = 0; j < i; j++) {
+          const FieldMeta *written = table_meta_.field(j + normal_field_start_index);
+          if (written->overflow_text()) {
+            delete_text(record + written->offset());
+          }
+        }
+        return rc;
+      }
+      continue;
+    }
     if (field->type() == CHARS) {
       const size_t data_len = strlen((const char *)value.data);
       if (copy_len > data_len) {
@@ -450,15 +755,15 @@ RC Table::make_record(int value_num, const Value *values, char *&record_out) {
       if(copy_len <data_len){
         copy_len=data_len;
       }
+    } else if (field->type() == TEXTS) {
+      copy_len = std::min(copy_len, strlen((const char *)value.data) + 1);
     }
     memcpy(record + field->offset(), value.data, copy_len);
   }
-
-  record_out = record;
   return RC::SUCCESS;
 }
 
-RC Table::change_record(int value_index, const Value *values,
+RC Table::change_record(Trx *trx, int value_index, const Value *values,
                         char *&record_out) {
   // 已经做了类型检查了
 
@@ -468,6 +773,9 @@ RC Table::change_record(int value_index, const Value *values,
       table_meta_.field(value_index + normal_field_start_index);
   const Value &value = values[0];
   size_t copy_len = field->len();
+  if (field->overflow_text()) {
+    return write_text(trx, (const char *)value.data, record_out + field->offset());
+  }
   if (field->type() == CHARS) {
     const size_t data_len = strlen((const char *)value.data);
     if (copy_len > data_len) {
@@ -476,6 +784,8 @@ RC Table::change_record(int value_index, const Value *values,
     if(copy_len <data_len){
       copy_len=data_len;
     }
+  } else if (field->type() == TEXTS) {
+    copy_len = std::min(copy_len, strlen((const char *)value.data) + 1);
   }
   memcpy(record_out + field->offset(), value.data, copy_len);
   // record_out = record;
@@ -487,15 +797,45 @@ RC Table::init_record_handler(const char *base_dir) {
   std::string data_file = table_data_file(base_dir, table_meta_.name());
 
   RC rc = BufferPoolManager::instance().open_file(data_file.c_str(),
-                                                  data_buffer_pool_);
+                                                  data_buffer_pool_,
+                                                  table_meta_.buffer_pool());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to open disk buffer pool for file:%s. rc=%d:%s",
               data_file.c_str(), rc, strrc(rc));
     return rc;
   }
 
+  // 变长格式中字符串字段只保存实际的长度
+  RecordLayout layout;
+  const bool slotted = table_meta_.record_format() == RecordFormat::SLOTTED;
+  if (slotted) {
+    std::vector<RecordLayout::VarField> var_fields;
+    for (const FieldMeta &field : *table_meta_.field_metas()) {
+      if (field.type() == CHARS || (field.type() == TEXTS && !field.overflow_text())) {
+        var_fields.push_back({field.offset(), field.len()});
+      }
+    }
+    layout = RecordLayout(table_meta_.record_size(), std::move(var_fields));
+  }
+
+  // 以前创建的表没有空闲空间表文件，这里创建一个，打开之后遍历一次数据文件初始化
+  BufferPoolManager &bpm = BufferPoolManager::instance();
+  std::string fsm_file = table_fsm_file(base_dir, table_meta_.name());
+  if (access(fsm_file.c_str(), F_OK) != 0) {
+    rc = bpm.create_file(fsm_file.c_str(), data_buffer_pool_->page_size());
+  }
+  if (rc == RC::SUCCESS) {
+    rc = bpm.open_file(fsm_file.c_str(), fsm_buffer_pool_, table_meta_.buffer_pool());
+  }
+  if (rc != RC::SUCCESS) {
+    // 空闲空间表只影响插入时查找页面的效率，打不开的话每次遍历数据文件重建
+    LOG_WARN("Failed to open free space map file:%s, use a transient one. rc=%d:%s",
+             fsm_file.c_str(), rc, strrc(rc));
+    fsm_buffer_pool_ = nullptr;
+  }
+
   record_handler_ = new RecordFileHandler();
-  rc = record_handler_->init(data_buffer_pool_);
+  rc = record_handler_->init(data_buffer_pool_, slotted ? &layout : nullptr, fsm_buffer_pool_);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to init record handler. rc=%d:%s", rc, strrc(rc));
     data_buffer_pool_->close_file();
@@ -505,11 +845,159 @@ RC Table::init_record_handler(const char *base_dir) {
     return rc;
   }
 
+  if (has_overflow_text()) {
+    std::string overflow_file = table_overflow_file(base_dir, table_meta_.name());
+    rc = BufferPoolManager::instance().open_file(overflow_file.c_str(), overflow_buffer_pool_,
+                                                 table_meta_.buffer_pool());
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to open disk buffer pool for file:%s. rc=%d:%s",
+                overflow_file.c_str(), rc, strrc(rc));
+      return rc;
+    }
+    overflow_handler_ = new OverflowFileHandler();
+    overflow_handler_->init(overflow_buffer_pool_);
+  }
+
+  return rc;
+}
+
+bool Table::has_overflow_text() const {
+  for (const FieldMeta &field : *table_meta_.field_metas()) {
+    if (field.overflow_text()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+RC Table::write_text(Trx *trx, const char *text, char *field_data) {
+  const size_t len = strlen(text);
+  if (len > TEXT_MAX_LENGTH) {
+    LOG_WARN("Text is too long. table=%s, len=%lu, max len=%d", name(), len, TEXT_MAX_LENGTH);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  TextRef text_ref;
+  memset(&text_ref, 0, sizeof(text_ref));
+  text_ref.length = static_cast<uint16_t>(len);
+  text_ref.first_page = -1;
+  if (len <= TextRef::INLINE_SIZE) {
+    memcpy(text_ref.prefix, text, len);
+  } else {
+    memcpy(text_ref.prefix, text, TextRef::INLINE_SIZE);
+    RID rid;
+    RC rc = overflow_handler_->insert_data(text + TextRef::INLINE_SIZE, len - TextRef::INLINE_SIZE, &rid,
+        [this, trx](PageNum page_num, int offset, const char *data, int data_len) {
+          return log_overflow_page(trx, page_num, offset, data, data_len);
+        });
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("Failed to write text to overflow pages. table=%s, len=%lu, rc=%d:%s", name(), len, rc, strrc(rc));
+      return rc;
+    }
+    text_ref.first_page = rid.page_num;
+    text_ref.slot_num = static_cast<uint16_t>(rid.slot_num);
+  }
+  memcpy(field_data, &text_ref, sizeof(text_ref));
+  return RC::SUCCESS;
+}
+
+RC Table::log_overflow_page(Trx *trx, PageNum page_num, int offset, const char *data, int len) {
+  if (trx == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  // 一条日志记录不能超过CLOG_REDO_BUFFER_SIZE，一个页面的数据拆成多条日志
+  for (int chunk = 0; chunk < len; chunk += CLOG_OVERFLOW_CHUNK_SIZE) {
+    Record record;
+    record.set_rid(page_num, offset + chunk);
+    record.set_data(const_cast<char *>(data + chunk));
+
+    CLogRecord *clog_record = nullptr;
+    RC rc = clog_manager_->clog_gen_record(CLogType::REDO_OVERFLOW, trx->get_current_id(), clog_record, name(),
+        std::min(len - chunk, CLOG_OVERFLOW_CHUNK_SIZE), &record);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to create a clog record. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+    rc = clog_manager_->clog_append_record(clog_record);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC Table::read_text(const FieldMeta &field, const char *record, std::string &text) const {
+  TextRef text_ref;
+  memcpy(&text_ref, record + field.offset(), sizeof(text_ref));
+  if (!text_ref.overflow()) {
+    text.assign(text_ref.prefix, std::min<int>(text_ref.length, TextRef::INLINE_SIZE));
+    return RC::SUCCESS;
+  }
+
+  text.resize(text_ref.length);
+  memcpy(&text[0], text_ref.prefix, TextRef::INLINE_SIZE);
+  RC rc = overflow_handler_->get_data(
+      text_ref.overflow_rid(), &text[TextRef::INLINE_SIZE], text_ref.length - TextRef::INLINE_SIZE);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to read text from overflow pages. table=%s, field=%s, rc=%d:%s",
+             name(), field.name(), rc, strrc(rc));
+  }
   return rc;
 }
 
-RC Table::get_record_scanner(RecordFileScanner &scanner) {
-  RC rc = scanner.open_scan(*data_buffer_pool_, nullptr);
+void Table::delete_text(const char *field_data) {
+  TextRef text_ref;
+  memcpy(&text_ref, field_data, sizeof(text_ref));
+  if (text_ref.overflow()) {
+    RC rc = overflow_handler_->delete_data(text_ref.overflow_rid(), text_ref.length - TextRef::INLINE_SIZE);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("Failed to delete overflow pages. table=%s, first page=%d, rc=%d:%s",
+               name(), text_ref.first_page, rc, strrc(rc));
+    }
+  }
+}
+
+void Table::delete_texts(const char *record) {
+  for (const FieldMeta &field : *table_meta_.field_metas()) {
+    if (field.overflow_text()) {
+      delete_text(record + field.offset());
+    }
+  }
+}
+
+RC Table::delete_record_data(const RID &rid, const char *record) {
+  // 删除之后页面中的记录可能被覆盖，先保存下来用来释放溢出页面
+  std::string saved;
+  if (overflow_handler_ != nullptr) {
+    saved.assign(record, table_meta_.record_size());
+  }
+  RC rc = record_handler_->delete_record(&rid);
+  if (rc == RC::SUCCESS && overflow_handler_ != nullptr) {
+    delete_texts(saved.data());
+  }
+  return rc;
+}
+
+RC Table::recover_overflow_page(PageNum page_num, int offset, const char *data, int len) {
+  if (overflow_handler_ == nullptr) {
+    LOG_WARN("Table has no overflow file. table=%s", name());
+    return RC::SUCCESS;
+  }
+  return overflow_handler_->recover_page(page_num, offset, data, len);
+}
+
+RC Table::page_lsn(bool overflow, PageNum page_num, int64_t &lsn) {
+  DiskBufferPool *buffer_pool = overflow ? overflow_buffer_pool_ : data_buffer_pool_;
+  if (buffer_pool == nullptr) {
+    lsn = 0;
+    return RC::SUCCESS;
+  }
+  return buffer_pool->page_lsn(page_num, lsn);
+}
+
+RC Table::get_record_scanner(RecordFileScanner &scanner, bool readonly) {
+  RC rc = scanner.open_scan(*data_buffer_pool_, nullptr, readonly, record_handler_->layout());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to open scanner. rc=%d:%s", rc, strrc(rc));
   }
@@ -572,7 +1060,7 @@ RC Table::scan_record(Trx *trx, ConditionFilter *filter, int limit,
 
   RC rc = RC::SUCCESS;
   RecordFileScanner scanner;
-  rc = scanner.open_scan(*data_buffer_pool_, filter);
+  rc = scanner.open_scan(*data_buffer_pool_, filter, false, record_handler_->layout());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to open scanner. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -659,7 +1147,8 @@ static RC insert_index_record_reader_adapter(Record *record, void *context) {
   return inserter.insert_index(record);
 }
 
-RC Table::create_index(Trx *trx, const char *index_name, const std::vector<char *> attribute_name, const bool &is_unique)
+RC Table::create_index(Trx *trx, const char *index_name, const std::vector<char *> attribute_name, const bool &is_unique,
+                       const char *buffer_pool, int page_size)
 {
   if (common::is_blank(index_name) || attribute_name.empty()) {
     LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", name());
@@ -678,6 +1167,10 @@ RC Table::create_index(Trx *trx, const char *index_name, const std::vector<char
       field_meta.clear();
       break;
     }
+    if (fm->overflow_text()) {
+      LOG_WARN("Cannot create index on text field. table=%s, field=%s", name(), attr_name);
+      return RC::SCHEMA_FIELD_TYPE_MISMATCH;
+    }
     field_meta.push_back(*fm);
   }
   // const FieldMeta *field_meta = table_meta_.field(attribute_name);
@@ -694,11 +1187,13 @@ RC Table::create_index(Trx *trx, const char *index_name, const std::vector<char
         name(), index_name, attribute_name);
     return rc;
   }
+  new_index_meta.set_buffer_pool(common::is_blank(buffer_pool) ? table_meta_.buffer_pool() : buffer_pool);
 
   // 创建索引相关数据
   BplusTreeIndex *index = new BplusTreeIndex();
   std::string index_file = table_index_file(base_dir_.c_str(), name(), index_name);
-  rc = index->create(index_file.c_str(), new_index_meta, field_meta);
+  rc = index->create(
+      index_file.c_str(), new_index_meta, field_meta, page_size > 0 ? page_size : data_buffer_pool_->page_size());
   if (rc != RC::SUCCESS) {
     delete index;
     LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s",
@@ -775,15 +1270,22 @@ RC Table::update_record(Trx *trx, const Value *value, int value_index,
     LOG_ERROR("Invalid value. value: %s", value);
     return RC::INVALID_ARGUMENT;
   }
-  char *record_data;
-  ;
-  record_data = record->data();
+  // 扫描出来的记录可能直接指向缓冲池中的页面，在副本上修改，写回页面时再加页面的写锁
+  char *page_record_data = record->data();
+  std::vector<char> record_buf(page_record_data, page_record_data + table_meta_.record_size());
+  char *record_data = record_buf.data();
+  // 更新TEXT字段时先写入新的溢出页面，更新成功之后再释放原来的
+  const FieldMeta *field = table_meta_.field(value_index + table_meta_.sys_field_num());
+  char old_text[TEXT_FIELD_LENGTH];
+  if (field->overflow_text()) {
+    memcpy(old_text, record_data + field->offset(), sizeof(old_text));
+  }
   // int value_num=1;
   // 只更新一个字段的 别的字段全部复制即可
   // 创建record value->record_data
   // 这里对两个及以上的字段存在问题
   // RC rc = make_record(value_num, value, record_data);
-  RC rc = change_record(value_index, value, record_data);
+  RC rc = change_record(trx, value_index, value, record_data);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create a record. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -792,6 +1294,14 @@ RC Table::update_record(Trx *trx, const Value *value, int value_index,
   record->set_data(record_data);
   // 这部分需要调用底层接口重新实现下
   rc = update_record(trx, record);
+  record->set_data(page_record_data);
+  if (field->overflow_text()) {
+    if (rc == RC::SUCCESS) {
+      delete_text(old_text);
+    } else {
+      delete_text(record_data + field->offset());
+    }
+  }
   //
   // delete[] record_data;
   return rc;
@@ -859,7 +1369,7 @@ RC Table::delete_record(Trx *trx, Record *record) {
     return rc;
   }
 
-  rc = record_handler_->delete_record(&record->rid());
+  rc = delete_record_data(record->rid(), record->data());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to delete record (rid=%d.%d). rc=%d:%s",
               record->rid().page_num, record->rid().slot_num, rc, strrc(rc));
@@ -888,7 +1398,15 @@ RC Table::delete_record(Trx *trx, Record *record) {
 
 RC Table::recover_delete_record(Record *record) {
   RC rc = RC::SUCCESS;
-  rc = record_handler_->delete_record(&record->rid());
+  Record old_record;
+  rc = record_handler_->get_record(&record->rid(), &old_record);
+  if (rc == RC::SUCCESS) {
+    rc = delete_record_data(record->rid(), old_record.data());
+  }
+  if (rc == RC::RECORD_RECORD_NOT_EXIST) {
+    // 删除之后的页面已经刷盘了
+    rc = RC::SUCCESS;
+  }
 
   return rc;
 }
@@ -906,7 +1424,7 @@ RC Table::commit_delete(Trx *trx, const RID &rid) {
               rid.page_num, rid.slot_num, rc, strrc(rc));  // panic?
   }
 
-  rc = record_handler_->delete_record(&rid);
+  rc = delete_record_data(rid, record.data());
   if (rc != RC::SUCCESS) {
     return rc;
   }
@@ -915,14 +1433,8 @@ RC Table::commit_delete(Trx *trx, const RID &rid) {
 }
 
 RC Table::rollback_delete(Trx *trx, const RID &rid) {
-  RC rc = RC::SUCCESS;
-  Record record;
-  rc = record_handler_->get_record(&rid, &record);
-  if (rc != RC::SUCCESS) {
-    return rc;
-  }
-
-  return trx->rollback_delete(this, record);  // update record in place
+  return record_handler_->update_record_in_place(
+      &rid, [this, trx](Record &record) { return trx->rollback_delete(this, record); });
 }
 
 RC Table::insert_entry_of_indexes(const char *record, const RID &rid) {
@@ -936,6 +1448,28 @@ RC Table::insert_entry_of_indexes(const char *record, const RID &rid) {
   return rc;
 }
 
+RC Table::insert_entries_of_indexes(const char *records, int record_num, const RID *rids) {
+  const int record_size = table_meta_.record_size();
+  RC rc = RC::SUCCESS;
+  size_t done = 0;
+  for (; done < indexes_.size(); done++) {
+    rc = indexes_[done]->insert_entries(records, record_num, record_size, rids);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+  }
+
+  // 失败的索引自己会回滚，前面已经插入成功的索引需要删除
+  if (rc != RC::SUCCESS) {
+    for (size_t i = 0; i < done; i++) {
+      for (int j = 0; j < record_num; j++) {
+        indexes_[i]->delete_entry(records + static_cast<size_t>(j) * record_size, &rids[j]);
+      }
+    }
+  }
+  return rc;
+}
+
 RC Table::delete_entry_of_indexes(const char *record, const RID &rid,
                                   bool error_on_not_exists) {
   RC rc = RC::SUCCESS;
@@ -1075,6 +1609,24 @@ IndexScanner *Table::find_index_for_scan(const ConditionFilter *filter) {
   return nullptr;
 }
 
+RC Table::sync_data() {
+  // 先把日志刷盘，数据页面中可能还有其它事务修改过、日志还没有落盘的记录
+  RC rc = RC::SUCCESS;
+  if (clog_manager_ != nullptr) {
+    rc = clog_manager_->clog_sync();
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to sync clog. table=%s, rc=%d:%s", name(), rc, strrc(rc));
+      return rc;
+    }
+  }
+  rc = data_buffer_pool_->flush_all_pages();
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush data pages. table=%s, rc=%d:%s", name(), rc, strrc(rc));
+    return rc;
+  }
+  return sync();
+}
+
 RC Table::sync() {
   RC rc = RC::SUCCESS;
   for (Index *index : indexes_) {
@@ -14,12 +14,14 @@ See the Mulan PSL v2 for more details. */
 #ifndef __OBSERVER_STORAGE_COMMON_TABLE_H__
 #define __OBSERVER_STORAGE_COMMON_TABLE_H__
 
+#include "defs.h"
 #include "storage/common/table_meta.h"
 
 struct RID;
 class Record;
 class DiskBufferPool;
 class RecordFileHandler;
+class OverflowFileHandler;
 class RecordFileScanner;
 class ConditionFilter;
 class DefaultConditionFilter;
@@ -43,10 +45,14 @@ class Table {
    * @param attribute_count 字段个数
    * @param attributes 字段
    * @param clog_manager clog管理器，用于维护redo log
+   * @param buffer_pool 表使用的缓冲池，记录在元数据中，空表示默认的缓冲池
+   * @param page_size 数据文件的页面大小，记录在文件头中，0表示默认的BP_PAGE_SIZE
+   * @param record_format 记录在数据页面中的存放格式，记录在元数据中
    */
   RC create(const char *path, const char *name, const char *base_dir,
             int attribute_count, const AttrInfo attributes[],
-            CLogManager *clog_manager);
+            CLogManager *clog_manager, const char *buffer_pool = nullptr, int page_size = 0,
+            RecordFormat record_format = RecordFormat::FIXED);
 
   RC destory(const char *base_dir);
 
@@ -60,6 +66,23 @@ class Table {
           CLogManager *clog_manager);
 
   RC insert_record(Trx *trx, int value_num, const Value *values);
+  /**
+   * 批量插入row_num行，values中每行value_num个值。
+   * 记录按页面成批写入，同一个页面上的记录合并成一条REDO_INSERT_BATCH日志，索引项排序后再插入。
+   * 任何一行失败时整批都不会插入
+   */
+  RC insert_records(Trx *trx, int value_num, const Value *values, int row_num);
+  /**
+   * 导入数据使用。record_num条已经是记录格式的数据连续放在records中，整页追加到新分配的页面中，
+   * 不记录日志，也不加入事务，导入结束之后调用sync刷盘。
+   * @param with_indexes 是否同时插入索引项。空表导入时不插入，最后调用build_indexes一次性构建
+   */
+  RC append_records(const char *records, int record_num, bool with_indexes);
+  /**
+   * 遍历所有记录，为每个索引一次性插入索引项。空索引会自底向上构建。
+   * 只在导入空表之后使用，失败时删除所有记录，表恢复成空表
+   */
+  RC build_indexes();
   RC update_record(Trx *trx, const char *attribute_name, const Value *value,
                    int condition_num, const Condition conditions[],
                    int *updated_count);
@@ -71,12 +94,33 @@ class Table {
   RC delete_record(Trx *trx, Record *record);
   RC recover_delete_record(Record *record);
 
+  /**
+   * 读取记录中一个TEXT字段的完整内容，溢出的部分从溢出页面中读取
+   */
+  RC read_text(const FieldMeta &field, const char *record, std::string &text) const;
+  /**
+   * 重做REDO_OVERFLOW日志，把一段数据写回溢出页面
+   */
+  RC recover_overflow_page(PageNum page_num, int offset, const char *data, int len);
+  /**
+   * 回放日志时使用，读取数据页面或者溢出页面的LSN，LSN比它小的日志不需要重做
+   */
+  RC page_lsn(bool overflow, PageNum page_num, int64_t &lsn);
+
   RC scan_record(Trx *trx, ConditionFilter *filter, int limit, void *context,
                  void (*record_reader)(const char *data, void *context));
 
-  RC create_index(Trx *trx, const char *index_name, const std::vector<char *> attribute_name, const bool &is_unique);
+  /**
+   * @param buffer_pool 索引使用的缓冲池，空表示和表使用同一个缓冲池
+   * @param page_size 索引文件的页面大小，0表示和表的数据文件相同
+   */
+  RC create_index(Trx *trx, const char *index_name, const std::vector<char *> attribute_name, const bool &is_unique,
+                  const char *buffer_pool = nullptr, int page_size = 0);
 
-  RC get_record_scanner(RecordFileScanner &scanner);
+  /**
+   * @param readonly 扫描出来的记录不会被修改，可以直接访问文件映射中的页面(MmapScan)
+   */
+  RC get_record_scanner(RecordFileScanner &scanner, bool readonly = false);
 
   RecordFileHandler *record_handler() const { return record_handler_; }
 
@@ -86,6 +130,10 @@ class Table {
   const TableMeta &table_meta() const;
 
   RC sync();
+  /**
+   * 数据页面和索引都刷盘。导入的数据没有记录日志，导入之后使用
+   */
+  RC sync_data();
 
  public:
   RC commit_insert(Trx *trx, const RID &rid);
@@ -105,19 +153,39 @@ class Table {
 
  public:
   RC recover_insert_record(Record *record);
+  /**
+   * 重做REDO_INSERT_BATCH日志，data中是record_num个槽位号，后面跟着record_num条记录
+   */
+  RC recover_insert_records(PageNum page_num, int record_num, const char *data, int len);
 
  private:
   friend class RecordUpdater;
   friend class RecordDeleter;
 
   RC insert_entry_of_indexes(const char *record, const RID &rid);
+  RC insert_entries_of_indexes(const char *records, int record_num, const RID *rids);
   RC delete_entry_of_indexes(const char *record, const RID &rid,
                              bool error_on_not_exists);
 
  private:
   RC init_record_handler(const char *base_dir);
-  RC make_record(int value_num, const Value *values, char *&record_out);
-  RC change_record(int value_index, const Value *value, char *&record_out);
+  RC make_record(Trx *trx, int value_num, const Value *values, char *&record_out);
+  /**
+   * 检查类型并把values写入调用者提供的record中，record的大小是record_size
+   */
+  RC fill_record(Trx *trx, int value_num, const Value *values, char *record);
+  RC change_record(Trx *trx, int value_index, const Value *value, char *&record_out);
+
+  bool has_overflow_text() const;
+  RC write_text(Trx *trx, const char *text, char *field_data);
+  RC log_overflow_page(Trx *trx, PageNum page_num, int offset, const char *data, int len);
+  RC log_insert_records(Trx *trx, const char *records, int record_num, const RID *rids);
+  void delete_texts(const char *record);
+  void delete_text(const char *field_data);
+  /**
+   * 删除数据文件中的记录，同时释放记录中TEXT字段的溢出页面
+   */
+  RC delete_record_data(const RID &rid, const char *record);
 
  public:
   Index *find_index(const char *index_name) const;
@@ -132,9 +200,11 @@ class Table {
   std::string base_dir_;
   CLogManager *clog_manager_;
   TableMeta table_meta_;
-//   FILE* overflow_file_ =nullptr; /// 溢出数据文件
   DiskBufferPool *data_buffer_pool_ = nullptr;  /// 数据文件关联的buffer pool
   RecordFileHandler *record_handler_ = nullptr;  /// 记录操作
+  DiskBufferPool *overflow_buffer_pool_ = nullptr;  /// 溢出文件关联的buffer pool，没有TEXT字段时为空
+  OverflowFileHandler *overflow_handler_ = nullptr;  /// 溢出页面操作
+  DiskBufferPool *fsm_buffer_pool_ = nullptr;  /// 空闲空间表文件关联的buffer pool
   std::vector<Index *> indexes_;
 };
 
@@ -23,11 +23,18 @@ See the Mulan PSL v2 for more details. */
 static const Json::StaticString FIELD_TABLE_NAME("table_name");
 static const Json::StaticString FIELD_FIELDS("fields");
 static const Json::StaticString FIELD_INDEXES("indexes");
+static const Json::StaticString FIELD_BUFFER_POOL("buffer_pool");
+static const Json::StaticString FIELD_RECORD_FORMAT("record_format");
 
 std::vector<FieldMeta> TableMeta::sys_fields_;
 
 TableMeta::TableMeta(const TableMeta &other)
-    : name_(other.name_), fields_(other.fields_), indexes_(other.indexes_), record_size_(other.record_size_)
+    : name_(other.name_),
+      fields_(other.fields_),
+      indexes_(other.indexes_),
+      buffer_pool_(other.buffer_pool_),
+      record_format_(other.record_format_),
+      record_size_(other.record_size_)
 {}
 
 void TableMeta::swap(TableMeta &other) noexcept
@@ -35,6 +42,8 @@ void TableMeta::swap(TableMeta &other) noexcept
   name_.swap(other.name_);
   fields_.swap(other.fields_);
   indexes_.swap(other.indexes_);
+  buffer_pool_.swap(other.buffer_pool_);
+  std::swap(record_format_, other.record_format_);
   std::swap(record_size_, other.record_size_);
 }
 
@@ -209,6 +218,12 @@ int TableMeta::serialize(std::ostream &ss) const
     indexes_value.append(std::move(index_value));
   }
   table_value[FIELD_INDEXES] = std::move(indexes_value);
+  if (!buffer_pool_.empty()) {
+    table_value[FIELD_BUFFER_POOL] = buffer_pool_;
+  }
+  if (record_format_ != RecordFormat::FIXED) {
+    table_value[FIELD_RECORD_FORMAT] = record_format_name(record_format_);
+  }
 
   Json::StreamWriterBuilder builder;
   Json::StreamWriter *writer = builder.newStreamWriter();
@@ -268,6 +283,24 @@ int TableMeta::deserialize(std::istream &is)
   std::sort(
       fields.begin(), fields.end(), [](const FieldMeta &f1, const FieldMeta &f2) { return f1.offset() < f2.offset(); });
 
+  // 老版本的元数据中没有缓冲池，使用默认的缓冲池
+  const Json::Value &buffer_pool_value = table_value[FIELD_BUFFER_POOL];
+  if (!buffer_pool_value.isNull() && !buffer_pool_value.isString()) {
+    LOG_ERROR("Invalid buffer pool. json value=%s", buffer_pool_value.toStyledString().c_str());
+    return -1;
+  }
+  buffer_pool_ = buffer_pool_value.isString() ? buffer_pool_value.asString() : "";
+
+  const Json::Value &record_format_value = table_value[FIELD_RECORD_FORMAT];
+  RecordFormat record_format = RecordFormat::FIXED;
+  if (!record_format_value.isNull() &&
+      (!record_format_value.isString() ||
+          !record_format_from_name(record_format_value.asCString(), record_format))) {
+    LOG_ERROR("Invalid record format. json value=%s", record_format_value.toStyledString().c_str());
+    return -1;
+  }
+  record_format_ = record_format;
+
   name_.swap(table_name);
   fields_.swap(fields);
   record_size_ = fields_.back().offset() + fields_.back().len() - fields_.begin()->offset();
@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include "rc.h"
 #include "storage/common/field_meta.h"
 #include "storage/common/index_meta.h"
+#include "storage/record/record.h"
 #include "common/lang/serializable.h"
 
 class TableMeta : public common::Serializable {
@@ -36,6 +37,18 @@ public:
 
   RC add_index(const IndexMeta &index);
 
+  /**
+   * 表的数据页面缓存在哪个缓冲池中，空表示默认的缓冲池
+   */
+  void set_buffer_pool(const char *buffer_pool) { buffer_pool_ = buffer_pool == nullptr ? "" : buffer_pool; }
+  const char *buffer_pool() const { return buffer_pool_.c_str(); }
+
+  /**
+   * 表记录在数据页面中的存放格式，老版本的元数据中没有这一项，都是定长格式
+   */
+  void set_record_format(RecordFormat record_format) { record_format_ = record_format; }
+  RecordFormat record_format() const { return record_format_; }
+
 public:
   const char *name() const;
   const FieldMeta *trx_field() const;
@@ -67,6 +80,8 @@ protected:
   std::string name_;
   std::vector<FieldMeta> fields_;  // 包含sys_fields
   std::vector<IndexMeta> indexes_;
+  std::string buffer_pool_;
+  RecordFormat record_format_ = RecordFormat::FIXED;
 
   int record_size_ = 0;
 
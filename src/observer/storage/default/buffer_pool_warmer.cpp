@@ -0,0 +1,340 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/11.
+//
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+#include "storage/default/buffer_pool_warmer.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "common/log/log.h"
+#include "common/metrics/metrics.h"
+#include "common/metrics/metrics_registry.h"
+
+using namespace common;
+
+static const std::string WARM_UP_METRIC_TAG = "BufferPool.warmup";
+static const char *WARM_UP_FILE_HEADER = "# miniob buffer pool warm up list: <page num> <file name>, hottest first";
+
+/**
+ * 判断是否达到稳定状态的采样周期
+ */
+static const int STEADY_STATE_INTERVAL_MS = 1000;
+
+class WarmUpGauge : public Gauge
+{
+public:
+  WarmUpGauge(const BufferPoolWarmer &warmer) : warmer_(warmer)
+  {
+    set_snapshot(new SnapshotBasic<std::string>());
+  }
+
+  virtual ~WarmUpGauge()
+  {
+    delete snapshot_value_;
+  }
+
+  void snapshot() override
+  {
+    const long total = warmer_.total_pages();
+    const long loaded = warmer_.loaded_pages();
+    const long skipped = warmer_.skipped_pages();
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "state=%s, total=%ld, loaded=%ld, skipped=%ld, progress=%.1lf%%, warm_up_ms=%ld, steady_state_ms=%ld",
+             warmer_.loaded() ? "done" : "loading", total, loaded, skipped,
+             total > 0 ? (loaded + skipped) * 100.0 / total : 100.0, warmer_.warm_up_ms(), warmer_.steady_state_ms());
+    std::string value(buf);
+    static_cast<SnapshotBasic<std::string> *>(snapshot_value_)->setValue(value);
+  }
+
+private:
+  const BufferPoolWarmer &warmer_;
+};
+
+BufferPoolWarmer::BufferPoolWarmer(BufferPoolManager &bp_manager, const Options &options)
+    : bp_manager_(bp_manager), options_(options)
+{
+  options_.batch_pages = std::max(options_.batch_pages, 1);
+}
+
+BufferPoolWarmer::~BufferPoolWarmer()
+{
+  stop();
+}
+
+/**
+ * 所有缓冲池的页面个数和空闲页面个数
+ */
+static void count_pool_frames(BufferPoolManager &bp_manager, size_t &total_num, size_t &free_num)
+{
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  bp_manager.all_pools(pools);
+  total_num = 0;
+  free_num = 0;
+  for (auto &pool : pools) {
+    total_num += pool.second->total_frame_num();
+    free_num += pool.second->free_frame_num();
+  }
+}
+
+RC BufferPoolWarmer::dump(const char *file_name)
+{
+  // 每个缓冲池中的页面按照各自的热度排列，依次写到同一个文件中
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  bp_manager_.all_pools(pools);
+  std::vector<BPFrameId> page_ids;
+  for (auto &pool : pools) {
+    pool.second->list_hot_pages(pool.second->total_frame_num(), page_ids);
+  }
+
+  std::unordered_map<int, std::string> file_names;
+  bp_manager_.opened_files(file_names);
+
+  std::string tmp_file_name = std::string(file_name) + ".tmp";
+  FILE *file = fopen(tmp_file_name.c_str(), "w");
+  if (file == nullptr) {
+    LOG_ERROR("Failed to open %s to dump buffer pool pages, due to %s", tmp_file_name.c_str(), strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  int page_num = 0;
+  fprintf(file, "%s\n", WARM_UP_FILE_HEADER);
+  for (const BPFrameId &page_id : page_ids) {
+    auto iter = file_names.find(page_id.file_desc());
+    if (iter == file_names.end()) {
+      continue;  // 文件已经关闭了
+    }
+    fprintf(file, "%d %s\n", page_id.page_num(), iter->second.c_str());
+    page_num++;
+  }
+
+  if (ferror(file) || fflush(file) != 0 || fsync(fileno(file)) != 0) {
+    LOG_ERROR("Failed to write %s, due to %s", tmp_file_name.c_str(), strerror(errno));
+    fclose(file);
+    ::remove(tmp_file_name.c_str());
+    return RC::IOERR_WRITE;
+  }
+  fclose(file);
+
+  if (::rename(tmp_file_name.c_str(), file_name) != 0) {
+    LOG_ERROR("Failed to rename %s to %s, due to %s", tmp_file_name.c_str(), file_name, strerror(errno));
+    ::remove(tmp_file_name.c_str());
+    return RC::IOERR_WRITE;
+  }
+  LOG_INFO("Dump %d buffer pool pages to %s", page_num, file_name);
+  return RC::SUCCESS;
+}
+
+RC BufferPoolWarmer::load_list(const char *file_name, std::vector<Entry> &entries)
+{
+  std::ifstream ifs(file_name);
+  if (!ifs.is_open()) {
+    return RC::FILE_NOT_EXIST;
+  }
+
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    // 文件名中可能有空格，页号在前面
+    const size_t pos = line.find(' ');
+    if (pos == std::string::npos || pos + 1 == line.size()) {
+      LOG_WARN("Invalid line in buffer pool warm up file %s: %s", file_name, line.c_str());
+      continue;
+    }
+    char *end = nullptr;
+    const long page_num = strtol(line.c_str(), &end, 10);
+    if (end != line.c_str() + pos || page_num < 0) {
+      LOG_WARN("Invalid line in buffer pool warm up file %s: %s", file_name, line.c_str());
+      continue;
+    }
+    entries.push_back(Entry{line.substr(pos + 1), static_cast<PageNum>(page_num)});
+  }
+  return RC::SUCCESS;
+}
+
+RC BufferPoolWarmer::start(const char *file_name)
+{
+  std::vector<Entry> entries;
+  RC rc = load_list(file_name, entries);
+  if (rc != RC::SUCCESS) {
+    LOG_INFO("No buffer pool warm up file %s, start cold", file_name);
+  }
+
+  // 缓冲池变小了，只加载最热的那些页面
+  size_t capacity = 0;
+  size_t free_num = 0;
+  count_pool_frames(bp_manager_, capacity, free_num);
+  if (entries.size() > capacity) {
+    entries.resize(capacity);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock_guard(lock_);
+    if (!stopped_) {
+      LOG_WARN("buffer pool warmer has already been started");
+      return RC::SUCCESS;
+    }
+    stopped_ = false;
+  }
+
+  start_time_ = std::chrono::steady_clock::now();
+  total_pages_.store(static_cast<long>(entries.size()));
+  loaded_pages_.store(0);
+  skipped_pages_.store(0);
+  load_done_.store(false);
+  warm_up_ms_.store(-1);
+  steady_state_ms_.store(-1);
+
+  gauge_ = new WarmUpGauge(*this);
+  get_metrics_registry().register_metric(WARM_UP_METRIC_TAG, gauge_);
+
+  thread_ = std::thread(&BufferPoolWarmer::run, this, std::move(entries));
+  LOG_INFO("buffer pool warmer started. pages=%ld, file=%s", total_pages_.load(), file_name);
+  return RC::SUCCESS;
+}
+
+void BufferPoolWarmer::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock_guard(lock_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  cond_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  get_metrics_registry().unregister(WARM_UP_METRIC_TAG);
+  delete gauge_;
+  gauge_ = nullptr;
+  LOG_INFO("buffer pool warmer stopped");
+}
+
+bool BufferPoolWarmer::wait_loaded(int timeout_ms)
+{
+  std::unique_lock<std::mutex> lock(lock_);
+  return cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return load_done_.load(); });
+}
+
+long BufferPoolWarmer::elapsed_ms() const
+{
+  return static_cast<long>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time_).count());
+}
+
+bool BufferPoolWarmer::sleep_ms(int ms)
+{
+  std::unique_lock<std::mutex> lock(lock_);
+  return !cond_.wait_for(lock, std::chrono::milliseconds(ms), [this]() { return stopped_; });
+}
+
+void BufferPoolWarmer::run(std::vector<Entry> entries)
+{
+  load(entries);
+
+  warm_up_ms_.store(elapsed_ms());
+  {
+    std::lock_guard<std::mutex> lock_guard(lock_);
+    load_done_.store(true);
+  }
+  cond_.notify_all();
+  LOG_INFO("buffer pool warm up done. loaded=%ld, skipped=%ld, total=%ld, cost=%ldms",
+           loaded_pages_.load(), skipped_pages_.load(), total_pages_.load(), warm_up_ms_.load());
+
+  wait_steady_state();
+}
+
+void BufferPoolWarmer::load(std::vector<Entry> &entries)
+{
+  // 按照文件和页号排序，同一个文件中相邻的页面可以合并成一次读
+  std::sort(entries.begin(), entries.end(), [](const Entry &e1, const Entry &e2) {
+    return e1.file_name < e2.file_name || (e1.file_name == e2.file_name && e1.page_num < e2.page_num);
+  });
+
+  std::vector<PageNum> page_nums;
+  size_t begin = 0;
+  while (begin < entries.size()) {
+    {
+      std::lock_guard<std::mutex> lock_guard(lock_);
+      if (stopped_) {
+        return;
+      }
+    }
+
+    // 只使用空闲的frame，不和前台抢。每个文件所在的缓冲池满了之后，prefetch_pages不会再加载这个文件的页面
+    size_t total_num = 0;
+    size_t free_num = 0;
+    count_pool_frames(bp_manager_, total_num, free_num);
+    if (free_num == 0) {
+      LOG_INFO("buffer pool is full, stop warming up. loaded=%ld, total=%ld",
+               loaded_pages_.load(), total_pages_.load());
+      break;
+    }
+
+    const std::string &file_name = entries[begin].file_name;
+    const size_t batch_num = std::min(static_cast<size_t>(options_.batch_pages), free_num);
+    page_nums.clear();
+    size_t end = begin;
+    while (end < entries.size() && page_nums.size() < batch_num && entries[end].file_name == file_name) {
+      page_nums.push_back(entries[end].page_num);
+      end++;
+    }
+
+    int loaded_num = 0;
+    RC rc = bp_manager_.prefetch_pages(file_name.c_str(), page_nums.data(), static_cast<int>(page_nums.size()), loaded_num);
+    if (rc == RC::BUFFERPOOL_CLOSED) {
+      // 文件没有打开，跳过这个文件的所有页面
+      while (end < entries.size() && entries[end].file_name == file_name) {
+        end++;
+      }
+    }
+    loaded_pages_ += loaded_num;
+    skipped_pages_ += static_cast<long>(end - begin) - loaded_num;
+    begin = end;
+  }
+
+  skipped_pages_ += static_cast<long>(entries.size() - begin);
+}
+
+void BufferPoolWarmer::wait_steady_state()
+{
+  size_t total_num = 0;
+  size_t free_num = 0;
+  count_pool_frames(bp_manager_, total_num, free_num);
+  const long capacity = static_cast<long>(total_num);
+  const long max_misses = std::max(capacity / 100, 1L);
+  long last_misses = bp_manager_.page_misses();
+  while (sleep_ms(STEADY_STATE_INTERVAL_MS)) {
+    const long misses = bp_manager_.page_misses();
+    if (misses - last_misses <= max_misses) {
+      steady_state_ms_.store(elapsed_ms());
+      LOG_INFO("buffer pool reaches steady state after %ldms. misses in last interval=%ld",
+               steady_state_ms_.load(), misses - last_misses);
+      return;
+    }
+    last_misses = misses;
+  }
+}
@@ -0,0 +1,126 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/11.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rc.h"
+#include "defs.h"
+
+namespace common {
+class Gauge;
+}  // namespace common
+
+class BufferPoolManager;
+
+/**
+ * 缓冲池预热。
+ * 重启之后缓冲池是空的，B+树的内部节点这些热点页面都要一个一个地从磁盘读进来，要很久才能恢复到重启前的性能。
+ * 关闭时(以及定时地)把缓冲池中的页面(文件名和页号)按照从热到冷的顺序保存到一个文本文件中，
+ * 启动时在后台线程中把这些页面读回来：同一个文件的页面按照页号排序，每次批量读取一组，不需要等待预热完成就可以处理请求。
+ * 预热只使用空闲的frame，缓冲池满了就停止，不会淘汰前台已经加载的页面。
+ *
+ * 预热之后继续观察前台的缺页次数，连续一个采样周期内缺页的个数不超过缓冲池容量的1%时，认为达到了稳定状态。
+ * 进度和达到稳定状态的时间通过 BufferPool.warmup 指标输出。
+ */
+class BufferPoolWarmer
+{
+public:
+  struct Options {
+    bool enabled           = false;  //! 是否在关闭时保存、启动时加载页面列表
+    int  dump_interval_sec = 0;      //! 定时保存页面列表的间隔，0表示只在关闭时保存
+    int  batch_pages       = 64;     //! 每次批量读取的页面个数
+  };
+
+  struct Entry {
+    std::string file_name;
+    PageNum     page_num;
+  };
+
+public:
+  BufferPoolWarmer(BufferPoolManager &bp_manager, const Options &options);
+  ~BufferPoolWarmer();
+
+  const Options &options() const { return options_; }
+
+  /**
+   * 保存缓冲池中的页面列表。先写到临时文件再改名，中途宕机不会留下一个不完整的列表
+   */
+  RC dump(const char *file_name);
+
+  /**
+   * 启动后台线程加载页面列表中的页面。需要在打开数据文件之后调用，没有打开的文件中的页面会被跳过
+   */
+  RC start(const char *file_name);
+  void stop();
+
+  /**
+   * 读取页面列表，按照从热到冷的顺序
+   */
+  static RC load_list(const char *file_name, std::vector<Entry> &entries);
+
+  /**
+   * 等待加载完成，测试使用
+   * @return 超时返回false
+   */
+  bool wait_loaded(int timeout_ms);
+
+  long total_pages() const { return total_pages_.load(); }
+  long loaded_pages() const { return loaded_pages_.load(); }
+  long skipped_pages() const { return skipped_pages_.load(); }
+  bool loaded() const { return load_done_.load(); }
+
+  /**
+   * 从启动到预热完成的时间，还没有完成时返回-1
+   */
+  long warm_up_ms() const { return warm_up_ms_.load(); }
+
+  /**
+   * 从启动到达到稳定状态的时间，还没有达到时返回-1
+   */
+  long steady_state_ms() const { return steady_state_ms_.load(); }
+
+private:
+  void run(std::vector<Entry> entries);
+  void load(std::vector<Entry> &entries);
+  void wait_steady_state();
+  long elapsed_ms() const;
+  bool sleep_ms(int ms);
+
+private:
+  BufferPoolManager &bp_manager_;
+  Options            options_;
+
+  std::thread             thread_;
+  std::mutex              lock_;
+  std::condition_variable cond_;
+  bool                    stopped_ = true;
+
+  std::chrono::steady_clock::time_point start_time_;
+  std::atomic<long> total_pages_{0};
+  std::atomic<long> loaded_pages_{0};
+  std::atomic<long> skipped_pages_{0};
+  std::atomic<bool> load_done_{false};
+  std::atomic<long> warm_up_ms_{-1};
+  std::atomic<long> steady_state_ms_{-1};
+
+  common::Gauge *gauge_ = nullptr;
+};
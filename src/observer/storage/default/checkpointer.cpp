@@ -0,0 +1,115 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/24.
+//
+
+#include <time.h>
+#include <chrono>
+
+#include "storage/default/checkpointer.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "common/log/log.h"
+#include "common/metrics/metrics.h"
+#include "common/metrics/metrics_registry.h"
+
+using namespace common;
+
+static const std::string DURATION_METRIC_TAG = "BufferPool.checkpoint.duration_us";
+static const std::string FLUSHED_METRIC_TAG = "BufferPool.checkpoint.flushed";
+
+Checkpointer::Checkpointer(BufferPoolManager &bp_manager, const Options &options)
+    : bp_manager_(bp_manager), options_(options)
+{}
+
+Checkpointer::~Checkpointer()
+{
+  stop();
+}
+
+RC Checkpointer::start()
+{
+  if (options_.interval_sec <= 0) {
+    LOG_WARN("invalid checkpoint interval %d", options_.interval_sec);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  duration_timer_ = new SimpleTimer();
+  flushed_meter_ = new Meter();
+  MetricsRegistry &metrics_registry = get_metrics_registry();
+  metrics_registry.register_metric(DURATION_METRIC_TAG, duration_timer_);
+  metrics_registry.register_metric(FLUSHED_METRIC_TAG, flushed_meter_);
+
+  stopped_ = false;
+  thread_ = std::thread(&Checkpointer::run, this);
+  LOG_INFO("checkpointer started. interval=%ds", options_.interval_sec);
+  return RC::SUCCESS;
+}
+
+void Checkpointer::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock_guard(lock_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  thread_.join();
+
+  MetricsRegistry &metrics_registry = get_metrics_registry();
+  metrics_registry.unregister(DURATION_METRIC_TAG);
+  metrics_registry.unregister(FLUSHED_METRIC_TAG);
+  delete duration_timer_;
+  delete flushed_meter_;
+  duration_timer_ = nullptr;
+  flushed_meter_ = nullptr;
+  LOG_INFO("checkpointer stopped");
+}
+
+RC Checkpointer::checkpoint()
+{
+  struct timespec begin, end;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  int flushed_num = 0;
+  RC rc = bp_manager_.checkpoint(flushed_num);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  const long us = (end.tv_sec - begin.tv_sec) * 1000000L + (end.tv_nsec - begin.tv_nsec) / 1000;
+  if (duration_timer_ != nullptr) {
+    duration_timer_->update(us);
+  }
+  if (flushed_meter_ != nullptr && flushed_num > 0) {
+    flushed_meter_->inc(flushed_num);
+  }
+  LOG_INFO("checkpoint done. flushed=%d, duration=%ldus, rc=%s", flushed_num, us, strrc(rc));
+  return rc;
+}
+
+void Checkpointer::run()
+{
+  LOG_INFO("checkpointer thread started");
+
+  std::unique_lock<std::mutex> lock(lock_);
+  while (!stopped_) {
+    cond_.wait_for(lock, std::chrono::seconds(options_.interval_sec), [this]() { return stopped_; });
+    if (stopped_) {
+      break;
+    }
+
+    lock.unlock();
+    checkpoint();
+    lock.lock();
+  }
+
+  LOG_INFO("checkpointer thread stopped");
+}
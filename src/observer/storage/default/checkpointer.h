@@ -0,0 +1,69 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/24.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "rc.h"
+
+namespace common {
+class Meter;
+class SimpleTimer;
+}  // namespace common
+
+class BufferPoolManager;
+
+/**
+ * 后台检查点线程。
+ * 没有检查点时，启动时要回放整个日志文件，恢复时间随着日志的增长没有上限。
+ * 每隔interval_sec秒调用一次BufferPoolManager::checkpoint，把脏页表中最小的恢复LSN写到日志文件头中，
+ * 下次启动时从这里开始回放。检查点是模糊的，不需要停止写入，也不需要把所有脏页刷盘
+ */
+class Checkpointer
+{
+public:
+  struct Options {
+    int interval_sec = 60;  //! 两次检查点之间的间隔，0表示不做周期性的检查点
+  };
+
+public:
+  Checkpointer(BufferPoolManager &bp_manager, const Options &options);
+  ~Checkpointer();
+
+  RC start();
+  void stop();
+
+  /**
+   * 立即做一次检查点，记录耗时和刷盘的页面个数
+   */
+  RC checkpoint();
+
+private:
+  void run();
+
+private:
+  BufferPoolManager &     bp_manager_;
+  Options                 options_;
+
+  std::thread             thread_;
+  std::mutex              lock_;
+  std::condition_variable cond_;
+  bool                    stopped_ = true;
+
+  common::SimpleTimer *   duration_timer_ = nullptr;
+  common::Meter *         flushed_meter_  = nullptr;
+};
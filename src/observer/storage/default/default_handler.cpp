@@ -23,6 +23,10 @@ See the Mulan PSL v2 for more details. */
 #include "storage/index/bplus_tree.h"
 #include "storage/common/table.h"
 #include "storage/common/condition_filter.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/default/buffer_pool_warmer.h"
+
+static const char *WARM_UP_FILE_NAME = "bp_warmup";
 
 static DefaultHandler *default_handler = nullptr;
 
@@ -61,6 +65,14 @@ RC DefaultHandler::init(const char *base_dir)
   base_dir_ = base_dir;
   db_dir_ = tmp + "/";
 
+  // 打开数据库之前先用双写文件修复写坏的页面，之后才能回放日志
+  std::string double_write_file = std::string(base_dir) + "/dblwr";
+  RC rc = BufferPoolManager::instance().open_double_write(double_write_file.c_str());
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to open double write file %s. rc=%s", double_write_file.c_str(), strrc(rc));
+    return rc;
+  }
+
   LOG_INFO("Default handler init with %s success", base_dir);
   return RC::SUCCESS;
 }
@@ -69,12 +81,40 @@ void DefaultHandler::destroy()
 {
   sync();
 
+  // 关闭数据库之前保存缓冲池中的页面，关闭之后文件中的页面就被淘汰了
+  if (!opened_dbs_.empty()) {
+    BufferPoolManager::instance().warmer().stop();
+    dump_buffer_pool();
+  }
+
   for (const auto &iter : opened_dbs_) {
     delete iter.second;
   }
   opened_dbs_.clear();
 }
 
+RC DefaultHandler::start_warm_up()
+{
+  BufferPoolWarmer &warmer = BufferPoolManager::instance().warmer();
+  if (!warmer.options().enabled) {
+    return RC::SUCCESS;
+  }
+
+  std::string file_name = base_dir_ + "/" + WARM_UP_FILE_NAME;
+  return warmer.start(file_name.c_str());
+}
+
+RC DefaultHandler::dump_buffer_pool()
+{
+  BufferPoolWarmer &warmer = BufferPoolManager::instance().warmer();
+  if (!warmer.options().enabled) {
+    return RC::SUCCESS;
+  }
+
+  std::string file_name = base_dir_ + "/" + WARM_UP_FILE_NAME;
+  return warmer.dump(file_name.c_str());
+}
+
 RC DefaultHandler::create_db(const char *dbname)
 {
   if (nullptr == dbname || common::is_blank(dbname)) {
@@ -147,6 +147,16 @@ public:
 
   RC sync();
 
+  /**
+   * 开启了缓冲池预热(BufferPool.WarmUp)时，在后台加载上次保存的页面列表。在打开数据库之后调用
+   */
+  RC start_warm_up();
+
+  /**
+   * 开启了缓冲池预热时，保存缓冲池中的页面列表，下次启动时加载
+   */
+  RC dump_buffer_pool();
+
 public:
   static void set_default(DefaultHandler *handler);
   static DefaultHandler &get_default();
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <string.h>
 #include <string>
+#include <algorithm>
 
 #include "storage/default/default_storage_stage.h"
 
@@ -25,6 +26,9 @@ See the Mulan PSL v2 for more details. */
 #include "common/metrics/metrics_registry.h"
 #include "rc.h"
 #include "storage/default/default_handler.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/default/buffer_pool_warmer.h"
+#include "storage/common/bulk_loader.h"
 #include "storage/common/condition_filter.h"
 #include "storage/common/table.h"
 #include "storage/common/table_meta.h"
@@ -42,6 +46,12 @@ const char *CONF_SYSTEM_DB = "SystemDb";
 
 const char *DEFAULT_SYSTEM_DB = "sys";
 
+/**
+ * 定时保存缓冲池页面列表的事件，在TimerStage中等待，到时间之后回调到DefaultStorageStage
+ */
+class BufferPoolDumpEvent : public StageEvent {
+};
+
 //! Constructor
 DefaultStorageStage::DefaultStorageStage(const char *tag) : Stage(tag), handler_(nullptr)
 {}
@@ -109,6 +119,12 @@ bool DefaultStorageStage::set_properties()
   default_session.set_current_db(sys_db);
 
   LOG_INFO("Open system db success: %s", sys_db);
+
+  // 不等待预热完成，后台加载的同时就可以处理请求
+  ret = handler_->start_warm_up();
+  if (ret != RC::SUCCESS) {
+    LOG_WARN("Failed to start buffer pool warm up. rc=%s", strrc(ret));
+  }
   return true;
 }
 
@@ -121,6 +137,17 @@ bool DefaultStorageStage::initialize()
   query_metric_ = new SimpleTimer();
   metricsRegistry.register_metric(QUERY_METRIC_TAG, query_metric_);
 
+  const BufferPoolWarmer::Options &warmer_options = BufferPoolManager::instance().warmer().options();
+  if (warmer_options.enabled && warmer_options.dump_interval_sec > 0) {
+    if (next_stage_list_.empty()) {
+      LOG_WARN("No timer stage, buffer pool pages will be dumped only at shutdown");
+    } else {
+      timer_stage_ = next_stage_list_.front();
+      dump_interval_sec_ = warmer_options.dump_interval_sec;
+      add_event(new BufferPoolDumpEvent());
+    }
+  }
+
   LOG_TRACE("Exit");
   return true;
 }
@@ -140,6 +167,11 @@ void DefaultStorageStage::cleanup()
 void DefaultStorageStage::handle_event(StageEvent *event)
 {
   LOG_TRACE("Enter\n");
+  if (dynamic_cast<BufferPoolDumpEvent *>(event) != nullptr) {
+    register_dump_timer(event);
+    return;
+  }
+
   TimerStat timerStat(*query_metric_);
 
   SQLStageEvent *sql_event = static_cast<SQLStageEvent *>(event);
@@ -191,96 +223,30 @@ void DefaultStorageStage::handle_event(StageEvent *event)
   LOG_TRACE("Exit\n");
 }
 
-void DefaultStorageStage::callback_event(StageEvent *event, CallbackContext *context)
+void DefaultStorageStage::register_dump_timer(StageEvent *event)
 {
-  LOG_TRACE("Enter\n");
-  StorageEvent *storage_event = static_cast<StorageEvent *>(event);
-  storage_event->sql_event()->done_immediate();
-  LOG_TRACE("Exit\n");
-  return;
+  CompletionCallback *cb = new CompletionCallback(this, nullptr);
+  TimerRegisterEvent *tm_event = new TimerRegisterEvent(event, static_cast<u64_t>(dump_interval_sec_) * USEC_PER_SEC);
+  event->push_callback(cb);
+  timer_stage_->add_event(tm_event);
 }
 
-/**
- * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
- * @param table  要导入的表
- * @param file_values 从文件中读取到的一行数据，使用分隔符拆分后的几个字段值
- * @param record_values Table::insert_record使用的参数，为了防止频繁的申请内存
- * @param errmsg 如果出现错误，通过这个参数返回错误信息
- * @return 成功返回RC::SUCCESS
- */
-RC insert_record_from_file(
-    Table *table, std::vector<std::string> &file_values, std::vector<Value> &record_values, std::stringstream &errmsg)
+void DefaultStorageStage::callback_event(StageEvent *event, CallbackContext *context)
 {
-
-  const int field_num = record_values.size();
-  const int sys_field_num = table->table_meta().sys_field_num();
-
-  if (file_values.size() < record_values.size()) {
-    return RC::SCHEMA_FIELD_MISSING;
-  }
-
-  RC rc = RC::SUCCESS;
-
-  std::stringstream deserialize_stream;
-  for (int i = 0; i < field_num && RC::SUCCESS == rc; i++) {
-    const FieldMeta *field = table->table_meta().field(i + sys_field_num);
-
-    std::string &file_value = file_values[i];
-    if (field->type() != CHARS) {
-      common::strip(file_value);
-    }
-
-    switch (field->type()) {
-      case INTS: {
-        deserialize_stream.clear();  // 清理stream的状态，防止多次解析出现异常
-        deserialize_stream.str(file_value);
-
-        int int_value;
-        deserialize_stream >> int_value;
-        if (!deserialize_stream || !deserialize_stream.eof()) {
-          errmsg << "need an integer but got '" << file_values[i] << "' (field index:" << i << ")";
-
-          rc = RC::SCHEMA_FIELD_TYPE_MISMATCH;
-        } else {
-          value_init_integer(&record_values[i], int_value);
-        }
-      }
-
-      break;
-      case FLOATS: {
-        deserialize_stream.clear();
-        deserialize_stream.str(file_value);
-
-        float float_value;
-        deserialize_stream >> float_value;
-        if (!deserialize_stream || !deserialize_stream.eof()) {
-          errmsg << "need a float number but got '" << file_values[i] << "'(field index:" << i << ")";
-          rc = RC::SCHEMA_FIELD_TYPE_MISMATCH;
-        } else {
-          value_init_float(&record_values[i], float_value);
-        }
-      } break;
-      case CHARS: {
-
-        value_init_string(&record_values[i], file_value.c_str(),file_value.size());
-      } break;
-      default: {
-        errmsg << "Unsupported field type to loading: " << field->type();
-        rc = RC::SCHEMA_FIELD_TYPE_MISMATCH;
-      } break;
+  LOG_TRACE("Enter\n");
+  if (dynamic_cast<BufferPoolDumpEvent *>(event) != nullptr) {
+    if (handler_ != nullptr) {
+      handler_->dump_buffer_pool();
     }
+    // do it again.
+    add_event(event);
+    return;
   }
 
-  if (RC::SUCCESS == rc) {
-    rc = table->insert_record(nullptr, field_num, record_values.data());
-    if (rc != RC::SUCCESS) {
-      errmsg << "insert failed.";
-    }
-  }
-  for (int i = 0; i < field_num; i++) {
-    value_destroy(&record_values[i]);
-  }
-  return rc;
+  StorageEvent *storage_event = static_cast<StorageEvent *>(event);
+  storage_event->sql_event()->done_immediate();
+  LOG_TRACE("Exit\n");
+  return;
 }
 
 std::string DefaultStorageStage::load_data(const char *db_name, const char *table_name, const char *file_name)
@@ -293,51 +259,26 @@ std::string DefaultStorageStage::load_data(const char *db_name, const char *tabl
     return result_string.str();
   }
 
-  std::fstream fs;
-  fs.open(file_name, std::ios_base::in | std::ios_base::binary);
-  if (!fs.is_open()) {
-    result_string << "Failed to open file: " << file_name << ". system error=" << strerror(errno) << std::endl;
-    return result_string.str();
-  }
-
   struct timespec begin_time;
   clock_gettime(CLOCK_MONOTONIC, &begin_time);
-  const int sys_field_num = table->table_meta().sys_field_num();
-  const int field_num = table->table_meta().field_num() - sys_field_num;
-
-  std::vector<Value> record_values(field_num);
-  std::string line;
-  std::vector<std::string> file_values;
-  const std::string delim("|");
-  int line_num = 0;
-  int insertion_count = 0;
-  RC rc = RC::SUCCESS;
-  while (!fs.eof() && RC::SUCCESS == rc) {
-    std::getline(fs, line);
-    line_num++;
-    if (common::is_blank(line.c_str())) {
-      continue;
-    }
 
-    file_values.clear();
-    common::split_string(line, delim, file_values);
-    std::stringstream errmsg;
-    rc = insert_record_from_file(table, file_values, record_values, errmsg);
-    if (rc != RC::SUCCESS) {
-      result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
-                    << std::endl;
-    } else {
-      insertion_count++;
-    }
-  }
-  fs.close();
+  BulkLoader loader(table);
+  RC rc = loader.load(file_name);
 
   struct timespec end_time;
   clock_gettime(CLOCK_MONOTONIC, &end_time);
   long cost_nano = (end_time.tv_sec - begin_time.tv_sec) * 1000000000L + (end_time.tv_nsec - begin_time.tv_nsec);
   if (RC::SUCCESS == rc) {
-    result_string << strrc(rc) << ". total " << line_num << " line(s) handled and " << insertion_count
-                  << " record(s) loaded, total cost " << cost_nano / 1000000000.0 << " second(s)" << std::endl;
+    const double cost_second = std::max(cost_nano, 1L) / 1000000000.0;
+    result_string << strrc(rc) << ". total " << loader.line_num() << " line(s) handled and " << loader.row_num()
+                  << " record(s) loaded, total cost " << cost_nano / 1000000000.0 << " second(s), "
+                  << static_cast<long>(loader.row_num() / cost_second) << " rows/s, "
+                  << loader.byte_num() / cost_second / (1024 * 1024) << " MB/s" << std::endl;
+  } else if (loader.error_line() > 0) {
+    result_string << "Line:" << loader.error_line() << " insert record failed:" << loader.errmsg()
+                  << ". error:" << strrc(rc) << std::endl;
+  } else {
+    result_string << loader.errmsg() << ". error:" << strrc(rc) << std::endl;
   }
   return result_string.str();
 }
@@ -38,12 +38,19 @@ protected:
 private:
   std::string load_data(const char *db_name, const char *table_name, const char *file_name);
 
+  /**
+   * 通过TimerStage定时保存缓冲池的页面列表(预热使用)
+   */
+  void register_dump_timer(common::StageEvent *event);
+
 protected:
   common::SimpleTimer *query_metric_ = nullptr;
   static const std::string QUERY_METRIC_TAG;
 
 private:
   DefaultHandler *handler_;
+  common::Stage * timer_stage_ = nullptr;
+  int             dump_interval_sec_ = 0;
 };
 
 #endif  //__OBSERVER_STORAGE_DEFAULT_STORAGE_STAGE_H__
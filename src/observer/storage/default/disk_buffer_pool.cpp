@@ -13,121 +13,565 @@ See the Mulan PSL v2 for more details. */
 //
 #include "disk_buffer_pool.h"
 #include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
 
 #include "common/lang/mutex.h"
 #include "common/log/log.h"
 #include "common/os/os.h"
+#include "common/os/numa.h"
+#include "common/os/path.h"
 #include "common/io/io.h"
+#include "common/conf/ini.h"
+#include "common/lang/string.h"
+#include "common/math/crc32c.h"
+#include "common/metrics/metrics.h"
+#include "common/metrics/metrics_registry.h"
+#include "storage/default/double_write_buffer.h"
+#include "storage/default/page_io.h"
+#include "storage/default/page_cleaner.h"
+#include "storage/default/checkpointer.h"
+#include "storage/default/buffer_pool_warmer.h"
 
 using namespace common;
 
 static const PageNum BP_HEADER_PAGE = 0;
-static const int MEM_POOL_ITEM_NUM = 128;
+static const size_t DEFAULT_BUFFER_POOL_SIZE = 256UL << 20;
+static const size_t DEFAULT_PAGE_SIZE_POOL_SIZE = 32UL << 20;
+
+static const char *CONF_BUFFER_POOL_SECTION = "BufferPool";
+static const char *CONF_PARTITION_NUM = "PartitionNum";
+static const char *CONF_REPLACE_POLICY = "ReplacePolicy";
+static const char *CONF_SIZE = "Size";
+static const char *CONF_MAX_SIZE = "MaxSize";
+static const char *CONF_POPULATE = "Populate";
+static const char *CONF_HUGE_PAGE = "HugePage";
+static const char *CONF_CLEANER_THREAD_NUM = "CleanerThreadNum";
+static const char *CONF_CLEAN_RATIO = "CleanRatio";
+static const char *CONF_CLEANER_INTERVAL = "CleanerIntervalMs";
+static const char *CONF_IO_BACKEND = "IOBackend";
+static const char *CONF_READ_AHEAD_PAGES = "ReadAheadPages";
+static const char *CONF_CHECKSUM_VERIFY = "ChecksumVerify";
+static const char *CONF_DOUBLE_WRITE = "DoubleWrite";
+static const char *CONF_NUMA_AWARE = "NumaAware";
+static const char *CONF_WARM_UP = "WarmUp";
+static const char *CONF_WARM_UP_DUMP_INTERVAL = "WarmUpDumpIntervalSec";
+static const char *CONF_WARM_UP_BATCH_PAGES = "WarmUpBatchPages";
+static const char *CONF_POOLS = "Pools";
+static const char *CONF_DIRECT_IO = "DirectIO";
+static const char *CONF_MMAP_SCAN = "MmapScan";
+static const char *CONF_PAGE_SIZE_POOL_SIZE = "PageSizePoolSize";
+static const char *CONF_CHECKPOINT_INTERVAL = "CheckpointIntervalSec";
+
+static const std::string READ_AHEAD_METRIC_TAG = "BufferPool.readahead";
 
-unsigned long current_time()
+/**
+ * 连续调用BufferPoolIterator::next这么多次之后才开始预读，
+ * 只访问少数几个页面的遍历不需要预读
+ */
+static const int READ_AHEAD_TRIGGER_NUM = 4;
+
+uint32_t page_checksum(const Page &page, int page_size)
+{
+  const char *begin = reinterpret_cast<const char *>(&page);
+  const size_t skip = offsetof(Page, checksum) + sizeof(page.checksum);
+  uint32_t crc = crc32c(0, begin, offsetof(Page, checksum));
+  return crc32c(crc, begin + skip, page_size - skip);
+}
+
+void stamp_page(Page &page, int page_size)
+{
+  page.version = BP_PAGE_FORMAT_VERSION;
+  page.checksum = page_checksum(page, page_size);
+}
+
+bool verify_page_checksum(const Page &page, int page_size)
 {
-  struct timespec tp;
-  clock_gettime(CLOCK_MONOTONIC, &tp);
-  return tp.tv_sec * 1000 * 1000 * 1000UL + tp.tv_nsec;
+  if (page.version == BP_PAGE_FORMAT_VERSION && page.checksum == page_checksum(page, page_size)) {
+    return true;
+  }
+
+  const char *begin = reinterpret_cast<const char *>(&page);
+  return std::all_of(begin, begin + page_size, [](char c) { return c == 0; });
 }
 
-BPFrameManager::BPFrameManager(const char *name) : allocator_(name)
+namespace {
+/**
+ * 刷盘时使用的页面副本，每个线程一个，按需扩大。按照BP_DIRECT_IO_ALIGN对齐，可以直接用于O_DIRECT写
+ */
+class FlushBuffer
+{
+public:
+  ~FlushBuffer()
+  {
+    free(data_);
+  }
+
+  Page *pages(int page_size, int num)
+  {
+    const size_t size = static_cast<size_t>(page_size) * num;
+    if (size > size_) {
+      free(data_);
+      data_ = aligned_alloc(BP_DIRECT_IO_ALIGN, size);
+      if (data_ == nullptr) {
+        LOG_PANIC("Failed to alloc flush buffer. size=%lu", size);
+        abort();
+      }
+      size_ = size;
+    }
+    return static_cast<Page *>(data_);
+  }
+
+private:
+  void *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+thread_local FlushBuffer flush_buffer;
+}  // namespace
+
+constexpr const char *BPFrameManager::DEFAULT_REPLACE_POLICY;
+const uint64_t BPFrameId::INVALID;
+const unsigned int Frame::EVICTED;
+
+BPFrameManager::BPFrameManager(const char *tag) : tag_(tag)
 {}
 
-RC BPFrameManager::init(int pool_num)
+BPFrameManager::~BPFrameManager()
 {
-  int ret =  allocator_.init(false, pool_num);
-  if (ret == 0) {
-    return RC::SUCCESS;
+  for (int i = 0; i < partition_num_; i++) {
+    delete partitions_[i].replacer_;
+    partitions_[i].replacer_ = nullptr;
+  }
+}
+
+RC BPFrameManager::init(size_t frame_num, int partition_num /* = DEFAULT_PARTITION_NUM */,
+                        const char *replace_policy /* = DEFAULT_REPLACE_POLICY */,
+                        const FrameAllocator::Options &options /* = FrameAllocator::Options() */)
+{
+  if (partition_num <= 0) {
+    LOG_WARN("invalid partition num %d, use 1 instead", partition_num);
+    partition_num = 1;
+  }
+
+  std::unique_ptr<FrameReplacer> replacer_checker(FrameReplacer::create(replace_policy));
+  if (replacer_checker == nullptr) {
+    LOG_WARN("unknown replace policy %s, use %s instead", replace_policy, DEFAULT_REPLACE_POLICY);
+    replace_policy = DEFAULT_REPLACE_POLICY;
+  }
+
+  RC rc = allocator_.init(frame_num, options);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to init frame allocator of %s. frame num=%lu, rc=%s", tag_.c_str(), frame_num, strrc(rc));
+    return rc;
+  }
+
+  partition_num_ = partition_num;
+  partitions_.reset(new Partition[partition_num]);
+  for (int i = 0; i < partition_num; i++) {
+    partitions_[i].replacer_ = FrameReplacer::create(replace_policy);
+  }
+
+  // 按照最大的frame个数分配桶，扩容之后也不需要重新哈希，每个分区至少有一个桶
+  size_t bucket_num = 64;
+  while (bucket_num < allocator_.max_capacity() || bucket_num < static_cast<size_t>(partition_num)) {
+    bucket_num <<= 1;
+  }
+  buckets_.reset(new std::atomic<Frame *>[bucket_num]);
+  for (size_t i = 0; i < bucket_num; i++) {
+    buckets_[i].store(nullptr, std::memory_order_relaxed);
   }
-  return RC::GENERIC_ERROR;
+  bucket_mask_ = bucket_num - 1;
+
+  LOG_INFO("init frame manager %s done. frame num=%lu, partition num=%d, bucket num=%lu, replace policy=%s",
+           tag_.c_str(), allocator_.capacity(), partition_num, bucket_num, replace_policy);
+  return RC::SUCCESS;
 }
 
 RC BPFrameManager::cleanup()
 {
-  if (frames_.count() > 0) {
+  if (frame_num() > 0) {
     return RC::GENERIC_ERROR;
   }
-
-  frames_.destroy();
   return RC::SUCCESS;
 }
 
+size_t BPFrameManager::bucket_of(uint64_t key) const
+{
+  // 连续的页面分散到不同的桶和分区中，顺序扫描时不会集中在同一把锁上
+  return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & bucket_mask_;
+}
+
+template <typename Func>
+void BPFrameManager::for_each_frame(int partition_index, Func func) const
+{
+  for (size_t bucket = partition_index; bucket <= bucket_mask_; bucket += partition_num_) {
+    for (Frame *frame = buckets_[bucket].load(std::memory_order_relaxed); frame != nullptr;
+         frame = frame->hash_next_.load(std::memory_order_relaxed)) {
+      func(frame);
+    }
+  }
+}
+
+Frame *BPFrameManager::find(size_t bucket, uint64_t key, bool locked) const
+{
+  // 不加锁遍历时，链表可能正在被修改，走得太远就放弃
+  const size_t max_steps = locked ? std::numeric_limits<size_t>::max() : 64;
+  Frame *frame = buckets_[bucket].load(std::memory_order_acquire);
+  for (size_t i = 0; frame != nullptr && i < max_steps; i++) {
+    if (frame->frame_id_.load(std::memory_order_acquire) == key) {
+      return frame;
+    }
+    frame = frame->hash_next_.load(std::memory_order_acquire);
+  }
+  return nullptr;
+}
+
+void Frame::mark_dirty()
+{
+  // 先设置脏标记再记录恢复LSN。检查点在这中间看到的是上一次变脏时的LSN，只会更小，不影响正确性
+  if (!dirty_.exchange(true)) {
+    recovery_lsn_.store(BufferPoolManager::next_lsn(), std::memory_order_relaxed);
+  }
+}
+
 Frame *BPFrameManager::begin_purge()
 {
   Frame *frame_can_purge = nullptr;
-  auto purge_finder = [&frame_can_purge](const BPFrameId &frame_id, Frame * const frame) {
-    if (frame->can_purge()) {
-      frame_can_purge = frame;
-      return false; // false to break the progress
-    }
-    return true; // true continue to look up
-  };
-  frames_.foreach_reverse(purge_finder);
+
+  // 多个NUMA节点时，第一遍只淘汰当前节点上的页面，找不到再放宽
+  const int node = allocator_.node_num() > 1 ? common::numa_current_node() : -1;
+
+  // 每次从不同的分区开始查找，避免总是淘汰同一个分区中的页面
+  const unsigned int start = purge_cursor_.fetch_add(1);
+  for (int pass = (node >= 0 ? 0 : 1); pass < 2 && frame_can_purge == nullptr; pass++) {
+    for (int i = 0; i < partition_num_ && frame_can_purge == nullptr; i++) {
+      Partition &partition = partitions_[(start + i) % partition_num_];
+      std::lock_guard<std::mutex> lock_guard(partition.lock_);
+
+      // victim返回的frame可能马上被不加锁查找的线程pin住，这时候换一个
+      for (int retry = 0; retry < 8 && frame_can_purge == nullptr; retry++) {
+        Frame *frame = partition.replacer_->victim();
+        if (frame == nullptr) {
+          break;
+        }
+        if (pass == 0 && allocator_.node_of(frame) != node) {
+          continue;
+        }
+        unsigned int expected = 0;
+        if (frame->pin_count_.compare_exchange_strong(expected, 1)) {
+          frame_can_purge = frame;
+        }
+      }
+    }
+  }
   return frame_can_purge;
 }
 
 Frame *BPFrameManager::get(int file_desc, PageNum page_num)
 {
-  BPFrameId frame_id(file_desc, page_num);
+  const uint64_t key = BPFrameId(file_desc, page_num).key();
+  const size_t bucket = bucket_of(key);
+  Frame *frame = find(bucket, key, false);
+  if (frame != nullptr) {
+    return frame;
+  }
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  Frame *frame = nullptr;
-  (void)frames_.get(frame_id, frame);
+  Partition &partition = partition_of(bucket);
+  std::lock_guard<std::mutex> lock_guard(partition.lock_);
+  return find(bucket, key, true);
+}
+
+Frame *BPFrameManager::pin(int file_desc, PageNum page_num)
+{
+  const uint64_t key = BPFrameId(file_desc, page_num).key();
+  const size_t bucket = bucket_of(key);
+  Partition &partition = partition_of(bucket);
+
+  Frame *frame = find(bucket, key, false);
+  if (frame != nullptr) {
+    const unsigned int old_pin_count = frame->pin_count_.fetch_add(1);
+    if ((old_pin_count & Frame::EVICTED) != 0 || frame->frame_id_.load(std::memory_order_acquire) != key) {
+      // 在查找和pin之间，frame被淘汰了
+      frame->pin_count_.fetch_sub(1);
+      frame = nullptr;
+    } else if (partition.replacer_->concurrent_touch()) {
+      partition.replacer_->touch(frame);
+    } else {
+      std::lock_guard<std::mutex> lock_guard(partition.lock_);
+      partition.replacer_->touch(frame);
+    }
+  }
+
+  if (frame == nullptr) {
+    frame = pin_locked(bucket, key);
+    if (frame == nullptr) {
+      return nullptr;
+    }
+  }
+
+  // 页面还没有加载完成。加载失败时frame会被删除
+  for (int spins = 0; frame->loading_.load(std::memory_order_acquire); spins++) {
+    if (frame->frame_id_.load(std::memory_order_acquire) != key) {
+      frame->pin_count_.fetch_sub(1);
+      return pin(file_desc, page_num);
+    }
+    std::this_thread::yield();
+  }
+
+  if (numa_hit_stats_) {
+    if (allocator_.node_of(frame) == common::numa_current_node()) {
+      numa_stats_.local_hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      numa_stats_.remote_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  return frame;
+}
+
+Frame *BPFrameManager::pin_locked(size_t bucket, uint64_t key)
+{
+  Partition &partition = partition_of(bucket);
+  std::lock_guard<std::mutex> lock_guard(partition.lock_);
+  Frame *frame = find(bucket, key, true);
+  if (frame != nullptr) {
+    // 持有锁时frame不会被删除，不需要检查EVICTED
+    frame->pin_count_.fetch_add(1);
+    partition.replacer_->touch(frame);
+  }
   return frame;
 }
 
 Frame *BPFrameManager::alloc(int file_desc, PageNum page_num)
 {
-  BPFrameId frame_id(file_desc, page_num);
+  const uint64_t key = BPFrameId(file_desc, page_num).key();
+  const size_t bucket = bucket_of(key);
+  Partition &partition = partition_of(bucket);
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  Frame *frame = nullptr;
-  bool found = frames_.get(frame_id, frame);
-  if (found) {
-    // assert (frame != nullptr);
+  std::lock_guard<std::mutex> lock_guard(partition.lock_);
+  if (find(bucket, key, true) != nullptr) {
     return nullptr; // should use get
   }
 
-  frame = allocator_.alloc();
-  if (frame != nullptr) {
-    frames_.put(frame_id, frame);
+  // 新页面放在第一次访问它的线程所在的节点上
+  const int node = allocator_.node_num() > 1 ? common::numa_current_node() : -1;
+  Frame *frame = allocator_.alloc(node);
+  if (frame == nullptr) {
+    return nullptr;
   }
+  if (node >= 0) {
+    if (allocator_.node_of(frame) == node) {
+      numa_stats_.local_allocs.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      numa_stats_.remote_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  frame->dirty_ = false;
+  frame->prefetched_ = false;
+  frame->loading_.store(true, std::memory_order_relaxed);
+  frame->file_desc_ = file_desc;
+  frame->page_.page_num = page_num;
+  frame->replacer_hook() = FrameReplacerHook();
+
+  // 新分配的frame的pin count是0，复用的frame上有EVICTED标记，还可能有不加锁查找的线程留下的临时pin
+  frame->pin_count_.fetch_add(1);
+  frame->pin_count_.fetch_and(~Frame::EVICTED);
+  frame->frame_id_.store(key, std::memory_order_release);
+
+  frame->hash_next_.store(buckets_[bucket].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  buckets_[bucket].store(frame, std::memory_order_release);
+  partition.frame_num_++;
+  partition.replacer_->insert(frame);
   return frame;
 }
 
-RC BPFrameManager::free(int file_desc, PageNum page_num, Frame *frame)
+void BPFrameManager::finish_load(Frame *frame)
 {
-  BPFrameId frame_id(file_desc, page_num);
+  frame->loading_.store(false, std::memory_order_release);
+}
 
-  std::lock_guard<std::mutex> lock_guard(lock_);
-  Frame *frame_source = nullptr;
-  bool found = frames_.get(frame_id, frame_source);
-  if (!found || frame != frame_source) {
+RC BPFrameManager::free(int file_desc, PageNum page_num, Frame *frame)
+{
+  const uint64_t key = BPFrameId(file_desc, page_num).key();
+  const size_t bucket = bucket_of(key);
+  Partition &partition = partition_of(bucket);
+
+  std::lock_guard<std::mutex> lock_guard(partition.lock_);
+  std::atomic<Frame *> *link = &buckets_[bucket];
+  Frame *frame_source = link->load(std::memory_order_relaxed);
+  while (frame_source != nullptr && frame_source != frame) {
+    link = &frame_source->hash_next_;
+    frame_source = link->load(std::memory_order_relaxed);
+  }
+  if (frame_source == nullptr || frame->frame_id_.load(std::memory_order_relaxed) != key) {
     LOG_WARN("failed to find frame or got frame not match. file_desc=%d, PageNum=%d, frame_source=%p, frame=%p",
              file_desc, page_num, frame_source, frame);
     return RC::GENERIC_ERROR;
   }
 
-  frames_.remove(frame_id);
+  unsigned int expected = 1;
+  if (frame->loading_.load(std::memory_order_acquire)) {
+    // 加载失败的页面。等待加载的线程看到frame_id_变化之后会放弃，这里等它们都退出
+    frame->frame_id_.store(BPFrameId::INVALID, std::memory_order_release);
+    while (!frame->pin_count_.compare_exchange_weak(expected, Frame::EVICTED)) {
+      expected = 1;
+      std::this_thread::yield();
+    }
+  } else if (!frame->pin_count_.compare_exchange_strong(expected, Frame::EVICTED)) {
+    LOG_DEBUG("frame is pinned by others. file_desc=%d, PageNum=%d, pin_count=%u", file_desc, page_num, expected);
+    return RC::BUFFERPOOL_PAGE_PINNED;
+  } else if (frame->dirty_) {
+    // 刷盘之后又被修改了
+    frame->pin_count_.fetch_sub(Frame::EVICTED - 1);
+    return RC::BUFFERPOOL_PAGE_PINNED;
+  }
+
+  if (frame->prefetched_.exchange(false)) {
+    prefetch_stats_.wasted++;
+  }
+
+  // 保留frame自己的next指针，正在遍历这个frame的线程还可以继续往下走
+  frame->frame_id_.store(BPFrameId::INVALID, std::memory_order_release);
+  link->store(frame->hash_next_.load(std::memory_order_relaxed), std::memory_order_release);
+  partition.frame_num_--;
+  partition.replacer_->remove(frame);
   allocator_.free(frame);
   return RC::SUCCESS;
 }
 
 std::list<Frame *> BPFrameManager::find_list(int file_desc)
 {
-  std::lock_guard<std::mutex> lock_guard(lock_);
+  std::list<Frame *> frames;
+  for (int i = 0; i < partition_num_; i++) {
+    Partition &partition = partitions_[i];
+    std::lock_guard<std::mutex> lock_guard(partition.lock_);
+    for_each_frame(i, [&frames, file_desc](Frame *frame) {
+      if (file_desc == frame->file_desc()) {
+        frames.push_back(frame);
+      }
+    });
+  }
+  return frames;
+}
+
+RC BPFrameManager::resize(size_t frame_num)
+{
+  return allocator_.resize(frame_num);
+}
 
+std::list<Frame *> BPFrameManager::find_beyond_capacity_list()
+{
   std::list<Frame *> frames;
-  auto fetcher = [&frames, file_desc](const BPFrameId &frame_id, Frame * const frame) -> bool {
-    if (file_desc == frame_id.file_desc()) {
+  for (int i = 0; i < partition_num_; i++) {
+    Partition &partition = partitions_[i];
+    std::lock_guard<std::mutex> lock_guard(partition.lock_);
+    for_each_frame(i, [this, &frames](Frame *frame) {
+      if (allocator_.beyond_capacity(frame)) {
+        frames.push_back(frame);
+      }
+    });
+  }
+  return frames;
+}
+
+size_t BPFrameManager::frame_num() const
+{
+  size_t num = 0;
+  for (int i = 0; i < partition_num_; i++) {
+    const Partition &partition = partitions_[i];
+    std::lock_guard<std::mutex> lock_guard(partition.lock_);
+    num += partition.frame_num_;
+  }
+  return num;
+}
+
+void BPFrameManager::count_frames(int partition_index, size_t &frame_num, size_t &dirty_num) const
+{
+  const Partition &partition = partitions_[partition_index];
+  std::lock_guard<std::mutex> lock_guard(partition.lock_);
+  frame_num = partition.frame_num_;
+  dirty_num = 0;
+  for_each_frame(partition_index, [&dirty_num](Frame *frame) {
+    if (frame->dirty_) {
+      dirty_num++;
+    }
+  });
+}
+
+void BPFrameManager::list_hot_pages(size_t max_num, std::vector<BPFrameId> &page_ids) const
+{
+  std::vector<std::vector<BPFrameId>> partition_ids(partition_num_);
+  std::vector<Frame *> frames;
+  for (int i = 0; i < partition_num_; i++) {
+    const Partition &partition = partitions_[i];
+    std::lock_guard<std::mutex> lock_guard(partition.lock_);
+    frames.clear();
+    partition.replacer_->list_hot_frames(frames);
+    for (Frame *frame : frames) {
+      if (!frame->loading_.load(std::memory_order_acquire)) {
+        partition_ids[i].emplace_back(frame->file_desc_, frame->page_.page_num);
+      }
+    }
+  }
+
+  // 各个分区的页面数差不多，在分区内排第k的页面和在其它分区内排第k的页面一样热
+  for (size_t rank = 0; page_ids.size() < max_num; rank++) {
+    bool found = false;
+    for (int i = 0; i < partition_num_ && page_ids.size() < max_num; i++) {
+      if (rank < partition_ids[i].size()) {
+        page_ids.push_back(partition_ids[i][rank]);
+        found = true;
+      }
+    }
+    if (!found) {
+      break;
+    }
+  }
+}
+
+void BPFrameManager::pin_dirty_frames(int partition_index, size_t max_num, std::vector<Frame *> &frames,
+                                      int64_t max_recovery_lsn)
+{
+  Partition &partition = partitions_[partition_index];
+  std::lock_guard<std::mutex> lock_guard(partition.lock_);
+  for_each_frame(partition_index, [&frames, &max_num, max_recovery_lsn](Frame *frame) {
+    if (max_num == 0) {
+      return;
+    }
+    unsigned int expected = 0;
+    if (frame->dirty_ && !frame->loading_ && frame->recovery_lsn() < max_recovery_lsn &&
+        frame->pin_count_.compare_exchange_strong(expected, 1)) {
       frames.push_back(frame);
+      max_num--;
     }
-    return true;
-  };
-  frames_.foreach(fetcher);
-  return frames;
+  });
+}
+
+int64_t BPFrameManager::min_recovery_lsn(int partition_index, int64_t lsn, const std::function<bool(int)> &opened) const
+{
+  const Partition &partition = partitions_[partition_index];
+  std::lock_guard<std::mutex> lock_guard(partition.lock_);
+  for_each_frame(partition_index, [&lsn, &opened](Frame *frame) {
+    if (frame->dirty_ && !frame->loading_ && opened(frame->file_desc())) {
+      lsn = std::min(lsn, frame->recovery_lsn());
+    }
+  });
+  return lsn;
+}
+
+void BPFrameManager::unpin_frame(Frame *frame)
+{
+  frame->pin_count_.fetch_sub(1);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -137,25 +581,45 @@ BufferPoolIterator::~BufferPoolIterator()
 {}
 RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
 {
-  bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
   if (start_page <= 0) {
     current_page_num_ = 0;
   } else {
     current_page_num_ = start_page;
   }
+
+  bp_ = &bp;
+  set_read_ahead_pages(bp.bp_manager_.read_ahead_pages());
   return RC::SUCCESS;
 }
 
+void BufferPoolIterator::set_read_ahead_pages(int pages)
+{
+  // 预读的页面不能把缓冲池挤满，否则读进来的页面在被访问之前就会被淘汰掉
+  if (bp_ != nullptr) {
+    const int max_pages = static_cast<int>(bp_->frame_manager_.total_frame_num() / 4);
+    pages = std::min(pages, max_pages);
+  }
+  read_ahead_pages_ = std::max(pages, 0);
+  sequential_num_ = 0;
+  read_ahead_end_ = 0;
+}
+
 bool BufferPoolIterator::has_next()
 {
-  return bitmap_.next_setted_bit(current_page_num_ + 1) != -1;
+  return bp_->next_allocated_page(current_page_num_ + 1) != BP_INVALID_PAGE_NUM;
 }
 
 PageNum BufferPoolIterator::next()
 {
-  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
-  if (next_page != -1) {
+  PageNum next_page = bp_->next_allocated_page(current_page_num_ + 1);
+  if (next_page != BP_INVALID_PAGE_NUM) {
     current_page_num_ = next_page;
+
+    // 当前页面进入了上一次预读窗口的后半段，就接着预读下一批
+    if (read_ahead_pages_ > 0 && ++sequential_num_ >= READ_AHEAD_TRIGGER_NUM &&
+        current_page_num_ + read_ahead_pages_ / 2 >= read_ahead_end_) {
+      read_ahead();
+    }
   }
   return next_page;
 }
@@ -163,13 +627,100 @@ PageNum BufferPoolIterator::next()
 RC BufferPoolIterator::reset()
 {
   current_page_num_ = 0;
+  sequential_num_ = 0;
+  read_ahead_end_ = 0;
   return RC::SUCCESS;
 }
 
+void BufferPoolIterator::read_ahead()
+{
+  // 当前页面马上就要被访问，也放到这一批里面
+  std::vector<PageNum> page_nums;
+  page_nums.reserve(read_ahead_pages_);
+  PageNum page_num = std::max(current_page_num_, read_ahead_end_);
+  while (static_cast<int>(page_nums.size()) < read_ahead_pages_) {
+    page_num = bp_->next_allocated_page(page_num);
+    if (page_num == BP_INVALID_PAGE_NUM) {
+      break;
+    }
+    page_nums.push_back(page_num);
+    page_num++;
+  }
+
+  if (page_nums.empty()) {
+    read_ahead_end_ = bp_->file_header_->page_count;  // 后面没有页面了
+    return;
+  }
+  read_ahead_end_ = page_nums.back() + 1;
+
+  int loaded_num = 0;
+  RC rc = bp_->prefetch_pages(page_nums.data(), static_cast<int>(page_nums.size()), loaded_num);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to read ahead pages from %d. rc=%s", page_nums.front(), strrc(rc));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
-DiskBufferPool::DiskBufferPool(BufferPoolManager &bp_manager, BPFrameManager &frame_manager)
-  : bp_manager_(bp_manager), frame_manager_(frame_manager)
+DiskBufferPool::DiskBufferPool(
+    BufferPoolManager &bp_manager, BPFrameManager &frame_manager, const std::string &pool_name)
+  : bp_manager_(bp_manager),
+    frame_manager_(frame_manager),
+    page_io_(bp_manager.page_io()),
+    page_size_(frame_manager.page_size()),
+    pool_name_(pool_name)
+{
+}
+
+static long current_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+std::string DiskBufferPool::Stats::to_string() const
+{
+  const long hits = this->hits.load();
+  const long misses = this->misses.load();
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "hits=%ld, misses=%ld, hit_rate=%.2lf%%, prefetched=%ld, evictions=%ld, dirty_writes=%ld, mapped_reads=%ld, "
+           "read_us(avg/p50/p99/max)=%.1lf/%ld/%ld/%ld, write_us(avg/p50/p99/max)=%.1lf/%ld/%ld/%ld",
+           hits, misses, hits + misses > 0 ? hits * 100.0 / (hits + misses) : 0.0,
+           prefetched.load(), evictions.load(), dirty_writes.load(), mapped_reads.load(),
+           read_latency.mean_us(), read_latency.percentile_us(0.5), read_latency.percentile_us(0.99),
+           read_latency.max_us(),
+           write_latency.mean_us(), write_latency.percentile_us(0.5), write_latency.percentile_us(0.99),
+           write_latency.max_us());
+  return std::string(buf);
+}
+
+class BufferPoolStatsGauge : public Gauge
 {
+public:
+  BufferPoolStatsGauge(const DiskBufferPool::Stats &stats) : stats_(stats)
+  {
+    set_snapshot(new SnapshotBasic<std::string>());
+  }
+
+  virtual ~BufferPoolStatsGauge()
+  {
+    delete snapshot_value_;
+  }
+
+  void snapshot() override
+  {
+    std::string value = stats_.to_string();
+    static_cast<SnapshotBasic<std::string> *>(snapshot_value_)->setValue(value);
+  }
+
+private:
+  const DiskBufferPool::Stats &stats_;
+};
+
+static std::string stats_metric_tag(const std::string &file_name)
+{
+  return "BufferPool.file." + file_name;
 }
 
 DiskBufferPool::~DiskBufferPool()
@@ -178,14 +729,45 @@ DiskBufferPool::~DiskBufferPool()
   LOG_INFO("Exit");
 }
 
-RC DiskBufferPool::open_file(const char *file_name)
+/**
+ * 检查文件的O_DIRECT对齐要求。内核不支持查询时(STATX_DIOALIGN)假定逻辑块不超过BP_DIRECT_IO_ALIGN
+ */
+static bool direct_io_aligned(int fd, const char *file_name, int page_size)
+{
+#if defined(STATX_DIOALIGN)
+  struct statx stx;
+  if (statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 && (stx.stx_mask & STATX_DIOALIGN) != 0) {
+    if (stx.stx_dio_mem_align == 0 || stx.stx_dio_mem_align > BP_DIRECT_IO_ALIGN ||
+        stx.stx_dio_offset_align == 0 || stx.stx_dio_offset_align > (uint32_t)page_size) {
+      LOG_WARN("Direct io alignment of %s is not supported. memory align=%u, offset align=%u",
+               file_name, stx.stx_dio_mem_align, stx.stx_dio_offset_align);
+      return false;
+    }
+  }
+#endif
+  return true;
+}
+
+RC DiskBufferPool::open_file(const char *file_name, bool direct_io, bool mmap_scan)
 {
-  int fd;
-  if ((fd = open(file_name, O_RDWR)) < 0) {
+  int fd = -1;
+  if (direct_io) {
+    fd = open(file_name, O_RDWR | O_DIRECT);
+    if (fd < 0 && errno == EINVAL) {
+      LOG_WARN("File system does not support direct io, open %s with page cache", file_name);
+    } else if (fd >= 0 && !direct_io_aligned(fd, file_name, page_size_)) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  direct_io_ = fd >= 0;
+  if (fd < 0 && (fd = open(file_name, O_RDWR)) < 0) {
     LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
     return RC::IOERR_ACCESS;
   }
-  LOG_INFO("Successfully open file %s.", file_name);
+  // 使用O_DIRECT时页面不经过page cache，映射读到的可能是旧的内容，而且映射会把页面读进page cache
+  mmap_scan_ = mmap_scan && !direct_io_;
+  LOG_INFO("Successfully open file %s. direct io=%d, mmap scan=%d", file_name, direct_io_, mmap_scan_);
 
   file_name_ = file_name;
   file_desc_ = fd;
@@ -199,21 +781,37 @@ RC DiskBufferPool::open_file(const char *file_name)
     return rc;
   }
 
-  hdr_frame_->dirty_ = false;
-  hdr_frame_->file_desc_ = fd;
-  hdr_frame_->pin_count_ = 1;
-  hdr_frame_->acc_time_ = current_time();
   if ((rc = load_page(BP_HEADER_PAGE, hdr_frame_)) != RC::SUCCESS) {
     LOG_ERROR("Failed to load first page of %s, due to %s.", file_name, strerror(errno));
-    hdr_frame_->pin_count_ = 0;
-    purge_frame(BP_HEADER_PAGE, hdr_frame_);
+    frame_manager_.free(file_desc_, BP_HEADER_PAGE, hdr_frame_);
     close(fd);
     file_desc_ = -1;
     return rc;
   }
+  frame_manager_.finish_load(hdr_frame_);
 
   file_header_ = (BPFileHeader *)hdr_frame_->data();
 
+  if (file_header_->page_size != page_size_) {
+    LOG_ERROR("Page size of %s is %d, but the buffer pool is for %d byte pages",
+              file_name, file_header_->page_size, page_size_);
+    rc = RC::BUFFERPOOL_FILEERR;
+  } else {
+    rc = load_space_map();
+  }
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to load space map of %s, rc=%s", file_name, strrc(rc));
+    hdr_frame_->pin_count_--;
+    purge_all_pages();
+    close(fd);
+    file_desc_ = -1;
+    file_header_ = nullptr;
+    return rc;
+  }
+
+  stats_gauge_ = new BufferPoolStatsGauge(stats_);
+  get_metrics_registry().register_metric(stats_metric_tag(file_name_), stats_gauge_);
+
   LOG_INFO("Successfully open %s. file_desc=%d, hdr_frame=%p", file_name, file_desc_, hdr_frame_);
   return RC::SUCCESS;
 }
@@ -225,8 +823,14 @@ RC DiskBufferPool::close_file()
     return rc;
   }
 
+  // 缓冲池按照文件描述符查找页面，关闭之后文件描述符可能被新打开的文件复用，留在缓冲池中的页面
+  // 会被新文件读到，后台刷脏页和检查点也会把它们写到新文件中。所以先刷盘并淘汰这个文件的所有页面
+  if ((rc = purge_data_pages()) != RC::SUCCESS) {
+    LOG_ERROR("Failed to close %s, due to failed to purge all pages. rc=%s", file_name_.c_str(), strrc(rc));
+    return rc;
+  }
+
   hdr_frame_->pin_count_--;
-  // TODO: 理论上是在回放时回滚未提交事务，但目前没有undo log，因此不下刷数据page，只通过redo log回放
   if ((rc = purge_page(0)) != RC::SUCCESS) {
     hdr_frame_->pin_count_++;
     LOG_ERROR("Failed to close %s, due to failed to purge all pages.", file_name_.c_str());
@@ -234,14 +838,21 @@ RC DiskBufferPool::close_file()
   }
 
   disposed_pages.clear();
+  unmap_file();
 
   if (close(file_desc_) < 0) {
     LOG_ERROR("Failed to close fileId:%d, fileName:%s, error:%s", file_desc_, file_name_.c_str(), strerror(errno));
     return RC::IOERR_CLOSE;
   }
-  LOG_INFO("Successfully close file %d:%s.", file_desc_, file_name_.c_str());
+  LOG_INFO("Successfully close file %d:%s. %s", file_desc_, file_name_.c_str(), stats_.to_string().c_str());
   file_desc_ = -1;
 
+  if (stats_gauge_ != nullptr) {
+    get_metrics_registry().unregister(stats_metric_tag(file_name_));
+    delete stats_gauge_;
+    stats_gauge_ = nullptr;
+  }
+
   bp_manager_.close_file(file_name_.c_str());
   return RC::SUCCESS;
 }
@@ -250,91 +861,284 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
 {
   RC rc = RC::SUCCESS;
 
-  Frame *used_match_frame = frame_manager_.get(file_desc_, page_num);
-  if (used_match_frame != nullptr) {
-    used_match_frame->pin_count_++;
-    used_match_frame->acc_time_ = current_time();
+  while (true) {
+    Frame *used_match_frame = frame_manager_.pin(file_desc_, page_num);
+    if (used_match_frame != nullptr) {
+      if (used_match_frame->prefetched_.load(std::memory_order_relaxed) && used_match_frame->prefetched_.exchange(false)) {
+        frame_manager_.prefetch_stats().hit++;
+      }
+      stats_.hits.fetch_add(1, std::memory_order_relaxed);
 
+      *frame = used_match_frame;
+      return RC::SUCCESS;
+    }
 
-    *frame = used_match_frame;
-    return RC::SUCCESS;
-  }
+    // Allocate one page and load the data into this page
+    Frame *allocated_frame = nullptr;
+    rc = allocate_frame(page_num, &allocated_frame);
+    if (rc == RC::BUFFERPOOL_EXIST) {
+      continue;  // 其它线程正在加载这个页面，等它加载完
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
+      return rc;
+    }
 
-  // Allocate one page and load the data into this page
-  Frame *allocated_frame = nullptr;
-  if ((rc = allocate_frame(page_num, &allocated_frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
-    return rc;
-  }
+    if ((rc = load_page(page_num, allocated_frame)) != RC::SUCCESS) {
+      LOG_ERROR("Failed to load page %s:%d", file_name_.c_str(), page_num);
+      frame_manager_.free(file_desc_, page_num, allocated_frame);
+      return rc;
+    }
+    frame_manager_.finish_load(allocated_frame);
+    bp_manager_.inc_page_misses();
+    stats_.misses.fetch_add(1, std::memory_order_relaxed);
 
-  allocated_frame->dirty_ = false;
-  allocated_frame->file_desc_ = file_desc_;
-  allocated_frame->pin_count_ = 1;
-  allocated_frame->acc_time_ = current_time();
-  if ((rc = load_page(page_num, allocated_frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to load page %s:%d", file_name_.c_str(), page_num);
-    allocated_frame->pin_count_ = 0;
-    purge_frame(page_num, allocated_frame);
-    return rc;
+    *frame = allocated_frame;
+    return RC::SUCCESS;
   }
-
-  *frame = allocated_frame;
-  return RC::SUCCESS;
 }
 
-RC DiskBufferPool::allocate_page(Frame **frame)
+RC DiskBufferPool::get_pages(const PageNum *page_nums, int num, Frame **frames)
 {
+  std::vector<int> load_indexes;   // 需要从文件中读取的页面在page_nums中的下标
+  std::vector<int> retry_indexes;  // 其它线程正在加载或者暂时分配不到frame的页面，最后逐个获取
+  for (int i = 0; i < num; i++) {
+    frames[i] = frame_manager_.pin(file_desc_, page_nums[i]);
+    if (frames[i] != nullptr) {
+      if (frames[i]->prefetched_.load(std::memory_order_relaxed) && frames[i]->prefetched_.exchange(false)) {
+        frame_manager_.prefetch_stats().hit++;
+      }
+      stats_.hits.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+
+    // 分配的frame是pin住的，读取的过程中不会被淘汰
+    if (allocate_frame(page_nums[i], &frames[i]) == RC::SUCCESS) {
+      load_indexes.push_back(i);
+    } else {
+      frames[i] = nullptr;
+      retry_indexes.push_back(i);
+    }
+  }
+
   RC rc = RC::SUCCESS;
+  if (!load_indexes.empty()) {
+    std::sort(load_indexes.begin(), load_indexes.end(), [page_nums](int i1, int i2) {
+      return page_nums[i1] < page_nums[i2];
+    });
+
+    std::vector<PageIORequest> requests(load_indexes.size());
+    for (size_t i = 0; i < load_indexes.size(); i++) {
+      requests[i].file_desc = file_desc_;
+      requests[i].page_num = page_nums[load_indexes[i]];
+      requests[i].page = &frames[load_indexes[i]]->page_;
+      requests[i].page_size = page_size_;
+    }
 
-  int byte = 0, bit = 0;
-  if ((file_header_->allocated_pages) < (file_header_->page_count)) {
-    // There is one free page
-    for (int i = 0; i < file_header_->page_count; i++) {
-      byte = i / 8;
-      bit = i % 8;
-      if (((file_header_->bitmap[byte]) & (1 << bit)) == 0) {
-        (file_header_->allocated_pages)++;
-        file_header_->bitmap[byte] |= (1 << bit);
-        // TODO,  do we need clean the loaded page's data?
-	hdr_frame_->mark_dirty();
-        return get_this_page(i, frame);
+    const long begin_us = current_us();
+    page_io_.read_pages(requests.data(), static_cast<int>(requests.size()));
+    stats_.read_latency.record(current_us() - begin_us);
+    for (size_t i = 0; i < load_indexes.size(); i++) {
+      Frame *&frame = frames[load_indexes[i]];
+      if (requests[i].rc == RC::SUCCESS) {
+        requests[i].rc = verify_page(frame->page_, requests[i].page_num);
+      }
+      if (requests[i].rc == RC::SUCCESS) {
+        frame->set_page_num(requests[i].page_num);
+        frame_manager_.finish_load(frame);
+        bp_manager_.inc_page_misses();
+        stats_.misses.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        LOG_ERROR("Failed to load page %s:%d, rc=%s", file_name_.c_str(), requests[i].page_num, strrc(requests[i].rc));
+        frame_manager_.free(file_desc_, requests[i].page_num, frame);
+        frame = nullptr;
+        rc = requests[i].rc;
       }
     }
   }
 
-  if (file_header_->page_count >= BPFileHeader::MAX_PAGE_NUM) {
-    LOG_WARN("file buffer pool is full. page count %d, max page count %d",
-	     file_header_->page_count, BPFileHeader::MAX_PAGE_NUM);
-    return BUFFERPOOL_NOBUF;
+  for (size_t i = 0; rc == RC::SUCCESS && i < retry_indexes.size(); i++) {
+    rc = get_this_page(page_nums[retry_indexes[i]], &frames[retry_indexes[i]]);
   }
 
-  PageNum page_num = file_header_->page_count;
-  Frame *allocated_frame = nullptr;
-  if ((rc = allocate_frame(page_num, &allocated_frame)) != RC::SUCCESS) {
-    LOG_ERROR("Failed to allocate frame %s, due to no free page.", file_name_.c_str());
-    return rc;
+  if (rc != RC::SUCCESS) {
+    for (int i = 0; i < num; i++) {
+      if (frames[i] != nullptr) {
+        unpin_page(frames[i]);
+        frames[i] = nullptr;
+      }
+    }
   }
+  return rc;
+}
 
-  file_header_->allocated_pages++;
-  file_header_->page_count++;
+RC DiskBufferPool::read_page(PageNum page_num, Frame *&frame, const Page *&page, char *buffer)
+{
+  frame = nullptr;
+  if (mmap_scan_ && buffer != nullptr && frame_manager_.get(file_desc_, page_num) == nullptr) {
+    RC rc = check_page_num(page_num);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    const Page *mapped = mapped_page(page_num);
+    if (mapped != nullptr) {
+      // 映射是MAP_SHARED的，其它线程刷盘时会直接改到映射中的内容，所以复制一份再校验。
+      // 这里不管校验模式如何都要检查，复制时正好碰上写盘得到的半新半旧的页面，校验和一定对不上，
+      // 这时改从缓冲池读取，由get_this_page按照配置的模式处理真正损坏的页面
+      Page *copy = reinterpret_cast<Page *>(buffer);
+      memcpy(copy, mapped, page_size_);
+      if (verify_page_checksum(*copy, page_size_) && (copy->page_num == page_num || copy->version == 0)) {
+        stats_.mapped_reads.fetch_add(1, std::memory_order_relaxed);
+        page = copy;
+        return RC::SUCCESS;
+      }
+      LOG_DEBUG("Mapped page %s:%d is not consistent, read it through buffer pool", file_name_.c_str(), page_num);
+    }
+  }
 
-  byte = page_num / 8;
-  bit = page_num % 8;
-  file_header_->bitmap[byte] |= (1 << bit);
-  hdr_frame_->mark_dirty();
+  RC rc = get_this_page(page_num, &frame);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  page = &frame->page_;
+  return RC::SUCCESS;
+}
+
+const Page *DiskBufferPool::mapped_page(PageNum page_num)
+{
+  const size_t end = (size_t)(page_num + 1) * page_size_;
+  std::lock_guard<std::mutex> lock_guard(map_lock_);
+  if (end > map_size_) {
+    struct stat st;
+    if (fstat(file_desc_, &st) != 0) {
+      LOG_WARN("Failed to stat %s, due to %s.", file_name_.c_str(), strerror(errno));
+      return nullptr;
+    }
+    const size_t file_size = (size_t)st.st_size / page_size_ * page_size_;
+    if (end > file_size) {
+      return nullptr;  // 新分配的页面还没有写到文件中
+    }
+
+    void *addr = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, file_desc_, 0);
+    if (addr == MAP_FAILED) {
+      LOG_WARN("Failed to mmap %s, size=%lu, due to %s.", file_name_.c_str(), file_size, strerror(errno));
+      return nullptr;
+    }
+    if (map_addr_ != nullptr) {
+      retired_maps_.emplace_back(map_addr_, map_size_);
+    }
+    map_addr_ = static_cast<char *>(addr);
+    map_size_ = file_size;
+    LOG_INFO("Map %s, size=%lu", file_name_.c_str(), map_size_);
+  }
+  return reinterpret_cast<const Page *>(map_addr_ + (size_t)page_num * page_size_);
+}
+
+void DiskBufferPool::unmap_file()
+{
+  std::lock_guard<std::mutex> lock_guard(map_lock_);
+  retired_maps_.emplace_back(map_addr_, map_size_);
+  for (const auto &map : retired_maps_) {
+    if (map.first != nullptr) {
+      munmap(map.first, map.second);
+    }
+  }
+  retired_maps_.clear();
+  map_addr_ = nullptr;
+  map_size_ = 0;
+}
+
+void DiskBufferPool::advise_sequential()
+{
+  // 文件变大重新映射之后，新的映射上没有这个提示，所以每次扫描开始时都要调用
+  if (!mmap_scan_ || mapped_page(BP_HEADER_PAGE) == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock_guard(map_lock_);
+  if (madvise(map_addr_, map_size_, MADV_SEQUENTIAL) != 0) {
+    LOG_WARN("Failed to advise %s, due to %s.", file_name_.c_str(), strerror(errno));
+  }
+}
+
+void DiskBufferPool::advise_will_need(PageNum start_page, int page_num)
+{
+  if (!mmap_scan_ || page_num <= 0 || mapped_page(start_page) == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock_guard(map_lock_);
+  const size_t begin = (size_t)start_page * page_size_;
+  const size_t length = std::min((size_t)page_num * page_size_, map_size_ - begin);
+  if (madvise(map_addr_ + begin, length, MADV_WILLNEED) != 0) {
+    LOG_WARN("Failed to advise %s, due to %s.", file_name_.c_str(), strerror(errno));
+  }
+}
+
+RC DiskBufferPool::allocate_page(Frame **frame)
+{
+  RC rc = RC::SUCCESS;
+
+  Frame *bitmap_frame = nullptr;
+  char *bitmap = nullptr;
+  PageNum page_num = BP_INVALID_PAGE_NUM;
+  int group = 0, word = 0;
+  if (space_map_.first_free_word(group, word)) {
+    // There is one free page
+    if ((rc = get_group_bitmap(group, bitmap_frame, bitmap)) != RC::SUCCESS) {
+      return rc;
+    }
+    const int pages = space_map_.pages_in_group(group, file_header_->page_count);
+    const uint64_t free_mask = space_map_.free_mask(bitmap, word, pages);
+    assert(free_mask != 0);
+    page_num = space_map_.group_page(group) + word * 64 + __builtin_ctzll(free_mask);
+    put_group_bitmap(bitmap_frame);
+  } else {
+    if (file_header_->page_count >= std::numeric_limits<PageNum>::max() - 1) {
+      LOG_WARN("file buffer pool is full. page count %d", file_header_->page_count);
+      return BUFFERPOOL_NOBUF;
+    }
 
-  allocated_frame->dirty_ = false;
-  allocated_frame->file_desc_ = file_desc_;
-  allocated_frame->pin_count_ = 1;
-  allocated_frame->acc_time_ = current_time();
-  allocated_frame->clear_page();
-  allocated_frame->page_.page_num = file_header_->page_count - 1;
+    // 最后一个分组已经满了，先创建一个新的分组
+    if (space_map_.is_bitmap_page(file_header_->page_count)) {
+      if ((rc = create_group(space_map_.group_of(file_header_->page_count))) != RC::SUCCESS) {
+        return rc;
+      }
+    }
+    page_num = file_header_->page_count;
+  }
+
+  Frame *allocated_frame = nullptr;
+  if ((rc = allocate_frame(page_num, &allocated_frame)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate frame %s, due to no free page.", file_name_.c_str());
+    return rc;
+  }
 
-  // Use flush operation to extension file
-  if ((rc = flush_page(*allocated_frame)) != RC::SUCCESS) {
-    LOG_WARN("Failed to alloc page %s , due to failed to extend one page.", file_name_.c_str());
-    // skip return false, delay flush the extended page
-    // return tmp;
+  if ((rc = get_group_bitmap(space_map_.group_of(page_num), bitmap_frame, bitmap)) != RC::SUCCESS) {
+    frame_manager_.free(file_desc_, page_num, allocated_frame);
+    return rc;
+  }
+  const bool extend = page_num == file_header_->page_count;
+  if (extend) {
+    hdr_frame_->latch().lock();
+    file_header_->page_count++;
+    hdr_frame_->latch().unlock();
+  }
+  set_page_allocated(bitmap_frame, bitmap, page_num, true);
+  put_group_bitmap(bitmap_frame);
+
+  allocated_frame->clear_page(page_size_);
+  allocated_frame->page_.page_num = page_num;
+  frame_manager_.finish_load(allocated_frame);
+
+  // 空闲页面原来的内容没有用，不需要从磁盘读取
+  if (extend) {
+    // Use flush operation to extension file
+    if ((rc = flush_page(*allocated_frame)) != RC::SUCCESS) {
+      LOG_WARN("Failed to alloc page %s , due to failed to extend one page.", file_name_.c_str());
+      // skip return false, delay flush the extended page
+      // return tmp;
+    }
+  } else {
+    allocated_frame->mark_dirty();
   }
 
   *frame = allocated_frame;
@@ -364,6 +1168,11 @@ RC DiskBufferPool::unpin_page(Frame *frame)
  */
 RC DiskBufferPool::dispose_page(PageNum page_num)
 {
+  if (space_map_.is_bitmap_page(page_num)) {
+    LOG_WARN("Cannot dispose bitmap page %s:%d", file_name_.c_str(), page_num);
+    return RC::BUFFERPOOL_INVALID_PAGE_NUM;
+  }
+
   RC rc = purge_page(page_num);
   if (rc != RC::SUCCESS) {
     LOG_INFO("Dispose page %s:%d later, due to this page is being used", file_name_.c_str(), page_num);
@@ -372,18 +1181,23 @@ RC DiskBufferPool::dispose_page(PageNum page_num)
     return rc;
   }
 
-  hdr_frame_->dirty_ = true;
-  file_header_->allocated_pages--;
-  char tmp = 1 << (page_num % 8);
-  file_header_->bitmap[page_num / 8] &= ~tmp;
+  Frame *bitmap_frame = nullptr;
+  char *bitmap = nullptr;
+  if ((rc = get_group_bitmap(space_map_.group_of(page_num), bitmap_frame, bitmap)) != RC::SUCCESS) {
+    return rc;
+  }
+  set_page_allocated(bitmap_frame, bitmap, page_num, false);
+  put_group_bitmap(bitmap_frame);
   return RC::SUCCESS;
 }
 
 RC DiskBufferPool::purge_frame(PageNum page_num, Frame *buf)
 {
-  if (buf->pin_count_ > 0) {
-    LOG_INFO("Begin to free page %d of %d(file id), but it's pinned, pin_count:%d.",
-	     buf->page_num(), buf->file_desc_, buf->pin_count_);
+  // 先pin住，防止刷盘的过程中被其它线程淘汰
+  unsigned int pin_count = 0;
+  if (!buf->pin_count_.compare_exchange_strong(pin_count, 1)) {
+    LOG_INFO("Begin to free page %d of %d(file id), but it's pinned, pin_count:%u.",
+	     buf->page_num(), buf->file_desc_, pin_count);
     return RC::LOCKED_UNLOCK;
   }
 
@@ -391,12 +1205,18 @@ RC DiskBufferPool::purge_frame(PageNum page_num, Frame *buf)
     RC rc = flush_page(*buf);
     if (rc != RC::SUCCESS) {
       LOG_WARN("Failed to flush page %d of %d(file desc) during purge page.", buf->page_num(), buf->file_desc_);
+      buf->pin_count_--;
       return rc;
     }
   }
 
-  LOG_DEBUG("Successfully purge frame =%p, page %d of %d(file desc)", buf, buf->page_num(), buf->file_desc_);
-  frame_manager_.free(file_desc_, page_num, buf);
+  RC rc = frame_manager_.free(file_desc_, page_num, buf);
+  if (rc != RC::SUCCESS) {
+    LOG_INFO("Failed to purge page %d of %d(file desc), it's pinned or modified again.", page_num, file_desc_);
+    buf->pin_count_--;
+    return RC::LOCKED_UNLOCK;
+  }
+  LOG_DEBUG("Successfully purge frame =%p, page %d of %d(file desc)", buf, page_num, file_desc_);
   return RC::SUCCESS;
 }
 
@@ -421,21 +1241,51 @@ RC DiskBufferPool::purge_all_pages()
   std::list<Frame *> used = frame_manager_.find_list(file_desc_);
   for (std::list<Frame *>::iterator it = used.begin(); it != used.end(); ++it) {
     Frame *frame = *it;
-    if (frame->pin_count_ > 0) {
-      LOG_WARN("The page has been pinned, file_desc:%d, pagenum:%d, pin_count=%d",
-	       frame->file_desc_, frame->page_.page_num, frame->pin_count_);
+    RC rc = purge_frame(frame->page_num(), frame);
+    if (rc == RC::LOCKED_UNLOCK) {
+      LOG_WARN("The page has been pinned, file_desc:%d, pagenum:%d, pin_count=%u",
+	       frame->file_desc_, frame->page_num(), frame->pin_count_.load());
       continue;
     }
-    if (frame->dirty_) {
-      RC rc = flush_page(*frame);
-      if (rc != RC::SUCCESS) {
-        LOG_ERROR("Failed to flush all pages' of %s.", file_name_.c_str());
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush all pages' of %s.", file_name_.c_str());
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::purge_data_pages()
+{
+  // 后台刷脏页时会短暂地pin住页面，稍等一下再试
+  const int max_retry = 1000;
+  for (int retry = 0; retry < max_retry; retry++) {
+    bool all_purged = true;
+    std::list<Frame *> used = frame_manager_.find_list(file_desc_);
+    for (Frame *frame : used) {
+      if (frame->page_num() == BP_HEADER_PAGE) {
+        continue;
+      }
+      RC rc = purge_frame(frame->page_num(), frame);
+      if (rc == RC::LOCKED_UNLOCK) {
+        all_purged = false;
+      } else if (rc != RC::SUCCESS) {
         return rc;
       }
     }
-    frame_manager_.free(file_desc_, frame->page_.page_num, frame);
+    if (all_purged) {
+      return RC::SUCCESS;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
-  return RC::SUCCESS;
+
+  for (Frame *frame : frame_manager_.find_list(file_desc_)) {
+    if (frame->page_num() != BP_HEADER_PAGE) {
+      LOG_ERROR("The page is still pinned. file=%s, page num=%d, pin count=%u",
+                file_name_.c_str(), frame->page_num(), frame->pin_count_.load());
+    }
+  }
+  return RC::LOCKED_UNLOCK;
 }
 
 RC DiskBufferPool::check_all_pages_unpinned()
@@ -444,34 +1294,50 @@ RC DiskBufferPool::check_all_pages_unpinned()
   for (auto & frame : frames) {
     if (frame->page_num() == BP_HEADER_PAGE && frame->pin_count_ > 1) {
       LOG_WARN("This page has been pinned. file desc=%d, page num:%d, pin count=%d",
-	       file_desc_, frame->page_num(), frame->pin_count_);
+	       file_desc_, frame->page_num(), frame->pin_count_.load());
     } else if (frame->page_num() != BP_HEADER_PAGE && frame->pin_count_ > 0) {
       LOG_WARN("This page has been pinned. file desc=%d, page num:%d, pin count=%d",
-	       file_desc_, frame->page_num(), frame->pin_count_);
+	       file_desc_, frame->page_num(), frame->pin_count_.load());
     }
   }
   LOG_INFO("all pages have been checked of file desc %d", file_desc_);
   return RC::SUCCESS;
 }
 
+void DiskBufferPool::copy_page_for_flush(Frame &frame, Page *copy)
+{
+  // LSN要在复制之前取，这样LSN比它小的日志对应的修改都已经在页面中了
+  const int64_t lsn = BufferPoolManager::flush_lsn();
+
+  // 先清除脏标记，复制之后如果页面又被修改了，会重新标记为脏页
+  frame.latch().lock_shared();
+  frame.dirty_ = false;
+  memcpy(copy, &frame.page_, page_size_);
+  frame.latch().unlock_shared();
+  copy->lsn = std::max(copy->lsn, lsn);
+  stamp_page(*copy, page_size_);
+}
+
 RC DiskBufferPool::flush_page(Frame &frame)
 {
   // The better way is use mmap the block into memory,
   // so it is easier to flush data to file.
 
-  Page &page = frame.page_;
-  s64_t offset = ((s64_t)page.page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == offset - 1) {
-    LOG_ERROR("Failed to flush page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
-  }
+  Page *page = flush_buffer.pages(page_size_, 1);
+  copy_page_for_flush(frame, page);
+  PageIORequest request;
+  request.file_desc = file_desc_;
+  request.page_num = page->page_num;
+  request.page = page;
+  request.page_size = page_size_;
 
-  if (writen(file_desc_, &page, sizeof(Page)) != 0) {
-    LOG_ERROR("Failed to flush page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_WRITE;
+  RC rc = write_pages(&request, 1);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush page %d of %d. rc=%s", page->page_num, file_desc_, strrc(rc));
+    frame.dirty_ = true;
+    return rc;
   }
-  frame.dirty_ = false;
-  LOG_DEBUG("Flush block. file desc=%d, page num=%d", file_desc_, page.page_num);
+  LOG_DEBUG("Flush block. file desc=%d, page num=%d", file_desc_, page->page_num);
 
   return RC::SUCCESS;
 }
@@ -491,19 +1357,230 @@ RC DiskBufferPool::flush_all_pages()
 
 RC DiskBufferPool::recover_page(PageNum page_num)
 {
-  int byte = 0, bit = 0;
-  byte = page_num / 8;
-  bit = page_num % 8;
+  RC rc = RC::SUCCESS;
 
-  if (!(file_header_->bitmap[byte] & (1 << bit))) {
-    file_header_->bitmap[byte] |= (1 << bit);
-    file_header_->allocated_pages++;
-    file_header_->page_count++;
-    hdr_frame_->mark_dirty();
+  // 页面所在的分组可能还没有创建，需要依次创建前面的分组。跳过的页面都当作空闲页面
+  const int group = space_map_.group_of(page_num);
+  const int page_count = file_header_->page_count;
+  while (space_map_.group_page(group) >= file_header_->page_count) {
+    const int next_group = space_map_.group_of(file_header_->page_count - 1) + 1;
+    hdr_frame_->latch().lock();
+    file_header_->page_count = space_map_.group_page(next_group);
+    hdr_frame_->latch().unlock();
+    if ((rc = create_group(next_group)) != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
+  Frame *bitmap_frame = nullptr;
+  char *bitmap = nullptr;
+  if ((rc = get_group_bitmap(group, bitmap_frame, bitmap)) != RC::SUCCESS) {
+    return rc;
+  }
+
+  const int bit = page_num - space_map_.group_page(group);
+  if (!(bitmap[bit / 8] & (1 << (bit % 8)))) {
+    hdr_frame_->latch().lock();
+    file_header_->page_count = std::max(file_header_->page_count, page_num + 1);
+    hdr_frame_->latch().unlock();
+    set_page_allocated(bitmap_frame, bitmap, page_num, true);
+  }
+  put_group_bitmap(bitmap_frame);
+
+  // 页面个数变化之后，跳过的页面变成了空闲页面，重新构建摘要
+  if (file_header_->page_count != page_count) {
+    rc = load_space_map();
+  }
+
+  // 页面超出了文件的末尾时(分配之后还没有写过)，写入一个空页面扩展文件，之后才能正常读取。
+  // 文件头中的页面个数可能还没有落盘，要以文件的实际大小为准
+  struct stat st;
+  if (rc == RC::SUCCESS && fstat(file_desc_, &st) == 0 &&
+      static_cast<off_t>(page_num + 1) * page_size_ > st.st_size &&
+      frame_manager_.get(file_desc_, page_num) == nullptr) {
+    Frame *frame = nullptr;
+    if ((rc = allocate_frame(page_num, &frame)) != RC::SUCCESS) {
+      LOG_ERROR("Failed to allocate frame for recovered page %s:%d", file_name_.c_str(), page_num);
+      return rc;
+    }
+    frame->clear_page(page_size_);
+    frame->page_.page_num = page_num;
+    frame_manager_.finish_load(frame);
+    rc = flush_page(*frame);
+    unpin_page(frame);
+  }
+  return rc;
+}
+
+RC DiskBufferPool::page_lsn(PageNum page_num, int64_t &lsn)
+{
+  lsn = 0;
+  if (page_num <= 0 || page_num >= file_header_->page_count || space_map_.is_bitmap_page(page_num)) {
+    return RC::SUCCESS;
+  }
+
+  // 没有分配的页面中可能是以前的数据，不能使用它的LSN
+  Frame *bitmap_frame = nullptr;
+  char *bitmap = nullptr;
+  const int group = space_map_.group_of(page_num);
+  RC rc = get_group_bitmap(group, bitmap_frame, bitmap);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  const int bit = page_num - space_map_.group_page(group);
+  const bool allocated = (bitmap[bit / 8] & (1 << (bit % 8))) != 0;
+  put_group_bitmap(bitmap_frame);
+  if (!allocated) {
+    return RC::SUCCESS;
+  }
+
+  struct stat st;
+  if (frame_manager_.get(file_desc_, page_num) == nullptr &&
+      (fstat(file_desc_, &st) != 0 || static_cast<off_t>(page_num + 1) * page_size_ > st.st_size)) {
+    return RC::SUCCESS;
+  }
+
+  Frame *frame = nullptr;
+  if ((rc = get_this_page(page_num, &frame)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to get page %s:%d for lsn. rc=%s", file_name_.c_str(), page_num, strrc(rc));
+    return rc;
+  }
+  frame->latch().lock_shared();
+  lsn = frame->lsn();
+  frame->latch().unlock_shared();
+  unpin_page(frame);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::flush_pages(const std::vector<Frame *> &frames, int &flushed_num)
+{
+  flushed_num = 0;
+
+  std::vector<PageIORequest> requests(frames.size());
+  Page *pages = flush_buffer.pages(page_size_, static_cast<int>(frames.size()));
+  for (size_t i = 0; i < frames.size(); i++) {
+    Page *page = reinterpret_cast<Page *>(reinterpret_cast<char *>(pages) + i * page_size_);
+    copy_page_for_flush(*frames[i], page);
+    requests[i].file_desc = file_desc_;
+    requests[i].page_num = page->page_num;
+    requests[i].page = page;
+    requests[i].page_size = page_size_;
+  }
+
+  RC rc = write_pages(requests.data(), static_cast<int>(requests.size()));
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (requests[i].rc == RC::SUCCESS) {
+      flushed_num++;
+    } else {
+      frames[i]->dirty_ = true;
+    }
+  }
+
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush pages of %s. flushed=%d, total=%d, rc=%s",
+              file_name_.c_str(), flushed_num, (int)frames.size(), strrc(rc));
+    return rc;
   }
+  LOG_DEBUG("Flush pages. file=%s, page num=%d", file_name_.c_str(), flushed_num);
   return RC::SUCCESS;
 }
 
+RC DiskBufferPool::flush_header_page(int64_t max_recovery_lsn, bool &flushed)
+{
+  flushed = false;
+  if (!hdr_frame_->dirty() || hdr_frame_->recovery_lsn() >= max_recovery_lsn) {
+    return RC::SUCCESS;
+  }
+  RC rc = flush_page(*hdr_frame_);
+  flushed = rc == RC::SUCCESS;
+  return rc;
+}
+
+RC DiskBufferPool::write_pages(PageIORequest *requests, int num)
+{
+  RC rc = RC::SUCCESS;
+  const long begin_us = current_us();
+  DoubleWriteBuffer *double_write_buffer = bp_manager_.double_write_buffer();
+  if (double_write_buffer != nullptr) {
+    rc = double_write_buffer->write_pages(page_io_, file_name_.c_str(), requests, num);
+  } else {
+    rc = page_io_.write_pages(requests, num);
+  }
+  stats_.write_latency.record(current_us() - begin_us);
+  if (rc == RC::SUCCESS) {
+    stats_.dirty_writes.fetch_add(num, std::memory_order_relaxed);
+  }
+  return rc;
+}
+
+RC DiskBufferPool::prefetch_pages(const PageNum *page_nums, int num, int &loaded_num)
+{
+  loaded_num = 0;
+
+  std::vector<Frame *> frames;
+  for (int i = 0; i < num; i++) {
+    const PageNum page_num = page_nums[i];
+    if (check_page_num(page_num) != RC::SUCCESS || frame_manager_.get(file_desc_, page_num) != nullptr) {
+      continue;
+    }
+
+    // 分配的frame是pin住的，读取的过程中不会被淘汰
+    Frame *frame = nullptr;
+    RC rc = allocate_frame(page_num, &frame);
+    if (rc == RC::BUFFERPOOL_EXIST) {
+      continue;  // 其它线程正在加载
+    }
+    if (rc != RC::SUCCESS) {
+      break;  // 没有空闲的frame了，预读就到此为止
+    }
+    frames.push_back(frame);
+  }
+  if (frames.empty()) {
+    return RC::SUCCESS;
+  }
+
+  std::sort(frames.begin(), frames.end(), [](const Frame *f1, const Frame *f2) {
+    return f1->page_num() < f2->page_num();
+  });
+
+  std::vector<PageIORequest> requests(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    requests[i].file_desc = file_desc_;
+    requests[i].page_num = frames[i]->page_num();
+    requests[i].page = &frames[i]->page_;
+    requests[i].page_size = page_size_;
+  }
+
+  // 读取失败时页面中的页号不可信，使用请求中的页号
+  const long begin_us = current_us();
+  RC rc = page_io_.read_pages(requests.data(), static_cast<int>(requests.size()));
+  stats_.read_latency.record(current_us() - begin_us);
+  for (size_t i = 0; i < frames.size(); i++) {
+    Frame *frame = frames[i];
+    if (requests[i].rc == RC::SUCCESS) {
+      requests[i].rc = verify_page(frame->page_, requests[i].page_num);
+    }
+    if (requests[i].rc == RC::SUCCESS) {
+      frame->set_page_num(requests[i].page_num);
+      frame->prefetched_ = true;
+      frame_manager_.finish_load(frame);
+      frame_manager_.unpin_frame(frame);
+      loaded_num++;
+    } else {
+      frame_manager_.free(file_desc_, requests[i].page_num, frame);
+    }
+  }
+
+  frame_manager_.prefetch_stats().loaded += loaded_num;
+  stats_.prefetched.fetch_add(loaded_num, std::memory_order_relaxed);
+
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to prefetch pages of %s. loaded=%d, total=%d, rc=%s",
+             file_name_.c_str(), loaded_num, (int)frames.size(), strrc(rc));
+  }
+  return rc;
+}
+
 RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
 {
   while (true) {
@@ -512,6 +1589,9 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
       *buffer = frame;
       return RC::SUCCESS;
     }
+    if (frame_manager_.get(file_desc_, page_num) != nullptr) {
+      return RC::BUFFERPOOL_EXIST;  // 其它线程已经分配了这个页面
+    }
 
     frame = frame_manager_.begin_purge();
     if (frame == nullptr) {
@@ -523,136 +1603,786 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
       RC rc = bp_manager_.flush_page(*frame);
       if (rc != RC::SUCCESS) {
         LOG_ERROR("Failed to aclloc block due to failed to flush old block.");
+        frame_manager_.unpin_frame(frame);
         return rc;
       }
     }
 
-    frame_manager_.free(frame->file_desc(), frame->page_num(), frame);
+    const int victim_file_desc = frame->file_desc();
+    if (frame_manager_.free(victim_file_desc, frame->page_num(), frame) != RC::SUCCESS) {
+      // 刷盘的过程中又被其它线程pin住或者修改了，换一个
+      frame_manager_.unpin_frame(frame);
+    } else {
+      bp_manager_.record_eviction(victim_file_desc);
+    }
   }
   return RC::INTERNAL;
 }
 
 RC DiskBufferPool::check_page_num(PageNum page_num)
 {
-  if (page_num >= file_header_->page_count) {
+  if (page_num < 0 || page_num >= file_header_->page_count) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
-  if ((file_header_->bitmap[page_num / 8] & (1 << (page_num % 8))) == 0) {
+  if (space_map_.is_bitmap_page(page_num)) {
+    return RC::SUCCESS;
+  }
+
+  Frame *bitmap_frame = nullptr;
+  char *bitmap = nullptr;
+  const int group = space_map_.group_of(page_num);
+  RC rc = get_group_bitmap(group, bitmap_frame, bitmap);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  const int bit = page_num - space_map_.group_page(group);
+  const bool allocated = (bitmap[bit / 8] & (1 << (bit % 8))) != 0;
+  put_group_bitmap(bitmap_frame);
+  if (!allocated) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
+PageNum DiskBufferPool::next_allocated_page(PageNum start)
 {
-  s64_t offset = ((s64_t)page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.",
-	      file_name_.c_str(), page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
-  }
+  const int page_count = file_header_->page_count;
+  while (start < page_count) {
+    const int group = space_map_.group_of(start);
+    const PageNum group_begin = space_map_.group_page(group);
+    if (start == group_begin) {
+      start++;  // 文件头或者分组的位图页
+      continue;
+    }
 
-  int ret = readn(file_desc_, &(frame->page_), sizeof(Page));
-  if (ret != 0) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to read data:%s, ret=%d, page count=%d",
-	      file_name_.c_str(), page_num, strerror(errno), ret, file_header_->allocated_pages);
-    return RC::IOERR_READ;
+    Frame *bitmap_frame = nullptr;
+    char *bitmap = nullptr;
+    if (get_group_bitmap(group, bitmap_frame, bitmap) != RC::SUCCESS) {
+      return BP_INVALID_PAGE_NUM;
+    }
+    common::Bitmap group_bitmap(bitmap, space_map_.pages_in_group(group, page_count));
+    const int bit = group_bitmap.next_setted_bit(start - group_begin);
+    put_group_bitmap(bitmap_frame);
+    if (bit != -1) {
+      return group_begin + bit;
+    }
+    start = space_map_.group_page(group + 1);
   }
-  return RC::SUCCESS;
+  return BP_INVALID_PAGE_NUM;
 }
 
-RC DiskBufferPool::get_page_count(int *page_count)
+RC DiskBufferPool::get_group_bitmap(int group, Frame *&frame, char *&bitmap)
 {
-  *page_count = file_header_->allocated_pages;
+  if (group == 0) {
+    frame = hdr_frame_;
+    bitmap = file_header_->bitmap;
+    return RC::SUCCESS;
+  }
+
+  RC rc = get_this_page(space_map_.group_page(group), &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to get bitmap page of group %d of %s, rc=%s", group, file_name_.c_str(), strrc(rc));
+    return rc;
+  }
+  bitmap = reinterpret_cast<BPGroupHeader *>(frame->data())->bitmap;
   return RC::SUCCESS;
 }
-int DiskBufferPool::file_desc() const
-{
-  return file_desc_;
-}
-////////////////////////////////////////////////////////////////////////////////
-BufferPoolManager::BufferPoolManager()
-{
-  frame_manager_.init(MEM_POOL_ITEM_NUM);
-}
 
-BufferPoolManager::~BufferPoolManager()
+void DiskBufferPool::put_group_bitmap(Frame *frame)
 {
-  std::unordered_map<std::string, DiskBufferPool *> tmp_bps;
-  tmp_bps.swap(buffer_pools_);
-  
-  for (auto &iter : tmp_bps) {
-    delete iter.second;
+  if (frame != hdr_frame_) {
+    unpin_page(frame);
   }
 }
 
-RC BufferPoolManager::create_file(const char *file_name)
+void DiskBufferPool::set_page_allocated(Frame *bitmap_frame, char *bitmap, PageNum page_num, bool allocated)
 {
-  int fd = open(file_name, O_RDWR | O_CREAT | O_EXCL, S_IREAD | S_IWRITE);
-  if (fd < 0) {
-    LOG_ERROR("Failed to create %s, due to %s.", file_name, strerror(errno));
-    return RC::SCHEMA_DB_EXIST;
+  const int bit = page_num - space_map_.group_page(space_map_.group_of(page_num));
+  const int delta = allocated ? 1 : -1;
+  // 位图页和文件头会被后台刷脏和检查点写回，修改时持有写锁，写回的时候才是一个完整的页面
+  if (bitmap_frame != hdr_frame_) {
+    bitmap_frame->latch().lock();
+  }
+  hdr_frame_->latch().lock();
+  if (allocated) {
+    bitmap[bit / 8] |= (1 << (bit % 8));
+  } else {
+    bitmap[bit / 8] &= ~(1 << (bit % 8));
   }
 
-  close(fd);
+  if (bitmap_frame != hdr_frame_) {
+    reinterpret_cast<BPGroupHeader *>(bitmap_frame->data())->allocated_pages += delta;
+    bitmap_frame->mark_dirty();
+  }
+  file_header_->allocated_pages += delta;
+  hdr_frame_->mark_dirty();
+  hdr_frame_->latch().unlock();
+  if (bitmap_frame != hdr_frame_) {
+    bitmap_frame->latch().unlock();
+  }
+  space_map_.update(page_num, bitmap, file_header_->page_count);
+}
 
-  /**
-   * Here don't care about the failure
-   */
-  fd = open(file_name, O_RDWR);
-  if (fd < 0) {
-    LOG_ERROR("Failed to open for readwrite %s, due to %s.", file_name, strerror(errno));
-    return RC::IOERR_ACCESS;
+RC DiskBufferPool::create_group(int group)
+{
+  const PageNum page_num = space_map_.group_page(group);
+  assert(page_num == file_header_->page_count);
+
+  Frame *frame = nullptr;
+  RC rc = allocate_frame(page_num, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate frame for bitmap page of group %d of %s", group, file_name_.c_str());
+    return rc;
   }
 
-  Page page;
-  memset(&page, 0, sizeof(Page));
+  frame->clear_page(page_size_);
+  frame->page_.page_num = page_num;
+  frame_manager_.finish_load(frame);
 
-  BPFileHeader *file_header = (BPFileHeader *)page.data;
-  file_header->allocated_pages = 1;
-  file_header->page_count = 1;
+  BPGroupHeader *group_header = reinterpret_cast<BPGroupHeader *>(frame->data());
+  group_header->group = group;
+  group_header->allocated_pages = 1;
+  group_header->bitmap[0] |= 0x01;
 
-  char *bitmap = file_header->bitmap;
-  bitmap[0] |= 0x01;
-  if (lseek(fd, 0, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to seek file %s to position 0, due to %s .", file_name, strerror(errno));
-    close(fd);
-    return RC::IOERR_SEEK;
-  }
+  hdr_frame_->latch().lock();
+  file_header_->page_count++;
+  file_header_->allocated_pages++;
+  hdr_frame_->mark_dirty();
+  hdr_frame_->latch().unlock();
+  space_map_.load_group(group, group_header->bitmap, file_header_->page_count);
 
-  if (writen(fd, (char *)&page, sizeof(Page)) != 0) {
-    LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
-    close(fd);
-    return RC::IOERR_WRITE;
+  // 位图页立即写入，扩展文件
+  frame->mark_dirty();
+  if ((rc = flush_page(*frame)) != RC::SUCCESS) {
+    LOG_WARN("Failed to write bitmap page of group %d of %s, rc=%s", group, file_name_.c_str(), strrc(rc));
   }
+  unpin_page(frame);
 
-  close(fd);
-  LOG_INFO("Successfully create %s.", file_name);
+  LOG_INFO("Create group %d of %s. bitmap page=%d", group, file_name_.c_str(), page_num);
   return RC::SUCCESS;
 }
 
-RC BufferPoolManager::open_file(const char *_file_name, DiskBufferPool *& _bp)
+RC DiskBufferPool::load_space_map()
 {
-  std::string file_name(_file_name);
-  
-  if (buffer_pools_.find(file_name) != buffer_pools_.end()) {
-    LOG_WARN("file already opened. file name=%s", _file_name);
-    return RC::BUFFERPOOL_OPEN;
+  space_map_.clear();
+
+  const int page_count = file_header_->page_count;
+  const int group_num = (page_count + space_map_.group_page_num() - 1) / space_map_.group_page_num();
+  space_map_.load_group(0, file_header_->bitmap, page_count);
+  if (group_num <= 1) {
+    return RC::SUCCESS;
   }
 
-  DiskBufferPool *bp = new DiskBufferPool(*this, frame_manager_);
-  RC rc = bp->open_file(_file_name);
-  if (rc != RC::SUCCESS) {
-    LOG_WARN("failed to open file name");
-    delete bp;
-    return rc;
+  // 先把所有分组的位图页一次读进来
+  std::vector<PageNum> bitmap_pages;
+  for (int group = 1; group < group_num; group++) {
+    bitmap_pages.push_back(space_map_.group_page(group));
   }
+  int loaded_num = 0;
+  prefetch_pages(bitmap_pages.data(), static_cast<int>(bitmap_pages.size()), loaded_num);
 
-  buffer_pools_.insert(std::pair<std::string, DiskBufferPool *>(file_name, bp));
-  fd_buffer_pools_.insert(std::pair<int, DiskBufferPool *>(bp->file_desc(), bp));
+  for (int group = 1; group < group_num; group++) {
+    Frame *bitmap_frame = nullptr;
+    char *bitmap = nullptr;
+    RC rc = get_group_bitmap(group, bitmap_frame, bitmap);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    space_map_.load_group(group, bitmap, page_count);
+    put_group_bitmap(bitmap_frame);
+  }
+  LOG_INFO("Load space map of %s. page count=%d, group num=%d", file_name_.c_str(), page_count, group_num);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
+{
+  PageIORequest request;
+  request.file_desc = file_desc_;
+  request.page_num = page_num;
+  request.page = &frame->page_;
+  request.page_size = page_size_;
+  const long begin_us = current_us();
+  RC rc = page_io_.read_pages(&request, 1);
+  stats_.read_latency.record(current_us() - begin_us);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to load page %s:%d, rc=%s", file_name_.c_str(), page_num, strrc(rc));
+    return rc;
+  }
+  if ((rc = verify_page(frame->page_, page_num)) != RC::SUCCESS) {
+    return rc;
+  }
+
+  // 没有写过的页面中页号是0，淘汰时要根据页号找到这个frame
+  frame->set_page_num(page_num);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::verify_page(const Page &page, PageNum page_num)
+{
+  const BufferPoolManager::ChecksumVerify mode = bp_manager_.checksum_verify();
+  if (mode == BufferPoolManager::ChecksumVerify::OFF) {
+    return RC::SUCCESS;
+  }
+
+  // 页号不对说明写到了错误的位置
+  bool ok = verify_page_checksum(page, page_size_);
+  if (ok && page.page_num != page_num && page.version != 0) {
+    ok = false;
+  }
+  if (ok) {
+    return RC::SUCCESS;
+  }
+
+  LOG_ERROR("Page %s:%d is corrupted. page num in page=%d, version=%d, checksum=%u, expect checksum=%u",
+            file_name_.c_str(), page_num, page.page_num, page.version, page.checksum, page_checksum(page, page_size_));
+  return mode == BufferPoolManager::ChecksumVerify::STRICT ? RC::BUFFERPOOL_PAGE_CORRUPTED : RC::SUCCESS;
+}
+
+RC DiskBufferPool::get_page_count(int *page_count)
+{
+  *page_count = file_header_->allocated_pages;
+  return RC::SUCCESS;
+}
+int DiskBufferPool::file_desc() const
+{
+  return file_desc_;
+}
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * 预读的统计信息，输出 loaded/hit/wasted 个数以及命中率
+ */
+class ReadAheadGauge : public Gauge
+{
+public:
+  ReadAheadGauge(BPFrameManager &frame_manager) : frame_manager_(frame_manager)
+  {
+    set_snapshot(new SnapshotBasic<std::string>());
+  }
+
+  virtual ~ReadAheadGauge()
+  {
+    delete snapshot_value_;
+  }
+
+  void snapshot() override
+  {
+    BPFrameManager::PrefetchStats &stats = frame_manager_.prefetch_stats();
+    const long loaded = stats.loaded.load();
+    const long hit = stats.hit.load();
+    const long wasted = stats.wasted.load();
+    char buf[128];
+    snprintf(buf, sizeof(buf), "loaded=%ld, hit=%ld, wasted=%ld, hit_rate=%.2lf%%",
+             loaded, hit, wasted, loaded > 0 ? hit * 100.0 / loaded : 0.0);
+    std::string value(buf);
+    static_cast<SnapshotBasic<std::string> *>(snapshot_value_)->setValue(value);
+  }
+
+private:
+  BPFrameManager &frame_manager_;
+};
+
+const char *BufferPoolManager::DEFAULT_POOL_NAME = "default";
+
+/**
+ * 页面大小对应的缓冲池的名字，比如 default.4K
+ */
+static std::string page_size_pool_name(int page_size)
+{
+  return std::string(BufferPoolManager::DEFAULT_POOL_NAME) + "." + std::to_string(page_size >> 10) + "K";
+}
+
+BufferPoolManager::BufferPoolManager()
+{
+  page_io_ = PageIO::create(get_properties()->get(CONF_IO_BACKEND, "sync", CONF_BUFFER_POOL_SECTION));
+  LOG_INFO("buffer pool uses %s page io", page_io_->name());
+
+  int partition_num = BPFrameManager::DEFAULT_PARTITION_NUM;
+  std::string partition_num_str = get_properties()->get(CONF_PARTITION_NUM, "", CONF_BUFFER_POOL_SECTION);
+  if (!partition_num_str.empty()) {
+    str_to_val(partition_num_str, partition_num);
+  }
+  std::string replace_policy = get_properties()->get(CONF_REPLACE_POLICY, "", CONF_BUFFER_POOL_SECTION);
+  if (replace_policy.empty()) {
+    replace_policy = BPFrameManager::DEFAULT_REPLACE_POLICY;
+  }
+
+  size_t size = DEFAULT_BUFFER_POOL_SIZE;
+  std::string size_str = get_properties()->get(CONF_SIZE, "", CONF_BUFFER_POOL_SECTION);
+  if (!size_str.empty() && !str_to_bytes(size_str, size)) {
+    LOG_WARN("invalid buffer pool size %s, use default %lu", size_str.c_str(), DEFAULT_BUFFER_POOL_SIZE);
+    size = DEFAULT_BUFFER_POOL_SIZE;
+  }
+
+  // 默认可以在线扩容到物理内存的大小
+  size_t max_size = static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::string max_size_str = get_properties()->get(CONF_MAX_SIZE, "", CONF_BUFFER_POOL_SECTION);
+  if (!max_size_str.empty() && !str_to_bytes(max_size_str, max_size)) {
+    LOG_WARN("invalid buffer pool max size %s, use size %lu", max_size_str.c_str(), size);
+    max_size = size;
+  }
+
+  FrameAllocator::Options options;
+  options.max_frame_num = max_size / BP_PAGE_SIZE;
+  options.populate = get_properties()->get(CONF_POPULATE, "false", CONF_BUFFER_POOL_SECTION) == "true";
+  options.huge_page = get_properties()->get(CONF_HUGE_PAGE, "false", CONF_BUFFER_POOL_SECTION) == "true";
+  if (get_properties()->get(CONF_NUMA_AWARE, "false", CONF_BUFFER_POOL_SECTION) == "true") {
+    options.numa_node_num = common::numa_node_num();
+  }
+
+  size_t frame_num = std::max(size / BP_PAGE_SIZE, static_cast<size_t>(1));
+  RC rc = frame_manager_.init(frame_num, partition_num, replace_policy.c_str(), options);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to init buffer pool. size=%lu, rc=%s", size, strrc(rc));
+    return;
+  }
+  pool_options_ = options;
+  partition_num_ = partition_num;
+  replace_policy_ = replace_policy;
+
+  page_size_pool_bytes_ = DEFAULT_PAGE_SIZE_POOL_SIZE;
+  std::string page_size_pool_str = get_properties()->get(CONF_PAGE_SIZE_POOL_SIZE, "", CONF_BUFFER_POOL_SECTION);
+  if (!page_size_pool_str.empty() && !str_to_bytes(page_size_pool_str, page_size_pool_bytes_)) {
+    LOG_WARN("invalid page size pool size %s, use default %lu",
+             page_size_pool_str.c_str(), DEFAULT_PAGE_SIZE_POOL_SIZE);
+    page_size_pool_bytes_ = DEFAULT_PAGE_SIZE_POOL_SIZE;
+  }
+
+  // 有名字的缓冲池，比如 Pools=hot,scan，每个缓冲池的参数在 [BufferPool.hot] 中，没有配置的使用默认缓冲池的参数
+  std::vector<std::string> pool_names;
+  split_string(get_properties()->get(CONF_POOLS, "", CONF_BUFFER_POOL_SECTION), ",", pool_names);
+  for (std::string &pool_name : pool_names) {
+    strip(pool_name);
+    if (pool_name.empty()) {
+      continue;
+    }
+    const std::string section = std::string(CONF_BUFFER_POOL_SECTION) + "." + pool_name;
+    size_t pool_size = size;
+    std::string pool_size_str = get_properties()->get(CONF_SIZE, "", section);
+    if (!pool_size_str.empty() && !str_to_bytes(pool_size_str, pool_size)) {
+      LOG_WARN("invalid size %s of buffer pool %s, use %lu", pool_size_str.c_str(), pool_name.c_str(), size);
+      pool_size = size;
+    }
+    int pool_partition_num = partition_num;
+    std::string pool_partition_str = get_properties()->get(CONF_PARTITION_NUM, "", section);
+    if (!pool_partition_str.empty()) {
+      str_to_val(pool_partition_str, pool_partition_num);
+    }
+    std::string pool_policy = get_properties()->get(CONF_REPLACE_POLICY, replace_policy, section);
+
+    rc = create_pool(pool_name.c_str(),
+                     std::max(pool_size / BP_PAGE_SIZE, static_cast<size_t>(1)),
+                     pool_partition_num,
+                     pool_policy.c_str());
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to create buffer pool %s, tables of this pool will use the default pool. rc=%s",
+               pool_name.c_str(), strrc(rc));
+    }
+  }
+
+  PageCleaner::Options cleaner_options;
+  std::string cleaner_str = get_properties()->get(CONF_CLEANER_THREAD_NUM, "", CONF_BUFFER_POOL_SECTION);
+  if (!cleaner_str.empty()) {
+    str_to_val(cleaner_str, cleaner_options.thread_num);
+  }
+  cleaner_str = get_properties()->get(CONF_CLEAN_RATIO, "", CONF_BUFFER_POOL_SECTION);
+  if (!cleaner_str.empty()) {
+    str_to_val(cleaner_str, cleaner_options.clean_ratio);
+  }
+  cleaner_str = get_properties()->get(CONF_CLEANER_INTERVAL, "", CONF_BUFFER_POOL_SECTION);
+  if (!cleaner_str.empty()) {
+    str_to_val(cleaner_str, cleaner_options.interval_ms);
+  }
+
+  std::string read_ahead_str = get_properties()->get(CONF_READ_AHEAD_PAGES, "", CONF_BUFFER_POOL_SECTION);
+  if (!read_ahead_str.empty()) {
+    int read_ahead_pages = DEFAULT_READ_AHEAD_PAGES;
+    str_to_val(read_ahead_str, read_ahead_pages);
+    set_read_ahead_pages(read_ahead_pages);
+  }
+  std::string checksum_verify = get_properties()->get(CONF_CHECKSUM_VERIFY, "strict", CONF_BUFFER_POOL_SECTION);
+  if (checksum_verify == "off") {
+    checksum_verify_ = ChecksumVerify::OFF;
+  } else if (checksum_verify == "warn") {
+    checksum_verify_ = ChecksumVerify::WARN;
+  } else {
+    if (checksum_verify != "strict") {
+      LOG_WARN("unknown checksum verify mode %s, use strict instead", checksum_verify.c_str());
+    }
+    checksum_verify_ = ChecksumVerify::STRICT;
+  }
+  LOG_INFO("buffer pool checksum verify mode: %s, crc32c hardware: %d",
+           checksum_verify.c_str(), crc32c_hardware_enabled());
+
+  double_write_ = get_properties()->get(CONF_DOUBLE_WRITE, "false", CONF_BUFFER_POOL_SECTION) == "true";
+  split_string(get_properties()->get(CONF_DIRECT_IO, "", CONF_BUFFER_POOL_SECTION), ", ", direct_io_dbs_);
+  split_string(get_properties()->get(CONF_MMAP_SCAN, "", CONF_BUFFER_POOL_SECTION), ", ", mmap_scan_dbs_);
+
+  BufferPoolWarmer::Options warmer_options;
+  warmer_options.enabled = get_properties()->get(CONF_WARM_UP, "false", CONF_BUFFER_POOL_SECTION) == "true";
+  std::string warm_up_str = get_properties()->get(CONF_WARM_UP_DUMP_INTERVAL, "", CONF_BUFFER_POOL_SECTION);
+  if (!warm_up_str.empty()) {
+    str_to_val(warm_up_str, warmer_options.dump_interval_sec);
+  }
+  warm_up_str = get_properties()->get(CONF_WARM_UP_BATCH_PAGES, "", CONF_BUFFER_POOL_SECTION);
+  if (!warm_up_str.empty()) {
+    str_to_val(warm_up_str, warmer_options.batch_pages);
+  }
+  warmer_ = new BufferPoolWarmer(*this, warmer_options);
+
+  read_ahead_gauge_ = new ReadAheadGauge(frame_manager_);
+  get_metrics_registry().register_metric(READ_AHEAD_METRIC_TAG, read_ahead_gauge_);
+
+  // 线程数配置成0表示不启用后台刷脏
+  if (cleaner_options.thread_num > 0) {
+    page_cleaner_ = new PageCleaner(*this, cleaner_options);
+    rc = page_cleaner_->start();
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to start page cleaner. rc=%s", strrc(rc));
+      delete page_cleaner_;
+      page_cleaner_ = nullptr;
+    }
+  }
+
+  // 间隔配置成0表示不做周期性的检查点
+  Checkpointer::Options checkpointer_options;
+  std::string checkpoint_str = get_properties()->get(CONF_CHECKPOINT_INTERVAL, "", CONF_BUFFER_POOL_SECTION);
+  if (!checkpoint_str.empty()) {
+    str_to_val(checkpoint_str, checkpointer_options.interval_sec);
+  }
+  if (checkpointer_options.interval_sec > 0) {
+    checkpointer_ = new Checkpointer(*this, checkpointer_options);
+    rc = checkpointer_->start();
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to start checkpointer. rc=%s", strrc(rc));
+      delete checkpointer_;
+      checkpointer_ = nullptr;
+    }
+  }
+}
+
+BufferPoolManager::~BufferPoolManager()
+{
+  if (warmer_ != nullptr) {
+    warmer_->stop();
+    delete warmer_;
+    warmer_ = nullptr;
+  }
+
+  if (checkpointer_ != nullptr) {
+    checkpointer_->stop();
+    delete checkpointer_;
+    checkpointer_ = nullptr;
+  }
+
+  if (page_cleaner_ != nullptr) {
+    page_cleaner_->stop();
+    delete page_cleaner_;
+    page_cleaner_ = nullptr;
+  }
+
+  if (read_ahead_gauge_ != nullptr) {
+    get_metrics_registry().unregister(READ_AHEAD_METRIC_TAG);
+    delete read_ahead_gauge_;
+    read_ahead_gauge_ = nullptr;
+  }
+
+  std::unordered_map<std::string, DiskBufferPool *> tmp_bps;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+    tmp_bps.swap(buffer_pools_);
+    fd_buffer_pools_.clear();
+  }
+
+  for (auto &iter : tmp_bps) {
+    delete iter.second;
+  }
+
+  for (auto &iter : named_pools_) {
+    delete iter.second;
+  }
+  named_pools_.clear();
+
+  for (auto &iter : page_size_pools_) {
+    delete iter.second;
+  }
+  page_size_pools_.clear();
+
+  if (double_write_buffer_ != nullptr) {
+    LOG_INFO("double write buffer written pages=%ld, batches=%ld",
+             double_write_buffer_->written_pages(), double_write_buffer_->written_batches());
+    delete double_write_buffer_;
+    double_write_buffer_ = nullptr;
+  }
+
+  delete page_io_;
+  page_io_ = nullptr;
+}
+
+RC BufferPoolManager::create_file(const char *file_name, int page_size)
+{
+  if (!BPFileHeader::valid_page_size(page_size)) {
+    LOG_WARN("Invalid page size %d of %s. page size should be a power of 2 between %d and %d",
+             page_size, file_name, BP_MIN_PAGE_SIZE, BP_MAX_PAGE_SIZE);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int fd = open(file_name, O_RDWR | O_CREAT | O_EXCL, S_IREAD | S_IWRITE);
+  if (fd < 0) {
+    LOG_ERROR("Failed to create %s, due to %s.", file_name, strerror(errno));
+    return RC::SCHEMA_DB_EXIST;
+  }
+
+  close(fd);
+
+  /**
+   * Here don't care about the failure
+   */
+  fd = open(file_name, O_RDWR);
+  if (fd < 0) {
+    LOG_ERROR("Failed to open for readwrite %s, due to %s.", file_name, strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  std::vector<char> buffer(page_size, 0);
+  Page &page = *reinterpret_cast<Page *>(buffer.data());
+
+  BPFileHeader *file_header = (BPFileHeader *)page.data;
+  file_header->allocated_pages = 1;
+  file_header->page_count = 1;
+  file_header->page_size = page_size;
+
+  char *bitmap = file_header->bitmap;
+  bitmap[0] |= 0x01;
+  stamp_page(page, page_size);
+  if (pwriten(fd, buffer.data(), page_size, 0) != 0) {
+    LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
+    close(fd);
+    return RC::IOERR_WRITE;
+  }
+
+  close(fd);
+  LOG_INFO("Successfully create %s. page size=%d", file_name, page_size);
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::open_double_write(const char *file_name)
+{
+  if (double_write_buffer_ != nullptr) {
+    LOG_WARN("double write buffer has already been opened");
+    return RC::SUCCESS;
+  }
+
+  // 之前开启过双写，这次启动前关闭了，也需要修复
+  if (!double_write_ && ::access(file_name, F_OK) != 0) {
+    return RC::SUCCESS;
+  }
+
+  DoubleWriteBuffer *double_write_buffer = new DoubleWriteBuffer();
+  RC rc = double_write_buffer->open(file_name);
+  if (rc != RC::SUCCESS) {
+    delete double_write_buffer;
+    return rc;
+  }
+
+  int repaired_num = 0;
+  rc = double_write_buffer->recover(repaired_num);
+  if (rc != RC::SUCCESS || !double_write_) {
+    delete double_write_buffer;
+    // 没有开启双写时数据文件会直接写，双写文件中的页面就过时了，不能留到下次启动时用来修复
+    if (rc == RC::SUCCESS) {
+      ::unlink(file_name);
+    }
+    return rc;
+  }
+
+  double_write_buffer_ = double_write_buffer;
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::create_pool(const char *name, size_t frame_num, int partition_num, const char *replace_policy)
+{
+  if (is_blank(name) || 0 == strcasecmp(name, DEFAULT_POOL_NAME)) {
+    LOG_WARN("invalid buffer pool name: %s", name);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+  if (named_pools_.find(name) != named_pools_.end()) {
+    LOG_WARN("buffer pool %s already exists", name);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 有名字的缓冲池不支持在线调整大小
+  FrameAllocator::Options options = pool_options_;
+  options.max_frame_num = frame_num;
+  BPFrameManager *frame_manager = new BPFrameManager(name);
+  RC rc = frame_manager->init(frame_num, partition_num, replace_policy, options);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to init buffer pool %s. frame num=%lu, rc=%s", name, frame_num, strrc(rc));
+    delete frame_manager;
+    return rc;
+  }
+
+  named_pools_.emplace(name, frame_manager);
+  LOG_INFO("create buffer pool %s. frame num=%lu, partition num=%d, replace policy=%s",
+           name, frame_num, partition_num, replace_policy);
+  return RC::SUCCESS;
+}
+
+BPFrameManager *BufferPoolManager::find_pool(const char *name)
+{
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+  return find_pool_locked(name);
+}
+
+BPFrameManager *BufferPoolManager::find_pool_locked(const char *name)
+{
+  if (is_blank(name) || 0 == strcasecmp(name, DEFAULT_POOL_NAME)) {
+    return &frame_manager_;
+  }
+  auto iter = named_pools_.find(name);
+  return iter == named_pools_.end() ? nullptr : iter->second;
+}
+
+void BufferPoolManager::all_pools(std::vector<std::pair<std::string, BPFrameManager *>> &pools)
+{
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+  pools.emplace_back(DEFAULT_POOL_NAME, &frame_manager_);
+  for (auto &iter : named_pools_) {
+    pools.emplace_back(iter.first, iter.second);
+  }
+  for (auto &iter : page_size_pools_) {
+    pools.emplace_back(page_size_pool_name(iter.first), iter.second);
+  }
+}
+
+BPFrameManager *BufferPoolManager::page_size_pool(int page_size)
+{
+  std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+  return page_size_pool_locked(page_size);
+}
+
+BPFrameManager *BufferPoolManager::page_size_pool_locked(int page_size)
+{
+  if (page_size == BP_PAGE_SIZE) {
+    return &frame_manager_;
+  }
+  if (!BPFileHeader::valid_page_size(page_size)) {
+    return nullptr;
+  }
+
+  auto iter = page_size_pools_.find(page_size);
+  if (iter != page_size_pools_.end()) {
+    return iter->second;
+  }
+
+  // 这些缓冲池不支持在线调整大小
+  const std::string name = page_size_pool_name(page_size);
+  const size_t frame_num = std::max(page_size_pool_bytes_ / page_size, static_cast<size_t>(1));
+  FrameAllocator::Options options = pool_options_;
+  options.max_frame_num = frame_num;
+  options.page_size = page_size;
+  BPFrameManager *frame_manager = new BPFrameManager(name.c_str());
+  RC rc = frame_manager->init(frame_num, partition_num_, replace_policy_.c_str(), options);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to init buffer pool %s. frame num=%lu, rc=%s", name.c_str(), frame_num, strrc(rc));
+    delete frame_manager;
+    return nullptr;
+  }
+
+  page_size_pools_.emplace(page_size, frame_manager);
+  LOG_INFO("create buffer pool %s. frame num=%lu, partition num=%d, replace policy=%s",
+           name.c_str(), frame_num, partition_num_, replace_policy_.c_str());
+  return frame_manager;
+}
+
+/**
+ * 读取文件头中记录的页面大小，文件头在第一个页面的数据区的开始位置
+ */
+static RC read_file_page_size(const char *file_name, int &page_size)
+{
+  int fd = open(file_name, O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  BPFileHeader file_header;
+  const int ret = preadn(fd, &file_header, sizeof(file_header), offsetof(Page, data));
+  close(fd);
+  if (ret != 0) {
+    LOG_ERROR("Failed to read header of %s, due to %s.", file_name, strerror(errno));
+    return RC::IOERR_READ;
+  }
+  if (!BPFileHeader::valid_page_size(file_header.page_size)) {
+    LOG_ERROR("Invalid page size of %s: %d", file_name, file_header.page_size);
+    return RC::BUFFERPOOL_FILEERR;
+  }
+  page_size = file_header.page_size;
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::open_file(const char *_file_name, DiskBufferPool *& _bp, const char *pool_name)
+{
+  std::string file_name(_file_name);
+
+  std::string dir;
+  getDirName(_file_name, dir);
+  int page_size = BP_PAGE_SIZE;
+  RC rc = read_file_page_size(_file_name, page_size);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  BPFrameManager *frame_manager = nullptr;
+  std::string actual_pool_name;
+  bool direct_io = false;
+  bool mmap_scan = false;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+    if (buffer_pools_.find(file_name) != buffer_pools_.end() || opening_files_.count(file_name) > 0) {
+      LOG_WARN("file already opened. file name=%s", _file_name);
+      return RC::BUFFERPOOL_OPEN;
+    }
+
+    direct_io = direct_io_dirs_.count(dir) > 0;
+    mmap_scan = mmap_scan_dirs_.count(dir) > 0;
+    if (page_size != BP_PAGE_SIZE) {
+      frame_manager = page_size_pool_locked(page_size);
+      if (frame_manager == nullptr) {
+        return RC::NOMEM;
+      }
+      actual_pool_name = page_size_pool_name(page_size);
+    } else {
+      frame_manager = find_pool_locked(pool_name);
+      if (frame_manager == nullptr) {
+        LOG_WARN("buffer pool %s does not exist, file %s uses the default pool", pool_name, _file_name);
+        frame_manager = &frame_manager_;
+      }
+      actual_pool_name = frame_manager == &frame_manager_ ? DEFAULT_POOL_NAME : pool_name;
+    }
+    opening_files_.insert(file_name);
+  }
+
+  // 打开文件时会读取文件头和位图页面，缓冲池满了的时候要淘汰脏页，刷脏页时需要加读锁，所以这里不能持有锁。
+  // 缓冲池只增不减，frame_manager在解锁之后仍然有效
+  DiskBufferPool *bp = new DiskBufferPool(*this, *frame_manager, actual_pool_name);
+  rc = bp->open_file(_file_name, direct_io, mmap_scan);
+
+  std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+  opening_files_.erase(file_name);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open file name");
+    lock_guard.unlock();
+    delete bp;
+    return rc;
+  }
+
+  buffer_pools_.insert(std::pair<std::string, DiskBufferPool *>(file_name, bp));
+  fd_buffer_pools_.insert(std::pair<int, DiskBufferPool *>(bp->file_desc(), bp));
   _bp = bp;
   return RC::SUCCESS;
 }
@@ -660,23 +2390,105 @@ RC BufferPoolManager::open_file(const char *_file_name, DiskBufferPool *& _bp)
 RC BufferPoolManager::close_file(const char *_file_name)
 {
   std::string file_name(_file_name);
+  DiskBufferPool *bp = nullptr;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+    auto iter = buffer_pools_.find(file_name);
+    if (iter == buffer_pools_.end()) {
+      LOG_WARN("file has not opened: %s", _file_name);
+      return RC::INTERNAL;
+    }
+
+    int fd = iter->second->file_desc();
+    fd_buffer_pools_.erase(fd);
+
+    bp = iter->second;
+    buffer_pools_.erase(iter);
+  }
+
+  // 关闭文件时会再次调用close_file，不能持有锁
+  delete bp;
+  return RC::SUCCESS;
+}
+
+bool BufferPoolManager::direct_io_configured(const char *db_name) const
+{
+  return direct_io_dbs_.count("*") > 0 || direct_io_dbs_.count(db_name) > 0;
+}
+
+void BufferPoolManager::set_direct_io_dir(const std::string &dir, bool direct_io)
+{
+  std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+  if (direct_io) {
+    direct_io_dirs_.insert(dir);
+  } else {
+    direct_io_dirs_.erase(dir);
+  }
+}
+
+bool BufferPoolManager::mmap_scan_configured(const char *db_name) const
+{
+  return mmap_scan_dbs_.count("*") > 0 || mmap_scan_dbs_.count(db_name) > 0;
+}
+
+void BufferPoolManager::set_mmap_scan_dir(const std::string &dir, bool mmap_scan)
+{
+  std::unique_lock<std::shared_timed_mutex> lock_guard(lock_);
+  if (mmap_scan) {
+    mmap_scan_dirs_.insert(dir);
+  } else {
+    mmap_scan_dirs_.erase(dir);
+  }
+}
+
+void BufferPoolManager::opened_files(std::unordered_map<int, std::string> &files)
+{
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+  for (auto &iter : fd_buffer_pools_) {
+    files.emplace(iter.first, iter.second->file_name());
+  }
+}
+
+RC BufferPoolManager::prefetch_pages(const std::string &file_name, const PageNum *page_nums, int num, int &loaded_num)
+{
+  loaded_num = 0;
+
+  // 持有读锁，读取的过程中文件不会被关闭
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
   auto iter = buffer_pools_.find(file_name);
   if (iter == buffer_pools_.end()) {
-    LOG_WARN("file has not opened: %s", _file_name);
-    return RC::INTERNAL;
+    return RC::BUFFERPOOL_CLOSED;
   }
 
-  int fd = iter->second->file_desc();
-  fd_buffer_pools_.erase(fd);
-
+  // 只使用文件所在缓冲池中空闲的frame
   DiskBufferPool *bp = iter->second;
-  buffer_pools_.erase(iter);
-  delete bp;
-  return RC::SUCCESS;
+  num = static_cast<int>(std::min(static_cast<size_t>(num), bp->frame_manager().free_frame_num()));
+  if (num <= 0) {
+    return RC::SUCCESS;
+  }
+  return bp->prefetch_pages(page_nums, num, loaded_num);
+}
+
+void BufferPoolManager::record_eviction(int file_desc)
+{
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+  auto iter = fd_buffer_pools_.find(file_desc);
+  if (iter != fd_buffer_pools_.end()) {
+    iter->second->stats().evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void BufferPoolManager::foreach_buffer_pool(const std::function<void(DiskBufferPool &)> &func)
+{
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+  for (auto &iter : buffer_pools_) {
+    func(*iter.second);
+  }
 }
 
 RC BufferPoolManager::flush_page(Frame &frame)
 {
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
   int fd = frame.file_desc();
   auto iter = fd_buffer_pools_.find(fd);
   if (iter == fd_buffer_pools_.end()) {
@@ -684,8 +2496,260 @@ RC BufferPoolManager::flush_page(Frame &frame)
     return RC::INTERNAL;
   }
 
+  RC rc = sync_log();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to sync log before flush page. rc=%s", strrc(rc));
+    return rc;
+  }
+
   DiskBufferPool *bp = iter->second;
-  return bp->flush_page(frame);
+  if (page_cleaner_ == nullptr) {
+    return bp->flush_page(frame);
+  }
+
+  // 前台淘汰的时候不得不等待写脏页，说明后台刷脏没有跟上，唤醒后台线程
+  struct timespec begin, end;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  rc = bp->flush_page(frame);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  page_cleaner_->record_stall((end.tv_sec - begin.tv_sec) * 1000000L + (end.tv_nsec - begin.tv_nsec) / 1000);
+  page_cleaner_->wakeup();
+  return rc;
+}
+
+int BufferPoolManager::flush_dirty_frames(BPFrameManager &frame_manager, int partition_index, size_t max_num,
+                                          int64_t max_recovery_lsn)
+{
+  // 持有读锁，刷盘的过程中文件不会被关闭
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+
+  std::vector<Frame *> frames;
+  frame_manager.pin_dirty_frames(partition_index, max_num, frames, max_recovery_lsn);
+  if (frames.empty()) {
+    return 0;
+  }
+
+  std::sort(frames.begin(), frames.end(), [](const Frame *f1, const Frame *f2) {
+    if (f1->file_desc() != f2->file_desc()) {
+      return f1->file_desc() < f2->file_desc();
+    }
+    return f1->page_num() < f2->page_num();
+  });
+
+  int flushed_num = 0;
+  RC rc = sync_log();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to sync log before flush pages. rc=%s", strrc(rc));
+  }
+
+  std::vector<Frame *> file_frames;
+  size_t begin = 0;
+  while (begin < frames.size()) {
+    const int fd = frames[begin]->file_desc();
+    size_t end = begin;
+    while (end < frames.size() && frames[end]->file_desc() == fd) {
+      end++;
+    }
+
+    auto iter = fd_buffer_pools_.find(fd);
+    if (iter == fd_buffer_pools_.end()) {
+      // 已经关闭的文件留下来的页面
+      for (size_t i = begin; i < end; i++) {
+        frame_manager.unpin_frame(frames[i]);
+      }
+      begin = end;
+      continue;
+    }
+
+    DiskBufferPool *bp = iter->second;
+    file_frames.assign(frames.begin() + begin, frames.begin() + end);
+    int num = 0;
+    if (rc == RC::SUCCESS && bp->flush_pages(file_frames, num) != RC::SUCCESS) {
+      LOG_WARN("failed to flush pages of fd %d", fd);
+    }
+    flushed_num += num;
+
+    for (Frame *frame : file_frames) {
+      bp->unpin_page(frame);
+    }
+    begin = end;
+  }
+  return flushed_num;
+}
+
+int BufferPoolManager::flush_frames_before(int64_t lsn)
+{
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  all_pools(pools);
+
+  int flushed_num = 0;
+  for (auto &pool : pools) {
+    BPFrameManager &frame_manager = *pool.second;
+    for (int i = 0; i < frame_manager.partition_num(); i++) {
+      flushed_num += flush_dirty_frames(frame_manager, i, std::numeric_limits<size_t>::max(), lsn);
+    }
+  }
+
+  // 文件头是一直pin住的，上面不会写它
+  RC rc = sync_log();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to sync log before flush header pages. rc=%s", strrc(rc));
+    return flushed_num;
+  }
+  foreach_buffer_pool([lsn, &flushed_num](DiskBufferPool &bp) {
+    bool flushed = false;
+    if (bp.flush_header_page(lsn, flushed) != RC::SUCCESS) {
+      LOG_WARN("failed to flush header page of %s", bp.file_name().c_str());
+    }
+    flushed_num += flushed ? 1 : 0;
+  });
+  return flushed_num;
+}
+
+int64_t BufferPoolManager::min_recovery_lsn()
+{
+  // 先取下一条日志的LSN再遍历，遍历之后才变脏的页面，恢复LSN不会比它小
+  int64_t lsn = next_lsn();
+
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  all_pools(pools);
+
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+  auto opened = [this](int fd) { return fd_buffer_pools_.count(fd) > 0; };
+  for (auto &pool : pools) {
+    BPFrameManager &frame_manager = *pool.second;
+    for (int i = 0; i < frame_manager.partition_num(); i++) {
+      lsn = frame_manager.min_recovery_lsn(i, lsn, opened);
+    }
+  }
+  return lsn;
+}
+
+RC BufferPoolManager::checkpoint(int &flushed_num)
+{
+  std::lock_guard<std::mutex> checkpoint_guard(checkpoint_lock_);
+  const int64_t checkpoint_begin_lsn = next_lsn();
+  flushed_num = flush_frames_before(last_checkpoint_lsn_);
+  const int64_t lsn = min_recovery_lsn();
+
+  RC rc = RC::SUCCESS;
+  {
+    std::lock_guard<std::mutex> lock_guard(log_syncer_lock_);
+    for (auto &iter : log_checkpointers_) {
+      RC tmp_rc = iter.second(lsn);
+      if (tmp_rc != RC::SUCCESS) {
+        LOG_WARN("failed to checkpoint log of %s. rc=%s", iter.first.c_str(), strrc(tmp_rc));
+        rc = tmp_rc;
+      }
+    }
+  }
+  last_checkpoint_lsn_ = checkpoint_begin_lsn;
+  LOG_DEBUG("checkpoint. min recovery lsn=%ld, next lsn=%ld, flushed=%d", lsn, checkpoint_begin_lsn, flushed_num);
+  return rc;
+}
+
+void BufferPoolManager::register_log_syncer(const std::string &name, const LogSyncer &log_syncer)
+{
+  std::lock_guard<std::mutex> lock_guard(log_syncer_lock_);
+  log_syncers_[name] = log_syncer;
+}
+
+void BufferPoolManager::unregister_log_syncer(const std::string &name)
+{
+  std::lock_guard<std::mutex> lock_guard(log_syncer_lock_);
+  log_syncers_.erase(name);
+}
+
+void BufferPoolManager::register_log_checkpointer(const std::string &name, const LogCheckpointer &checkpointer)
+{
+  std::lock_guard<std::mutex> lock_guard(log_syncer_lock_);
+  log_checkpointers_[name] = checkpointer;
+}
+
+void BufferPoolManager::unregister_log_checkpointer(const std::string &name)
+{
+  std::lock_guard<std::mutex> lock_guard(log_syncer_lock_);
+  log_checkpointers_.erase(name);
+}
+
+std::atomic<BufferPoolManager::LsnSource> BufferPoolManager::lsn_source_{nullptr};
+std::atomic<int> BufferPoolManager::redo_count_{0};
+
+void BufferPoolManager::set_lsn_source(LsnSource lsn_source)
+{
+  lsn_source_.store(lsn_source);
+}
+
+int64_t BufferPoolManager::next_lsn()
+{
+  LsnSource lsn_source = lsn_source_.load(std::memory_order_relaxed);
+  return lsn_source == nullptr ? 0 : lsn_source();
+}
+
+void BufferPoolManager::begin_redo()
+{
+  redo_count_.fetch_add(1);
+}
+
+void BufferPoolManager::end_redo()
+{
+  redo_count_.fetch_sub(1);
+}
+
+int64_t BufferPoolManager::flush_lsn()
+{
+  return redo_count_.load() > 0 ? 0 : next_lsn();
+}
+
+RC BufferPoolManager::sync_log()
+{
+  // 页面上还没有记录LSN，不知道页面依赖哪些日志，只能把所有已经生成的日志都刷盘
+  std::lock_guard<std::mutex> lock_guard(log_syncer_lock_);
+  for (auto &iter : log_syncers_) {
+    RC rc = iter.second();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::resize(size_t bytes)
+{
+  const size_t frame_num = bytes / BP_PAGE_SIZE;
+  RC rc = frame_manager_.resize(frame_num);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to resize buffer pool to %lu bytes. max size=%lu, rc=%s", bytes, max_capacity(), strrc(rc));
+    return rc;
+  }
+
+  // 缩容时，尽量把超出容量的页面淘汰掉，归还内存。被pin住的页面等释放的时候再归还
+  std::list<Frame *> frames = frame_manager_.find_beyond_capacity_list();
+  std::shared_lock<std::shared_timed_mutex> lock_guard(lock_);
+  int purged_num = 0;
+  for (Frame *frame : frames) {
+    auto iter = fd_buffer_pools_.find(frame->file_desc());
+    if (iter == fd_buffer_pools_.end()) {
+      continue;
+    }
+    if (iter->second->purge_page(frame->page_num()) == RC::SUCCESS) {
+      purged_num++;
+    }
+  }
+
+  LOG_INFO("resize buffer pool to %lu bytes. frames beyond capacity=%d, purged=%d",
+           capacity(), (int)frames.size(), purged_num);
+  return RC::SUCCESS;
+}
+
+size_t BufferPoolManager::capacity() const
+{
+  return frame_manager_.total_frame_num() * BP_PAGE_SIZE;
+}
+
+size_t BufferPoolManager::max_capacity() const
+{
+  return frame_manager_.max_frame_num() * BP_PAGE_SIZE;
 }
 
 static BufferPoolManager *default_bpm = nullptr;
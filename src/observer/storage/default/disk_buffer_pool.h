@@ -21,54 +21,190 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 #include <time.h>
 #include <string>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <set>
 #include <mutex>
+#include <shared_mutex>
+#include <memory>
+#include <atomic>
 #include <unordered_map>
+#include <map>
+#include <limits>
 
 #include "rc.h"
 #include "defs.h"
-#include "common/mm/mem_pool.h"
-#include "common/lang/lru_cache.h"
 #include "common/lang/bitmap.h"
+#include "common/lang/rw_latch.h"
+#include "common/metrics/latency_histogram.h"
+#include "storage/default/frame_replacer.h"
+#include "storage/default/frame_allocator.h"
+#include "storage/default/space_map.h"
 
 class BufferPoolManager;
 class DiskBufferPool;
+class DoubleWriteBuffer;
+class BufferPoolWarmer;
+class PageIO;
+struct PageIORequest;
+
+namespace common {
+class Gauge;
+}
 
 //
 #define BP_INVALID_PAGE_NUM (-1)
 #define BP_PAGE_SIZE (1 << 14)
-#define BP_PAGE_DATA_SIZE (BP_PAGE_SIZE - sizeof(PageNum))
+#define BP_PAGE_HEADER_SIZE 24
+#define BP_PAGE_DATA_SIZE (BP_PAGE_SIZE - BP_PAGE_HEADER_SIZE)
+
+/**
+ * 每个文件的页面大小在创建时指定(BufferPoolManager::create_file)，记录在文件头中，
+ * 必须是[BP_MIN_PAGE_SIZE, BP_MAX_PAGE_SIZE]之间2的幂。没有指定时使用BP_PAGE_SIZE
+ */
+#define BP_MIN_PAGE_SIZE (1 << 12)
+#define BP_MAX_PAGE_SIZE (1 << 16)
 #define BP_FILE_SUB_HDR_SIZE (sizeof(BPFileSubHeader))
 
+/**
+ * 使用O_DIRECT读写时，内存地址需要按照磁盘的逻辑块大小对齐。
+ * frame中的页面按照这个大小对齐，逻辑块更大的磁盘上退化成使用page cache的读写
+ */
+#define BP_DIRECT_IO_ALIGN 512
+
+/**
+ * 页面格式的版本号，页面格式变化时增加
+ */
+#define BP_PAGE_FORMAT_VERSION 1
+
+/**
+ * 每个页面都以一个固定的页头开始，后面是页面的数据。
+ * 页面写盘之前计算校验和(stamp_page)，读取时校验(verify_page_checksum)，
+ * 这样就可以发现只写了一部分的页面(torn write)或者磁盘上损坏的数据，而不是读到错误的记录或者索引节点。
+ * 结构体按照默认的页面大小定义，其它大小的页面只是data的长度不同，是page_size - BP_PAGE_HEADER_SIZE
+ */
 struct Page {
-  PageNum page_num;
-  char data[BP_PAGE_DATA_SIZE];
+  PageNum  page_num;
+  uint32_t checksum;  //! 除了这个字段之外整个页面的CRC32C
+  int64_t  lsn;       //! LSN小于这个值的日志所做的修改都已经在页面中了，刷盘时标记，回放日志时据此跳过
+  uint16_t version;   //! 页面格式的版本号，参考BP_PAGE_FORMAT_VERSION
+  uint16_t flags;
+  uint32_t reserved;
+  char     data[BP_PAGE_DATA_SIZE];
 };
-// sizeof(Page) should be equal to BP_PAGE_SIZE
+static_assert(sizeof(Page) == BP_PAGE_SIZE, "sizeof(Page) should be equal to BP_PAGE_SIZE");
+
+uint32_t page_checksum(const Page &page, int page_size = BP_PAGE_SIZE);
+
+/**
+ * 写盘之前调用，设置页面格式的版本号和校验和
+ */
+void stamp_page(Page &page, int page_size = BP_PAGE_SIZE);
 
 /**
- * BufferPool的文件第一个页面，存放一些元数据信息，包括了后面每页的分配信息。
- * TODO 1. 当前的做法，只能分配比较少的页面，你可以扩展一下，支持更多的页面或无限多的页面吗？
- *         可以参考Linux ext(n)和Windows NTFS等文件系统
- *      2. 当前使用bitmap存放页面分配情况，但是这种方法在页面非常多的时候，查找空闲页面的
- *         效率非常低，你有办法优化吗？
+ * 检查页面格式的版本号和校验和。文件扩展之后还没有写过的全0页面也认为是完好的
+ */
+bool verify_page_checksum(const Page &page, int page_size = BP_PAGE_SIZE);
+
+/**
+ * BufferPool的文件第一个页面，存放一些元数据信息，以及第0个分组的页面分配信息。
+ * 一个页面的位图能够表示的页面个数有限，所以文件按照GROUP_PAGE_NUM个页面划分成多个分组(类似ext4的block group)，
+ * 每个分组的第一个页面存放这个分组的位图：第0个分组的位图就在文件头中，其它分组使用BPGroupHeader。
+ * 分组的位置是固定的，根据页号就可以直接算出它的位图在哪个页面。
+ * 查找空闲页面使用内存中的摘要(参考BPSpaceMap)，不需要逐位扫描位图。
  */
 struct BPFileHeader {
   int32_t page_count;        //! 当前文件一共有多少个页面
-  int32_t allocated_pages;   //! 已经分配了多少个页面
-  char    bitmap[0];         //! 页面分配位图, 第0个页面(就是当前页面)，总是1
+  int32_t allocated_pages;   //! 已经分配了多少个页面，包括各个分组的位图页
+  int32_t page_size;         //! 文件中每个页面的大小，创建文件时确定，之后不能修改
+  int32_t reserved;
+  char    bitmap[0];         //! 第0个分组的页面分配位图, 第0个页面(就是当前页面)，总是1
+
+  static constexpr int FIELDS_SIZE = 16;
+
+  /**
+   * 每个分组的页面个数，即一个页面中bitmap的字节数 乘以8
+   */
+  static constexpr int group_page_num(int page_size)
+  {
+    return (page_size - BP_PAGE_HEADER_SIZE - FIELDS_SIZE) * 8;
+  }
+  static const int GROUP_PAGE_NUM = (BP_PAGE_SIZE - BP_PAGE_HEADER_SIZE - FIELDS_SIZE) * 8;
 
   /**
-   * 能够分配的最大的页面个数，即bitmap的字节数 乘以8
+   * 页面大小是否合法，参考BP_MIN_PAGE_SIZE和BP_MAX_PAGE_SIZE
    */
-  static const int MAX_PAGE_NUM = (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages)) * 8;
+  static bool valid_page_size(int page_size)
+  {
+    return page_size >= BP_MIN_PAGE_SIZE && page_size <= BP_MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+  }
 };
 
+/**
+ * 第0个之外的分组的第一个页面，布局与BPFileHeader相同，位图的大小也相同
+ */
+struct BPGroupHeader {
+  int32_t group;             //! 分组的编号
+  int32_t allocated_pages;   //! 这个分组中已经分配了多少个页面，包括当前页面
+  int32_t reserved[2];
+  char    bitmap[0];         //! 这个分组的页面分配位图，第0个页面(就是当前页面)，总是1
+};
+static_assert(offsetof(BPFileHeader, bitmap) == BPFileHeader::FIELDS_SIZE, "bitmap offset of file header");
+static_assert(offsetof(BPGroupHeader, bitmap) == BPFileHeader::FIELDS_SIZE, "bitmap offset of group header");
+
+class BPFrameId
+{
+public: 
+  BPFrameId(int file_desc, PageNum page_num) :
+    file_desc_(file_desc), page_num_(page_num)
+  {}
+
+  bool equal_to(const BPFrameId &other) const
+  {
+    return file_desc_ == other.file_desc_ && page_num_ == other.page_num_;
+  }
+
+  bool operator== (const BPFrameId &other) const
+  {
+    return this->equal_to(other);
+  }
+
+  size_t hash() const
+  {
+    return static_cast<size_t>(file_desc_) << 32L | page_num_;
+  }
+
+  /**
+   * 文件描述符和页号拼成的一个整数，可以原子地读写
+   */
+  uint64_t key() const
+  {
+    return static_cast<uint64_t>(static_cast<uint32_t>(file_desc_)) << 32 | static_cast<uint32_t>(page_num_);
+  }
+
+  static const uint64_t INVALID = ~0ULL;
+
+  int file_desc() const { return file_desc_; }
+  PageNum page_num() const { return page_num_; }
+
+private:
+  int file_desc_;
+  PageNum page_num_;
+};
+
+/**
+ * 缓冲池中的一个页面。
+ * page_必须是最后一个成员：页面大小不是BP_PAGE_SIZE的缓冲池中，frame按照实际的页面大小从arena中切分(参考FrameAllocator)，
+ * 这时page_.data的实际长度是page_size - BP_PAGE_HEADER_SIZE，只能按照所属文件的页面大小访问
+ */
 class Frame
 {
 public:
-  void clear_page()
+  void clear_page(int page_size)
   {
-    memset(&page_, 0, sizeof(page_));
+    memset(&page_, 0, page_size);
   }
 
   PageNum page_num() const
@@ -81,12 +217,37 @@ public:
     page_.page_num = page_num;
   }
 
+  /**
+   * 页面从磁盘读上来时的LSN。刷盘时写入的是复制页面那一刻的下一条日志的LSN(参考copy_page_for_flush)，
+   * 内存中的这个值不会跟着修改变化
+   */
+  int64_t lsn() const
+  {
+    return page_.lsn;
+  }
+
+  void set_lsn(int64_t lsn)
+  {
+    page_.lsn = lsn;
+  }
+
   /**
    * 标记指定页面为“脏”页。如果修改了页面的内容，则应调用此函数，
-   * 以便该页面被淘汰出缓冲区时系统将新的页面数据写入磁盘文件
+   * 以便该页面被淘汰出缓冲区时系统将新的页面数据写入磁盘文件。
+   * 页面从干净变脏时记录恢复LSN，修改页面的日志总是在修改之后生成的，所以不会小于这个LSN
    */
-  void mark_dirty() {
-    dirty_ = true;
+  void mark_dirty();
+
+  bool dirty() const {
+    return dirty_;
+  }
+
+  /**
+   * 恢复LSN(recovery LSN)：页面最近一次从干净变脏时的下一条日志的LSN。
+   * 所有脏页的恢复LSN(脏页表)中最小的那个之前的日志都不需要再回放了，参考BufferPoolManager::checkpoint
+   */
+  int64_t recovery_lsn() const {
+    return recovery_lsn_.load(std::memory_order_relaxed);
   }
 
   char *data() {
@@ -104,63 +265,136 @@ public:
   }
   bool can_purge()
   {
-    return pin_count_ <= 0;
+    return pin_count_.load(std::memory_order_relaxed) == 0;
   }
-private:
-  friend class DiskBufferPool;
-
-  bool          dirty_     = false;
-  unsigned int  pin_count_ = 0;
-  unsigned long acc_time_  = 0;
-  int           file_desc_ = -1;
-  Page          page_;
-};
-
-class BPFrameId
-{
-public: 
-  BPFrameId(int file_desc, PageNum page_num) :
-    file_desc_(file_desc), page_num_(page_num)
-  {}
 
-  bool equal_to(const BPFrameId &other) const
+  unsigned int pin_count() const
   {
-    return file_desc_ == other.file_desc_ && page_num_ == other.page_num_;
+    return pin_count_.load(std::memory_order_relaxed);
   }
 
-  bool operator== (const BPFrameId &other) const
+  /**
+   * 页面的读写锁。修改页面内容时持有写锁，刷盘时持有读锁把页面复制出来，
+   * 保证写到磁盘上的是一个完整的页面。pin只保证页面不会被淘汰，不保护页面的内容。
+   * 不可重入，持有写锁的线程不能再刷这个页面
+   */
+  common::RWLatch &latch()
   {
-    return this->equal_to(other);
+    return latch_;
   }
 
-  size_t hash() const
+  FrameReplacerHook &replacer_hook()
   {
-    return static_cast<size_t>(file_desc_) << 32L | page_num_;
+    return replacer_hook_;
   }
+private:
+  friend class DiskBufferPool;
+  friend class BPFrameManager;
+  friend class FrameAllocator;
 
-  int file_desc() const { return file_desc_; }
-  PageNum page_num() const { return page_num_; }
+  /**
+   * 从frame表中删除的frame会在pin_count_上设置这个标记，
+   * 不加锁查找的线程pin住frame之后看到这个标记，就知道拿到的frame已经失效了
+   */
+  static const unsigned int EVICTED = 1U << 31;
 
-private:
-  int file_desc_;
-  PageNum page_num_;
+  // 后台刷脏线程也会访问这两个字段
+  std::atomic<bool>         dirty_{false};
+  std::atomic<int64_t>      recovery_lsn_{0};
+  std::atomic<unsigned int> pin_count_{0};
+  std::atomic<bool>         prefetched_{false};  // 预读进来之后还没有被访问过，用于统计预读的命中率
+  std::atomic<bool>         loading_{false};     // 正在从磁盘读取页面，其它线程命中之后需要等待
+  std::atomic<uint64_t>     frame_id_{BPFrameId::INVALID};  // 不加锁查找时用来校验frame对应的页面
+  std::atomic<Frame *>      hash_next_{nullptr};  // frame表中同一个桶的下一个frame
+  common::RWLatch           latch_;
+  int                       file_desc_ = -1;
+  FrameReplacerHook         replacer_hook_;
+  Frame *                   free_next_ = nullptr;  // 空闲链表，FrameAllocator使用
+  alignas(BP_DIRECT_IO_ALIGN) Page page_;          // 可以直接用于O_DIRECT读写
 };
 
+/**
+ * 管理所有的Frame。
+ * frame表是一个桶的个数固定的哈希表，每个桶是一个frame的单向链表(Frame::hash_next_)。
+ * 桶按照编号拆分成多个分区，每个分区有自己的锁和页面替换策略(参考FrameReplacer)。
+ * 修改链表(alloc/free)需要持有分区的锁，查找(get/pin)不需要加锁：
+ * 链表的指针都是原子变量，删除的frame保留自己的next指针，正在遍历的线程不会走丢；
+ * 找到之后先pin住，再检查frame没有被删除(Frame::EVICTED)并且仍然是要找的页面(Frame::frame_id_)，
+ * 检查失败时退回到加锁查找。
+ * 删除frame时使用CAS将pin count从1(调用者自己的pin)改成EVICTED，有其它线程pin住时删除失败。
+ * 分配frame使用的内存池是所有分区共享的。
+ */
 class BPFrameManager
 {
+public:
+  /**
+   * 预读的统计信息
+   */
+  struct PrefetchStats {
+    std::atomic<long> loaded{0};  //! 预读进来的页面个数
+    std::atomic<long> hit{0};     //! 预读进来之后被访问到的页面个数
+    std::atomic<long> wasted{0};  //! 预读进来之后还没有被访问就被淘汰的页面个数
+  };
+
+  /**
+   * 多个NUMA节点时，访问的页面是否在当前线程所在节点的内存上
+   */
+  struct NumaStats {
+    std::atomic<long> local_allocs{0};   //! 从当前节点分配到的frame个数
+    std::atomic<long> remote_allocs{0};  //! 当前节点没有空闲的frame，从其它节点分配的个数
+    std::atomic<long> local_hits{0};     //! 命中的页面在当前节点上，需要打开set_numa_hit_stats
+    std::atomic<long> remote_hits{0};    //! 命中的页面在其它节点上
+  };
+
 public:
   BPFrameManager(const char *tag);
+  ~BPFrameManager();
 
-  RC init(int pool_num);
+  /**
+   * @param frame_num frame的个数，即缓存的页面个数
+   * @param partition_num frame表的分区个数
+   * @param replace_policy 页面替换策略，可以是 lru, clock 或 2q
+   * @param options frame内存分配相关的参数，比如最多可以扩容到多少个frame
+   */
+  RC init(size_t frame_num, int partition_num = DEFAULT_PARTITION_NUM,
+          const char *replace_policy = DEFAULT_REPLACE_POLICY,
+          const FrameAllocator::Options &options = FrameAllocator::Options());
   RC cleanup();
 
+  /**
+   * 在线调整frame的个数。
+   * 缩容时，超出容量并且正在使用的frame要等释放之后才会真正归还内存，
+   * 可以通过find_beyond_capacity_list找到它们并主动淘汰
+   */
+  RC resize(size_t frame_num);
+  std::list<Frame *> find_beyond_capacity_list();
+
+  /**
+   * 查找页面对应的frame，不会pin住，也不算作一次访问。只能用来判断页面是否在缓冲池中
+   */
   Frame *get(int file_desc, PageNum page_num);
 
+  /**
+   * 查找页面对应的frame并pin住，页面正在加载时等待加载完成。
+   * 使用CLOCK替换策略时整个过程不需要加锁
+   * @return 页面不在缓冲池中时返回nullptr
+   */
+  Frame *pin(int file_desc, PageNum page_num);
+
   std::list<Frame *> find_list(int file_desc);
 
+  /**
+   * 分配一个frame并加入frame表，返回的frame已经pin住并且处于加载状态(Frame::loading_)，
+   * 调用者初始化页面之后需要调用finish_load，其它线程才能访问
+   * @return 页面已经在frame表中，或者没有空闲的frame时返回nullptr
+   */
   Frame *alloc(int file_desc, PageNum page_num);
+  void finish_load(Frame *frame);
 
   /**
+   * 将frame从frame表中删除并释放。调用者需要持有一个pin，释放之后这个pin也就没有了。
+   * 还有其它线程pin住了这个frame，或者页面又被改脏了，就不能释放，这时候调用者的pin保持不变。
+   * 加载失败的frame(还没有调用finish_load)总是可以释放，会等待那些等着它加载完成的线程退出。
    * 尽管frame中已经包含了file_desc和page_num，但是依然要求
    * 传入，因为frame可能忘记初始化或者没有初始化
    */
@@ -168,32 +402,112 @@ public:
 
   /**
    * 如果不能从空闲链表中分配新的页面，就使用这个接口，
-   * 尝试从pin count=0的页面中淘汰一个
+   * 尝试从pin count=0的页面中淘汰一个。
+   * 返回的frame已经被pin住，避免在刷盘的过程中被后台刷脏线程拿走。
+   * 多个NUMA节点时优先淘汰当前节点上的页面，这样新加载的页面会放在第一次访问它的线程所在的节点上
    */
   Frame *begin_purge();
 
-  size_t frame_num() const { return frames_.count(); }
+  size_t frame_num() const;
+
+  /**
+   * 后台刷脏使用。统计指定分区中已经分配的frame个数和脏页个数
+   */
+  void count_frames(int partition_index, size_t &frame_num, size_t &dirty_num) const;
+
+  /**
+   * 后台刷脏使用。将指定分区中没有被使用的脏页pin住，放到frames中。
+   * pin住之后页面不会被淘汰，刷盘之后需要调用unpin_frame或者DiskBufferPool::unpin_page
+   * @param max_recovery_lsn 只要恢复LSN小于这个值的脏页，检查点使用
+   */
+  void pin_dirty_frames(int partition_index, size_t max_num, std::vector<Frame *> &frames,
+                        int64_t max_recovery_lsn = std::numeric_limits<int64_t>::max());
+  void unpin_frame(Frame *frame);
+
+  /**
+   * 检查点使用。指定分区中脏页的最小恢复LSN，没有脏页时返回lsn
+   * @param opened 只统计这些文件的页面。已经关闭的文件留下来的脏页不会再写回，不能让它们挡住检查点
+   */
+  int64_t min_recovery_lsn(int partition_index, int64_t lsn, const std::function<bool(int)> &opened) const;
+
+  /**
+   * 按照从热到冷的顺序列出缓冲池中的页面，最多max_num个，用于预热
+   */
+  void list_hot_pages(size_t max_num, std::vector<BPFrameId> &page_ids) const;
+
+  /**
+   * frame中页面的大小，同一个BPFrameManager中只有一种大小的页面
+   */
+  int page_size() const { return allocator_.page_size(); }
 
   /**
-   * 测试使用。返回已经从内存申请的个数
+   * 还可以分配的空闲frame个数
    */
-  size_t total_frame_num() const { return allocator_.get_size(); }
+  size_t free_frame_num() const { return allocator_.capacity() - std::min(allocator_.capacity(), allocator_.used_num()); }
+
+  /**
+   * 返回当前的容量，即最多可以分配的frame个数
+   */
+  size_t total_frame_num() const { return allocator_.capacity(); }
+  size_t max_frame_num() const { return allocator_.max_capacity(); }
+
+  int partition_num() const { return partition_num_; }
+
+  PrefetchStats &prefetch_stats() { return prefetch_stats_; }
+
+  int numa_node_num() const { return allocator_.node_num(); }
+  int numa_node_of(const Frame *frame) const { return allocator_.node_of(frame); }
+  NumaStats &numa_stats() { return numa_stats_; }
+
+  /**
+   * 是否统计命中的页面是本地的还是远端的。每次命中都要查询当前线程所在的节点，只在测试性能时打开
+   */
+  void set_numa_hit_stats(bool enable) { numa_hit_stats_ = enable; }
+
+public:
+  static const int DEFAULT_PARTITION_NUM = 8;
+  static constexpr const char *DEFAULT_REPLACE_POLICY = "clock";
 
 private:
-  class BPFrameIdHasher {
-  public:
-    size_t operator() (const BPFrameId &frame_id) const {
-      return frame_id.hash();
-    }
+  struct Partition {
+    mutable std::mutex lock_;
+    size_t             frame_num_ = 0;
+    FrameReplacer *    replacer_ = nullptr;
   };
-  using FrameLruCache = common::LruCache<BPFrameId, Frame *, BPFrameIdHasher>;
-  using FrameAllocator = common::MemPoolSimple<Frame>;
 
-  std::mutex lock_;
-  FrameLruCache frames_;
-  FrameAllocator allocator_;
+  size_t bucket_of(uint64_t key) const;
+  Partition &partition_of(size_t bucket) { return partitions_[bucket % partition_num_]; }
+
+  /**
+   * 在桶中查找，可以不加锁调用。不加锁时可能因为并发的修改漏掉要找的frame
+   */
+  Frame *find(size_t bucket, uint64_t key, bool locked) const;
+  Frame *pin_locked(size_t bucket, uint64_t key);
+
+  /**
+   * 遍历分区中所有的frame，需要持有分区的锁
+   */
+  template <typename Func>
+  void for_each_frame(int partition_index, Func func) const;
+
+private:
+  std::string                  tag_;
+  int                          partition_num_ = 0;
+  std::unique_ptr<Partition[]> partitions_;
+  std::unique_ptr<std::atomic<Frame *>[]> buckets_;
+  size_t                       bucket_mask_ = 0;
+  std::atomic<unsigned int>    purge_cursor_{0};
+  FrameAllocator               allocator_;
+  PrefetchStats                prefetch_stats_;
+  NumaStats                    numa_stats_;
+  bool                         numa_hit_stats_ = false;
 };
 
+/**
+ * 按照页号顺序遍历文件中所有已经分配的页面，不包括文件头和各个分组的位图页。
+ * 连续调用next几次之后认为是顺序扫描，会根据页面分配位图找到接下来的若干个页面，
+ * 通过DiskBufferPool::prefetch_pages一次读进缓冲区(预读)，预读窗口的大小由BufferPool配置项ReadAheadPages决定
+ */
 class BufferPoolIterator
 {
 public:
@@ -204,15 +518,46 @@ public:
   bool has_next();
   PageNum next();
   RC reset();
+
+  /**
+   * 调整预读窗口，0表示不预读。比如只遍历页号而不访问页面时可以关闭预读
+   */
+  void set_read_ahead_pages(int pages);
+
+private:
+  void read_ahead();
+
 private:
-  common::Bitmap   bitmap_;
   PageNum  current_page_num_ = -1;
+
+  DiskBufferPool * bp_ = nullptr;
+  int      read_ahead_pages_ = 0;
+  int      sequential_num_ = 0;   // 连续调用next的次数
+  PageNum  read_ahead_end_ = 0;   // 这个页号之前的页面已经预读过了
 };
 
 class DiskBufferPool
 {
 public:
-  DiskBufferPool(BufferPoolManager &bp_manager, BPFrameManager &frame_manager);
+  /**
+   * 每个文件(表的数据文件或者索引文件)在缓冲池中的统计信息，用来找出哪个表或者索引在抢占缓冲池。
+   * 通过 BufferPool.file.<文件名> 指标和 show bufferpool status 命令输出
+   */
+  struct Stats {
+    std::atomic<long> hits{0};          //! 前台读取页面时命中缓冲池的次数
+    std::atomic<long> misses{0};        //! 前台读取页面时没有命中，需要从磁盘读取的次数
+    std::atomic<long> prefetched{0};    //! 预读或者预热读进来的页面个数
+    std::atomic<long> evictions{0};     //! 这个文件的页面被淘汰的次数
+    std::atomic<long> dirty_writes{0};  //! 写回磁盘的脏页个数
+    std::atomic<long> mapped_reads{0};  //! 只读扫描时从文件映射中复制出来的页面个数，参考read_page
+    common::LatencyHistogram read_latency;   //! 每次读盘的延迟，批量读算一次
+    common::LatencyHistogram write_latency;  //! 每次写盘的延迟，批量写算一次
+
+    std::string to_string() const;
+  };
+
+public:
+  DiskBufferPool(BufferPoolManager &bp_manager, BPFrameManager &frame_manager, const std::string &pool_name);
   ~DiskBufferPool();
 
   /**
@@ -222,8 +567,11 @@ public:
 
   /**
    * 根据文件名打开一个分页文件
+   * @param direct_io 使用O_DIRECT读写，页面只缓存在缓冲池中，不再占用操作系统的page cache。
+   *                  文件系统不支持或者对齐要求超过BP_DIRECT_IO_ALIGN时，退化成普通的读写
+   * @param mmap_scan 只读扫描时通过mmap直接访问文件中的页面，参考read_page。和direct_io不能同时使用
    */
-  RC open_file(const char *file_name);
+  RC open_file(const char *file_name, bool direct_io = false, bool mmap_scan = false);
 
   /**
    * 关闭分页文件
@@ -235,6 +583,32 @@ public:
    */
   RC get_this_page(PageNum page_num, Frame **frame);
 
+  /**
+   * 一次获取多个页面并全部pin住，相当于对每个页面调用get_this_page。
+   * 先在缓冲池中查找所有的页面，不在缓冲池中的页面按照页号排序后一次提交给PageIO，连续的页面合并成一次读取。
+   * 只要有一个页面获取失败，已经pin住的页面都会unpin，frames中都是nullptr
+   * @param frames 和page_nums一一对应，使用完之后每个都需要unpin_page
+   */
+  RC get_pages(const PageNum *page_nums, int num, Frame **frames);
+
+  /**
+   * 只读访问一个页面。开启了mmap_scan并且页面不在缓冲池中时，把文件映射中的页面复制到buffer中并校验，
+   * page指向buffer，frame为nullptr，不需要unpin，下次使用buffer之前页面一直有效。
+   * 映射中的页面随时可能被刷盘修改，所以不会把映射中的地址交给调用者。
+   * 其它情况(包括复制出来的页面校验不通过)和get_this_page相同，page指向frame中的页面，使用完之后需要unpin_page。
+   * 缓冲池中的页面可能比文件中的新(脏页)，所以总是优先使用缓冲池中的页面
+   * @param buffer 至少page_size()字节，由调用者持有。nullptr时总是通过缓冲池读取
+   */
+  RC read_page(PageNum page_num, Frame *&frame, const Page *&page, char *buffer);
+
+  /**
+   * 给文件映射的访问模式提示(madvise)，没有开启mmap_scan时什么都不做。
+   * advise_sequential告诉内核接下来会顺序访问，可以加大预读并尽快回收访问过的页面；
+   * advise_will_need让内核在后台把[start_page, start_page + page_num)读进page cache
+   */
+  void advise_sequential();
+  void advise_will_need(PageNum start_page, int page_num);
+
   /**
    * 在指定文件中分配一个新的页面，并将其放入缓冲区，返回页面句柄指针。
    * 分配页面时，如果文件中有空闲页，就直接分配一个空闲页；
@@ -266,6 +640,12 @@ public:
    */
   RC get_page_count(int *page_count);
 
+  /**
+   * 页号大于等于start的第一个已经分配的数据页，跳过文件头和各个分组的位图页
+   * @return 没有的话返回BP_INVALID_PAGE_NUM
+   */
+  PageNum next_allocated_page(PageNum start);
+
   /**
    * 检查是否所有页面都是pin count == 0状态(除了第1个页面)
    * 调试使用
@@ -273,6 +653,31 @@ public:
   RC check_all_pages_unpinned();
 
   int file_desc() const;
+  const std::string &file_name() const { return file_name_; }
+  Stats &stats() { return stats_; }
+
+  /**
+   * 文件是否真正使用了O_DIRECT
+   */
+  bool direct_io() const { return direct_io_; }
+
+  /**
+   * 只读扫描是否使用文件映射
+   */
+  bool mmap_scan() const { return mmap_scan_; }
+
+  /**
+   * 文件的页面缓存在哪个缓冲池中
+   */
+  const std::string &pool_name() const { return pool_name_; }
+  BPFrameManager &frame_manager() { return frame_manager_; }
+  BufferPoolManager &bp_manager() { return bp_manager_; }
+
+  /**
+   * 文件中页面的大小，和所在缓冲池的页面大小相同
+   */
+  int page_size() const { return page_size_; }
+  int page_data_size() const { return page_size_ - BP_PAGE_HEADER_SIZE; }
 
   /**
    * 如果页面是脏的，就将数据刷新到磁盘
@@ -284,10 +689,38 @@ public:
    */
   RC flush_all_pages();
 
+  /**
+   * 批量刷盘，后台刷脏使用。frames需要按照页号排好序并且已经被pin住，
+   * 所有页面一次提交给PageIO，页号连续的页面会合并成一次向量写
+   * @param flushed_num 实际写入的页面个数
+   */
+  RC flush_pages(const std::vector<Frame *> &frames, int &flushed_num);
+
+  /**
+   * 检查点使用。文件头页面一直是pin住的，后台刷脏不会写它，恢复LSN小于max_recovery_lsn时在这里刷盘。
+   * 修改文件头时持有它的写锁，刷盘时持有读锁
+   * @param flushed 是否写了文件头
+   */
+  RC flush_header_page(int64_t max_recovery_lsn, bool &flushed);
+
+  /**
+   * 将还不在缓冲区中的页面一次性批量读进来，读完之后不会pin住。
+   * 顺序扫描或者范围扫描知道接下来要访问哪些页面时使用，不存在的页面会被跳过。
+   * 没有空闲的frame时会淘汰其它页面，淘汰不了就只读取一部分
+   * @param loaded_num 实际读取的页面个数
+   */
+  RC prefetch_pages(const PageNum *page_nums, int num, int &loaded_num);
+
   /**
    * 回放日志时处理page0中已被认定为不存在的page
    */
   RC recover_page(PageNum page_num);
+
+  /**
+   * 回放日志时使用，读取页面的LSN，小于这个LSN的日志已经包含在页面中了，不需要重做。
+   * 页面还没有分配或者超出了文件的末尾时返回0
+   */
+  RC page_lsn(PageNum page_num, int64_t &lsn);
 protected:
 protected:
   RC allocate_frame(PageNum page_num, Frame **buf);
@@ -296,6 +729,15 @@ protected:
    * 刷新指定页面到磁盘(flush)，并且释放关联的Frame
    */
   RC purge_frame(PageNum page_num, Frame *used_frame);
+  /**
+   * 刷盘并淘汰除了文件头之外的所有页面，关闭文件时使用。有页面一直被pin住时返回失败
+   */
+  RC purge_data_pages();
+  /**
+   * 刷盘之前在页面的读锁保护下复制页面并计算校验和，写盘时不再持有页面的锁。
+   * 复制之前取到的LSN记录到复制出来的页面中：日志总是在修改页面之后生成的，LSN比它小的日志的修改都已经复制了
+   */
+  void copy_page_for_flush(Frame &frame, Page *copy);
   RC check_page_num(PageNum page_num);
 
   /**
@@ -303,37 +745,335 @@ protected:
    */
   RC load_page(PageNum page_num, Frame *frame);
 
+  /**
+   * 把页面写到数据文件中，开启了双写时先写到双写文件
+   */
+  RC write_pages(PageIORequest *requests, int num);
+
+  /**
+   * 根据配置(ChecksumVerify)校验刚读上来的页面
+   */
+  RC verify_page(const Page &page, PageNum page_num);
+
+  /**
+   * 获取分组的位图。第0个分组的位图在文件头中，其它分组需要读取位图页，
+   * 使用完之后调用put_group_bitmap释放
+   */
+  RC get_group_bitmap(int group, Frame *&frame, char *&bitmap);
+  void put_group_bitmap(Frame *frame);
+
+  /**
+   * 修改页面在位图中的分配状态，同时维护已分配页面的计数和空闲页面摘要
+   */
+  void set_page_allocated(Frame *bitmap_frame, char *bitmap, PageNum page_num, bool allocated);
+
+  /**
+   * 在文件末尾创建一个新的分组，即写入分组的位图页。调用时文件的页面个数必须正好是分组的起始位置
+   */
+  RC create_group(int group);
+
+  /**
+   * 打开文件时读取所有分组的位图，构建空闲页面摘要
+   */
+  RC load_space_map();
+
+  /**
+   * 返回页面在文件映射中的地址，页面超出了当前的映射范围时按照文件的大小重新映射。
+   * 页面还没有写到文件中或者映射失败时返回nullptr
+   */
+  const Page *mapped_page(PageNum page_num);
+  void unmap_file();
+
 private:
   BufferPoolManager &bp_manager_;
   BPFrameManager &   frame_manager_;
+  PageIO &           page_io_;
+  const int          page_size_;
+  std::string        pool_name_;
   std::string        file_name_;
   int                file_desc_ = -1;
+  bool               direct_io_ = false;
+  bool               mmap_scan_ = false;
+  std::mutex         map_lock_;
+  char *             map_addr_ = nullptr;  // 受map_lock_保护
+  size_t             map_size_ = 0;
+  std::vector<std::pair<char *, size_t>> retired_maps_;  // 文件变大之后旧的映射，可能还有人在访问，关闭文件时才释放
   Frame *            hdr_frame_ = nullptr;
   BPFileHeader *     file_header_ = nullptr;
+  BPSpaceMap         space_map_{BPFileHeader::group_page_num(page_size_)};
   std::set<PageNum>  disposed_pages;
+  Stats              stats_;
+  common::Gauge *    stats_gauge_ = nullptr;
 
 private:
   friend class BufferPoolIterator;
 };
 
+class PageCleaner;
+class Checkpointer;
+
 class BufferPoolManager
 {
+public:
+  /**
+   * 写脏页之前调用，保证已经生成的日志都已经落盘(WAL)
+   */
+  using LogSyncer = std::function<RC()>;
+  using LogCheckpointer = std::function<RC(int64_t min_recovery_lsn)>;
+  using LsnSource = int64_t (*)();
+
+  /**
+   * 读取页面时如何处理校验失败的页面
+   */
+  enum class ChecksumVerify {
+    OFF,     //! 不校验
+    WARN,    //! 校验失败时打印日志，仍然使用这个页面
+    STRICT,  //! 校验失败时读取失败
+  };
+
 public:
   BufferPoolManager();
   ~BufferPoolManager();
 
-  RC create_file(const char *file_name);
-  RC open_file(const char *file_name, DiskBufferPool *&bp);
+  /**
+   * 创建文件
+   * @param page_size 文件的页面大小，记录在文件头中。点查为主的小表适合用小的页面，扫描为主的大表适合用大的页面
+   */
+  RC create_file(const char *file_name, int page_size = BP_PAGE_SIZE);
+
+  /**
+   * 打开文件
+   * @param pool_name 文件的页面缓存在哪个缓冲池中，空或者default表示默认的缓冲池。
+   *                  指定的缓冲池不存在(比如从配置中删掉了)时使用默认的缓冲池。
+   *                  有名字的缓冲池和默认的缓冲池都是BP_PAGE_SIZE大小的页面，
+   *                  其它页面大小的文件总是使用这个页面大小对应的缓冲池，参考page_size_pool
+   */
+  RC open_file(const char *file_name, DiskBufferPool *&bp, const char *pool_name = nullptr);
   RC close_file(const char *file_name);
 
+  /**
+   * 前台淘汰脏页时调用，会被统计为一次淘汰等待(eviction stall)
+   */
   RC flush_page(Frame &frame);
 
+  /**
+   * 后台刷脏使用。将指定缓冲池的指定分区中没有被使用的脏页按照文件和页号排序后批量刷盘
+   * @param max_num 最多刷多少个页面
+   * @param max_recovery_lsn 只刷恢复LSN小于这个值的页面
+   * @return 实际写入的页面个数
+   */
+  int flush_dirty_frames(BPFrameManager &frame_manager, int partition_index, size_t max_num,
+                         int64_t max_recovery_lsn = std::numeric_limits<int64_t>::max());
+
+  /**
+   * 把所有缓冲池中恢复LSN小于lsn的脏页刷盘，包括文件头页面。正在被使用的页面会跳过
+   * @return 刷盘的页面个数
+   */
+  int flush_frames_before(int64_t lsn);
+
+  /**
+   * 所有打开的文件的脏页中最小的恢复LSN，没有脏页时返回下一条日志的LSN
+   */
+  int64_t min_recovery_lsn();
+
+  /**
+   * 模糊检查点，不会阻塞前台的读写。
+   * 先把上一次检查点时就已经是脏页的页面刷盘，这样检查点每次都能向前推进，
+   * 恢复时最多回放两个检查点间隔内的日志；然后用脏页的最小恢复LSN通知每个注册的日志
+   * @param flushed_num 这次检查点刷盘的页面个数
+   */
+  RC checkpoint(int &flushed_num);
+
+  /**
+   * 默认的缓冲池
+   */
+  BPFrameManager &frame_manager() { return frame_manager_; }
+
+  /**
+   * 除了默认的缓冲池之外，还可以创建有名字的缓冲池，每个都有自己的容量和替换策略。
+   * 表和索引在创建时指定使用哪个缓冲池(记录在TableMeta中)，这样小的热点表就不会被大表的扫描挤出去。
+   * 配置在BufferPool的Pools中，每个缓冲池的参数在 BufferPool.<名字> 中
+   * @param frame_num 缓冲池的页面个数，不支持在线调整
+   */
+  RC create_pool(const char *name, size_t frame_num, int partition_num, const char *replace_policy);
+
+  /**
+   * 按照名字查找缓冲池，空或者default返回默认的缓冲池
+   * @return 不存在时返回nullptr
+   */
+  BPFrameManager *find_pool(const char *name);
+
+  /**
+   * 所有的缓冲池，第一个是默认的缓冲池
+   */
+  void all_pools(std::vector<std::pair<std::string, BPFrameManager *>> &pools);
+
+  /**
+   * 页面大小不是BP_PAGE_SIZE的文件使用的缓冲池，每种页面大小一个，第一次打开这种文件时创建，
+   * 容量由配置PageSizePoolSize决定。名字是default.<页面大小>，比如default.4K
+   */
+  BPFrameManager *page_size_pool(int page_size);
+  PageIO &page_io() { return *page_io_; }
+
+  /**
+   * 顺序扫描时预读的页面个数
+   */
+  int read_ahead_pages() const { return read_ahead_pages_; }
+  void set_read_ahead_pages(int pages) { read_ahead_pages_ = std::max(pages, 0); }
+
+  ChecksumVerify checksum_verify() const { return checksum_verify_; }
+  void set_checksum_verify(ChecksumVerify checksum_verify) { checksum_verify_ = checksum_verify; }
+
+  /**
+   * 打开双写文件，并用它修复数据文件中写坏的页面。需要在打开任何数据文件之前调用。
+   * 不管有没有开启双写(DoubleWrite)，都会做修复，修复之后没有开启双写时就关闭这个文件
+   */
+  RC open_double_write(const char *file_name);
+
+  /**
+   * 没有开启双写时返回nullptr
+   */
+  DoubleWriteBuffer *double_write_buffer() { return double_write_buffer_; }
+  bool double_write() const { return double_write_; }
+  void set_double_write(bool enable) { double_write_ = enable; }
+
+  /**
+   * 配置(DirectIO)中是否指定了这个数据库使用O_DIRECT
+   */
+  bool direct_io_configured(const char *db_name) const;
+
+  /**
+   * 之后打开的这个目录下的文件(一个数据库的表和索引)是否使用O_DIRECT，
+   * 打开数据库时设置，已经打开的文件不受影响
+   */
+  void set_direct_io_dir(const std::string &dir, bool direct_io);
+
+  /**
+   * 配置(MmapScan)中是否指定了这个数据库的只读扫描使用文件映射
+   */
+  bool mmap_scan_configured(const char *db_name) const;
+
+  /**
+   * 之后打开的这个目录下的文件是否开启mmap_scan，和set_direct_io_dir一样在打开数据库时设置
+   */
+  void set_mmap_scan_dir(const std::string &dir, bool mmap_scan);
+
+  /**
+   * 每个DB有自己的日志，按照DB名字注册
+   */
+  void register_log_syncer(const std::string &name, const LogSyncer &log_syncer);
+  void unregister_log_syncer(const std::string &name);
+
+  /**
+   * 检查点时调用，参数是缓冲池中脏页的最小恢复LSN，这之前的日志修改的页面都已经落盘了。
+   * 日志回放完并且回放修改的页面都落盘之后才能注册，否则检查点会越过还没有落盘的修改
+   */
+  void register_log_checkpointer(const std::string &name, const LogCheckpointer &checkpointer);
+  void unregister_log_checkpointer(const std::string &name);
+
+  /**
+   * 页面变脏时记录的恢复LSN从这里获取。日志模块设置，没有设置时都是0
+   */
+  static void set_lsn_source(LsnSource lsn_source);
+  static int64_t next_lsn();
+
+  /**
+   * 回放日志期间修改页面不会生成新的日志，还没有回放的日志的LSN也比next_lsn小，
+   * 这时刷盘不能用next_lsn标记页面，只保留页面原来的LSN
+   */
+  static void begin_redo();
+  static void end_redo();
+  /**
+   * 刷盘时标记到页面上的LSN，回放日志期间返回0
+   */
+  static int64_t flush_lsn();
+
+  /**
+   * 在线调整默认缓冲池的大小，不能超过配置的最大值(MaxSize)。
+   * 缩容时会将超出容量并且没有被pin住的页面刷盘并淘汰掉
+   * @param bytes 缓冲池的大小，会按照页面大小向下取整
+   */
+  RC resize(size_t bytes);
+  size_t capacity() const;
+  size_t max_capacity() const;
+
+  /**
+   * 所有打开的文件，文件描述符到文件名的映射
+   */
+  void opened_files(std::unordered_map<int, std::string> &files);
+
+  /**
+   * 按照文件名找到打开的文件，然后调用DiskBufferPool::prefetch_pages。
+   * 最多使用文件所在缓冲池中空闲的frame，缓冲池满了时什么都不加载
+   * @return 文件没有打开时返回BUFFERPOOL_CLOSED
+   */
+  RC prefetch_pages(const std::string &file_name, const PageNum *page_nums, int num, int &loaded_num);
+
+  /**
+   * 前台读取页面时没有命中缓冲池的次数(不包括预读)
+   */
+  long page_misses() const { return page_misses_.load(); }
+  void inc_page_misses() { page_misses_++; }
+
+  /**
+   * 某个文件的页面被淘汰了，记到这个文件的统计中
+   */
+  void record_eviction(int file_desc);
+
+  /**
+   * 持有读锁遍历所有打开的文件，遍历的过程中文件不会被关闭。func中不能打开或者关闭文件
+   */
+  void foreach_buffer_pool(const std::function<void(DiskBufferPool &)> &func);
+
+  BufferPoolWarmer &warmer() { return *warmer_; }
+
 public:
+  static const int DEFAULT_READ_AHEAD_PAGES = 32;
+  static const char *DEFAULT_POOL_NAME;
+
   static void set_instance(BufferPoolManager *bpm);
   static BufferPoolManager &instance();
   
+private:
+  RC sync_log();
+  BPFrameManager *find_pool_locked(const char *name);
+  BPFrameManager *page_size_pool_locked(int page_size);
+
 private:
   BPFrameManager frame_manager_{"BufPool"};
+  std::map<std::string, BPFrameManager *> named_pools_;  // 受lock_保护，只增不减
+  std::map<int, BPFrameManager *> page_size_pools_;      // 受lock_保护，只增不减
+  size_t         page_size_pool_bytes_ = 0;
+  int            partition_num_ = BPFrameManager::DEFAULT_PARTITION_NUM;
+  std::string    replace_policy_;
+  FrameAllocator::Options pool_options_;
+  PageIO *       page_io_ = nullptr;
+  PageCleaner *  page_cleaner_ = nullptr;
+  Checkpointer * checkpointer_ = nullptr;
+  common::Gauge *read_ahead_gauge_ = nullptr;
+  int            read_ahead_pages_ = DEFAULT_READ_AHEAD_PAGES;
+  ChecksumVerify checksum_verify_ = ChecksumVerify::STRICT;
+  bool           double_write_ = false;
+  std::set<std::string> direct_io_dbs_;   // 配置的使用O_DIRECT的数据库，*表示所有数据库
+  std::set<std::string> direct_io_dirs_;  // 受lock_保护
+  std::set<std::string> mmap_scan_dbs_;   // 配置的只读扫描使用文件映射的数据库，*表示所有数据库
+  std::set<std::string> mmap_scan_dirs_;  // 受lock_保护
+  std::set<std::string> opening_files_;   // 正在打开的文件，受lock_保护
+  DoubleWriteBuffer *double_write_buffer_ = nullptr;
+  BufferPoolWarmer * warmer_ = nullptr;
+  std::atomic<long>  page_misses_{0};
+  std::mutex     log_syncer_lock_;
+  std::unordered_map<std::string, LogSyncer> log_syncers_;
+  std::unordered_map<std::string, LogCheckpointer> log_checkpointers_;  // 受log_syncer_lock_保护
+
+  std::mutex     checkpoint_lock_;  // 检查点是串行的
+  int64_t        last_checkpoint_lsn_ = 0;  // 上一次检查点时的下一条日志的LSN，受checkpoint_lock_保护
+  static std::atomic<LsnSource> lsn_source_;
+  static std::atomic<int>       redo_count_;  // 正在回放日志的数据库个数
+
+  // 保护下面的两个map。刷盘时持有读锁，打开和关闭文件时持有写锁，
+  // 这样后台刷脏的时候文件不会被关闭
+  std::shared_timed_mutex lock_;
   std::unordered_map<std::string, DiskBufferPool *> buffer_pools_;
   std::unordered_map<int, DiskBufferPool *> fd_buffer_pools_;
 };
@@ -0,0 +1,208 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/08.
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "storage/default/double_write_buffer.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/default/page_io.h"
+#include "common/io/io.h"
+#include "common/log/log.h"
+#include "common/math/crc32c.h"
+
+using namespace common;
+
+static const uint32_t DOUBLE_WRITE_MAGIC = 0x44424C57;  // "DBLW"
+
+const int DoubleWriteBuffer::MAX_BATCH_PAGES =
+    static_cast<int>((BP_PAGE_SIZE - sizeof(DoubleWriteBuffer::Header)) / sizeof(DoubleWriteBuffer::Entry));
+
+static uint32_t header_checksum(const char *header_page)
+{
+  const size_t skip = offsetof(DoubleWriteBuffer::Header, page_num);
+  return crc32c(0, header_page + skip, BP_PAGE_SIZE - skip);
+}
+
+DoubleWriteBuffer::~DoubleWriteBuffer()
+{
+  close();
+}
+
+RC DoubleWriteBuffer::open(const char *file_name)
+{
+  int fd = ::open(file_name, O_RDWR | O_CREAT, S_IREAD | S_IWRITE);
+  if (fd < 0) {
+    LOG_ERROR("Failed to open double write file %s, due to %s.", file_name, strerror(errno));
+    return RC::IOERR_ACCESS;
+  }
+
+  file_name_ = file_name;
+  file_desc_ = fd;
+  header_page_ = new char[BP_PAGE_SIZE];
+  LOG_INFO("Successfully open double write file %s, max batch pages=%d", file_name, MAX_BATCH_PAGES);
+  return RC::SUCCESS;
+}
+
+void DoubleWriteBuffer::close()
+{
+  if (file_desc_ >= 0) {
+    ::close(file_desc_);
+    file_desc_ = -1;
+  }
+  delete[] header_page_;
+  header_page_ = nullptr;
+}
+
+RC DoubleWriteBuffer::recover(int &repaired_num)
+{
+  repaired_num = 0;
+
+  // 文件是空的，或者头页面本身就没有写完整，这时候数据文件还没有开始写，不需要修复
+  Header *header = reinterpret_cast<Header *>(header_page_);
+  if (preadn(file_desc_, header_page_, BP_PAGE_SIZE, 0) != 0 || header->magic != DOUBLE_WRITE_MAGIC ||
+      header->checksum != header_checksum(header_page_) || header->page_num < 0 ||
+      header->page_num > MAX_BATCH_PAGES) {
+    LOG_INFO("No pages in double write file %s", file_name_.c_str());
+    return RC::SUCCESS;
+  }
+
+  std::vector<char> copy_buffer(BP_MAX_PAGE_SIZE);
+  std::vector<char> page_buffer(BP_MAX_PAGE_SIZE);
+  Page &copy = *reinterpret_cast<Page *>(copy_buffer.data());
+  Page &page = *reinterpret_cast<Page *>(page_buffer.data());
+  off_t copy_offset = BP_PAGE_SIZE;
+  for (int i = 0; i < header->page_num; i++) {
+    const Entry &entry = header->entries[i];
+    const int page_size = entry.page_size;
+    if (!BPFileHeader::valid_page_size(page_size)) {
+      // 后面的页面位置都无法确定了
+      LOG_WARN("Invalid page size in double write file. entry=%d, page size=%d", i, page_size);
+      break;
+    }
+    const off_t offset_in_buffer = copy_offset;
+    copy_offset += page_size;
+    if (entry.file_name[sizeof(entry.file_name) - 1] != '\0') {
+      LOG_WARN("Invalid file name in double write file. entry=%d", i);
+      continue;
+    }
+
+    if (preadn(file_desc_, &copy, page_size, offset_in_buffer) != 0 ||
+        !verify_page_checksum(copy, page_size) || copy.version == 0 || copy.page_num != entry.page_num) {
+      // 双写文件中的页面不完整，说明这一批还没有开始写数据文件
+      LOG_WARN("Page in double write file is broken. file=%s, page=%d", entry.file_name, entry.page_num);
+      continue;
+    }
+
+    int fd = ::open(entry.file_name, O_RDWR);
+    if (fd < 0) {
+      // 表可能已经被删除了
+      LOG_WARN("Failed to open %s while recovering from double write file, due to %s.",
+               entry.file_name, strerror(errno));
+      continue;
+    }
+
+    const off_t offset = (off_t)entry.page_num * page_size;
+    if (preadn(fd, &page, page_size, offset) == 0 && verify_page_checksum(page, page_size) && page.version != 0 &&
+        page.page_num == entry.page_num) {
+      ::close(fd);
+      continue;
+    }
+
+    LOG_WARN("Repair page %s:%d from double write file", entry.file_name, entry.page_num);
+    if (pwriten(fd, &copy, page_size, offset) != 0 || fdatasync(fd) != 0) {
+      LOG_ERROR("Failed to repair page %s:%d, due to %s.", entry.file_name, entry.page_num, strerror(errno));
+      ::close(fd);
+      return RC::IOERR_WRITE;
+    }
+    ::close(fd);
+    repaired_num++;
+  }
+
+  LOG_INFO("Recover from double write file %s done. pages=%d, repaired=%d",
+           file_name_.c_str(), header->page_num, repaired_num);
+  return RC::SUCCESS;
+}
+
+RC DoubleWriteBuffer::write_pages(PageIO &page_io, const char *file_name, PageIORequest *requests, int num)
+{
+  if (strlen(file_name) >= sizeof(Entry::file_name)) {
+    LOG_WARN("File name is too long for double write, write pages directly. file=%s", file_name);
+    return page_io.write_pages(requests, num);
+  }
+
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  RC rc = RC::SUCCESS;
+  for (int begin = 0; begin < num; begin += MAX_BATCH_PAGES) {
+    const int batch_num = std::min(num - begin, MAX_BATCH_PAGES);
+    PageIORequest *batch = requests + begin;
+    rc = write_batch(file_name, batch, batch_num);
+    if (rc == RC::SUCCESS) {
+      rc = page_io.write_pages(batch, batch_num);
+    }
+
+    // 数据文件落盘之后，双写文件中的这一批页面才可以被覆盖
+    if (rc == RC::SUCCESS && fdatasync(batch[0].file_desc) != 0) {
+      LOG_ERROR("Failed to sync %s, due to %s.", file_name, strerror(errno));
+      rc = RC::IOERR_FSYNC;
+    }
+
+    if (rc != RC::SUCCESS) {
+      for (int i = begin; i < num; i++) {
+        if (requests[i].rc == RC::SUCCESS) {
+          requests[i].rc = rc;
+        }
+      }
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC DoubleWriteBuffer::write_batch(const char *file_name, PageIORequest *requests, int num)
+{
+  memset(header_page_, 0, BP_PAGE_SIZE);
+  Header *header = reinterpret_cast<Header *>(header_page_);
+  header->magic = DOUBLE_WRITE_MAGIC;
+  header->page_num = num;
+
+  std::vector<struct iovec> iov(num + 1);
+  iov[0].iov_base = header_page_;
+  iov[0].iov_len = BP_PAGE_SIZE;
+  ssize_t size = BP_PAGE_SIZE;
+  for (int i = 0; i < num; i++) {
+    header->entries[i].page_num = requests[i].page_num;
+    header->entries[i].page_size = requests[i].page_size;
+    strcpy(header->entries[i].file_name, file_name);
+    iov[i + 1].iov_base = requests[i].page;
+    iov[i + 1].iov_len = requests[i].page_size;
+    size += requests[i].page_size;
+  }
+  header->checksum = header_checksum(header_page_);
+
+  if (pwritev(file_desc_, iov.data(), num + 1, 0) != size || fdatasync(file_desc_) != 0) {
+    LOG_ERROR("Failed to write double write file %s, due to %s.", file_name_.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  written_pages_ += num;
+  written_batches_++;
+  return RC::SUCCESS;
+}
@@ -0,0 +1,100 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/08.
+//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "rc.h"
+#include "defs.h"
+
+struct PageIORequest;
+class PageIO;
+
+/**
+ * 双写缓冲。
+ * 页面(比如文件头和B+树节点)都是原地覆盖写的，写到一半时宕机会留下一个新旧混合的页面。
+ * 日志中只有逻辑的插入删除记录，没办法在这样的页面上重做。
+ * 所以一批脏页在写到数据文件之前，先顺序写到双写文件并落盘，然后再写到原来的位置并落盘。
+ * 启动时(回放日志之前)调用recover，用双写文件中完整的页面修复数据文件中校验失败的页面。
+ *
+ * 双写文件的第一个页面是DoubleWriteHeader，记录这一批页面属于哪个文件的哪个页面，后面依次是页面的内容。
+ * 数据文件中的页面落盘之后才会写下一批，所以双写文件中总是最后一批页面。
+ * 所有的刷盘都要经过这里，写操作是串行的。
+ */
+class DoubleWriteBuffer
+{
+public:
+  struct Entry {
+    PageNum page_num;
+    int32_t page_size;  //! 页面大小，页面内容在双写文件中依次紧挨着存放
+    char    file_name[248];
+  };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t checksum;  //! 除了magic和这个字段之外整个页面的CRC32C
+    int32_t  page_num;  //! 这一批有多少个页面
+    int32_t  reserved;
+    Entry    entries[0];
+  };
+
+  /**
+   * 一批最多写多少个页面，受限于头页面的大小
+   */
+  static const int MAX_BATCH_PAGES;
+
+public:
+  DoubleWriteBuffer() = default;
+  ~DoubleWriteBuffer();
+
+  /**
+   * 打开双写文件，不存在时创建
+   */
+  RC open(const char *file_name);
+  void close();
+
+  /**
+   * 用双写文件中的页面修复数据文件中损坏(校验失败)的页面，在打开数据文件之前调用
+   * @param repaired_num 修复了多少个页面
+   */
+  RC recover(int &repaired_num);
+
+  /**
+   * 先把页面写到双写文件，然后再写到数据文件中，返回时页面都已经落盘。
+   * 同一批请求属于同一个文件，页面超过MAX_BATCH_PAGES时分多次写
+   * @param file_name 数据文件的名字，恢复时根据这个名字打开文件
+   */
+  RC write_pages(PageIO &page_io, const char *file_name, PageIORequest *requests, int num);
+
+  /**
+   * 写到双写文件中的页面个数和批次，用来评估写放大
+   */
+  long written_pages() const { return written_pages_.load(); }
+  long written_batches() const { return written_batches_.load(); }
+
+private:
+  RC write_batch(const char *file_name, PageIORequest *requests, int num);
+
+private:
+  std::mutex  lock_;
+  std::string file_name_;
+  int         file_desc_ = -1;
+  char *      header_page_ = nullptr;
+
+  std::atomic<long> written_pages_{0};
+  std::atomic<long> written_batches_{0};
+};
@@ -0,0 +1,310 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/10/25.
+//
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <new>
+
+#include "storage/default/frame_allocator.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "common/log/log.h"
+#include "common/os/numa.h"
+
+static const size_t OS_PAGE_SIZE = 4096;
+static const size_t HUGE_PAGE_SIZE = 2UL << 20;
+static const size_t CACHE_LINE_SIZE = 64;
+
+static size_t align_up(size_t value, size_t align)
+{
+  return (value + align - 1) / align * align;
+}
+
+/**
+ * Frame::page_是最后一个成员，frame的头部就是sizeof(Frame) - sizeof(Page)
+ */
+static size_t frame_stride_of(int page_size)
+{
+  // arena按照大页对齐，frame的大小又是页面对齐要求的整数倍，所以每个frame中的页面都可以直接用于O_DIRECT
+  static_assert(sizeof(Frame) % BP_DIRECT_IO_ALIGN == 0, "frames should keep the page aligned");
+  static_assert(BP_MIN_PAGE_SIZE % BP_DIRECT_IO_ALIGN == 0, "every page size should keep the pages aligned");
+  return align_up(sizeof(Frame) - sizeof(Page) + page_size, CACHE_LINE_SIZE);
+}
+
+FrameAllocator::~FrameAllocator()
+{
+  cleanup();
+}
+
+RC FrameAllocator::init(size_t frame_num, const Options &options)
+{
+  if (arena_ != nullptr) {
+    LOG_WARN("frame allocator has been initialized");
+    return RC::GENERIC_ERROR;
+  }
+
+  if (frame_num == 0) {
+    LOG_WARN("invalid frame num %lu", frame_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  page_size_ = options.page_size > 0 ? options.page_size : BP_PAGE_SIZE;
+  frame_stride_ = frame_stride_of(page_size_);
+
+  size_t max_frame_num = std::max(frame_num, options.max_frame_num);
+  size_t arena_size = align_up(max_frame_num * frame_stride(), HUGE_PAGE_SIZE);
+
+  // 只预留虚拟地址空间，用到的时候才分配物理内存。多申请一个大页用来对齐
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  bool populated = false;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  const int node_num = std::max(options.numa_node_num, 1);
+#ifdef MAP_POPULATE
+  // 绑定节点之后才能分配物理内存
+  if (options.populate && max_frame_num == frame_num && node_num == 1) {
+    flags |= MAP_POPULATE;
+    populated = true;
+  }
+#endif
+  size_t map_size = arena_size + HUGE_PAGE_SIZE;
+  void *addr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (addr == MAP_FAILED && max_frame_num > frame_num) {
+    // 系统可能不允许预留这么多的地址空间(比如 vm.overcommit_memory=2)，退化成不能扩容
+    LOG_WARN("failed to reserve memory for %lu frames, fallback to %lu. error=%s",
+             max_frame_num, frame_num, strerror(errno));
+    max_frame_num = frame_num;
+    arena_size = align_up(max_frame_num * frame_stride(), HUGE_PAGE_SIZE);
+    map_size = arena_size + HUGE_PAGE_SIZE;
+    addr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  }
+  if (addr == MAP_FAILED) {
+    LOG_ERROR("failed to reserve memory for frames. size=%lu, error=%s", map_size, strerror(errno));
+    return RC::NOMEM;
+  }
+
+  char *map_begin = static_cast<char *>(addr);
+  char *arena = reinterpret_cast<char *>(align_up(reinterpret_cast<size_t>(map_begin), HUGE_PAGE_SIZE));
+  if (arena != map_begin) {
+    munmap(map_begin, arena - map_begin);
+  }
+  const size_t tail_size = map_begin + map_size - (arena + arena_size);
+  if (tail_size > 0) {
+    munmap(arena + arena_size, tail_size);
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (options.huge_page && 0 != madvise(arena, arena_size, MADV_HUGEPAGE)) {
+    LOG_WARN("failed to advise huge page for frames. error=%s", strerror(errno));
+  }
+#endif
+
+  if (node_num > 1) {
+    int bound_chunks = 0;
+    for (size_t offset = 0; offset < arena_size; offset += HUGE_PAGE_SIZE) {
+      const int node = static_cast<int>(offset / HUGE_PAGE_SIZE % node_num);
+      if (common::numa_bind_memory(arena + offset, HUGE_PAGE_SIZE, node)) {
+        bound_chunks++;
+      }
+    }
+    LOG_INFO("interleave frames on %d numa nodes. bound chunks=%d, total chunks=%lu",
+             node_num, bound_chunks, arena_size / HUGE_PAGE_SIZE);
+  }
+
+  if (options.populate && !populated) {
+    // 只有初始容量部分需要预先分配物理内存
+    memset(arena, 0, frame_num * frame_stride());
+  }
+
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  arena_ = arena;
+  arena_size_ = arena_size;
+  max_frame_num_ = max_frame_num;
+  capacity_ = 0;
+  used_num_ = 0;
+  node_num_ = node_num;
+  free_lists_.assign(node_num, nullptr);
+  frame_states_.assign(max_frame_num, RELEASED);
+  resize_locked(frame_num);
+
+  LOG_INFO("init frame allocator done. frame num=%lu, max frame num=%lu, arena size=%lu",
+           frame_num, max_frame_num, arena_size);
+  return RC::SUCCESS;
+}
+
+void FrameAllocator::cleanup()
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  if (arena_ == nullptr) {
+    return;
+  }
+
+  if (used_num_ > 0) {
+    LOG_WARN("there are still %lu frames in use while cleanup frame allocator", used_num_);
+  }
+
+  munmap(arena_, arena_size_);
+  arena_ = nullptr;
+  arena_size_ = 0;
+  capacity_ = 0;
+  max_frame_num_ = 0;
+  used_num_ = 0;
+  free_lists_.clear();
+  frame_states_.clear();
+}
+
+size_t FrameAllocator::index_of(const Frame *frame) const
+{
+  return (reinterpret_cast<const char *>(frame) - arena_) / frame_stride();
+}
+
+Frame *FrameAllocator::frame_at(size_t index) const
+{
+  return reinterpret_cast<Frame *>(arena_ + index * frame_stride());
+}
+
+void FrameAllocator::release_memory(size_t index)
+{
+  // 只能释放完全落在这个frame内部的操作系统页面，与相邻frame共享的页面保留
+  char *begin = reinterpret_cast<char *>(frame_at(index));
+  char *aligned_begin = reinterpret_cast<char *>(align_up(reinterpret_cast<size_t>(begin), OS_PAGE_SIZE));
+  char *aligned_end = reinterpret_cast<char *>((reinterpret_cast<size_t>(begin) + frame_stride()) / OS_PAGE_SIZE * OS_PAGE_SIZE);
+  if (aligned_end > aligned_begin) {
+    (void)madvise(aligned_begin, aligned_end - aligned_begin, MADV_DONTNEED);
+  }
+  frame_states_[index] = RELEASED;
+}
+
+int FrameAllocator::node_of(const Frame *frame) const
+{
+  if (node_num_ <= 1) {
+    return 0;
+  }
+  const size_t offset = reinterpret_cast<const char *>(frame) - arena_;
+  return static_cast<int>(offset / HUGE_PAGE_SIZE % node_num_);
+}
+
+void FrameAllocator::push_free(Frame *frame)
+{
+  Frame *&free_list = free_lists_[node_of(frame)];
+  frame->free_next_ = free_list;
+  free_list = frame;
+}
+
+Frame *FrameAllocator::alloc(int node /* = -1 */)
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  if (free_lists_.empty()) {
+    return nullptr;
+  }
+
+  const int first = node < 0 ? 0 : node % node_num_;
+  Frame *frame = nullptr;
+  int i = 0;
+  for (; i < node_num_ && frame == nullptr; i++) {
+    frame = free_lists_[(first + i) % node_num_];
+  }
+  if (frame == nullptr) {
+    return nullptr;
+  }
+
+  free_lists_[(first + i - 1) % node_num_] = frame->free_next_;
+  frame->free_next_ = nullptr;
+  frame_states_[index_of(frame)] = USED;
+  used_num_++;
+  return frame;
+}
+
+void FrameAllocator::free(Frame *frame)
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  const size_t index = index_of(frame);
+  if (index >= max_frame_num_ || frame_states_[index] != USED) {
+    LOG_WARN("free an invalid frame. frame=%p, index=%lu", frame, index);
+    return;
+  }
+
+  used_num_--;
+  if (index >= capacity_) {
+    release_memory(index);
+    return;
+  }
+
+  frame_states_[index] = FREE;
+  push_free(frame);
+}
+
+RC FrameAllocator::resize(size_t frame_num)
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  if (frame_num == 0 || frame_num > max_frame_num_) {
+    LOG_WARN("invalid frame num %lu, max frame num is %lu", frame_num, max_frame_num_);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  LOG_INFO("resize frame allocator from %lu to %lu frames", capacity_, frame_num);
+  resize_locked(frame_num);
+  return RC::SUCCESS;
+}
+
+void FrameAllocator::resize_locked(size_t frame_num)
+{
+  if (frame_num >= capacity_) {
+    // 倒序插入，保证地址低的frame先被分配出去
+    for (size_t index = frame_num; index-- > capacity_; ) {
+      if (frame_states_[index] != RELEASED) {
+        continue;  // 缩容时还在使用的frame，释放的时候会自动回到空闲链表
+      }
+      Frame *frame = new (frame_at(index)) Frame;  // 不要值初始化，避免把整个页面清零
+      push_free(frame);
+      frame_states_[index] = FREE;
+    }
+  } else {
+    for (Frame *&free_list : free_lists_) {
+      Frame **link = &free_list;
+      while (*link != nullptr) {
+        Frame *frame = *link;
+        const size_t index = index_of(frame);
+        if (index >= frame_num) {
+          *link = frame->free_next_;
+          release_memory(index);
+        } else {
+          link = &frame->free_next_;
+        }
+      }
+    }
+  }
+
+  capacity_ = frame_num;
+}
+
+bool FrameAllocator::beyond_capacity(const Frame *frame) const
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  return index_of(frame) >= capacity_;
+}
+
+size_t FrameAllocator::capacity() const
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  return capacity_;
+}
+
+size_t FrameAllocator::used_num() const
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+  return used_num_;
+}
@@ -0,0 +1,112 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/10/25.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+
+#include "rc.h"
+
+class Frame;
+
+/**
+ * Frame的内存分配器。
+ * 启动时一次性预留一块按照大页对齐的连续内存(arena)，所有的frame都从这块内存中切分出来，
+ * 空闲的frame使用侵入式链表串起来，分配和释放都是O(1)的，不需要额外申请内存。
+ * 预留的虚拟地址空间可以比实际使用的大，这样可以在运行时扩容或者缩容(参考resize)。
+ * 多个NUMA节点时，arena按照大页交错地绑定到各个节点上，每个节点有自己的空闲链表，
+ * 分配时优先使用调用线程所在节点的内存。按照大页交错而不是按节点切成几段，缩容之后各个节点剩下的frame也是均衡的。
+ */
+class FrameAllocator
+{
+public:
+  struct Options {
+    size_t max_frame_num = 0;    //! 最多可以扩容到多少个frame，0表示与初始大小相同
+    bool   populate      = false; //! 启动时是否预先分配好物理内存
+    bool   huge_page     = false; //! 是否使用透明大页
+    int    numa_node_num = 1;     //! 大于1时frame交错分布在这么多个NUMA节点上
+    int    page_size     = 0;     //! frame中页面的大小，0表示默认的BP_PAGE_SIZE
+  };
+
+public:
+  FrameAllocator() = default;
+  ~FrameAllocator();
+
+  RC init(size_t frame_num, const Options &options);
+  void cleanup();
+
+  /**
+   * 从空闲链表中分配一个frame
+   * @param node 优先从这个节点分配，这个节点没有空闲的frame时再从其它节点分配。小于0表示不关心
+   * @return 没有空闲的frame时返回nullptr
+   */
+  Frame *alloc(int node = -1);
+
+  /**
+   * 释放frame。如果frame已经超出了当前容量(缩容之后)，就将它的内存还给操作系统
+   */
+  void free(Frame *frame);
+
+  /**
+   * 调整容量。扩容是立即生效的；缩容时空闲的frame会立即释放，
+   * 正在使用的frame要等到调用free时才会释放，调用方可以通过beyond_capacity找到它们并尽快淘汰
+   */
+  RC resize(size_t frame_num);
+
+  /**
+   * frame是否在缩容之后超出了容量
+   */
+  bool beyond_capacity(const Frame *frame) const;
+
+  size_t capacity() const;
+  size_t max_capacity() const { return max_frame_num_; }
+  size_t used_num() const;
+
+  int node_num() const { return node_num_; }
+
+  /**
+   * frame的内存在哪个NUMA节点上，不需要加锁
+   */
+  int node_of(const Frame *frame) const;
+
+  /**
+   * 每个frame在arena中占用的字节数，frame的头部加上页面的大小
+   */
+  size_t frame_stride() const { return frame_stride_; }
+  int page_size() const { return page_size_; }
+
+private:
+  enum FrameState : char { RELEASED = 0, FREE, USED };
+
+  size_t index_of(const Frame *frame) const;
+  Frame *frame_at(size_t index) const;
+  void   release_memory(size_t index);
+  void   resize_locked(size_t frame_num);
+  void   push_free(Frame *frame);
+
+private:
+  mutable std::mutex lock_;
+  char *             arena_          = nullptr;
+  size_t             arena_size_     = 0;
+  size_t             capacity_       = 0;
+  size_t             max_frame_num_  = 0;
+  size_t             used_num_       = 0;
+  int                node_num_       = 1;
+  int                page_size_      = 0;
+  size_t             frame_stride_   = 0;
+  std::vector<Frame *> free_lists_;  // 每个NUMA节点一个空闲链表
+  std::vector<char>  frame_states_;
+};
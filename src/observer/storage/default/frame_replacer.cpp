@@ -0,0 +1,242 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/10/20.
+//
+
+#include <strings.h>
+
+#include "storage/default/frame_replacer.h"
+#include "storage/default/disk_buffer_pool.h"
+
+void FrameList::push_front(Frame *frame)
+{
+  FrameReplacerHook &hook = frame->replacer_hook();
+  hook.prev = nullptr;
+  hook.next = head_;
+  if (head_ != nullptr) {
+    head_->replacer_hook().prev = frame;
+  } else {
+    tail_ = frame;
+  }
+  head_ = frame;
+  size_++;
+}
+
+void FrameList::remove(Frame *frame)
+{
+  FrameReplacerHook &hook = frame->replacer_hook();
+  if (hook.prev != nullptr) {
+    hook.prev->replacer_hook().next = hook.next;
+  } else {
+    head_ = hook.next;
+  }
+
+  if (hook.next != nullptr) {
+    hook.next->replacer_hook().prev = hook.prev;
+  } else {
+    tail_ = hook.prev;
+  }
+
+  hook.prev = nullptr;
+  hook.next = nullptr;
+  size_--;
+}
+
+void FrameList::append_to(std::vector<Frame *> &frames) const
+{
+  for (Frame *frame = head_; frame != nullptr; frame = frame->replacer_hook().next) {
+    frames.push_back(frame);
+  }
+}
+
+FrameReplacer *FrameReplacer::create(const char *name)
+{
+  if (0 == strcasecmp(name, "lru")) {
+    return new LruFrameReplacer();
+  }
+  if (0 == strcasecmp(name, "clock")) {
+    return new ClockFrameReplacer();
+  }
+  if (0 == strcasecmp(name, "2q")) {
+    return new TwoQueueFrameReplacer();
+  }
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LruFrameReplacer::insert(Frame *frame)
+{
+  list_.push_front(frame);
+}
+
+void LruFrameReplacer::touch(Frame *frame)
+{
+  if (list_.front() != frame) {
+    list_.remove(frame);
+    list_.push_front(frame);
+  }
+}
+
+void LruFrameReplacer::remove(Frame *frame)
+{
+  list_.remove(frame);
+}
+
+Frame *LruFrameReplacer::victim()
+{
+  for (Frame *frame = list_.back(); frame != nullptr; frame = frame->replacer_hook().prev) {
+    if (frame->can_purge()) {
+      return frame;
+    }
+  }
+  return nullptr;
+}
+
+void LruFrameReplacer::list_hot_frames(std::vector<Frame *> &frames) const
+{
+  list_.append_to(frames);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ClockFrameReplacer::insert(Frame *frame)
+{
+  frame->replacer_hook().referenced = true;
+  list_.push_front(frame);
+}
+
+void ClockFrameReplacer::touch(Frame *frame)
+{
+  // 已经是1的时候不写，避免热点页面所在的缓存行在CPU之间来回失效
+  std::atomic<bool> &referenced = frame->replacer_hook().referenced;
+  if (!referenced.load(std::memory_order_relaxed)) {
+    referenced.store(true, std::memory_order_relaxed);
+  }
+}
+
+void ClockFrameReplacer::remove(Frame *frame)
+{
+  if (hand_ == frame) {
+    hand_ = list_.size() > 1 ? advance(frame) : nullptr;
+  }
+  list_.remove(frame);
+}
+
+Frame *ClockFrameReplacer::advance(Frame *frame) const
+{
+  // 时钟指针从最老的页面(尾部)向最新的页面(头部)移动，到头之后回到尾部
+  Frame *prev = frame->replacer_hook().prev;
+  return prev != nullptr ? prev : list_.back();
+}
+
+Frame *ClockFrameReplacer::victim()
+{
+  if (hand_ == nullptr) {
+    hand_ = list_.back();
+  }
+
+  // 转两圈还没有找到，说明所有页面都被pin住了
+  const size_t max_steps = list_.size() * 2;
+  for (size_t i = 0; i < max_steps; i++) {
+    Frame *frame = hand_;
+    hand_ = advance(frame);
+
+    if (!frame->can_purge()) {
+      continue;
+    }
+
+    FrameReplacerHook &hook = frame->replacer_hook();
+    if (hook.referenced) {
+      hook.referenced = false;
+      continue;
+    }
+    return frame;
+  }
+  return nullptr;
+}
+
+void ClockFrameReplacer::list_hot_frames(std::vector<Frame *> &frames) const
+{
+  // 没有顺序信息，访问位是1的页面比较热
+  for (int pass = 0; pass < 2; pass++) {
+    const bool referenced = (pass == 0);
+    for (Frame *frame = list_.front(); frame != nullptr; frame = frame->replacer_hook().next) {
+      if (frame->replacer_hook().referenced.load(std::memory_order_relaxed) == referenced) {
+        frames.push_back(frame);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FrameList &TwoQueueFrameReplacer::queue_of(Frame *frame)
+{
+  return frame->replacer_hook().queue == A1_QUEUE ? a1_ : am_;
+}
+
+void TwoQueueFrameReplacer::insert(Frame *frame)
+{
+  frame->replacer_hook().queue = A1_QUEUE;
+  a1_.push_front(frame);
+}
+
+void TwoQueueFrameReplacer::touch(Frame *frame)
+{
+  FrameReplacerHook &hook = frame->replacer_hook();
+  if (hook.queue == A1_QUEUE) {
+    a1_.remove(frame);
+    hook.queue = AM_QUEUE;
+    am_.push_front(frame);
+  } else if (am_.front() != frame) {
+    am_.remove(frame);
+    am_.push_front(frame);
+  }
+}
+
+void TwoQueueFrameReplacer::remove(Frame *frame)
+{
+  queue_of(frame).remove(frame);
+}
+
+static Frame *find_victim_from_tail(const FrameList &list)
+{
+  for (Frame *frame = list.back(); frame != nullptr; frame = frame->replacer_hook().prev) {
+    if (frame->can_purge()) {
+      return frame;
+    }
+  }
+  return nullptr;
+}
+
+Frame *TwoQueueFrameReplacer::victim()
+{
+  // A1 的目标大小是总页面数的1/4，超过目标大小时优先淘汰A1中只访问过一次的页面
+  const size_t a1_target = (a1_.size() + am_.size()) / 4;
+  Frame *frame = nullptr;
+  if (a1_.size() > a1_target || am_.size() == 0) {
+    frame = find_victim_from_tail(a1_);
+    if (frame == nullptr) {
+      frame = find_victim_from_tail(am_);
+    }
+  } else {
+    frame = find_victim_from_tail(am_);
+    if (frame == nullptr) {
+      frame = find_victim_from_tail(a1_);
+    }
+  }
+  return frame;
+}
+
+void TwoQueueFrameReplacer::list_hot_frames(std::vector<Frame *> &frames) const
+{
+  am_.append_to(frames);
+  a1_.append_to(frames);
+}
@@ -0,0 +1,177 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/10/20.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+class Frame;
+
+/**
+ * 页面替换算法在Frame上维护的信息，具体含义由替换算法自己解释。
+ * 使用侵入式的链表，加入、删除、访问页面时都不需要额外申请内存。
+ */
+struct FrameReplacerHook {
+  Frame *           prev  = nullptr;
+  Frame *           next  = nullptr;
+  int               queue = 0;            // 页面所在的队列，2Q算法使用
+  std::atomic<bool> referenced{false};    // 访问位，CLOCK算法使用。命中时不加锁设置
+
+  FrameReplacerHook() = default;
+  FrameReplacerHook &operator=(const FrameReplacerHook &other)
+  {
+    prev = other.prev;
+    next = other.next;
+    queue = other.queue;
+    referenced.store(other.referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+  }
+};
+
+/**
+ * 侵入式的Frame双向链表，头部是最新加入的页面
+ */
+class FrameList
+{
+public:
+  void push_front(Frame *frame);
+  void remove(Frame *frame);
+
+  Frame *front() const { return head_; }
+  Frame *back() const { return tail_; }
+  size_t size() const { return size_; }
+
+  /**
+   * 从头到尾把frame追加到frames中
+   */
+  void append_to(std::vector<Frame *> &frames) const;
+
+private:
+  Frame *head_ = nullptr;
+  Frame *tail_ = nullptr;
+  size_t size_ = 0;
+};
+
+/**
+ * 页面替换策略。
+ * BPFrameManager的每个分区都有一个独立的替换策略对象，调用方负责加锁。
+ */
+class FrameReplacer
+{
+public:
+  virtual ~FrameReplacer() = default;
+
+  /**
+   * 新的页面加载到了frame中
+   */
+  virtual void insert(Frame *frame) = 0;
+
+  /**
+   * 页面被访问(命中)
+   */
+  virtual void touch(Frame *frame) = 0;
+
+  /**
+   * touch是否可以不加锁调用。可以的话，命中页面时就不需要获取分区的锁了
+   */
+  virtual bool concurrent_touch() const { return false; }
+
+  /**
+   * frame被释放，不再参与替换
+   */
+  virtual void remove(Frame *frame) = 0;
+
+  /**
+   * 挑选一个可以淘汰的页面(pin count为0)。不会将其从替换策略中移除
+   * @return 没有可以淘汰的页面时返回nullptr
+   */
+  virtual Frame *victim() = 0;
+
+  /**
+   * 按照从热到冷的顺序列出所有的frame，用于保存缓冲池预热的页面列表
+   */
+  virtual void list_hot_frames(std::vector<Frame *> &frames) const = 0;
+
+  /**
+   * 根据名字创建替换策略，支持 lru, clock 和 2q
+   * @return 名字不认识时返回nullptr
+   */
+  static FrameReplacer *create(const char *name);
+};
+
+/**
+ * 经典的LRU。每次命中都要将页面移动到链表头部，淘汰时从尾部开始查找
+ */
+class LruFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame) override;
+  void touch(Frame *frame) override;
+  void remove(Frame *frame) override;
+  Frame *victim() override;
+  void list_hot_frames(std::vector<Frame *> &frames) const override;
+
+private:
+  FrameList list_;
+};
+
+/**
+ * CLOCK算法。命中时只设置访问位，淘汰时时钟指针扫过的页面如果访问位是1就清零，
+ * 遇到访问位是0并且没有被pin的页面就淘汰
+ */
+class ClockFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame) override;
+  void touch(Frame *frame) override;
+  bool concurrent_touch() const override { return true; }
+  void remove(Frame *frame) override;
+  Frame *victim() override;
+  void list_hot_frames(std::vector<Frame *> &frames) const override;
+
+private:
+  Frame *advance(Frame *frame) const;
+
+private:
+  FrameList list_;
+  Frame *   hand_ = nullptr;
+};
+
+/**
+ * 简化的2Q算法，可以抵抗全表扫描对缓存的污染。
+ * 第一次加载的页面放在A1队列(FIFO)中，再次被访问时才会晋升到Am队列(LRU)。
+ * 淘汰时优先选择A1中的页面，只要A1没有小于目标大小，Am中的热点页面(比如索引页面)就不会被扫描冲掉。
+ */
+class TwoQueueFrameReplacer : public FrameReplacer
+{
+public:
+  void insert(Frame *frame) override;
+  void touch(Frame *frame) override;
+  void remove(Frame *frame) override;
+  Frame *victim() override;
+  void list_hot_frames(std::vector<Frame *> &frames) const override;
+
+public:
+  static const int A1_QUEUE = 1;
+  static const int AM_QUEUE = 2;
+
+private:
+  FrameList &queue_of(Frame *frame);
+
+private:
+  FrameList a1_;
+  FrameList am_;
+};
@@ -0,0 +1,233 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/10/28.
+//
+
+#include <algorithm>
+#include <chrono>
+
+#include "storage/default/page_cleaner.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "common/log/log.h"
+#include "common/metrics/metrics.h"
+#include "common/metrics/metrics_registry.h"
+
+using namespace common;
+
+static const std::string FLUSHED_METRIC_TAG = "BufferPool.cleaner.flushed";
+static const std::string STALL_METRIC_TAG = "BufferPool.cleaner.eviction_stall_us";
+static const std::string LAG_METRIC_TAG = "BufferPool.cleaner.lag";
+
+/**
+ * 前台发生淘汰等待时，每个分区至少刷这么多页面
+ */
+static const size_t URGENT_BATCH_SIZE = 32;
+
+class CleanerLagGauge : public Gauge
+{
+public:
+  CleanerLagGauge(const PageCleaner &cleaner) : cleaner_(cleaner)
+  {
+    set_snapshot(new SnapshotBasic<long>());
+  }
+
+  virtual ~CleanerLagGauge()
+  {
+    delete snapshot_value_;
+  }
+
+  void snapshot() override
+  {
+    long lag = static_cast<long>(cleaner_.lag());
+    static_cast<SnapshotBasic<long> *>(snapshot_value_)->setValue(lag);
+  }
+
+private:
+  const PageCleaner &cleaner_;
+};
+
+PageCleaner::PageCleaner(BufferPoolManager &bp_manager, const Options &options)
+    : bp_manager_(bp_manager), options_(options)
+{
+  // 线程比分区多没有意义。每个缓冲池的分区独立地分给各个线程
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  bp_manager_.all_pools(pools);
+  int max_partition_num = 1;
+  for (auto &pool : pools) {
+    max_partition_num = std::max(max_partition_num, pool.second->partition_num());
+  }
+  options_.thread_num = std::max(1, std::min(options_.thread_num, max_partition_num));
+  options_.interval_ms = std::max(options_.interval_ms, 1);
+
+  lags_.reset(new std::atomic<size_t>[options_.thread_num]);
+  for (int i = 0; i < options_.thread_num; i++) {
+    lags_[i].store(0);
+  }
+}
+
+PageCleaner::~PageCleaner()
+{
+  stop();
+}
+
+RC PageCleaner::start()
+{
+  if (options_.clean_ratio <= 0 || options_.clean_ratio >= 1) {
+    LOG_WARN("invalid clean ratio %lf", options_.clean_ratio);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  flushed_meter_ = new Meter();
+  stall_timer_ = new SimpleTimer();
+  lag_gauge_ = new CleanerLagGauge(*this);
+  MetricsRegistry &metrics_registry = get_metrics_registry();
+  metrics_registry.register_metric(FLUSHED_METRIC_TAG, flushed_meter_);
+  metrics_registry.register_metric(STALL_METRIC_TAG, stall_timer_);
+  metrics_registry.register_metric(LAG_METRIC_TAG, lag_gauge_);
+
+  stopped_ = false;
+  for (int i = 0; i < options_.thread_num; i++) {
+    threads_.emplace_back(&PageCleaner::run, this, i);
+  }
+
+  LOG_INFO("page cleaner started. thread num=%d, clean ratio=%lf, interval=%dms",
+           options_.thread_num, options_.clean_ratio, options_.interval_ms);
+  return RC::SUCCESS;
+}
+
+void PageCleaner::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock_guard(lock_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  cond_.notify_all();
+
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+
+  MetricsRegistry &metrics_registry = get_metrics_registry();
+  metrics_registry.unregister(FLUSHED_METRIC_TAG);
+  metrics_registry.unregister(STALL_METRIC_TAG);
+  metrics_registry.unregister(LAG_METRIC_TAG);
+  delete flushed_meter_;
+  delete stall_timer_;
+  delete lag_gauge_;
+  flushed_meter_ = nullptr;
+  stall_timer_ = nullptr;
+  lag_gauge_ = nullptr;
+  LOG_INFO("page cleaner stopped");
+}
+
+void PageCleaner::wakeup()
+{
+  {
+    std::lock_guard<std::mutex> lock_guard(lock_);
+    wakeup_seq_++;
+  }
+  cond_.notify_all();
+}
+
+void PageCleaner::record_stall(long us)
+{
+  if (stall_timer_ != nullptr) {
+    stall_timer_->update(us);
+  }
+}
+
+size_t PageCleaner::lag() const
+{
+  size_t lag = 0;
+  for (int i = 0; i < options_.thread_num; i++) {
+    lag += lags_[i].load();
+  }
+  return lag;
+}
+
+int PageCleaner::clean_round(int thread_index, bool urgent)
+{
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  bp_manager_.all_pools(pools);
+
+  size_t total_lag = 0;
+  int flushed_num = 0;
+  for (auto &pool : pools) {
+    clean_pool(*pool.second, thread_index, urgent, flushed_num, total_lag);
+  }
+
+  lags_[thread_index].store(total_lag);
+  if (flushed_num > 0) {
+    if (flushed_meter_ != nullptr) {
+      flushed_meter_->inc(flushed_num);
+    }
+    LOG_DEBUG("page cleaner %d flushed %d pages. urgent=%d, lag=%lu", thread_index, flushed_num, urgent, total_lag);
+  }
+  return flushed_num;
+}
+
+void PageCleaner::clean_pool(BPFrameManager &frame_manager, int thread_index, bool urgent, int &flushed_num,
+                             size_t &total_lag)
+{
+  const int partition_num = frame_manager.partition_num();
+
+  // 空闲的frame不属于任何分区，平均分给每个分区计算
+  const double target = frame_manager.total_frame_num() * options_.clean_ratio / partition_num;
+  const double free_num = static_cast<double>(frame_manager.free_frame_num()) / partition_num;
+
+  for (int i = thread_index; i < partition_num; i += options_.thread_num) {
+    size_t frame_num = 0;
+    size_t dirty_num = 0;
+    frame_manager.count_frames(i, frame_num, dirty_num);
+
+    const double clean_num = free_num + frame_num - dirty_num;
+    size_t lag = clean_num < target ? static_cast<size_t>(target - clean_num + 0.5) : 0;
+    if (urgent) {
+      lag = std::max(lag, URGENT_BATCH_SIZE);
+    }
+    lag = std::min(lag, dirty_num);
+    if (lag == 0) {
+      continue;
+    }
+
+    const int num = bp_manager_.flush_dirty_frames(frame_manager, i, lag);
+    flushed_num += num;
+    total_lag += lag - std::min(lag, static_cast<size_t>(num));
+  }
+}
+
+void PageCleaner::run(int thread_index)
+{
+  LOG_INFO("page cleaner thread %d started", thread_index);
+
+  std::unique_lock<std::mutex> lock(lock_);
+  unsigned long seen_seq = wakeup_seq_;
+  while (!stopped_) {
+    cond_.wait_for(lock, std::chrono::milliseconds(options_.interval_ms),
+                   [this, seen_seq]() { return stopped_ || wakeup_seq_ != seen_seq; });
+    if (stopped_) {
+      break;
+    }
+
+    const bool urgent = wakeup_seq_ != seen_seq;
+    seen_seq = wakeup_seq_;
+    lock.unlock();
+    clean_round(thread_index, urgent);
+    lock.lock();
+  }
+
+  LOG_INFO("page cleaner thread %d stopped", thread_index);
+}
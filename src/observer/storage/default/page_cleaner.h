@@ -0,0 +1,102 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/10/28.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rc.h"
+
+namespace common {
+class Meter;
+class SimpleTimer;
+class Gauge;
+}  // namespace common
+
+class BufferPoolManager;
+class BPFrameManager;
+
+/**
+ * 后台刷脏线程。
+ * 如果只在淘汰页面的时候才把脏页写回磁盘，前台的查询就要等待这次写操作(eviction stall)。
+ * PageCleaner 周期性地检查每个分区中干净页面(空闲的frame加上不脏的页面)的比例，
+ * 低于目标比例时，就把分区中没有被使用的脏页按照页号排序，合并成尽量少的写操作刷到磁盘，
+ * 保证前台淘汰页面时大多能直接拿到干净的页面。
+ * 前台淘汰脏页时会调用wakeup，让后台线程立即开始一轮刷脏。
+ * 多个线程时，第i个线程负责编号 partition % thread_num == i 的分区。
+ */
+class PageCleaner
+{
+public:
+  struct Options {
+    int    thread_num  = 1;    //! 刷脏线程的个数
+    double clean_ratio = 0.2;  //! 每个分区中干净页面的目标比例
+    int    interval_ms = 100;  //! 两轮刷脏之间的间隔
+  };
+
+public:
+  PageCleaner(BufferPoolManager &bp_manager, const Options &options);
+  ~PageCleaner();
+
+  RC start();
+  void stop();
+
+  /**
+   * 前台淘汰脏页时调用，唤醒后台线程立即刷脏
+   */
+  void wakeup();
+
+  /**
+   * 记录一次前台淘汰脏页的等待时间
+   */
+  void record_stall(long us);
+
+  /**
+   * 所有分区距离目标干净页面个数还差多少页
+   */
+  size_t lag() const;
+
+  /**
+   * 执行一轮刷脏，返回刷盘的页面个数。每个缓冲池都会检查一遍
+   * @param thread_index 只处理这个线程负责的分区
+   * @param urgent 前台发生了淘汰等待，即使没有落后于目标也刷一批
+   */
+  int clean_round(int thread_index, bool urgent);
+
+private:
+  void run(int thread_index);
+  void clean_pool(BPFrameManager &frame_manager, int thread_index, bool urgent, int &flushed_num, size_t &total_lag);
+
+private:
+  BufferPoolManager &       bp_manager_;
+  Options                   options_;
+
+  std::vector<std::thread>  threads_;
+  std::mutex                lock_;
+  std::condition_variable   cond_;
+  bool                      stopped_ = true;
+  unsigned long             wakeup_seq_ = 0;  // 每次wakeup加一，线程据此判断是否有新的唤醒请求
+
+  std::unique_ptr<std::atomic<size_t>[]> lags_;  // 每个线程负责的分区的落后页面数
+
+  common::Meter *           flushed_meter_ = nullptr;
+  common::SimpleTimer *     stall_timer_   = nullptr;
+  common::Gauge *           lag_gauge_     = nullptr;
+};
@@ -0,0 +1,384 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/02.
+//
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define MINIOB_HAVE_IO_URING 1
+#endif
+
+#include "storage/default/page_io.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "common/log/log.h"
+
+static const unsigned DEFAULT_IO_URING_ENTRIES = 256;
+
+PageIO *PageIO::create(const std::string &name)
+{
+  if (0 == strcasecmp(name.c_str(), "io_uring")) {
+    IoUringPageIO *page_io = new IoUringPageIO();
+    RC rc = page_io->init(DEFAULT_IO_URING_ENTRIES);
+    if (rc == RC::SUCCESS) {
+      return page_io;
+    }
+    LOG_WARN("io_uring is not available, fallback to sync page io. rc=%s", strrc(rc));
+    delete page_io;
+  } else if (0 != strcasecmp(name.c_str(), "sync")) {
+    LOG_WARN("unknown page io backend %s, use sync", name.c_str());
+  }
+  return new SyncPageIO();
+}
+
+RC PageIO::read_pages(PageIORequest *requests, int num)
+{
+  return submit(false, requests, num);
+}
+
+RC PageIO::write_pages(PageIORequest *requests, int num)
+{
+  return submit(true, requests, num);
+}
+
+RC PageIO::submit(bool write, PageIORequest *requests, int num)
+{
+  if (num <= 0) {
+    return RC::SUCCESS;
+  }
+
+  // 同一个文件中页号连续的请求合并成一段
+  std::vector<struct iovec> iov(num);
+  std::vector<Run> runs;
+  for (int i = 0; i < num; i++) {
+    PageIORequest &request = requests[i];
+    request.rc = RC::SUCCESS;
+    iov[i].iov_base = request.page;
+    iov[i].iov_len = request.page_size;
+
+    if (!runs.empty()) {
+      Run &last = runs.back();
+      const PageIORequest &prev = requests[i - 1];
+      if (prev.file_desc == request.file_desc && prev.page_num + 1 == request.page_num &&
+          prev.page_size == request.page_size && last.iov_num < IOV_MAX) {
+        last.iov_num++;
+        continue;
+      }
+    }
+
+    Run run;
+    run.file_desc = request.file_desc;
+    run.offset = static_cast<off_t>(request.page_num) * request.page_size;
+    run.iov = &iov[i];
+    run.iov_num = 1;
+    run.requests = &request;
+    runs.push_back(run);
+  }
+
+  do_io(write, runs);
+
+  for (int i = 0; i < num; i++) {
+    if (requests[i].rc != RC::SUCCESS) {
+      return requests[i].rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void PageIO::set_result(const Run &run, RC rc)
+{
+  for (int i = 0; i < run.iov_num; i++) {
+    run.requests[i].rc = rc;
+  }
+}
+
+RC PageIO::sync_io(bool write, const Run &run, size_t done)
+{
+  // 跳过已经完成的部分
+  int index = 0;
+  while (index < run.iov_num && done >= run.iov[index].iov_len) {
+    done -= run.iov[index].iov_len;
+    index++;
+  }
+  if (index >= run.iov_num) {
+    return RC::SUCCESS;
+  }
+
+  std::vector<struct iovec> iov(run.iov + index, run.iov + run.iov_num);
+  iov[0].iov_base = static_cast<char *>(iov[0].iov_base) + done;
+  iov[0].iov_len -= done;
+  off_t offset = run.offset + static_cast<off_t>(index) * run.iov[0].iov_len + done;
+
+  size_t begin = 0;
+  while (begin < iov.size()) {
+    const int iov_num = static_cast<int>(iov.size() - begin);
+    ssize_t ret = write ? pwritev(run.file_desc, &iov[begin], iov_num, offset)
+                        : preadv(run.file_desc, &iov[begin], iov_num, offset);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      LOG_ERROR("Failed to %s pages. fd=%d, offset=%ld, error=%s",
+                write ? "write" : "read", run.file_desc, (long)offset, strerror(errno));
+      return write ? RC::IOERR_WRITE : RC::IOERR_READ;
+    }
+    if (ret == 0) {
+      LOG_ERROR("Failed to read pages, end of file. fd=%d, offset=%ld", run.file_desc, (long)offset);
+      return RC::IOERR_READ;
+    }
+
+    offset += ret;
+    while (ret > 0) {
+      struct iovec &vec = iov[begin];
+      if (static_cast<size_t>(ret) >= vec.iov_len) {
+        ret -= vec.iov_len;
+        begin++;
+      } else {
+        vec.iov_base = static_cast<char *>(vec.iov_base) + ret;
+        vec.iov_len -= ret;
+        ret = 0;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SyncPageIO::do_io(bool write, std::vector<Run> &runs)
+{
+  for (const Run &run : runs) {
+    set_result(run, sync_io(write, run, 0));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+#ifdef MINIOB_HAVE_IO_URING
+
+static inline unsigned load_acquire(const unsigned *p)
+{
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(unsigned *p, unsigned v)
+{
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+IoUringPageIO::~IoUringPageIO()
+{
+  cleanup();
+}
+
+RC IoUringPageIO::init(unsigned entries)
+{
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ring_fd_ < 0) {
+    LOG_WARN("failed to setup io_uring. error=%s", strerror(errno));
+    ring_fd_ = -1;
+    return RC::UNIMPLENMENT;
+  }
+
+  sq_entries_ = params.sq_entries;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    LOG_WARN("failed to map io_uring submission queue. error=%s", strerror(errno));
+    cleanup();
+    return RC::IOERR;
+  }
+
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      LOG_WARN("failed to map io_uring completion queue. error=%s", strerror(errno));
+      cleanup();
+      return RC::IOERR;
+    }
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    LOG_WARN("failed to map io_uring submission entries. error=%s", strerror(errno));
+    cleanup();
+    return RC::IOERR;
+  }
+
+  char *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+  char *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+
+  LOG_INFO("io_uring page io initialized. sq entries=%u, cq entries=%u", params.sq_entries, params.cq_entries);
+  return RC::SUCCESS;
+}
+
+void IoUringPageIO::cleanup()
+{
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  cq_ring_ = nullptr;
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = nullptr;
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+}
+
+int IoUringPageIO::enter(unsigned to_submit, unsigned min_complete)
+{
+  while (true) {
+    int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+                                       min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+    if (ret >= 0 || errno != EINTR) {
+      return ret;
+    }
+  }
+}
+
+void IoUringPageIO::do_io(bool write, std::vector<Run> &runs)
+{
+  std::lock_guard<std::mutex> lock_guard(lock_);
+
+  struct io_uring_sqe *sqes = static_cast<struct io_uring_sqe *>(sqes_);
+  struct io_uring_cqe *cqes = static_cast<struct io_uring_cqe *>(cqes_);
+
+  // 每次最多提交sq_entries_个请求，完成队列是提交队列的两倍大，不会溢出
+  size_t begin = 0;
+  while (begin < runs.size()) {
+    const size_t end = std::min(runs.size(), begin + sq_entries_);
+
+    unsigned tail = *sq_tail_;
+    for (size_t i = begin; i < end; i++) {
+      const Run &run = runs[i];
+      const unsigned index = tail & *sq_mask_;
+      struct io_uring_sqe &sqe = sqes[index];
+      memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe.fd = run.file_desc;
+      sqe.off = run.offset;
+      sqe.addr = reinterpret_cast<unsigned long>(run.iov);
+      sqe.len = run.iov_num;
+      sqe.user_data = i;
+      sq_array_[index] = index;
+      tail++;
+    }
+    store_release(sq_tail_, tail);
+
+    const unsigned to_submit = static_cast<unsigned>(end - begin);
+    int ret = enter(to_submit, to_submit);
+    if (ret < 0) {
+      // 提交失败，整批走同步IO
+      LOG_WARN("failed to submit io_uring requests. error=%s", strerror(errno));
+      for (size_t i = begin; i < end; i++) {
+        set_result(runs[i], sync_io(write, runs[i], 0));
+      }
+      begin = end;
+      continue;
+    }
+
+    unsigned completed = 0;
+    while (completed < to_submit) {
+      unsigned head = *cq_head_;
+      const unsigned cq_tail = load_acquire(cq_tail_);
+      if (head == cq_tail) {
+        if (enter(0, 1) < 0) {
+          LOG_ERROR("failed to wait io_uring completions. error=%s", strerror(errno));
+          break;
+        }
+        continue;
+      }
+
+      for (; head != cq_tail; head++) {
+        const struct io_uring_cqe &cqe = cqes[head & *cq_mask_];
+        const Run &run = runs[cqe.user_data];
+        const size_t expected = static_cast<size_t>(run.iov_num) * run.iov[0].iov_len;
+        if (cqe.res < 0) {
+          LOG_ERROR("Failed to %s pages. fd=%d, offset=%ld, error=%s",
+                    write ? "write" : "read", run.file_desc, (long)run.offset, strerror(-cqe.res));
+          set_result(run, write ? RC::IOERR_WRITE : RC::IOERR_READ);
+        } else if (static_cast<size_t>(cqe.res) < expected) {
+          // 部分完成，剩下的同步处理
+          set_result(run, sync_io(write, run, static_cast<size_t>(cqe.res)));
+        } else {
+          set_result(run, RC::SUCCESS);
+        }
+        completed++;
+      }
+      store_release(cq_head_, head);
+    }
+    begin = end;
+  }
+}
+
+#else  // MINIOB_HAVE_IO_URING
+
+IoUringPageIO::~IoUringPageIO()
+{}
+
+RC IoUringPageIO::init(unsigned entries)
+{
+  LOG_WARN("io_uring is not supported on this platform");
+  return RC::UNIMPLENMENT;
+}
+
+void IoUringPageIO::cleanup()
+{}
+
+int IoUringPageIO::enter(unsigned to_submit, unsigned min_complete)
+{
+  return -1;
+}
+
+void IoUringPageIO::do_io(bool write, std::vector<Run> &runs)
+{
+  for (const Run &run : runs) {
+    set_result(run, sync_io(write, run, 0));
+  }
+}
+
+#endif  // MINIOB_HAVE_IO_URING
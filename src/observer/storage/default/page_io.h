@@ -0,0 +1,148 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/02.
+//
+
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rc.h"
+#include "defs.h"
+#include "storage/default/disk_buffer_pool.h"
+
+/**
+ * 一个页面的读写请求
+ */
+struct PageIORequest {
+  int     file_desc = -1;
+  PageNum page_num  = -1;
+  Page *  page      = nullptr;
+  int     page_size = BP_PAGE_SIZE;  //! 页面所在文件的页面大小，同一个文件的请求都相同
+  RC      rc        = RC::SUCCESS;  //! 请求完成之后的结果
+};
+
+/**
+ * 页面读写的接口，DiskBufferPool所有的页面IO都通过它来完成。
+ * 批量读写时，同一个文件中页号连续的请求会合并成一次向量IO(preadv/pwritev或者io_uring的readv/writev)。
+ * 调用返回时所有请求都已经完成，每个请求的结果记录在PageIORequest::rc中。
+ */
+class PageIO
+{
+public:
+  virtual ~PageIO() = default;
+
+  virtual const char *name() const = 0;
+
+  /**
+   * @param requests 请求按照(file_desc, page_num)排好序时合并的效果最好
+   * @return 有一个请求失败就返回失败
+   */
+  RC read_pages(PageIORequest *requests, int num);
+  RC write_pages(PageIORequest *requests, int num);
+
+  /**
+   * 按照名字创建，可以是 sync 或者 io_uring。
+   * 系统不支持io_uring(比如内核版本太低或者被seccomp禁止)时退化成sync
+   */
+  static PageIO *create(const std::string &name);
+
+protected:
+  /**
+   * 一段连续的页面
+   */
+  struct Run {
+    int             file_desc;
+    off_t           offset;
+    struct iovec *  iov;
+    int             iov_num;
+    PageIORequest * requests;
+  };
+
+  /**
+   * 执行一批IO，需要设置每个Run中所有请求的rc
+   */
+  virtual void do_io(bool write, std::vector<Run> &runs) = 0;
+
+  /**
+   * 同步完成一段向量IO，处理部分读写的情况
+   * @param done 已经完成的字节数
+   */
+  static RC sync_io(bool write, const Run &run, size_t done);
+
+  static void set_result(const Run &run, RC rc);
+
+private:
+  RC submit(bool write, PageIORequest *requests, int num);
+};
+
+/**
+ * 阻塞的pread/pwrite实现
+ */
+class SyncPageIO : public PageIO
+{
+public:
+  const char *name() const override { return "sync"; }
+
+protected:
+  void do_io(bool write, std::vector<Run> &runs) override;
+};
+
+/**
+ * 基于Linux io_uring的实现。一批请求一次提交，然后等待全部完成，
+ * 这样一次批量读写只需要一到两次系统调用，并且内核可以并发处理这些请求。
+ * 不依赖liburing，直接使用系统调用。
+ */
+class IoUringPageIO : public PageIO
+{
+public:
+  IoUringPageIO() = default;
+  ~IoUringPageIO();
+
+  const char *name() const override { return "io_uring"; }
+
+  /**
+   * @param entries 提交队列的大小，一批请求超过这个数量时会分多次提交
+   */
+  RC init(unsigned entries);
+
+protected:
+  void do_io(bool write, std::vector<Run> &runs) override;
+
+private:
+  void cleanup();
+  int  enter(unsigned to_submit, unsigned min_complete);
+
+private:
+  std::mutex lock_;
+  int        ring_fd_ = -1;
+  unsigned   sq_entries_ = 0;
+
+  void *     sq_ring_ = nullptr;
+  size_t     sq_ring_size_ = 0;
+  void *     cq_ring_ = nullptr;
+  size_t     cq_ring_size_ = 0;
+  void *     sqes_ = nullptr;
+  size_t     sqes_size_ = 0;
+
+  unsigned * sq_tail_ = nullptr;
+  unsigned * sq_mask_ = nullptr;
+  unsigned * sq_array_ = nullptr;
+  unsigned * cq_head_ = nullptr;
+  unsigned * cq_tail_ = nullptr;
+  unsigned * cq_mask_ = nullptr;
+  void *     cqes_ = nullptr;
+};
@@ -0,0 +1,144 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/05.
+//
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+#include "storage/default/space_map.h"
+
+static const int WORD_BITS = 64;
+
+BPSpaceMap::BPSpaceMap(int group_page_num)
+    : group_page_num_(group_page_num), group_word_num_((group_page_num + WORD_BITS - 1) / WORD_BITS)
+{
+  // 位图按照字节读取
+  assert(group_page_num > 0 && group_page_num % 8 == 0);
+}
+
+int BPSpaceMap::pages_in_group(int group, int page_count) const
+{
+  const PageNum begin = group_page(group);
+  if (page_count <= begin) {
+    return 0;
+  }
+  return std::min(group_page_num_, page_count - begin);
+}
+
+void BPSpaceMap::clear()
+{
+  levels_.clear();
+}
+
+uint64_t BPSpaceMap::free_mask(const char *bitmap, int word, int pages) const
+{
+  const int begin = word * WORD_BITS;
+  if (begin >= pages) {
+    return 0;
+  }
+
+  // 最后一个字可能不完整，只读取位图中存在的字节
+  const int bits = std::min(WORD_BITS, pages - begin);
+  uint64_t value = 0;
+  memcpy(&value, bitmap + begin / 8, (bits + 7) / 8);
+
+  const uint64_t mask = bits == WORD_BITS ? ~0ULL : ((1ULL << bits) - 1);
+  return ~value & mask;
+}
+
+void BPSpaceMap::load_group(int group, const char *bitmap, int page_count)
+{
+  const size_t base = static_cast<size_t>(group) * group_word_num_;
+  grow(base + group_word_num_);
+
+  const int pages = pages_in_group(group, page_count);
+  for (int word = 0; word < group_word_num_; word++) {
+    set_word(base + word, free_mask(bitmap, word, pages) != 0);
+  }
+}
+
+void BPSpaceMap::update(PageNum page_num, const char *bitmap, int page_count)
+{
+  const int group = group_of(page_num);
+  const int word = (page_num - group_page(group)) / WORD_BITS;
+  const size_t index = static_cast<size_t>(group) * group_word_num_ + word;
+  grow(index + 1);
+  set_word(index, free_mask(bitmap, word, pages_in_group(group, page_count)) != 0);
+}
+
+bool BPSpaceMap::first_free_word(int &group, int &word) const
+{
+  if (levels_.empty() || levels_.back()[0] == 0) {
+    return false;
+  }
+
+  size_t index = 0;
+  for (int level = static_cast<int>(levels_.size()) - 1; level >= 0; level--) {
+    index = index * WORD_BITS + __builtin_ctzll(levels_[level][index]);
+  }
+  group = static_cast<int>(index / group_word_num_);
+  word = static_cast<int>(index % group_word_num_);
+  return true;
+}
+
+void BPSpaceMap::set_word(size_t index, bool has_free)
+{
+  for (std::vector<uint64_t> &level : levels_) {
+    uint64_t &value = level[index / WORD_BITS];
+    const bool was_empty = value == 0;
+    if (has_free) {
+      value |= 1ULL << (index % WORD_BITS);
+    } else {
+      value &= ~(1ULL << (index % WORD_BITS));
+    }
+
+    // 这个字是否为空没有变化，上面的层就不需要修改了
+    if ((value == 0) == was_empty) {
+      break;
+    }
+    index /= WORD_BITS;
+    has_free = value != 0;
+  }
+}
+
+void BPSpaceMap::grow(size_t word_num)
+{
+  if (!levels_.empty() && levels_[0].size() * WORD_BITS >= word_num) {
+    return;
+  }
+
+  size_t bit_num = word_num;
+  for (size_t level = 0;; level++) {
+    const size_t size = (bit_num + WORD_BITS - 1) / WORD_BITS;
+    if (level == levels_.size()) {
+      // 新增加的一层，根据下一层的内容构建
+      levels_.emplace_back(size, 0);
+      if (level > 0) {
+        const std::vector<uint64_t> &lower = levels_[level - 1];
+        for (size_t i = 0; i < lower.size(); i++) {
+          if (lower[i] != 0) {
+            levels_[level][i / WORD_BITS] |= 1ULL << (i % WORD_BITS);
+          }
+        }
+      }
+    } else if (levels_[level].size() < size) {
+      levels_[level].resize(size, 0);
+    }
+
+    if (size == 1) {
+      break;
+    }
+    bit_num = size;
+  }
+}
@@ -0,0 +1,100 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/05.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "defs.h"
+
+/**
+ * 分页文件的空闲页面摘要，用来快速找到一个空闲页面。
+ *
+ * 文件按照group_page_num个页面划分成多个分组，每个分组有一个页面分配位图(见BPFileHeader和BPGroupHeader)。
+ * 位图本身保存在文件中，这里只在内存中维护它的摘要：
+ * 第0层的每一位对应位图中的一个64位的字，字中有空闲页面时置1；
+ * 上面每一层的一位对应下一层的一个字，字不为0时置1，一直到最上层只剩一个字。
+ * 查找第一个空闲页面时从最上层往下找，复杂度是O(log64(n))，找到的是位图中的一个字，
+ * 再在这个字中找到具体的页面。
+ * 打开文件时根据所有分组的位图构建(load_group)，之后位图中的某一位变化时调用update更新。
+ *
+ * 超出文件页面个数(page_count)的位不算空闲页面，它们需要通过扩展文件来分配。
+ */
+class BPSpaceMap
+{
+public:
+  /**
+   * @param group_page_num 每个分组的页面个数，即一个位图页能够表示多少个页面
+   */
+  explicit BPSpaceMap(int group_page_num);
+
+  int group_page_num() const { return group_page_num_; }
+
+  int group_of(PageNum page_num) const { return page_num / group_page_num_; }
+
+  /**
+   * 分组的位图所在的页面，就是这个分组的第一个页面。第0个分组的位图在文件头中
+   */
+  PageNum group_page(int group) const { return static_cast<PageNum>(group) * group_page_num_; }
+
+  bool is_bitmap_page(PageNum page_num) const { return page_num % group_page_num_ == 0; }
+
+  /**
+   * 文件中有page_count个页面时，分组中有多少个页面已经存在于文件中
+   */
+  int pages_in_group(int group, int page_count) const;
+
+  /**
+   * 清空摘要，打开文件之前调用
+   */
+  void clear();
+
+  /**
+   * 根据分组的位图重新计算这个分组的摘要
+   * @param bitmap 分组的位图
+   * @param page_count 文件中的页面个数
+   */
+  void load_group(int group, const char *bitmap, int page_count);
+
+  /**
+   * 位图中page_num对应的位发生变化之后调用，重新计算它所在的字
+   */
+  void update(PageNum page_num, const char *bitmap, int page_count);
+
+  /**
+   * 查找第一个有空闲页面的位图字
+   * @param group 字所在的分组
+   * @param word 字在分组位图中的下标
+   * @return 没有空闲页面时返回false
+   */
+  bool first_free_word(int &group, int &word) const;
+
+  /**
+   * 分组位图中第word个字里面空闲页面的掩码，超出分组大小或者文件页面个数的位不算空闲
+   * @param pages 分组中已经存在于文件中的页面个数
+   */
+  uint64_t free_mask(const char *bitmap, int word, int pages) const;
+
+private:
+  void set_word(size_t index, bool has_free);
+  void grow(size_t word_num);
+
+private:
+  int group_page_num_;
+  int group_word_num_;  // 每个分组的位图有多少个64位的字
+
+  // levels_[0]是最下层，每一位对应位图中的一个字
+  std::vector<std::vector<uint64_t>> levels_;
+};
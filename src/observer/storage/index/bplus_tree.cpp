@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 // Rewritten by Longda & Wangyunlai
 //
 #include "storage/index/bplus_tree.h"
+#include <algorithm>
 #include "storage/default/disk_buffer_pool.h"
 #include "rc.h"
 #include "common/log/log.h"
@@ -21,20 +22,20 @@ See the Mulan PSL v2 for more details. */
 
 #define FIRST_INDEX_PAGE 1
 
-int calc_internal_page_capacity(int attr_length)
+int calc_internal_page_capacity(int attr_length, int page_data_size)
 {
   int item_size = attr_length + sizeof(RID) + sizeof(PageNum);
 
   int capacity =
-    ((int)BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) / item_size;
+    (page_data_size - InternalIndexNode::HEADER_SIZE) / item_size;
   return capacity;
 }
 
-int calc_leaf_page_capacity(int attr_length)
+int calc_leaf_page_capacity(int attr_length, int page_data_size)
 {
   int item_size = attr_length + sizeof(RID) + sizeof(RID);
   int capacity =
-    ((int)BP_PAGE_DATA_SIZE - LeafIndexNode::HEADER_SIZE) / item_size;
+    (page_data_size - LeafIndexNode::HEADER_SIZE) / item_size;
   return capacity;
 }
 
@@ -261,7 +262,9 @@ RC LeafIndexNodeHandler::move_to(LeafIndexNodeHandler &other, DiskBufferPool *bp
     }
 
     LeafIndexNodeHandler next_right_node(header_, next_right_frame);
+    next_right_frame->latch().lock();
     next_right_node.set_prev_page(other.page_num());
+    next_right_frame->latch().unlock();
     next_right_frame->mark_dirty();
     bp->unpin_page(next_right_frame);
   }
@@ -575,7 +578,9 @@ RC InternalIndexNodeHandler::copy_from(const char *items, int num, DiskBufferPoo
       return rc;
     }
     IndexNodeHandler child_node(header_, frame);
+    frame->latch().lock();
     child_node.set_parent_page_num(this_page_num);
+    frame->latch().unlock();
     frame->mark_dirty();
     disk_buffer_pool->unpin_page(frame);
   }
@@ -599,7 +604,9 @@ RC InternalIndexNodeHandler::preappend(const char *item, DiskBufferPool *bp)
   }
 
   IndexNodeHandler child_node(header_, frame);
+  frame->latch().lock();
   child_node.set_parent_page_num(this->page_num());
+  frame->latch().unlock();
 
   frame->mark_dirty();
   bp->unpin_page(frame);
@@ -735,10 +742,11 @@ RC BplusTreeHandler::sync()
 }
 
 RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_length, bool is_unique,
-			    int internal_max_size /* = -1*/, int leaf_max_size /* = -1 */)
+			    int internal_max_size /* = -1*/, int leaf_max_size /* = -1 */, const char *buffer_pool /* = nullptr */,
+			    int page_size /* = BP_PAGE_SIZE */)
 {
   BufferPoolManager &bpm = BufferPoolManager::instance();
-  RC rc = bpm.create_file(file_name);
+  RC rc = bpm.create_file(file_name, page_size);
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to create file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
     return rc;
@@ -746,7 +754,7 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   LOG_INFO("Successfully create index file:%s", file_name);
 
   DiskBufferPool *bp = nullptr;
-  rc = bpm.open_file(file_name, bp);
+  rc = bpm.open_file(file_name, bp, buffer_pool);
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to open file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
     return rc;
@@ -769,20 +777,22 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   }
 
   if (internal_max_size < 0) {
-    internal_max_size = calc_internal_page_capacity(attr_length);
+    internal_max_size = calc_internal_page_capacity(attr_length, bp->page_data_size());
   }
   if (leaf_max_size < 0) {
-    leaf_max_size = calc_leaf_page_capacity(attr_length);
+    leaf_max_size = calc_leaf_page_capacity(attr_length, bp->page_data_size());
   }
 
   char *pdata = header_frame->data();
   IndexFileHeader *file_header = (IndexFileHeader *)pdata;
+  header_frame->latch().lock();
   file_header->attr_length = attr_length;
   file_header->key_length = attr_length + sizeof(RID);
   file_header->attr_type = file_header->attr_length > 4 ? CHARS : attr_type;
   file_header->internal_max_size = internal_max_size;
   file_header->leaf_max_size = leaf_max_size;
   file_header->root_page = BP_INVALID_PAGE_NUM;
+  header_frame->latch().unlock();
 
   header_frame->mark_dirty();
 
@@ -805,7 +815,7 @@ RC BplusTreeHandler::create(const char *file_name, AttrType attr_type, int attr_
   return RC::SUCCESS;
 }
 
-RC BplusTreeHandler::open(const char *file_name, bool is_unique)
+RC BplusTreeHandler::open(const char *file_name, bool is_unique, const char *buffer_pool /* = nullptr */)
 {
   if (disk_buffer_pool_ != nullptr) {
     LOG_WARN("%s has been opened before index.open.", file_name);
@@ -814,7 +824,7 @@ RC BplusTreeHandler::open(const char *file_name, bool is_unique)
 
   BufferPoolManager &bpm = BufferPoolManager::instance();
   DiskBufferPool *disk_buffer_pool;
-  RC rc = bpm.open_file(file_name, disk_buffer_pool);
+  RC rc = bpm.open_file(file_name, disk_buffer_pool, buffer_pool);
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to open file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
     return rc;
@@ -1154,7 +1164,9 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(Frame *frame, const char *key,
   }
 
   if (leaf_node.size() < leaf_node.max_size()) {
+    frame->latch().lock();
     leaf_node.insert(insert_position, key, (const char *)rid);
+    frame->latch().unlock();
     frame->mark_dirty();
     disk_buffer_pool_->unpin_page(frame);
     return RC::SUCCESS;
@@ -1168,11 +1180,23 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(Frame *frame, const char *key,
   }
 
   LeafIndexNodeHandler new_index_node(file_header_, new_frame);
+  frame->latch().lock();
+  new_frame->latch().lock();
   new_index_node.set_prev_page(frame->page_num());
   new_index_node.set_next_page(leaf_node.next_page());
   new_index_node.set_parent_page_num(leaf_node.parent_page_num());
   leaf_node.set_next_page(new_frame->page_num());
 
+  if (insert_position < leaf_node.size()) {
+    leaf_node.insert(insert_position, key, (const char *)rid);
+  } else {
+    new_index_node.insert(insert_position - leaf_node.size(), key, (const char *)rid);
+  }
+  new_frame->latch().unlock();
+  frame->latch().unlock();
+  frame->mark_dirty();
+  new_frame->mark_dirty();
+
   PageNum next_page_num = new_index_node.next_page();
   if (next_page_num != BP_INVALID_PAGE_NUM) {
     Frame * next_frame;
@@ -1183,17 +1207,145 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(Frame *frame, const char *key,
     }
 
     LeafIndexNodeHandler next_node(file_header_, next_frame);
+    next_frame->latch().lock();
     next_node.set_prev_page(new_frame->page_num());
+    next_frame->latch().unlock();
+    next_frame->mark_dirty();
     disk_buffer_pool_->unpin_page(next_frame);
   }
 
-  if (insert_position < leaf_node.size()) {
-    leaf_node.insert(insert_position, key, (const char *)rid);
-  } else {
-    new_index_node.insert(insert_position - leaf_node.size(), key, (const char *)rid);
+  return insert_entry_into_parent(frame, new_frame, new_index_node.key_at(0));
+}
+
+/**
+ * 把num个元素平均分到最少的节点中，每个节点不超过max_size个。
+ * 节点个数多于1个时，每个节点的元素个数不会少于max_size - max_size / 2(min_size)
+ */
+static int node_count(int num, int max_size)
+{
+  return (num + max_size - 1) / max_size;
+}
+
+static int node_item_num(int num, int node_count, int node_index)
+{
+  return num / node_count + (node_index < num % node_count ? 1 : 0);
+}
+
+RC BplusTreeHandler::build_tree(const std::vector<const char *> &sorted_keys)
+{
+  const int key_num = static_cast<int>(sorted_keys.size());
+  for (int i = 1; i < key_num; i++) {
+    if (key_comparator_(sorted_keys[i - 1], sorted_keys[i]) == 0) {
+      LOG_TRACE("entry exists");
+      return RC::RECORD_DUPLICATE_KEY;
+    }
   }
 
-  return insert_entry_into_parent(frame, new_frame, new_index_node.key_at(0));
+  // 叶子层：每个叶子页面记录第一个键值，作为上一层的分隔键
+  std::vector<std::pair<const char *, PageNum>> children;
+  const int leaf_num = node_count(key_num, file_header_.leaf_max_size);
+  Frame *prev_frame = nullptr;
+  RC rc = RC::SUCCESS;
+  for (int leaf = 0, next_key = 0; leaf < leaf_num; leaf++) {
+    Frame *frame = nullptr;
+    rc = disk_buffer_pool_->allocate_page(&frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to allocate leaf page while building tree. rc=%d:%s", rc, strrc(rc));
+      break;
+    }
+
+    LeafIndexNodeHandler leaf_node(file_header_, frame);
+    frame->latch().lock();
+    leaf_node.init_empty();
+    const int item_num = node_item_num(key_num, leaf_num, leaf);
+    for (int i = 0; i < item_num; i++) {
+      const char *key = sorted_keys[next_key + i];
+      leaf_node.insert(i, key, key + file_header_.attr_length);
+    }
+    if (prev_frame != nullptr) {
+      leaf_node.set_prev_page(prev_frame->page_num());
+    }
+    frame->latch().unlock();
+    children.emplace_back(sorted_keys[next_key], frame->page_num());
+    next_key += item_num;
+
+    if (prev_frame != nullptr) {
+      LeafIndexNodeHandler prev_node(file_header_, prev_frame);
+      prev_frame->latch().lock();
+      prev_node.set_next_page(frame->page_num());
+      prev_frame->latch().unlock();
+      prev_frame->mark_dirty();
+      disk_buffer_pool_->unpin_page(prev_frame);
+    }
+    frame->mark_dirty();
+    prev_frame = frame;
+  }
+  if (prev_frame != nullptr) {
+    disk_buffer_pool_->unpin_page(prev_frame);
+  }
+
+  while (rc == RC::SUCCESS && children.size() > 1) {
+    rc = build_level(children);
+  }
+  if (rc != RC::SUCCESS) {
+    // 树还没有挂到根上，已经分配的页面只是浪费掉，不影响正确性
+    LOG_WARN("Failed to build tree. key num=%d, rc=%d:%s", key_num, rc, strrc(rc));
+    return rc;
+  }
+
+  file_header_.root_page = children[0].second;
+  LOG_INFO("Build tree done. key num=%d, leaf num=%d, root page=%d", key_num, leaf_num, file_header_.root_page);
+  return update_root_page_num();
+}
+
+RC BplusTreeHandler::build_level(std::vector<std::pair<const char *, PageNum>> &children)
+{
+  const int child_num = static_cast<int>(children.size());
+  const int node_num = node_count(child_num, file_header_.internal_max_size);
+  std::vector<std::pair<const char *, PageNum>> nodes;
+  for (int node = 0, next_child = 0; node < node_num; node++) {
+    Frame *frame = nullptr;
+    RC rc = disk_buffer_pool_->allocate_page(&frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to allocate internal page while building tree. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+
+    InternalIndexNodeHandler internal_node(file_header_, frame);
+    frame->latch().lock();
+    internal_node.init_empty();
+    const int item_num = node_item_num(child_num, node_num, node);
+    internal_node.create_new_root(children[next_child].second, children[next_child + 1].first,
+                                  children[next_child + 1].second);
+    for (int i = 2; i < item_num; i++) {
+      internal_node.insert(children[next_child + i].first, children[next_child + i].second, key_comparator_);
+    }
+    frame->latch().unlock();
+
+    // 子节点记录父节点
+    for (int i = 0; i < item_num; i++) {
+      Frame *child_frame = nullptr;
+      rc = disk_buffer_pool_->get_this_page(children[next_child + i].second, &child_frame);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to fetch child page while building tree. rc=%d:%s", rc, strrc(rc));
+        disk_buffer_pool_->unpin_page(frame);
+        return rc;
+      }
+      IndexNodeHandler child_node(file_header_, child_frame);
+      child_frame->latch().lock();
+      child_node.set_parent_page_num(frame->page_num());
+      child_frame->latch().unlock();
+      child_frame->mark_dirty();
+      disk_buffer_pool_->unpin_page(child_frame);
+    }
+
+    nodes.emplace_back(children[next_child].first, frame->page_num());
+    next_child += item_num;
+    frame->mark_dirty();
+    disk_buffer_pool_->unpin_page(frame);
+  }
+  children.swap(nodes);
+  return RC::SUCCESS;
 }
 
 RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, const char *key)
@@ -1215,10 +1367,16 @@ RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, co
     }
 
     InternalIndexNodeHandler root_node(file_header_, root_frame);
+    root_frame->latch().lock();
     root_node.init_empty();
     root_node.create_new_root(frame->page_num(), key, new_frame->page_num());
+    root_frame->latch().unlock();
+    frame->latch().lock();
     node_handler.set_parent_page_num(root_frame->page_num());
+    frame->latch().unlock();
+    new_frame->latch().lock();
     new_node_handler.set_parent_page_num(root_frame->page_num());
+    new_frame->latch().unlock();
 
     frame->mark_dirty();
     new_frame->mark_dirty();
@@ -1246,8 +1404,12 @@ RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, co
 
     /// current node is not in full mode, insert the entry and return
     if (node.size() < node.max_size()) {
+      parent_frame->latch().lock();
       node.insert(key, new_frame->page_num(), key_comparator_);
+      parent_frame->latch().unlock();
+      new_frame->latch().lock();
       new_node_handler.set_parent_page_num(parent_page_num);
+      new_frame->latch().unlock();
 
       frame->mark_dirty();
       new_frame->mark_dirty();
@@ -1269,13 +1431,16 @@ RC BplusTreeHandler::insert_entry_into_parent(Frame *frame, Frame *new_frame, co
       } else {
 	// insert into left or right ? decide by key compare result
 	InternalIndexNodeHandler new_node(file_header_, new_parent_frame);
-	if (key_comparator_(key, new_node.key_at(0)) > 0) {
-	  new_node.insert(key, new_frame->page_num(), key_comparator_);
-          new_node_handler.set_parent_page_num(new_node.page_num());
-	} else {
-	  node.insert(key, new_frame->page_num(), key_comparator_);
-          new_node_handler.set_parent_page_num(node.page_num());
-	}
+	Frame *insert_frame = key_comparator_(key, new_node.key_at(0)) > 0 ? new_parent_frame : parent_frame;
+	InternalIndexNodeHandler insert_node(file_header_, insert_frame);
+	insert_frame->latch().lock();
+	insert_node.insert(key, new_frame->page_num(), key_comparator_);
+	insert_frame->latch().unlock();
+	insert_frame->mark_dirty();
+	new_frame->latch().lock();
+	new_node_handler.set_parent_page_num(insert_node.page_num());
+	new_frame->latch().unlock();
+	new_frame->mark_dirty();
 
 	disk_buffer_pool_->unpin_page(frame);
 	disk_buffer_pool_->unpin_page(new_frame);
@@ -1306,10 +1471,14 @@ RC BplusTreeHandler::split(Frame *frame, Frame *&new_frame)
   }
 
   IndexNodeHandlerType new_node(file_header_, new_frame);
+  frame->latch().lock();
+  new_frame->latch().lock();
   new_node.init_empty();
   new_node.set_parent_page_num(old_node.parent_page_num());
 
   old_node.move_half_to(new_node, disk_buffer_pool_);
+  new_frame->latch().unlock();
+  frame->latch().unlock();
 
   frame->mark_dirty();
   new_frame->mark_dirty();
@@ -1326,7 +1495,9 @@ RC BplusTreeHandler::update_root_page_num()
   }
 
   IndexFileHeader *header = (IndexFileHeader *)header_frame->data();
+  header_frame->latch().lock();
   header->root_page = file_header_.root_page;
+  header_frame->latch().unlock();
   header_frame->mark_dirty();
   disk_buffer_pool_->unpin_page(header_frame);
   return rc;
@@ -1350,8 +1521,10 @@ RC BplusTreeHandler::create_new_tree(const char *key, const RID *rid)
   }
 
   LeafIndexNodeHandler leaf_node(file_header_, frame);
+  frame->latch().lock();
   leaf_node.init_empty();
   leaf_node.insert(0, key, (const char *)rid);
+  frame->latch().unlock();
   file_header_.root_page = frame->page_num();
   frame->mark_dirty();
   disk_buffer_pool_->unpin_page(frame);
@@ -1393,19 +1566,23 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
     return RC::NOMEM;
   }
 
+  RC rc = insert_entry_internal(key, rid);
+  free(key);
+  // mem_pool_item_->free(key);
+  // disk_buffer_pool_->check_all_pages_unpinned(file_id_);
+  return rc;
+}
+
+RC BplusTreeHandler::insert_entry_internal(const char *key, const RID *rid)
+{
   if (is_empty()) {
-    RC rc = create_new_tree(key, rid);
-    free(key);
-    // mem_pool_item_->free(key);
-    return rc;
+    return create_new_tree(key, rid);
   }
 
   Frame *frame;
   RC rc = find_leaf(key, frame);
   if (rc != RC::SUCCESS) {
     LOG_WARN("Failed to find leaf %s. rc=%d:%s", rid->to_string().c_str(), rc, strrc(rc));
-    free(key);
-    // mem_pool_item_->free(key);
     return rc;
   }
 
@@ -1413,19 +1590,59 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
   if (rc != RC::SUCCESS) {
     LOG_TRACE("Failed to insert into leaf of index, rid:%s", rid->to_string().c_str());
     disk_buffer_pool_->unpin_page(frame);
-    free(key);
-    // mem_pool_item_->free(key);
-    // disk_buffer_pool_->check_all_pages_unpinned(file_id_);
     return rc;
   }
 
-  free(key);
-  // mem_pool_item_->free(key);
   LOG_TRACE("insert entry success");
-  // disk_buffer_pool_->check_all_pages_unpinned(file_id_);
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::insert_entries(const char *keys, int key_num)
+{
+  if (keys == nullptr || key_num < 0) {
+    LOG_WARN("Invalid arguments, keys is empty");
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int key_length = file_header_.key_length;
+  std::vector<const char *> sorted_keys(key_num);
+  for (int i = 0; i < key_num; i++) {
+    sorted_keys[i] = keys + i * key_length;
+  }
+  std::stable_sort(sorted_keys.begin(), sorted_keys.end(), [this](const char *k1, const char *k2) {
+    return key_comparator_(k1, k2) < 0;
+  });
+
+  // 内部节点至少要放下两个子节点
+  if (is_empty() && key_num > 0 && file_header_.internal_max_size >= 3) {
+    return build_tree(sorted_keys);
+  }
+
+  RC rc = RC::SUCCESS;
+  int inserted = 0;
+  for (; inserted < key_num; inserted++) {
+    const char *key = sorted_keys[inserted];
+    RID rid;
+    memcpy(&rid, key + file_header_.attr_length, sizeof(rid));
+    rc = insert_entry_internal(key, &rid);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+  }
+
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to insert entries, rollback. inserted=%d, total=%d, rc=%d:%s",
+             inserted, key_num, rc, strrc(rc));
+    for (int i = 0; i < inserted; i++) {
+      Frame *leaf_frame;
+      if (find_leaf(sorted_keys[i], leaf_frame) == RC::SUCCESS) {
+        delete_entry_internal(leaf_frame, sorted_keys[i]);
+      }
+    }
+  }
+  return rc;
+}
+
 RC BplusTreeHandler::get_entry(const char *user_key, int key_len, std::list<RID> &rids)
 {
   BplusTreeScanner scanner(*this);
@@ -1474,7 +1691,10 @@ RC BplusTreeHandler::adjust_root(Frame *root_frame)
     }
 
     IndexNodeHandler child_node(file_header_, child_frame);
+    child_frame->latch().lock();
     child_node.set_parent_page_num(BP_INVALID_PAGE_NUM);
+    child_frame->latch().unlock();
+    child_frame->mark_dirty();
     disk_buffer_pool_->unpin_page(child_frame);
     
     file_header_.root_page = child_page_num;
@@ -1572,9 +1792,23 @@ RC BplusTreeHandler::coalesce(Frame *neighbor_frame, Frame *frame, Frame *parent
   IndexNodeHandlerType left_node(file_header_, left_frame);
   IndexNodeHandlerType right_node(file_header_, right_frame);
 
+  parent_frame->latch().lock();
   parent_node.remove(index);
+  parent_frame->latch().unlock();
+  parent_frame->mark_dirty();
   // parent_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
+  left_frame->latch().lock();
+  right_frame->latch().lock();
   RC rc = right_node.move_to(left_node, disk_buffer_pool_);
+  if (rc == RC::SUCCESS && left_node.is_leaf()) {
+    LeafIndexNodeHandler left_leaf_node(file_header_, left_frame);
+    LeafIndexNodeHandler right_leaf_node(file_header_, right_frame);
+    left_leaf_node.set_next_page(right_leaf_node.next_page());
+  }
+  right_frame->latch().unlock();
+  left_frame->latch().unlock();
+  left_frame->mark_dirty();
+  right_frame->mark_dirty();
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to move right node to left. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -1582,9 +1816,7 @@ RC BplusTreeHandler::coalesce(Frame *neighbor_frame, Frame *frame, Frame *parent
   // left_node.validate(key_comparator_);
 
   if (left_node.is_leaf()) {
-    LeafIndexNodeHandler left_leaf_node(file_header_, left_frame);
     LeafIndexNodeHandler right_leaf_node(file_header_, right_frame);
-    left_leaf_node.set_next_page(right_leaf_node.next_page());
 
     PageNum next_right_page_num = right_leaf_node.next_page();
     if (next_right_page_num != BP_INVALID_PAGE_NUM) {
@@ -1599,7 +1831,10 @@ RC BplusTreeHandler::coalesce(Frame *neighbor_frame, Frame *frame, Frame *parent
       }
 
       LeafIndexNodeHandler next_right_node(file_header_, next_right_frame);
+      next_right_frame->latch().lock();
       next_right_node.set_prev_page(left_node.page_num());
+      next_right_frame->latch().unlock();
+      next_right_frame->mark_dirty();
       disk_buffer_pool_->unpin_page(next_right_frame);
     }
     
@@ -1622,6 +1857,9 @@ RC BplusTreeHandler::redistribute(Frame *neighbor_frame, Frame *frame, Frame *pa
     LOG_ERROR("got invalid nodes. neighbor node size %d, this node size %d",
 	      neighbor_node.size(), node.size());
   }
+  neighbor_frame->latch().lock();
+  frame->latch().lock();
+  parent_frame->latch().lock();
   if (index == 0) {
     // the neighbor is at right
     neighbor_node.move_first_to_end(node, disk_buffer_pool_);
@@ -1637,6 +1875,9 @@ RC BplusTreeHandler::redistribute(Frame *neighbor_frame, Frame *frame, Frame *pa
     parent_node.set_key_at(index, node.key_at(0));
     // parent_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
   }
+  parent_frame->latch().unlock();
+  frame->latch().unlock();
+  neighbor_frame->latch().unlock();
 
   neighbor_frame->mark_dirty();
   frame->mark_dirty();
@@ -1651,7 +1892,9 @@ RC BplusTreeHandler::delete_entry_internal(Frame *leaf_frame, const char *key)
 {
   LeafIndexNodeHandler leaf_index_node(file_header_, leaf_frame);
 
+  leaf_frame->latch().lock();
   const int remove_count = leaf_index_node.remove(key, key_comparator_);
+  leaf_frame->latch().unlock();
   if (remove_count == 0) {
     LOG_TRACE("no data to remove");
     disk_buffer_pool_->unpin_page(leaf_frame);
@@ -1905,13 +2148,14 @@ RC BplusTreeScanner::next_entry(RID *rid)
   RC rc = RC::SUCCESS;
   if (left_frame_->page_num() != right_frame_->page_num()) {
     PageNum page_num = node.next_page();
+    PageNum parent_page_num = node.parent_page_num();
     tree_handler_.disk_buffer_pool_->unpin_page(left_frame_);
     if (page_num == BP_INVALID_PAGE_NUM) {
       left_frame_ = nullptr;
       LOG_WARN("got invalid next page. page num=%d", page_num);
       rc = RC::INTERNAL;
     } else {
-      rc = tree_handler_.disk_buffer_pool_->get_this_page(page_num, &left_frame_);
+      rc = fetch_next_leaf(parent_page_num, page_num);
       if (rc != RC::SUCCESS) {
 	      left_frame_ = nullptr;
         LOG_WARN("failed to fetch next page. page num=%d, rc=%d:%s", page_num, rc, strrc(rc));
@@ -1928,8 +2172,61 @@ RC BplusTreeScanner::next_entry(RID *rid)
   return rc;
 }
 
+RC BplusTreeScanner::fetch_next_leaf(PageNum parent_page_num, PageNum page_num)
+{
+  DiskBufferPool *bp = tree_handler_.disk_buffer_pool_;
+  if (leaf_index_ < leaf_frames_.size() && leaf_frames_[leaf_index_]->page_num() == page_num) {
+    left_frame_ = leaf_frames_[leaf_index_];
+    leaf_frames_[leaf_index_++] = nullptr;
+    return RC::SUCCESS;
+  }
+  release_leaf_frames();
+
+  // 右边界所在的叶子节点已经pin住了，只需要取到它前面为止
+  std::vector<PageNum> page_nums{page_num};
+  const int batch_pages = bp->bp_manager().read_ahead_pages();
+  Frame *parent_frame = nullptr;
+  if (batch_pages > 1 && parent_page_num != BP_INVALID_PAGE_NUM && page_num != right_frame_->page_num() &&
+      bp->get_this_page(parent_page_num, &parent_frame) == RC::SUCCESS) {
+    InternalIndexNodeHandler parent_node(tree_handler_.file_header_, parent_frame);
+    int index = parent_node.value_index(page_num);
+    for (index = index < 0 ? parent_node.size() : index + 1;
+         index < parent_node.size() && (int)page_nums.size() < batch_pages; index++) {
+      const PageNum child_page_num = parent_node.value_at(index);
+      if (child_page_num == right_frame_->page_num()) {
+        break;
+      }
+      page_nums.push_back(child_page_num);
+    }
+    bp->unpin_page(parent_frame);
+  }
+
+  leaf_frames_.resize(page_nums.size());
+  RC rc = bp->get_pages(page_nums.data(), static_cast<int>(page_nums.size()), leaf_frames_.data());
+  if (rc != RC::SUCCESS) {
+    leaf_frames_.clear();
+    return rc;
+  }
+  left_frame_ = leaf_frames_[0];
+  leaf_frames_[0] = nullptr;
+  leaf_index_ = 1;
+  return RC::SUCCESS;
+}
+
+void BplusTreeScanner::release_leaf_frames()
+{
+  for (Frame *frame : leaf_frames_) {
+    if (frame != nullptr) {
+      tree_handler_.disk_buffer_pool_->unpin_page(frame);
+    }
+  }
+  leaf_frames_.clear();
+  leaf_index_ = 0;
+}
+
 RC BplusTreeScanner::close()
 {
+  release_leaf_frames();
   if (left_frame_ != nullptr) {
     tree_handler_.disk_buffer_pool_->unpin_page(left_frame_);
     left_frame_ = nullptr;
@@ -24,6 +24,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/record/record_manager.h"
 #include "storage/default/disk_buffer_pool.h"
 #include "sql/parser/parse_defs.h"
+#include "common/mm/mem_pool.h"
 #include "util/comparator.h"
 #include "util/util.h"
 
@@ -270,6 +271,10 @@ struct InternalIndexNode : public IndexNode {
   char array[0];
 };
 
+/**
+ * 修改节点的接口不加锁，调用者修改之前要持有节点所在页面的写锁(Frame::latch)。
+ * 会顺带修改其它页面(兄弟节点、子节点)的接口，比如move_to、copy_from，自己对那些页面加锁
+ */
 class IndexNodeHandler {
 public:
   IndexNodeHandler(const IndexFileHeader &header, Frame *frame);
@@ -409,16 +414,18 @@ public:
   /**
    * 此函数创建一个名为fileName的索引。
    * attrType描述被索引属性的类型，attrLength描述被索引属性的长度
+   * buffer_pool是索引页面使用的缓冲池，空表示默认的缓冲池
+   * page_size是索引文件的页面大小，节点能放下多少个键值由页面大小决定
    */
   RC create(const char *file_name, AttrType attr_type, int attr_length, bool is_unique, int internal_max_size = -1,
-      int leaf_max_size = -1);
+      int leaf_max_size = -1, const char *buffer_pool = nullptr, int page_size = BP_PAGE_SIZE);
 
   /**
    * 打开名为fileName的索引文件。
    * 如果方法调用成功，则indexHandle为指向被打开的索引句柄的指针。
    * 索引句柄用于在索引中插入或删除索引项，也可用于索引的扫描
    */
-  RC open(const char *file_name, bool is_unique);
+  RC open(const char *file_name, bool is_unique, const char *buffer_pool = nullptr);
 
   /**
    * 关闭句柄indexHandle对应的索引文件
@@ -433,6 +440,13 @@ public:
    */
   RC insert_entry(const char *user_key, const RID *rid);
 
+  /**
+   * 批量插入key_num个索引项，keys中每个索引项的长度是key_length，属性值后面跟着RID。
+   * 先按照键值排序再依次插入，相邻的索引项大多落在同一个叶子页面上，访问的页面比按记录顺序插入少很多。
+   * 空树直接自底向上构建(参考build_tree)。失败时已经插入的索引项都会删除
+   */
+  RC insert_entries(const char *keys, int key_num);
+
   /**
    * 从IndexHandle句柄对应的索引中删除一个值为（*pData，rid）的索引项
    * @return RECORD_INVALID_KEY 指定值不存在
@@ -491,6 +505,13 @@ protected:
   template <typename IndexNodeHandlerType>
   RC redistribute(Frame *neighbor_frame, Frame *frame, Frame *parent_frame, int index);
 
+  RC insert_entry_internal(const char *key, const RID *rid);
+  /**
+   * 用排好序的索引项自底向上构建一棵新树：先按顺序填满叶子页面，再逐层向上构建内部节点，
+   * 每个页面只写一次，不会发生分裂
+   */
+  RC build_tree(const std::vector<const char *> &sorted_keys);
+  RC build_level(std::vector<std::pair<const char *, PageNum>> &children);
   RC insert_entry_into_parent(Frame *frame, Frame *new_frame, const char *key);
   RC insert_entry_into_leaf_node(Frame *frame, const char *pkey, const RID *rid);
   RC update_root_page_num();
@@ -544,6 +565,13 @@ private:
    */
   RC fix_user_key(const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive);
 
+  /**
+   * 移动到下一个叶子节点。批量获取的叶子节点用完之后，从父节点中取出接下来的若干个兄弟叶子节点(最多预读的页面个数)，
+   * 通过DiskBufferPool::get_pages一起获取，冷数据的范围扫描只需要一次批量读取
+   */
+  RC fetch_next_leaf(PageNum parent_page_num, PageNum page_num);
+  void release_leaf_frames();
+
 private:
   bool inited_ = false;
   BplusTreeHandler &tree_handler_;
@@ -554,6 +582,9 @@ private:
   Frame *right_frame_ = nullptr;
   int iter_index_ = -1;
   int end_index_ = -1;  // use -1 for end of scan
+
+  std::vector<Frame *> leaf_frames_;  // 批量获取的后续叶子节点，都是pin住的，用过的位置是nullptr
+  size_t leaf_index_ = 0;
 };
 
 #endif  //__OBSERVER_STORAGE_COMMON_INDEX_MANAGER_H_
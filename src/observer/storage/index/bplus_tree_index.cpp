@@ -20,7 +20,8 @@ BplusTreeIndex::~BplusTreeIndex() noexcept
   close();
 }
 
-RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_meta)
+RC BplusTreeIndex::create(
+    const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_meta, int page_size)
 {
   if (inited_) {
     LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s, field:%s",
@@ -36,7 +37,8 @@ RC BplusTreeIndex::create(const char *file_name, const IndexMeta &index_meta, co
   for (auto fm: field_meta) {
     length += fm.len();
   }
-  RC rc = index_handler_.create(file_name, field_meta[0].type(), length, index_meta.is_unique());
+  RC rc = index_handler_.create(
+      file_name, field_meta[0].type(), length, index_meta.is_unique(), -1, -1, index_meta.buffer_pool(), page_size);
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to create index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name,
@@ -64,7 +66,7 @@ RC BplusTreeIndex::open(const char *file_name, const IndexMeta &index_meta, cons
 
   Index::init(index_meta, field_meta);
 
-  RC rc = index_handler_.open(file_name, index_meta.is_unique());
+  RC rc = index_handler_.open(file_name, index_meta.is_unique(), index_meta.buffer_pool());
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to open index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name,
@@ -104,16 +106,63 @@ RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
   return index_handler_.insert_entry(insert_record, rid);//!!!
 }
 
-RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
+int BplusTreeIndex::key_length() const
+{
+  int attr_length = 0;
+  for (auto &fm: field_meta_) {
+    attr_length += fm.len();
+  }
+  return attr_length + sizeof(RID);
+}
+
+void BplusTreeIndex::make_key(const char *record, const RID &rid, char *key) const
 {
-  char *insert_record = (char *)malloc(strlen(record) + sizeof(RID));
   size_t offset = 0;
-  for (auto fm: field_meta_) {
-    memcpy(insert_record + offset, record + fm.offset(), fm.len());
+  for (auto &fm: field_meta_) {
+    memcpy(key + offset, record + fm.offset(), fm.len());
     offset += fm.len();
   }
-  memcpy(insert_record + offset, rid, sizeof(RID));
-  return index_handler_.delete_entry(insert_record, rid);
+  memcpy(key + offset, &rid, sizeof(RID));
+}
+
+RC BplusTreeIndex::insert_entries(const char *records, int record_num, int record_size, const RID *rids)
+{
+  const int key_len = key_length();
+  std::vector<char> keys(static_cast<size_t>(key_len) * record_num);
+  for (int i = 0; i < record_num; i++) {
+    make_key(records + static_cast<size_t>(i) * record_size, rids[i], keys.data() + static_cast<size_t>(i) * key_len);
+  }
+  return index_handler_.insert_entries(keys.data(), record_num);
+}
+
+RC BplusTreeIndex::build(RecordFileScanner &scanner)
+{
+  const int key_len = key_length();
+  std::vector<char> keys;
+  int key_num = 0;
+  Record record;
+  while (scanner.has_next()) {
+    RC rc = scanner.next(record);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to scan record while building index. index=%s, rc=%d:%s", index_meta_.name(), rc, strrc(rc));
+      return rc;
+    }
+    keys.resize(keys.size() + key_len);
+    make_key(record.data(), record.rid(), keys.data() + keys.size() - key_len);
+    key_num++;
+  }
+  if (key_num == 0) {
+    return RC::SUCCESS;
+  }
+  return index_handler_.insert_entries(keys.data(), key_num);
+}
+
+RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
+{
+  // 记录的第一个字段可能是0，不能用strlen计算键值的长度。键值由index_handler_释放
+  char *key = (char *)malloc(key_length());
+  make_key(record, *rid, key);
+  return index_handler_.delete_entry(key, rid);
 }
 
 IndexScanner *BplusTreeIndex::create_scanner(const char *left_key, int left_len, bool left_inclusive,
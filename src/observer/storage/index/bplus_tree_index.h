@@ -23,12 +23,18 @@ public:
   BplusTreeIndex() = default;
   virtual ~BplusTreeIndex() noexcept;
 
-  RC create(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_meta);
+  RC create(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_meta,
+      int page_size = BP_PAGE_SIZE);
   RC open(const char *file_name, const IndexMeta &index_meta, const std::vector<FieldMeta> &field_meta);
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
   RC delete_entry(const char *record, const RID *rid) override;
+  RC insert_entries(const char *records, int record_num, int record_size, const RID *rids) override;
+  /**
+   * 先取出所有记录的键值，空树时排序之后自底向上构建
+   */
+  RC build(RecordFileScanner &scanner) override;
 
   /**
    * 扫描指定范围的数据
@@ -38,6 +44,10 @@ public:
 
   RC sync() override;
 
+private:
+  int key_length() const;
+  void make_key(const char *record, const RID &rid, char *key) const;
+
 private:
   bool inited_ = false;
   BplusTreeHandler index_handler_;
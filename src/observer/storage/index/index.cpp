@@ -20,3 +20,34 @@ RC Index::init(const IndexMeta &index_meta, const std::vector<FieldMeta> &field_
   field_meta_ = field_meta;
   return RC::SUCCESS;
 }
+
+RC Index::build(RecordFileScanner &scanner)
+{
+  RC rc = RC::SUCCESS;
+  Record record;
+  while (rc == RC::SUCCESS && scanner.has_next()) {
+    rc = scanner.next(record);
+    if (rc == RC::SUCCESS) {
+      rc = insert_entry(record.data(), &record.rid());
+    }
+  }
+  return rc;
+}
+
+RC Index::insert_entries(const char *records, int record_num, int record_size, const RID *rids)
+{
+  RC rc = RC::SUCCESS;
+  int i = 0;
+  for (; i < record_num; i++) {
+    rc = insert_entry(records + i * record_size, &rids[i]);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+  }
+  if (rc != RC::SUCCESS) {
+    for (int j = 0; j < i; j++) {
+      delete_entry(records + j * record_size, &rids[j]);
+    }
+  }
+  return rc;
+}
@@ -46,6 +46,17 @@ public:
   virtual RC insert_entry(const char *record, const RID *rid) = 0;
   virtual RC delete_entry(const char *record, const RID *rid) = 0;
 
+  /**
+   * 批量插入record_num条连续存放的记录对应的索引项，失败时已经插入的索引项都会删除。
+   * 默认逐条调用insert_entry
+   */
+  virtual RC insert_entries(const char *records, int record_num, int record_size, const RID *rids);
+
+  /**
+   * 为scanner遍历到的所有记录插入索引项，用于导入数据之后一次性构建索引。默认逐条调用insert_entry
+   */
+  virtual RC build(RecordFileScanner &scanner);
+
   virtual IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive,
 			       const char *right_key, int right_len, bool right_inclusive) = 0;
 
@@ -165,18 +165,13 @@ RC PersistHandler::write_at(uint64_t offset, int size, const char *data, int64_t
     LOG_ERROR("Failed to write, because file is not opened.");
     rc = RC::FILE_NOT_OPENED;
   } else {
-    if (lseek(file_desc_, offset, SEEK_SET) == off_t(-1)) {
-      LOG_ERROR("Failed to write %lld of %d:%s due to failed to seek %s.", offset, file_desc_, file_name_.c_str(), strerror(errno));
-      rc = RC::FILE_SEEK;
-    } else {
-      int64_t write_size = 0;
-      if ((write_size = write(file_desc_, data, size)) != size) {
-        LOG_ERROR("Failed to write %llu of %d:%s due to %s. Write size: %lld", offset, file_desc_, file_name_.c_str(), strerror(errno), write_size);
-        rc = RC::FILE_WRITE;
-      }
-      if (out_size != nullptr) {
-        *out_size = write_size;
-      }
+    int64_t write_size = 0;
+    if ((write_size = pwrite(file_desc_, data, size, offset)) != size) {
+      LOG_ERROR("Failed to write %llu of %d:%s due to %s. Write size: %lld", offset, file_desc_, file_name_.c_str(), strerror(errno), write_size);
+      rc = RC::FILE_WRITE;
+    }
+    if (out_size != nullptr) {
+      *out_size = write_size;
     }
   }
 
@@ -244,18 +239,13 @@ RC PersistHandler::read_at(uint64_t offset, int size, char *data, int64_t *out_s
     LOG_ERROR("Failed to read, because file is not opened.");
     rc = RC::FILE_NOT_OPENED;
   } else {
-    if (lseek(file_desc_, offset, SEEK_SET) == off_t(-1)) {
-      LOG_ERROR("Failed to read %llu of %d:%s due to failed to seek %s.", offset, file_desc_, file_name_.c_str(), strerror(errno));
-      return RC::FILE_SEEK;
-    } else {
-      int64_t read_size = 0;
-      if ((read_size = read(file_desc_, data, size)) != size) {
-        LOG_WARN("Failed to read %lld of %d:%s due to %s.", offset, file_desc_, file_name_.c_str(), strerror(errno));
-        rc = RC::FILE_READ;
-      }
-      if (out_size != nullptr) {
-        *out_size = read_size;
-      }
+    int64_t read_size = 0;
+    if ((read_size = pread(file_desc_, data, size, offset)) != size) {
+      LOG_WARN("Failed to read %lld of %d:%s due to %s.", offset, file_desc_, file_name_.c_str(), strerror(errno));
+      rc = RC::FILE_READ;
+    }
+    if (out_size != nullptr) {
+      *out_size = read_size;
     }
   }
 
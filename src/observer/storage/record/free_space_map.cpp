@@ -0,0 +1,381 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/08.
+//
+
+#include <string.h>
+#include <algorithm>
+#include "storage/record/free_space_map.h"
+#include "common/log/log.h"
+
+static int get_category(const uint8_t *slots, int slot)
+{
+  return (slots[slot / 2] >> (slot % 2 * 4)) & 0x0F;
+}
+
+static void set_category(uint8_t *slots, int slot, int category)
+{
+  const int shift = slot % 2 * 4;
+  slots[slot / 2] = static_cast<uint8_t>((slots[slot / 2] & ~(0x0F << shift)) | (category << shift));
+}
+
+/**
+ * 在[from, to)之间查找等级不低于min_category的槽位，找不到时max_category是这个范围内的最大等级
+ */
+static int scan_slots(const uint8_t *slots, int from, int to, int min_category, int exclude_slot, int &max_category)
+{
+  for (int slot = from; slot < to;) {
+    // 大部分页面都是满的，一次跳过16个等级为0的页面
+    if (slot % 16 == 0 && slot + 16 <= to) {
+      uint64_t word = 0;
+      memcpy(&word, slots + slot / 2, sizeof(word));
+      if (word == 0) {
+        slot += 16;
+        continue;
+      }
+    }
+
+    const int category = get_category(slots, slot);
+    if (category >= min_category && slot != exclude_slot) {
+      return slot;
+    }
+    max_category = std::max(max_category, category);
+    slot++;
+  }
+  return -1;
+}
+
+/**
+ * 修改页面之前加写锁，与刷盘的线程互斥。不持久化时没有frame，不需要加锁
+ */
+static void lock_page(Frame *frame)
+{
+  if (frame != nullptr) {
+    frame->latch().lock();
+  }
+}
+
+static void unlock_page(Frame *frame)
+{
+  if (frame != nullptr) {
+    frame->latch().unlock();
+  }
+}
+
+FreeSpaceMap::~FreeSpaceMap()
+{
+  close();
+}
+
+RC FreeSpaceMap::open(DiskBufferPool *buffer_pool, int data_page_size)
+{
+  if (root_ != nullptr) {
+    LOG_ERROR("free space map has been opened");
+    return RC::RECORD_OPENNED;
+  }
+
+  data_page_size_ = data_page_size;
+  const int page_size = buffer_pool->page_data_size();
+  Frame *frame = nullptr;
+  RC rc = RC::SUCCESS;
+  const PageNum root_page = buffer_pool->next_allocated_page(1);
+  if (root_page == BP_INVALID_PAGE_NUM) {
+    if ((rc = buffer_pool->allocate_page(&frame)) != RC::SUCCESS) {
+      LOG_WARN("failed to allocate root page of free space map. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+    lock_page(frame);
+    init_root(frame->data(), page_size);
+    unlock_page(frame);
+    frame->mark_dirty();
+    need_rebuild_ = true;
+  } else {
+    if ((rc = buffer_pool->get_this_page(root_page, &frame)) != RC::SUCCESS) {
+      LOG_WARN("failed to get root page of free space map. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+
+    const FsmRootHeader *root = reinterpret_cast<const FsmRootHeader *>(frame->data());
+    if (root->magic != FsmRootHeader::MAGIC || root->data_page_size != data_page_size) {
+      LOG_WARN("free space map is invalid and will be rebuilt. file=%s, magic=%x, data page size=%d:%d",
+               buffer_pool->file_name().c_str(), root->magic, root->data_page_size, data_page_size);
+      // 以前的叶子页面都不要了
+      for (PageNum page_num = buffer_pool->next_allocated_page(root_page + 1); page_num != BP_INVALID_PAGE_NUM;
+           page_num = buffer_pool->next_allocated_page(page_num + 1)) {
+        buffer_pool->dispose_page(page_num);
+      }
+      lock_page(frame);
+      init_root(frame->data(), page_size);
+      unlock_page(frame);
+      frame->mark_dirty();
+      need_rebuild_ = true;
+    }
+  }
+
+  buffer_pool_ = buffer_pool;
+  root_frame_ = frame;
+  attach_root(frame->data(), page_size);
+  LOG_INFO("open free space map done. file=%s, leaf num=%d, rebuild=%d",
+           buffer_pool->file_name().c_str(), root_->leaf_num, need_rebuild_);
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::open_transient(int data_page_size)
+{
+  if (root_ != nullptr) {
+    LOG_ERROR("free space map has been opened");
+    return RC::RECORD_OPENNED;
+  }
+
+  data_page_size_ = data_page_size;
+  transient_root_.resize(BP_PAGE_DATA_SIZE);
+  init_root(transient_root_.data(), BP_PAGE_DATA_SIZE);
+  attach_root(transient_root_.data(), BP_PAGE_DATA_SIZE);
+  need_rebuild_ = true;
+  return RC::SUCCESS;
+}
+
+void FreeSpaceMap::close()
+{
+  if (root_frame_ != nullptr) {
+    buffer_pool_->unpin_page(root_frame_);
+    root_frame_ = nullptr;
+  }
+  buffer_pool_ = nullptr;
+  transient_root_.clear();
+  transient_leaves_.clear();
+  root_ = nullptr;
+  leaf_pages_ = nullptr;
+  leaf_max_ = nullptr;
+  need_rebuild_ = false;
+  search_leaf_ = 0;
+  search_slot_ = 0;
+}
+
+int FreeSpaceMap::category(int free_space) const
+{
+  if (free_space <= 0) {
+    return 0;
+  }
+  const int category = 1 + static_cast<int>(static_cast<int64_t>(free_space - 1) * (CATEGORY_NUM - 1) / data_page_size_);
+  return std::min(category, CATEGORY_NUM - 1);
+}
+
+int FreeSpaceMap::category_min_free(int category) const
+{
+  if (category <= 0) {
+    return 0;
+  }
+  return 1 + static_cast<int>((static_cast<int64_t>(category - 1) * data_page_size_ + CATEGORY_NUM - 2) /
+                              (CATEGORY_NUM - 1));
+}
+
+void FreeSpaceMap::update(PageNum page_num, int free_space)
+{
+  if (root_ == nullptr || page_num < 0) {
+    return;
+  }
+
+  const int category = this->category(free_space);
+  const int leaf = page_num / leaf_entries_;
+  if (leaf >= root_->leaf_num) {
+    // 没有空闲空间的页面不用记录，等级默认就是0
+    if (category == 0 || extend(leaf) != RC::SUCCESS) {
+      return;
+    }
+  }
+
+  Frame *frame = nullptr;
+  uint8_t *slots = pin_leaf(leaf, frame);
+  if (slots == nullptr) {
+    return;
+  }
+  const int slot = page_num % leaf_entries_;
+  const bool changed = get_category(slots, slot) != category;
+  if (changed) {
+    lock_page(frame);
+    set_category(slots, slot, category);
+    unlock_page(frame);
+  }
+  unpin_leaf(frame, changed);
+
+  if (category > leaf_max_[leaf]) {
+    lock_page(root_frame_);
+    leaf_max_[leaf] = category;
+    unlock_page(root_frame_);
+    mark_root_dirty();
+  }
+}
+
+PageNum FreeSpaceMap::find(int min_free, PageNum exclude_page)
+{
+  if (root_ == nullptr) {
+    return BP_INVALID_PAGE_NUM;
+  }
+
+  int min_category = 1;
+  while (min_category < CATEGORY_NUM && category_min_free(min_category) < min_free) {
+    min_category++;
+  }
+  if (min_category >= CATEGORY_NUM) {
+    return BP_INVALID_PAGE_NUM;
+  }
+
+  const int leaf_num = root_->leaf_num;
+  for (int i = 0; i < leaf_num; i++) {
+    const int leaf = (search_leaf_ + i) % leaf_num;
+    if (leaf_max_[leaf] < min_category) {
+      continue;
+    }
+
+    Frame *frame = nullptr;
+    const uint8_t *slots = pin_leaf(leaf, frame);
+    if (slots == nullptr) {
+      continue;
+    }
+
+    const PageNum base = leaf * leaf_entries_;
+    const int exclude_slot = exclude_page >= base && exclude_page < base + leaf_entries_ ? exclude_page - base : -1;
+    const int start = leaf == search_leaf_ ? search_slot_ : 0;
+    int max_category = 0;
+    int slot = scan_slots(slots, start, leaf_entries_, min_category, exclude_slot, max_category);
+    if (slot < 0) {
+      slot = scan_slots(slots, 0, start, min_category, exclude_slot, max_category);
+    }
+    unpin_leaf(frame, false);
+
+    if (slot >= 0) {
+      search_leaf_ = leaf;
+      search_slot_ = slot;
+      return base + slot;
+    }
+
+    // 整个叶子页面都找过了，根页面中记录的最大等级偏大，修正之后下次可以直接跳过
+    if (leaf_max_[leaf] != max_category) {
+      lock_page(root_frame_);
+      leaf_max_[leaf] = static_cast<uint8_t>(max_category);
+      unlock_page(root_frame_);
+      mark_root_dirty();
+    }
+  }
+  return BP_INVALID_PAGE_NUM;
+}
+
+void FreeSpaceMap::init_root(char *data, int page_size)
+{
+  memset(data, 0, page_size);
+  FsmRootHeader *root = reinterpret_cast<FsmRootHeader *>(data);
+  root->magic = FsmRootHeader::MAGIC;
+  root->data_page_size = data_page_size_;
+  root->leaf_num = 0;
+}
+
+void FreeSpaceMap::attach_root(char *data, int page_size)
+{
+  fsm_page_size_ = page_size;
+  leaf_capacity_ = (page_size - static_cast<int>(sizeof(FsmRootHeader))) / static_cast<int>(sizeof(PageNum) + 1);
+  leaf_entries_ = (page_size - static_cast<int>(sizeof(FsmLeafHeader))) * 2;
+
+  root_ = reinterpret_cast<FsmRootHeader *>(data);
+  leaf_pages_ = reinterpret_cast<PageNum *>(data + sizeof(FsmRootHeader));
+  leaf_max_ = reinterpret_cast<uint8_t *>(leaf_pages_ + leaf_capacity_);
+}
+
+RC FreeSpaceMap::extend(int leaf)
+{
+  if (leaf >= leaf_capacity_) {
+    LOG_WARN("data file is too large for free space map. leaf=%d, capacity=%d", leaf, leaf_capacity_);
+    return RC::RECORD_NOMEM;
+  }
+
+  while (root_->leaf_num <= leaf) {
+    Frame *frame = nullptr;
+    char *data = nullptr;
+    PageNum page_num = BP_INVALID_PAGE_NUM;
+    if (buffer_pool_ == nullptr) {
+      transient_leaves_.emplace_back(fsm_page_size_);
+      data = transient_leaves_.back().data();
+    } else {
+      RC rc = buffer_pool_->allocate_page(&frame);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to allocate leaf page of free space map. rc=%d:%s", rc, strrc(rc));
+        return rc;
+      }
+      data = frame->data();
+      page_num = frame->page_num();
+    }
+
+    lock_page(frame);
+    memset(data, 0, fsm_page_size_);
+    FsmLeafHeader *header = reinterpret_cast<FsmLeafHeader *>(data);
+    header->magic = FsmLeafHeader::MAGIC;
+    header->leaf_index = root_->leaf_num;
+    unlock_page(frame);
+    unpin_leaf(frame, true);
+
+    lock_page(root_frame_);
+    leaf_pages_[root_->leaf_num] = page_num;
+    leaf_max_[root_->leaf_num] = 0;
+    root_->leaf_num++;
+    unlock_page(root_frame_);
+  }
+  mark_root_dirty();
+  return RC::SUCCESS;
+}
+
+uint8_t *FreeSpaceMap::pin_leaf(int leaf, Frame *&frame)
+{
+  frame = nullptr;
+  if (buffer_pool_ == nullptr) {
+    return reinterpret_cast<uint8_t *>(transient_leaves_[leaf].data() + sizeof(FsmLeafHeader));
+  }
+
+  RC rc = buffer_pool_->get_this_page(leaf_pages_[leaf], &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get leaf page of free space map. leaf=%d, page=%d, rc=%d:%s",
+             leaf, leaf_pages_[leaf], rc, strrc(rc));
+    frame = nullptr;
+    return nullptr;
+  }
+
+  char *data = frame->data();
+  FsmLeafHeader *header = reinterpret_cast<FsmLeafHeader *>(data);
+  if (header->magic != FsmLeafHeader::MAGIC || header->leaf_index != leaf) {
+    // 空闲空间表只是提示，页面损坏了就当作这些数据页面都没有空闲空间
+    LOG_WARN("leaf page of free space map is invalid, reset it. leaf=%d, page=%d", leaf, leaf_pages_[leaf]);
+    frame->latch().lock();
+    memset(data, 0, fsm_page_size_);
+    header->magic = FsmLeafHeader::MAGIC;
+    header->leaf_index = leaf;
+    frame->latch().unlock();
+    frame->mark_dirty();
+  }
+  return reinterpret_cast<uint8_t *>(data + sizeof(FsmLeafHeader));
+}
+
+void FreeSpaceMap::unpin_leaf(Frame *frame, bool dirty)
+{
+  if (frame == nullptr) {
+    return;
+  }
+  if (dirty) {
+    frame->mark_dirty();
+  }
+  buffer_pool_->unpin_page(frame);
+}
+
+void FreeSpaceMap::mark_root_dirty()
+{
+  if (root_frame_ != nullptr) {
+    root_frame_->mark_dirty();
+  }
+}
@@ -0,0 +1,114 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/08.
+//
+#pragma once
+
+#include <vector>
+#include "rc.h"
+#include "storage/default/disk_buffer_pool.h"
+
+/**
+ * 空闲空间表的根页面，后面跟着leaf_pages[capacity]和leaf_max[capacity]两个数组
+ */
+struct FsmRootHeader {
+  static const int32_t MAGIC = 0x46534D52;  // "FSMR"
+
+  int32_t magic;
+  int32_t data_page_size;  //! 数据页面的大小，空闲空间的等级按照这个大小划分
+  int32_t leaf_num;        //! 已经分配的叶子页面个数
+};
+
+/**
+ * 空闲空间表的叶子页面，后面是每个数据页面4个bit的空闲空间等级
+ */
+struct FsmLeafHeader {
+  static const int32_t MAGIC = 0x46534D4C;  // "FSML"
+
+  int32_t magic;
+  int32_t leaf_index;  //! 第几个叶子页面，第i个叶子页面记录数据页号[i * entries, (i + 1) * entries)
+};
+
+/**
+ * 记录数据文件中每个页面的空闲空间(Free Space Map)，插入记录时用来查找放得下的页面。
+ * 每个数据页面用4个bit记录空闲空间的等级(0表示没有空闲空间，15表示几乎是空页面)，按照页号顺序放在叶子页面中；
+ * 根页面记录所有叶子页面的页号和每个叶子页面中的最大等级，查找时跳过没有足够空间的叶子页面。
+ * 空闲空间表放在单独的文件(参考table_fsm_file)中，打开表时只需要读取根页面，不用遍历数据文件。
+ * 空闲空间表不记录日志，只是一个提示：使用时需要检查数据页面实际的空闲空间，不一致时调用update修正
+ */
+class FreeSpaceMap {
+public:
+  static const int CATEGORY_NUM = 16;
+
+public:
+  FreeSpaceMap() = default;
+  ~FreeSpaceMap();
+
+  /**
+   * 使用buffer_pool中的页面保存空闲空间表，文件是空的时候创建根页面。
+   * 新创建的或者根页面损坏需要重新初始化时，need_rebuild返回true，调用者遍历数据文件重建
+   * @param data_page_size 数据页面的大小(page_data_size)
+   */
+  RC open(DiskBufferPool *buffer_pool, int data_page_size);
+
+  /**
+   * 不持久化，只保存在内存中，调用者需要遍历数据文件重建
+   */
+  RC open_transient(int data_page_size);
+  void close();
+
+  bool need_rebuild() const { return need_rebuild_; }
+
+  /**
+   * 更新一个数据页面的空闲空间，等级没有变化时不会修改页面
+   */
+  void update(PageNum page_num, int free_space);
+
+  /**
+   * 查找一个空闲空间不少于min_free的数据页面，从上次找到的位置开始，让连续的插入尽量使用同一个页面
+   * @param exclude_page 不使用这个页面
+   * @return 找不到的话返回BP_INVALID_PAGE_NUM
+   */
+  PageNum find(int min_free, PageNum exclude_page = BP_INVALID_PAGE_NUM);
+
+  /**
+   * 空闲空间对应的等级，以及一个等级保证的最少空闲空间
+   */
+  int category(int free_space) const;
+  int category_min_free(int category) const;
+
+private:
+  void init_root(char *data, int page_size);
+  void attach_root(char *data, int page_size);
+  RC extend(int leaf);
+  uint8_t *pin_leaf(int leaf, Frame *&frame);
+  void unpin_leaf(Frame *frame, bool dirty);
+  void mark_root_dirty();
+
+private:
+  DiskBufferPool *buffer_pool_ = nullptr;  //! 不持久化时是nullptr
+  Frame *root_frame_ = nullptr;            //! 根页面一直pin在缓冲池中
+  std::vector<char> transient_root_;
+  std::vector<std::vector<char>> transient_leaves_;
+
+  FsmRootHeader *root_ = nullptr;
+  PageNum *leaf_pages_ = nullptr;
+  uint8_t *leaf_max_ = nullptr;  //! 每个叶子页面中的最大等级，只会偏大，查找时发现偏大再修正
+  int leaf_capacity_ = 0;        //! 根页面最多可以记录的叶子页面个数
+  int leaf_entries_ = 0;         //! 每个叶子页面可以记录的数据页面个数
+  int fsm_page_size_ = 0;
+  int data_page_size_ = 0;
+  bool need_rebuild_ = false;
+
+  int search_leaf_ = 0;  //! 上次找到的位置
+  int search_slot_ = 0;
+};
@@ -0,0 +1,470 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/05.
+//
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "storage/record/overflow_manager.h"
+#include "common/log/log.h"
+
+static OverflowSlot *slots_of(char *page_data)
+{
+  return reinterpret_cast<OverflowSlot *>(page_data + sizeof(OverflowSlotPageHeader));
+}
+
+/**
+ * 槽位页面的空闲空间，包括已经释放但是还没有整理的空间
+ */
+static int slot_page_free_space(char *page_data, int page_size)
+{
+  const OverflowSlotPageHeader *header = reinterpret_cast<const OverflowSlotPageHeader *>(page_data);
+  const OverflowSlot *slots = slots_of(page_data);
+  int used = static_cast<int>(sizeof(OverflowSlotPageHeader) + header->slot_count * sizeof(OverflowSlot));
+  for (int i = 0; i < header->slot_count; i++) {
+    if (slots[i].offset != 0) {
+      used += slots[i].len;
+    }
+  }
+  return page_size - used;
+}
+
+/**
+ * 把使用中的数据都移动到页面的末尾，合并释放的空间。槽位号不变
+ */
+static void compact_slot_page(char *page_data, int page_size)
+{
+  OverflowSlotPageHeader *header = reinterpret_cast<OverflowSlotPageHeader *>(page_data);
+  OverflowSlot *slots = slots_of(page_data);
+  std::vector<char> copy(page_data, page_data + page_size);
+  int data_offset = page_size;
+  for (int i = 0; i < header->slot_count; i++) {
+    if (slots[i].offset != 0) {
+      data_offset -= slots[i].len;
+      memcpy(page_data + data_offset, copy.data() + slots[i].offset, slots[i].len);
+      slots[i].offset = data_offset;
+    }
+  }
+  header->data_offset = data_offset;
+}
+
+/**
+ * 释放一个槽位，目录末尾空闲的槽位一起去掉
+ */
+static void release_slot(char *page_data, int page_size, int slot_num)
+{
+  OverflowSlotPageHeader *header = reinterpret_cast<OverflowSlotPageHeader *>(page_data);
+  OverflowSlot *slots = slots_of(page_data);
+  slots[slot_num].offset = 0;
+  slots[slot_num].len = 0;
+  slots[slot_num].next_page = -1;
+  while (header->slot_count > 0 && slots[header->slot_count - 1].offset == 0) {
+    header->slot_count--;
+  }
+  if (header->slot_count == 0) {
+    header->data_offset = page_size;
+  }
+}
+
+OverflowFileHandler::~OverflowFileHandler()
+{
+  close();
+}
+
+RC OverflowFileHandler::init(DiskBufferPool *buffer_pool)
+{
+  if (buffer_pool_ != nullptr) {
+    LOG_ERROR("overflow file handler has been initialized");
+    return RC::RECORD_OPENNED;
+  }
+  RC rc = free_space_map_.open_transient(buffer_pool->page_data_size());
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("failed to open free space map of overflow file. rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+  buffer_pool_ = buffer_pool;
+  return RC::SUCCESS;
+}
+
+void OverflowFileHandler::close()
+{
+  free_space_map_.close();
+  buffer_pool_ = nullptr;
+}
+
+int OverflowFileHandler::page_capacity() const
+{
+  return buffer_pool_->page_data_size() - static_cast<int>(sizeof(OverflowPageHeader));
+}
+
+int OverflowFileHandler::max_slot_data_len() const
+{
+  return page_capacity() / 2;
+}
+
+RC OverflowFileHandler::insert_data(const char *data, int len, RID *rid, const PageLogger &logger)
+{
+  if (len <= 0) {
+    LOG_WARN("invalid overflow data length %d", len);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 不足一页的部分比较短时放在槽位页面中，作为数据的第一段，后面的数据正好是整页
+  const int tail_len = len % page_capacity();
+  const int slot_len = tail_len <= max_slot_data_len() ? tail_len : 0;
+  PageNum first_page = -1;
+  RC rc = RC::SUCCESS;
+  if (slot_len < len && (rc = insert_pages(data + slot_len, len - slot_len, &first_page, logger)) != RC::SUCCESS) {
+    return rc;
+  }
+  if (slot_len == 0) {
+    *rid = RID(first_page, 0);
+    return RC::SUCCESS;
+  }
+
+  rc = insert_slot(data, slot_len, first_page, rid, logger);
+  if (rc != RC::SUCCESS && first_page != -1) {
+    delete_pages(first_page, len - slot_len);
+  }
+  return rc;
+}
+
+RC OverflowFileHandler::insert_pages(const char *data, int len, PageNum *first_page, const PageLogger &logger)
+{
+  // 从最后一段开始写，这样每个页面写入时就知道下一个页面的页号，不需要再回头修改
+  const int capacity = page_capacity();
+  const int page_num = (len + capacity - 1) / capacity;
+  PageNum next_page = -1;
+  RC rc = RC::SUCCESS;
+  for (int i = page_num - 1; i >= 0; i--) {
+    Frame *frame = nullptr;
+    if ((rc = buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
+      LOG_WARN("failed to allocate overflow page. rc=%d:%s", rc, strrc(rc));
+      break;
+    }
+
+    const int offset = i * capacity;
+    const int data_len = std::min(capacity, len - offset);
+    char *page_data = frame->data();
+    OverflowPageHeader *header = reinterpret_cast<OverflowPageHeader *>(page_data);
+    frame->latch().lock();
+    header->magic = OverflowPageHeader::MAGIC;
+    header->next_page = next_page;
+    header->data_len = data_len;
+    memcpy(page_data + sizeof(OverflowPageHeader), data + offset, data_len);
+    frame->latch().unlock();
+    frame->mark_dirty();
+
+    if (logger) {
+      rc = logger(frame->page_num(), 0, page_data, static_cast<int>(sizeof(OverflowPageHeader)) + data_len);
+    }
+    next_page = frame->page_num();
+    buffer_pool_->unpin_page(frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to log overflow page. rc=%d:%s", rc, strrc(rc));
+      break;
+    }
+  }
+
+  if (rc != RC::SUCCESS) {
+    // 已经写入的页面是链表的后半段，从next_page开始释放
+    if (next_page != -1) {
+      delete_pages(next_page, len);
+    }
+    return rc;
+  }
+
+  *first_page = next_page;
+  return RC::SUCCESS;
+}
+
+RC OverflowFileHandler::insert_slot(const char *data, int len, PageNum next_page, RID *rid, const PageLogger &logger)
+{
+  const int page_size = buffer_pool_->page_data_size();
+  const int min_free = len + static_cast<int>(sizeof(OverflowSlot));
+  std::lock_guard<std::mutex> lock_guard(slot_lock_);
+
+  // 空闲空间表只是一个提示，以页面中的实际情况为准
+  RC rc = RC::SUCCESS;
+  Frame *frame = nullptr;
+  PageNum page_num = free_space_map_.find(min_free);
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    if ((rc = buffer_pool_->get_this_page(page_num, &frame)) == RC::SUCCESS) {
+      char *page_data = frame->data();
+      const bool slot_page =
+          reinterpret_cast<const OverflowSlotPageHeader *>(page_data)->magic == OverflowSlotPageHeader::MAGIC;
+      const int free_space = slot_page ? slot_page_free_space(page_data, page_size) : 0;
+      if (free_space >= min_free) {
+        break;
+      }
+      free_space_map_.update(page_num, free_space);
+      buffer_pool_->unpin_page(frame);
+      frame = nullptr;
+    } else {
+      LOG_WARN("failed to get overflow page %d. rc=%d:%s", page_num, rc, strrc(rc));
+      free_space_map_.update(page_num, 0);
+    }
+
+    const PageNum next = free_space_map_.find(min_free);
+    if (next == page_num) {
+      LOG_WARN("failed to correct free space map of overflow file. page num=%d", page_num);
+      break;
+    }
+    page_num = next;
+  }
+
+  bool new_page = false;
+  if (frame == nullptr) {
+    if ((rc = buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
+      LOG_WARN("failed to allocate overflow slot page. rc=%d:%s", rc, strrc(rc));
+      return rc;
+    }
+    new_page = true;
+  }
+
+  char *page_data = frame->data();
+  OverflowSlotPageHeader *header = reinterpret_cast<OverflowSlotPageHeader *>(page_data);
+  OverflowSlot *slots = slots_of(page_data);
+  frame->latch().lock();
+  if (new_page) {
+    header->magic = OverflowSlotPageHeader::MAGIC;
+    header->slot_count = 0;
+    header->data_offset = page_size;
+  }
+  int slot_num = 0;
+  while (slot_num < header->slot_count && slots[slot_num].offset != 0) {
+    slot_num++;
+  }
+  const int dir_end =
+      static_cast<int>(sizeof(OverflowSlotPageHeader) + std::max(slot_num + 1, header->slot_count) * sizeof(OverflowSlot));
+  const bool compacted = header->data_offset - dir_end < len;
+  if (compacted) {
+    compact_slot_page(page_data, page_size);
+  }
+  if (slot_num == header->slot_count) {
+    header->slot_count++;
+  }
+  header->data_offset -= len;
+  memcpy(page_data + header->data_offset, data, len);
+  slots[slot_num].offset = header->data_offset;
+  slots[slot_num].len = len;
+  slots[slot_num].next_page = next_page;
+  frame->latch().unlock();
+  frame->mark_dirty();
+
+  // 目录和新写入的数据分别记录日志，整理过的页面要记录整个数据区
+  if (logger) {
+    const int data_end = compacted ? page_size : header->data_offset + len;
+    rc = logger(frame->page_num(), 0, page_data, dir_end);
+    if (rc == RC::SUCCESS) {
+      rc = logger(frame->page_num(), header->data_offset, page_data + header->data_offset, data_end - header->data_offset);
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to log overflow slot page. rc=%d:%s", rc, strrc(rc));
+      frame->latch().lock();
+      release_slot(page_data, page_size, slot_num);
+      frame->latch().unlock();
+    }
+  }
+
+  const PageNum frame_page_num = frame->page_num();
+  free_space_map_.update(frame_page_num, slot_page_free_space(page_data, page_size));
+  buffer_pool_->unpin_page(frame);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  *rid = RID(frame_page_num, slot_num);
+  return RC::SUCCESS;
+}
+
+RC OverflowFileHandler::get_data(const RID &rid, char *buf, int len)
+{
+  Frame *frame = nullptr;
+  RC rc = buffer_pool_->get_this_page(rid.page_num, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get overflow page %d. rc=%d:%s", rid.page_num, rc, strrc(rc));
+    return rc;
+  }
+
+  // 第一段数据在槽位页面中时，先读出这一段，剩下的在next_page开始的整页链表中
+  PageNum page_num = rid.page_num;
+  int offset = 0;
+  char *page_data = frame->data();
+  if (reinterpret_cast<const OverflowSlotPageHeader *>(page_data)->magic == OverflowSlotPageHeader::MAGIC) {
+    // 插入时会整理槽位页面，移动其它槽位的数据
+    frame->latch().lock_shared();
+    const OverflowSlotPageHeader *header = reinterpret_cast<const OverflowSlotPageHeader *>(page_data);
+    const OverflowSlot *slot = slots_of(page_data) + rid.slot_num;
+    if (rid.slot_num < 0 || rid.slot_num >= header->slot_count || slot->offset == 0 || slot->len > len ||
+        slot->offset + slot->len > buffer_pool_->page_data_size()) {
+      LOG_ERROR("invalid overflow slot %d.%d. slot count=%d, len=%d",
+                rid.page_num, rid.slot_num, header->slot_count, len);
+      frame->latch().unlock_shared();
+      buffer_pool_->unpin_page(frame);
+      return RC::RECORD_INVALID_KEY;
+    }
+    memcpy(buf, page_data + slot->offset, slot->len);
+    offset = slot->len;
+    page_num = slot->next_page;
+    frame->latch().unlock_shared();
+  }
+  buffer_pool_->unpin_page(frame);
+
+  while (offset < len) {
+    if (page_num < 0) {
+      LOG_ERROR("overflow page chain is shorter than expected. first page=%d, len=%d, read=%d",
+                rid.page_num, len, offset);
+      return RC::RECORD_INVALID_KEY;
+    }
+
+    if ((rc = buffer_pool_->get_this_page(page_num, &frame)) != RC::SUCCESS) {
+      LOG_WARN("failed to get overflow page %d. rc=%d:%s", page_num, rc, strrc(rc));
+      return rc;
+    }
+
+    page_data = frame->data();
+    const OverflowPageHeader *header = reinterpret_cast<const OverflowPageHeader *>(page_data);
+    if (header->magic != OverflowPageHeader::MAGIC || header->data_len <= 0 || header->data_len > page_capacity()) {
+      LOG_ERROR("invalid overflow page %d. magic=%x, data len=%d", page_num, header->magic, header->data_len);
+      buffer_pool_->unpin_page(frame);
+      return RC::RECORD_INVALID_KEY;
+    }
+
+    const int data_len = std::min(header->data_len, len - offset);
+    memcpy(buf + offset, page_data + sizeof(OverflowPageHeader), data_len);
+    offset += data_len;
+    page_num = header->next_page;
+    buffer_pool_->unpin_page(frame);
+  }
+  return RC::SUCCESS;
+}
+
+RC OverflowFileHandler::delete_data(const RID &rid, int len)
+{
+  Frame *frame = nullptr;
+  RC rc = buffer_pool_->get_this_page(rid.page_num, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get overflow page %d. rc=%d:%s", rid.page_num, rc, strrc(rc));
+    return rc;
+  }
+  const bool slot_page =
+      reinterpret_cast<const OverflowSlotPageHeader *>(frame->data())->magic == OverflowSlotPageHeader::MAGIC;
+  buffer_pool_->unpin_page(frame);
+
+  PageNum first_page = rid.page_num;
+  if (slot_page && (rc = delete_slot(rid, &first_page)) != RC::SUCCESS) {
+    return rc;
+  }
+  return delete_pages(first_page, len);
+}
+
+RC OverflowFileHandler::delete_slot(const RID &rid, PageNum *next_page)
+{
+  const int page_size = buffer_pool_->page_data_size();
+  std::lock_guard<std::mutex> lock_guard(slot_lock_);
+
+  Frame *frame = nullptr;
+  RC rc = buffer_pool_->get_this_page(rid.page_num, &frame);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to get overflow page %d. rc=%d:%s", rid.page_num, rc, strrc(rc));
+    return rc;
+  }
+
+  char *page_data = frame->data();
+  OverflowSlotPageHeader *header = reinterpret_cast<OverflowSlotPageHeader *>(page_data);
+  OverflowSlot *slots = slots_of(page_data);
+  if (header->magic != OverflowSlotPageHeader::MAGIC || rid.slot_num < 0 || rid.slot_num >= header->slot_count ||
+      slots[rid.slot_num].offset == 0) {
+    // 比如恢复时重复删除
+    LOG_WARN("overflow slot %d.%d is not in use, skip deleting", rid.page_num, rid.slot_num);
+    buffer_pool_->unpin_page(frame);
+    *next_page = -1;
+    return RC::SUCCESS;
+  }
+
+  frame->latch().lock();
+  *next_page = slots[rid.slot_num].next_page;
+  release_slot(page_data, page_size, rid.slot_num);
+  const bool empty = header->slot_count == 0;
+  frame->latch().unlock();
+  frame->mark_dirty();
+  const int free_space = slot_page_free_space(page_data, page_size);
+  buffer_pool_->unpin_page(frame);
+
+  if (!empty) {
+    free_space_map_.update(rid.page_num, free_space);
+    return RC::SUCCESS;
+  }
+
+  free_space_map_.update(rid.page_num, 0);
+  if ((rc = buffer_pool_->dispose_page(rid.page_num)) != RC::SUCCESS) {
+    LOG_WARN("failed to dispose overflow slot page %d. rc=%d:%s", rid.page_num, rc, strrc(rc));
+  }
+  return rc;
+}
+
+RC OverflowFileHandler::delete_pages(PageNum first_page, int len)
+{
+  // 页面链表损坏时(比如恢复时重复删除)，最多遍历这么多页面
+  const int max_pages = (len + page_capacity() - 1) / page_capacity() + 1;
+  PageNum page_num = first_page;
+  for (int i = 0; i < max_pages && page_num >= 0; i++) {
+    Frame *frame = nullptr;
+    RC rc = buffer_pool_->get_this_page(page_num, &frame);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get overflow page %d. rc=%d:%s", page_num, rc, strrc(rc));
+      return rc;
+    }
+
+    const OverflowPageHeader *header = reinterpret_cast<const OverflowPageHeader *>(frame->data());
+    if (header->magic != OverflowPageHeader::MAGIC) {
+      LOG_WARN("page %d is not an overflow page, stop deleting. first page=%d", page_num, first_page);
+      buffer_pool_->unpin_page(frame);
+      return RC::SUCCESS;
+    }
+    const PageNum next_page = header->next_page;
+    buffer_pool_->unpin_page(frame);
+
+    if ((rc = buffer_pool_->dispose_page(page_num)) != RC::SUCCESS) {
+      LOG_WARN("failed to dispose overflow page %d. rc=%d:%s", page_num, rc, strrc(rc));
+      return rc;
+    }
+    page_num = next_page;
+  }
+  return RC::SUCCESS;
+}
+
+RC OverflowFileHandler::recover_page(PageNum page_num, int offset, const char *data, int len)
+{
+  if (offset < 0 || offset + len > buffer_pool_->page_data_size()) {
+    LOG_ERROR("invalid overflow redo log. page=%d, offset=%d, len=%d", page_num, offset, len);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = buffer_pool_->recover_page(page_num);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to recover overflow page %d. rc=%d:%s", page_num, rc, strrc(rc));
+    return rc;
+  }
+
+  Frame *frame = nullptr;
+  if ((rc = buffer_pool_->get_this_page(page_num, &frame)) != RC::SUCCESS) {
+    LOG_WARN("failed to get overflow page %d. rc=%d:%s", page_num, rc, strrc(rc));
+    return rc;
+  }
+  frame->latch().lock();
+  memcpy(frame->data() + offset, data, len);
+  frame->latch().unlock();
+  frame->mark_dirty();
+  buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
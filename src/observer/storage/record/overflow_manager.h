@@ -0,0 +1,119 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/05.
+//
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include "rc.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/record/free_space_map.h"
+#include "storage/record/record.h"
+
+/**
+ * 溢出页面的页面头。一个大字段按顺序切分成多段，每段放在一个页面中，页面之间用next_page串成单链表
+ */
+struct OverflowPageHeader {
+  static const int32_t MAGIC = 0x4F564654;  // "OVFT"
+
+  int32_t magic;      //! 用来检查页面是不是溢出页面，防止链表损坏时访问到别的页面
+  PageNum next_page;  //! 下一个页面，-1表示最后一个页面
+  int32_t data_len;   //! 当前页面存放的数据长度
+};
+
+/**
+ * 多个字段共用的溢出页面(槽位页面)的页面头。
+ * 页面头后面是目录，数据从页面的末尾向前存放，释放的空间在插入时整理(compact)之后重用
+ */
+struct OverflowSlotPageHeader {
+  static const int32_t MAGIC = 0x4F56534C;  // "OVSL"
+
+  int32_t magic;
+  int32_t slot_count;   //! 目录项的个数，包括已经释放的
+  int32_t data_offset;  //! 数据区的起始位置，相对于页面数据的开头
+};
+
+/**
+ * 槽位页面的目录项。一个字段的数据先是槽位中的一段，后面跟着next_page开始的整页链表
+ */
+struct OverflowSlot {
+  int32_t offset;     //! 数据在页面中的位置，0表示这个目录项是空闲的
+  int32_t len;
+  PageNum next_page;  //! 后面整页存放的数据，-1表示没有
+};
+
+/**
+ * 管理存放大字段(TEXT)的溢出页面。
+ * 每个表的溢出页面放在单独的文件(参考table_overflow_file)中，与数据文件共用同一个BufferPool，
+ * 扫描数据文件时不会访问溢出页面。
+ * 一个字段的数据按照整页切分，整页的部分写入单独的页面链表；不足半页的剩余部分放在槽位页面中，和其它字段共用页面，
+ * 这样短文本不会各自占用一个页面。字段写入之后不会原地修改，只会整体删除。
+ * 槽位页面的空闲空间只记录在内存中，重启之后被删除过数据的页面才会重新使用
+ */
+class OverflowFileHandler {
+public:
+  /**
+   * 修改一个溢出页面之后调用，参数是页号、修改的位置和修改之后的数据(从页面数据的开头计算，包括页面头)，用来记录重做日志
+   */
+  using PageLogger = std::function<RC(PageNum page_num, int offset, const char *data, int len)>;
+
+public:
+  OverflowFileHandler() = default;
+  ~OverflowFileHandler();
+
+  RC init(DiskBufferPool *buffer_pool);
+  void close();
+
+  /**
+   * 每个整页可以存放的数据长度
+   */
+  int page_capacity() const;
+
+  /**
+   * 写入数据，返回数据的位置：槽位页面的页号和槽位号，或者整页链表的第一个页面(槽位号是0)
+   */
+  RC insert_data(const char *data, int len, RID *rid, const PageLogger &logger = nullptr);
+
+  /**
+   * 从rid开始读取len字节的数据到buf
+   */
+  RC get_data(const RID &rid, char *buf, int len);
+
+  /**
+   * 释放数据占用的槽位和页面，len是写入时的数据长度，用来限制遍历的页面个数
+   */
+  RC delete_data(const RID &rid, int len);
+
+  /**
+   * 重做日志时使用，把数据写到指定页面的offset位置，页面不存在时先分配
+   */
+  RC recover_page(PageNum page_num, int offset, const char *data, int len);
+
+private:
+  /**
+   * 放到槽位页面中的数据的最大长度，更长的数据单独使用一个页面
+   */
+  int max_slot_data_len() const;
+  /**
+   * 把数据按整页写到新分配的页面链表中，返回第一个页面
+   */
+  RC insert_pages(const char *data, int len, PageNum *first_page, const PageLogger &logger);
+  RC delete_pages(PageNum first_page, int len);
+  RC insert_slot(const char *data, int len, PageNum next_page, RID *rid, const PageLogger &logger);
+  RC delete_slot(const RID &rid, PageNum *next_page);
+
+private:
+  DiskBufferPool *buffer_pool_ = nullptr;
+  std::mutex      slot_lock_;        //! 保护槽位页面的分配、释放和free_space_map_
+  FreeSpaceMap    free_space_map_;  //! 槽位页面的空闲空间，只保存在内存中
+};
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 #include <vector>
 #include <limits>
 #include <sstream>
@@ -26,6 +27,20 @@ See the Mulan PSL v2 for more details. */
 
 class Field;
 
+/**
+ * 记录在数据文件页面中的存放格式，每个表在创建时选定，记录在表的元数据中
+ * FIXED: 每条记录占用一个固定大小的槽位，字符串按照声明的最大长度存放
+ * SLOTTED: 页面末尾是槽位目录，记录按照编码之后的实际长度存放，字符串只保存有效的部分
+ */
+enum class RecordFormat
+{
+  FIXED,
+  SLOTTED,
+};
+
+const char *record_format_name(RecordFormat format);
+bool record_format_from_name(const char *name, RecordFormat &format);
+
 struct RID {
   PageNum page_num;  // record's page number
   SlotNum slot_num;  // record's slot number
@@ -82,13 +97,79 @@ struct RID {
   }
 };
 
+/**
+ * TEXT字段在记录中的存放格式，占用TEXT_FIELD_LENGTH个字节。
+ * 长度不超过INLINE_SIZE的文本全部放在记录中；更长的文本在记录中只保存前INLINE_SIZE个字节，
+ * 剩下的部分放在表的溢出文件中(first_page, slot_num)的位置(参考OverflowFileHandler)，
+ * 只有投影或者比较这个字段时才会读取溢出页面。
+ * 文本最长TEXT_MAX_LENGTH，length只需要16位。以前的版本length是int32_t，高16位总是0，
+ * 读出来的slot_num是0，first_page指向的是整页链表，不会用到槽位号
+ */
+struct TextRef {
+  static const int INLINE_SIZE = 56;
+
+  uint16_t length;      //! 文本的长度
+  uint16_t slot_num;    //! first_page是槽位页面时，数据所在的槽位
+  PageNum  first_page;  //! 溢出数据所在的第一个页面，-1表示文本全部在记录中(第0个页面是文件头，不会用来存放数据)
+  char     prefix[INLINE_SIZE];
+
+  bool overflow() const { return first_page > 0; }
+  RID overflow_rid() const { return RID(first_page, slot_num); }
+};
+static_assert(TEXT_MAX_LENGTH <= UINT16_MAX, "TextRef::length should be able to hold TEXT_MAX_LENGTH");
+static_assert(sizeof(TextRef) == TEXT_FIELD_LENGTH, "sizeof(TextRef) should be equal to TEXT_FIELD_LENGTH");
+
 class Record
 {
 public:
   Record() = default;
   ~Record() = default;
 
-  void set_data(char *data) { this->data_ = data; }
+  /**
+   * 记录的内容在自己的缓冲区中时，复制之后指向新的缓冲区
+   */
+  Record(const Record &other) : rid_(other.rid_), data_(other.data_)
+  {
+    if (other.owned_) {
+      owned_data_ = other.owned_data_;
+      data_ = owned_data_.data();
+      owned_ = true;
+    }
+  }
+
+  Record &operator=(const Record &other)
+  {
+    if (this != &other) {
+      rid_ = other.rid_;
+      data_ = other.data_;
+      owned_ = other.owned_;
+      if (owned_) {
+        owned_data_.assign(other.owned_data_.begin(), other.owned_data_.end());
+        data_ = owned_data_.data();
+      }
+    }
+    return *this;
+  }
+
+  void set_data(char *data)
+  {
+    // 把alloc_data分配的内存重新设置回来时还是由记录自己管理
+    this->owned_ = this->owned_ && data == this->data_;
+    this->data_ = data;
+  }
+
+  /**
+   * 使用记录自己的缓冲区存放记录的内容，比如从变长格式的页面中解码出来的记录。
+   * 缓冲区在多次调用之间复用
+   */
+  char *alloc_data(int size)
+  {
+    owned_data_.resize(size);
+    data_ = owned_data_.data();
+    owned_ = true;
+    return data_;
+  }
+
   char *data() { return this->data_; }
   const char *data() const { return this->data_; }
 
@@ -101,6 +182,8 @@ private:
   RID                            rid_;
 
   // the data buffer
-  // record will not release the memory
+  // set_data设置的内存由调用者管理，alloc_data分配的内存在owned_data_中
   char *                         data_ = nullptr;
+  std::vector<char>              owned_data_;
+  bool                           owned_ = false;
 };
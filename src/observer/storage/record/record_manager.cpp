@@ -11,6 +11,9 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include "storage/record/record_manager.h"
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
 
 #include "common/lang/bitmap.h"
 #include "common/log/log.h"
@@ -38,6 +41,143 @@ int page_header_size(int record_capacity) {
   const int bitmap_size = page_bitmap_size(record_capacity);
   return align8(page_fix_size() + bitmap_size);
 }
+
+static const int32_t SLOTTED_PAGE_MAGIC = 0x534C5444;  // "SLTD"
+
+// 变长格式的页面中每条记录开头的标记
+static const char TUPLE_NORMAL = 0;
+static const char TUPLE_FORWARD = 1;  // 转发指针，后面是记录现在的RID
+static const char TUPLE_MOVED = 2;    // 从别的页面转发过来的记录，只能通过原来的RID访问
+static const int FORWARD_TUPLE_SIZE = 1 + sizeof(RID);
+
+const char *record_format_name(RecordFormat format) {
+  switch (format) {
+    case RecordFormat::SLOTTED:
+      return "slotted";
+    default:
+      return "fixed";
+  }
+}
+
+bool record_format_from_name(const char *name, RecordFormat &format) {
+  if (0 == strcasecmp(name, "fixed")) {
+    format = RecordFormat::FIXED;
+    return true;
+  }
+  if (0 == strcasecmp(name, "slotted")) {
+    format = RecordFormat::SLOTTED;
+    return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RecordLayout::RecordLayout(int record_size, std::vector<VarField> var_fields)
+    : record_size_(record_size), var_fields_(std::move(var_fields)) {
+  std::sort(var_fields_.begin(), var_fields_.end(),
+            [](const VarField &f1, const VarField &f2) { return f1.offset < f2.offset; });
+  min_encoded_size_ = record_size_;
+  max_encoded_size_ = record_size_;
+  for (const VarField &field : var_fields_) {
+    min_encoded_size_ -= field.len - static_cast<int>(sizeof(uint16_t));
+    max_encoded_size_ += sizeof(uint16_t);
+  }
+}
+
+int RecordLayout::encode(const char *record, char *buf) const {
+  int record_offset = 0;
+  int buf_offset = 0;
+  for (const VarField &field : var_fields_) {
+    const int fixed_len = field.offset - record_offset;
+    memcpy(buf + buf_offset, record + record_offset, fixed_len);
+    buf_offset += fixed_len;
+
+    const uint16_t len = static_cast<uint16_t>(strnlen(record + field.offset, field.len));
+    memcpy(buf + buf_offset, &len, sizeof(len));
+    buf_offset += sizeof(len);
+    memcpy(buf + buf_offset, record + field.offset, len);
+    buf_offset += len;
+    record_offset = field.offset + field.len;
+  }
+  memcpy(buf + buf_offset, record + record_offset, record_size_ - record_offset);
+  return buf_offset + record_size_ - record_offset;
+}
+
+RC RecordLayout::decode(const char *buf, int size, char *record) const {
+  int record_offset = 0;
+  int buf_offset = 0;
+  for (const VarField &field : var_fields_) {
+    const int fixed_len = field.offset - record_offset;
+    uint16_t len = 0;
+    if (buf_offset + fixed_len + static_cast<int>(sizeof(len)) > size) {
+      LOG_ERROR("Invalid encoded record. size=%d", size);
+      return RC::RECORD_INVALIDRECSIZE;
+    }
+    memcpy(record + record_offset, buf + buf_offset, fixed_len);
+    buf_offset += fixed_len;
+    memcpy(&len, buf + buf_offset, sizeof(len));
+    buf_offset += sizeof(len);
+    if (len > field.len || buf_offset + len > size) {
+      LOG_ERROR("Invalid encoded record. size=%d, field offset=%d, len=%d", size, field.offset, len);
+      return RC::RECORD_INVALIDRECSIZE;
+    }
+
+    memcpy(record + field.offset, buf + buf_offset, len);
+    memset(record + field.offset + len, 0, field.len - len);
+    buf_offset += len;
+    record_offset = field.offset + field.len;
+  }
+  if (buf_offset + record_size_ - record_offset != size) {
+    LOG_ERROR("Invalid encoded record. size=%d", size);
+    return RC::RECORD_INVALIDRECSIZE;
+  }
+  memcpy(record + record_offset, buf + buf_offset, record_size_ - record_offset);
+  return RC::SUCCESS;
+}
+
+/**
+ * 读取变长格式页面中的记录并解码，槽位中是转发指针时到记录现在的页面中读取
+ * @param readonly 只读打开转发之后的页面，参考RecordPageHandler::init_readonly
+ */
+static RC read_slotted_record(DiskBufferPool &buffer_pool, const RecordLayout &layout,
+                              RecordPageHandler &page_handler, SlotNum slot_num, bool readonly,
+                              Record &record) {
+  const char *tuple = nullptr;
+  int len = 0;
+  RC rc = page_handler.get_tuple(slot_num, tuple, len);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  if (tuple[0] == TUPLE_MOVED) {
+    return RC::RECORD_RECORD_NOT_EXIST;
+  }
+
+  record.set_rid(page_handler.get_page_num(), slot_num);
+  if (tuple[0] != TUPLE_FORWARD) {
+    return layout.decode(tuple + 1, len - 1, record.alloc_data(layout.record_size()));
+  }
+
+  RID forward;
+  memcpy(&forward, tuple + 1, sizeof(forward));
+  RecordPageHandler forward_handler;
+  rc = readonly ? forward_handler.init_readonly(buffer_pool, forward.page_num)
+                : forward_handler.init(buffer_pool, forward.page_num);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to init forwarded page. rid=%d.%d, forward=%d.%d, rc=%s",
+             page_handler.get_page_num(), slot_num, forward.page_num, forward.slot_num, strrc(rc));
+    return rc;
+  }
+  rc = forward_handler.get_tuple(forward.slot_num, tuple, len);
+  if (rc == RC::SUCCESS && tuple[0] != TUPLE_MOVED) {
+    rc = RC::RECORD_INVALIDRID;
+  }
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Invalid forwarded record. rid=%d.%d, forward=%d.%d, rc=%s",
+              page_handler.get_page_num(), slot_num, forward.page_num, forward.slot_num, strrc(rc));
+    return rc;
+  }
+  return layout.decode(tuple + 1, len - 1, record.alloc_data(layout.record_size()));
+}
 ////////////////////////////////////////////////////////////////////////////////
 RecordPageIterator::RecordPageIterator() {}
 RecordPageIterator::~RecordPageIterator() {}
@@ -45,6 +185,10 @@ RecordPageIterator::~RecordPageIterator() {}
 void RecordPageIterator::init(RecordPageHandler &record_page_handler) {
   record_page_handler_ = &record_page_handler;
   page_num_ = record_page_handler.get_page_num();
+  if (record_page_handler.slotted()) {
+    next_slot_num_ = next_slotted(0);
+    return;
+  }
   bitmap_.init(record_page_handler.bitmap_,
                record_page_handler.page_header_->record_capacity);
   next_slot_num_ = bitmap_.next_setted_bit(0);
@@ -54,6 +198,13 @@ bool RecordPageIterator::has_next() { return -1 != next_slot_num_; }
 
 RC RecordPageIterator::next(Record &record) {
   record.set_rid(page_num_, next_slot_num_);
+  if (record_page_handler_->slotted()) {
+    if (next_slot_num_ >= 0) {
+      next_slot_num_ = next_slotted(next_slot_num_ + 1);
+    }
+    return record.rid().slot_num != -1 ? RC::SUCCESS : RC::RECORD_EOF;
+  }
+
   record.set_data(record_page_handler_->get_record_data(record.rid().slot_num));
 
   if (next_slot_num_ >= 0) {
@@ -62,6 +213,18 @@ RC RecordPageIterator::next(Record &record) {
   return record.rid().slot_num != -1 ? RC::SUCCESS : RC::RECORD_EOF;
 }
 
+SlotNum RecordPageIterator::next_slotted(SlotNum slot_num) const {
+  // 转发过来的记录在原来的位置上返回
+  const SlottedPageHeader *header = record_page_handler_->slotted_header_;
+  for (; slot_num < header->slot_num; slot_num++) {
+    const RecordSlot *slot = record_page_handler_->get_slot(slot_num);
+    if (slot->offset != 0 && record_page_handler_->data_[slot->offset] != TUPLE_MOVED) {
+      return slot_num;
+    }
+  }
+  return -1;
+}
+
 // select *,a from t;
 // select a,* from t;
 
@@ -75,23 +238,59 @@ RC RecordPageHandler::init(DiskBufferPool &buffer_pool, PageNum page_num) {
     return RC::RECORD_OPENNED;
   }
 
+  Frame *frame = nullptr;
   RC ret = RC::SUCCESS;
-  if ((ret = buffer_pool.get_this_page(page_num, &frame_)) != RC::SUCCESS) {
+  if ((ret = buffer_pool.get_this_page(page_num, &frame)) != RC::SUCCESS) {
     LOG_ERROR("Failed to get page handle from disk buffer pool. ret=%d:%s", ret,
               strrc(ret));
     return ret;
   }
+  return init_pinned(buffer_pool, frame);
+}
 
-  char *data = frame_->data();
+RC RecordPageHandler::init_pinned(DiskBufferPool &buffer_pool, Frame *frame) {
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_WARN("Disk buffer pool has been opened for page_num %d.", frame->page_num());
+    return RC::RECORD_OPENNED;
+  }
 
-  disk_buffer_pool_ = &buffer_pool;
+  RC ret = RC::SUCCESS;
+  frame_ = frame;
+  const PageNum page_num = frame->page_num();
 
-  page_header_ = (PageHeader *)(data);
-  bitmap_ = data + page_fix_size();
+  page_num_ = page_num;
+  init_page_header(buffer_pool, frame_->data());
   LOG_TRACE("Successfully init page_num %d.", page_num);
   return ret;
 }
 
+RC RecordPageHandler::init_readonly(DiskBufferPool &buffer_pool, PageNum page_num, char *page_copy) {
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_WARN("Disk buffer pool has been opened for page_num %d.", page_num);
+    return RC::RECORD_OPENNED;
+  }
+
+  const Page *page = nullptr;
+  if (page_copy == nullptr && buffer_pool.mmap_scan()) {
+    page_copy_.resize(buffer_pool.page_size());
+    page_copy = page_copy_.data();
+  }
+  RC ret = buffer_pool.read_page(page_num, frame_, page, page_copy);
+  if (ret != RC::SUCCESS) {
+    LOG_ERROR("Failed to read page from disk buffer pool. ret=%d:%s", ret,
+              strrc(ret));
+    return ret;
+  }
+
+  // 记录的接口不区分const，调用者保证不会修改
+  char *data = const_cast<char *>(page->data);
+
+  page_num_ = page_num;
+  init_page_header(buffer_pool, data);
+  LOG_TRACE("Successfully init readonly page_num %d.", page_num);
+  return ret;
+}
+
 RC RecordPageHandler::recover_init(DiskBufferPool &buffer_pool,
                                    PageNum page_num) {
   if (disk_buffer_pool_ != nullptr) {
@@ -106,12 +305,8 @@ RC RecordPageHandler::recover_init(DiskBufferPool &buffer_pool,
     return ret;
   }
 
-  char *data = frame_->data();
-
-  disk_buffer_pool_ = &buffer_pool;
-
-  page_header_ = (PageHeader *)(data);
-  bitmap_ = data + page_fix_size();
+  page_num_ = page_num;
+  init_page_header(buffer_pool, frame_->data());
 
   buffer_pool.recover_page(page_num);
 
@@ -128,8 +323,9 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool,
     return ret;
   }
 
-  int page_size = BP_PAGE_DATA_SIZE;
+  int page_size = buffer_pool.page_data_size();
   int record_phy_size = align8(record_size);
+  frame_->latch().lock();
   page_header_->record_num = 0;
   page_header_->record_capacity =
       page_record_capacity(page_size, record_phy_size);
@@ -140,6 +336,7 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool,
   bitmap_ = frame_->data() + page_fix_size();
 
   memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+  frame_->latch().unlock();
 
   if ((ret = buffer_pool.flush_page(*frame_)) != RC::SUCCESS) {
     LOG_ERROR("Failed to flush page header %d:%d.", page_num);
@@ -149,9 +346,47 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool,
   return RC::SUCCESS;
 }
 
+RC RecordPageHandler::init_empty_slotted_page(DiskBufferPool &buffer_pool, PageNum page_num) {
+  RC ret = init(buffer_pool, page_num);
+  if (ret != RC::SUCCESS) {
+    LOG_ERROR("Failed to init empty slotted page %d.", page_num);
+    return ret;
+  }
+
+  SlottedPageHeader *header = reinterpret_cast<SlottedPageHeader *>(data_);
+  frame_->latch().lock();
+  header->magic = SLOTTED_PAGE_MAGIC;
+  header->record_num = 0;
+  header->slot_num = 0;
+  header->free_offset = sizeof(SlottedPageHeader);
+  header->free_space = page_size_ - static_cast<int>(sizeof(SlottedPageHeader));
+  frame_->latch().unlock();
+  slotted_header_ = header;
+
+  if ((ret = buffer_pool.flush_page(*frame_)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush page header %d.", page_num);
+    return ret;
+  }
+  return RC::SUCCESS;
+}
+
+void RecordPageHandler::init_page_header(DiskBufferPool &buffer_pool, char *data) {
+  disk_buffer_pool_ = &buffer_pool;
+  data_ = data;
+  page_header_ = (PageHeader *)(data);
+  bitmap_ = data + page_fix_size();
+  page_size_ = buffer_pool.page_data_size();
+
+  SlottedPageHeader *slotted_header = reinterpret_cast<SlottedPageHeader *>(data);
+  slotted_header_ = slotted_header->magic == SLOTTED_PAGE_MAGIC ? slotted_header : nullptr;
+}
+
 RC RecordPageHandler::cleanup() {
   if (disk_buffer_pool_ != nullptr) {
-    disk_buffer_pool_->unpin_page(frame_);
+    if (frame_ != nullptr) {
+      disk_buffer_pool_->unpin_page(frame_);
+      frame_ = nullptr;
+    }
     disk_buffer_pool_ = nullptr;
   }
 
@@ -165,6 +400,7 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid) {
   }
 
   // 找到空闲位置
+  frame_->latch().lock();
   Bitmap bitmap(bitmap_, page_header_->record_capacity);
   int index = bitmap.next_unsetted_bit(0);
   bitmap.set_bit(index);
@@ -173,6 +409,7 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid) {
   // assert index < page_header_->record_capacity
   char *record_data = get_record_data(index);
   memcpy(record_data, data, page_header_->record_real_size);
+  frame_->latch().unlock();
 
   frame_->mark_dirty();
 
@@ -187,24 +424,30 @@ RC RecordPageHandler::insert_record(const char *data, RID *rid) {
 }
 
 RC RecordPageHandler::recover_insert_record(const char *data, RID *rid) {
-  if (page_header_->record_num == page_header_->record_capacity) {
-    LOG_WARN("Page is full, page_num %d:%d.", frame_->page_num());
-    return RC::RECORD_NOMEM;
-  }
   if (rid->slot_num >= page_header_->record_capacity) {
     LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).",
              rid->slot_num, page_header_->record_capacity);
     return RC::RECORD_NOMEM;
   }
 
-  // 更新位图
+  // 检查点之后回放的日志，可能已经随着页面刷到磁盘上了，重复回放时不能重复计数
   Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  bitmap.set_bit(rid->slot_num);
-  page_header_->record_num++;
+  if (!bitmap.get_bit(rid->slot_num) && page_header_->record_num == page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d.", frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  frame_->latch().lock();
+  if (!bitmap.get_bit(rid->slot_num)) {
+    // 更新位图
+    bitmap.set_bit(rid->slot_num);
+    page_header_->record_num++;
+  }
 
   // 恢复数据
   char *record_data = get_record_data(rid->slot_num);
   memcpy(record_data, data, page_header_->record_real_size);
+  frame_->latch().unlock();
 
   frame_->mark_dirty();
 
@@ -225,9 +468,10 @@ RC RecordPageHandler::update_record(const Record *rec) {
               rec->rid().slot_num, frame_->page_num());
     return RC::RECORD_RECORD_NOT_EXIST;
   } else {
+    frame_->latch().lock();
     char *record_data = get_record_data(rec->rid().slot_num);
     memcpy(record_data, rec->data(), page_header_->record_real_size);
-    bitmap.set_bit(rec->rid().slot_num);
+    frame_->latch().unlock();
     frame_->mark_dirty();
     // LOG_TRACE("Update record. file_id=%d, page num=%d,slot=%d", file_id_,
     // rec->rid.page_num, rec->rid.slot_num);
@@ -245,8 +489,10 @@ RC RecordPageHandler::delete_record(const RID *rid) {
 
   Bitmap bitmap(bitmap_, page_header_->record_capacity);
   if (bitmap.get_bit(rid->slot_num)) {
+    frame_->latch().lock();
     bitmap.clear_bit(rid->slot_num);
     page_header_->record_num--;
+    frame_->latch().unlock();
     frame_->mark_dirty();
 
     if (page_header_->record_num == 0) {
@@ -267,14 +513,14 @@ RC RecordPageHandler::get_record(const RID *rid, Record *rec) {
   if (rid->slot_num >= page_header_->record_capacity) {
     LOG_ERROR(
         "Invalid slot_num:%d, exceed page's record capacity, page_num %d.",
-        rid->slot_num, frame_->page_num());
+        rid->slot_num, get_page_num());
     return RC::RECORD_INVALIDRID;
   }
 
   Bitmap bitmap(bitmap_, page_header_->record_capacity);
   if (!bitmap.get_bit(rid->slot_num)) {
     LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid->slot_num,
-              frame_->page_num());
+              get_page_num());
     return RC::RECORD_RECORD_NOT_EXIST;
   }
 
@@ -283,11 +529,183 @@ RC RecordPageHandler::get_record(const RID *rid, Record *rec) {
   return RC::SUCCESS;
 }
 
+RC RecordPageHandler::get_tuple(SlotNum slot_num, const char *&tuple, int &len) {
+  if (slotted_header_ == nullptr || slot_num < 0) {
+    LOG_ERROR("Invalid slot_num:%d or not a slotted page, page_num %d.", slot_num, get_page_num());
+    return RC::RECORD_INVALIDRID;
+  }
+  const RecordSlot *slot = slot_num < slotted_header_->slot_num ? get_slot(slot_num) : nullptr;
+  if (slot == nullptr || slot->offset == 0) {
+    return RC::RECORD_RECORD_NOT_EXIST;
+  }
+
+  tuple = data_ + slot->offset;
+  len = slot->length;
+  return RC::SUCCESS;
+}
+
+void RecordPageHandler::put_tuple(RecordSlot *slot, const char *tuple, int len) {
+  memcpy(data_ + slotted_header_->free_offset, tuple, len);
+  slot->offset = static_cast<uint16_t>(slotted_header_->free_offset);
+  slot->length = static_cast<uint16_t>(len);
+  slotted_header_->free_offset += len;
+}
+
+RC RecordPageHandler::insert_tuple(const char *tuple, int len, RID *rid) {
+  // 优先使用删除之后空出来的槽位
+  SlotNum slot_num = 0;
+  while (slot_num < slotted_header_->slot_num && get_slot(slot_num)->offset != 0) {
+    slot_num++;
+  }
+  const int slot_size = slot_num == slotted_header_->slot_num ? sizeof(RecordSlot) : 0;
+  if (len + slot_size > slotted_header_->free_space) {
+    return RC::RECORD_NOMEM;
+  }
+
+  frame_->latch().lock();
+  if (len + slot_size > contiguous_free_space()) {
+    compact();
+  }
+
+  if (slot_size > 0) {
+    slotted_header_->slot_num++;
+  }
+  put_tuple(get_slot(slot_num), tuple, len);
+  slotted_header_->free_space -= len + slot_size;
+  slotted_header_->record_num++;
+  frame_->latch().unlock();
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = slot_num;
+  }
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::insert_tuple_at(const char *tuple, int len, SlotNum slot_num) {
+  if (slot_num < 0) {
+    LOG_WARN("slot_num illegal, slot_num(%d).", slot_num);
+    return RC::RECORD_INVALIDRID;
+  }
+  if (slot_num < slotted_header_->slot_num && get_slot(slot_num)->offset != 0) {
+    return update_tuple(slot_num, tuple, len);
+  }
+
+  const int new_slots = std::max(slot_num + 1 - slotted_header_->slot_num, 0);
+  const int slot_size = new_slots * static_cast<int>(sizeof(RecordSlot));
+  if (len + slot_size > slotted_header_->free_space) {
+    LOG_WARN("Page is full, page_num %d.", get_page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  frame_->latch().lock();
+  if (len + slot_size > contiguous_free_space()) {
+    compact();
+  }
+
+  for (SlotNum i = slotted_header_->slot_num; i < slot_num; i++) {
+    get_slot(i)->offset = 0;
+    get_slot(i)->length = 0;
+  }
+  slotted_header_->slot_num += new_slots;
+  put_tuple(get_slot(slot_num), tuple, len);
+  slotted_header_->free_space -= len + slot_size;
+  slotted_header_->record_num++;
+  frame_->latch().unlock();
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::update_tuple(SlotNum slot_num, const char *tuple, int len) {
+  const char *old_tuple = nullptr;
+  int old_len = 0;
+  RC rc = get_tuple(slot_num, old_tuple, old_len);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  if (len > old_len && len > slotted_header_->free_space + old_len) {
+    return RC::RECORD_NOMEM;
+  }
+
+  frame_->latch().lock();
+  RecordSlot *slot = get_slot(slot_num);
+  if (len <= old_len) {
+    memcpy(data_ + slot->offset, tuple, len);
+    slot->length = static_cast<uint16_t>(len);
+    slotted_header_->free_space += old_len - len;
+  } else {
+    // 原来的空间还给页面，在空闲空间中重新放一份，必要时整理碎片
+    slot->offset = 0;
+    slot->length = 0;
+    slotted_header_->free_space += old_len;
+    if (len > contiguous_free_space()) {
+      compact();
+    }
+    put_tuple(slot, tuple, len);
+    slotted_header_->free_space -= len;
+  }
+  frame_->latch().unlock();
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC RecordPageHandler::delete_tuple(SlotNum slot_num) {
+  const char *tuple = nullptr;
+  int len = 0;
+  RC rc = get_tuple(slot_num, tuple, len);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  frame_->latch().lock();
+  RecordSlot *slot = get_slot(slot_num);
+  slot->offset = 0;
+  slot->length = 0;
+  slotted_header_->free_space += len;
+  slotted_header_->record_num--;
+
+  // 末尾的空槽位还给空闲空间
+  while (slotted_header_->slot_num > 0 && get_slot(slotted_header_->slot_num - 1)->offset == 0) {
+    slotted_header_->slot_num--;
+    slotted_header_->free_space += sizeof(RecordSlot);
+  }
+  if (slotted_header_->record_num == 0) {
+    slotted_header_->free_offset = sizeof(SlottedPageHeader);
+  }
+  frame_->latch().unlock();
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+void RecordPageHandler::compact() {
+  std::vector<SlotNum> slots;
+  for (SlotNum i = 0; i < slotted_header_->slot_num; i++) {
+    if (get_slot(i)->offset != 0) {
+      slots.push_back(i);
+    }
+  }
+  std::sort(slots.begin(), slots.end(),
+            [this](SlotNum s1, SlotNum s2) { return get_slot(s1)->offset < get_slot(s2)->offset; });
+
+  int offset = sizeof(SlottedPageHeader);
+  for (SlotNum slot_num : slots) {
+    RecordSlot *slot = get_slot(slot_num);
+    if (slot->offset != offset) {
+      memmove(data_ + offset, data_ + slot->offset, slot->length);
+      slot->offset = static_cast<uint16_t>(offset);
+    }
+    offset += slot->length;
+  }
+  slotted_header_->free_offset = offset;
+}
+
 PageNum RecordPageHandler::get_page_num() const {
   if (nullptr == page_header_) {
     return (PageNum)(-1);
   }
-  return frame_->page_num();
+  return page_num_;
 }
 
 bool RecordPageHandler::is_full() const {
@@ -296,15 +714,32 @@ bool RecordPageHandler::is_full() const {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-RC RecordFileHandler::init(DiskBufferPool *buffer_pool) {
+RC RecordFileHandler::init(DiskBufferPool *buffer_pool, const RecordLayout *layout,
+                           DiskBufferPool *fsm_buffer_pool) {
   if (disk_buffer_pool_ != nullptr) {
     LOG_ERROR("record file handler has been openned.");
     return RC::RECORD_OPENNED;
   }
 
   disk_buffer_pool_ = buffer_pool;
+  slotted_ = layout != nullptr;
+  if (slotted_) {
+    layout_ = *layout;
+  }
 
-  RC rc = init_free_pages();
+  RC rc = RC::SUCCESS;
+  if (fsm_buffer_pool != nullptr) {
+    rc = free_space_map_.open(fsm_buffer_pool, buffer_pool->page_data_size());
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to open free space map, use a transient one instead. rc=%d:%s", rc, strrc(rc));
+    }
+  }
+  if (fsm_buffer_pool == nullptr || rc != RC::SUCCESS) {
+    rc = free_space_map_.open_transient(buffer_pool->page_data_size());
+  }
+  if (rc == RC::SUCCESS && free_space_map_.need_rebuild()) {
+    rc = rebuild_free_space_map();
+  }
 
   LOG_INFO("open record file handle done. rc=%s", strrc(rc));
   return RC::SUCCESS;
@@ -314,11 +749,13 @@ void RecordFileHandler::close() {
   if (disk_buffer_pool_ != nullptr) {
     disk_buffer_pool_ = nullptr;
   }
+  free_space_map_.close();
+  last_page_ = BP_INVALID_PAGE_NUM;
 }
 
-RC RecordFileHandler::init_free_pages() {
-  // 遍历当前文件上所有页面，找到没有满的页面
-  // 这个效率很低，会降低启动速度
+RC RecordFileHandler::rebuild_free_space_map() {
+  // 遍历当前文件上所有页面，记录每个页面的空闲空间
+  // 这个效率很低，只在没有持久化的空闲空间表时使用
 
   RC rc = RC::SUCCESS;
   BufferPoolIterator bp_iterator;
@@ -334,85 +771,177 @@ RC RecordFileHandler::init_free_pages() {
       return rc;
     }
 
-    if (!record_page_handler.is_full()) {
-      free_pages_.insert(current_page_num);
+    if (record_page_handler.slotted() == slotted_) {
+      free_space_map_.update(current_page_num, record_page_handler.free_space());
     }
     record_page_handler.cleanup();
   }
   return rc;
 }
 
+RC RecordFileHandler::find_free_page(int min_free, PageNum exclude_page, RecordPageHandler &page_handler,
+                                     bool &found) {
+  found = false;
+  PageNum page_num = last_page_ != exclude_page ? last_page_ : BP_INVALID_PAGE_NUM;
+  if (page_num == BP_INVALID_PAGE_NUM) {
+    page_num = free_space_map_.find(min_free, exclude_page);
+  }
 
-// 实现text
-RC RecordFileHandler::insert_record_text(const char *data, int record_size, RID *rid){
-  return RC::SUCCESS;
-
-
-
+  while (page_num != BP_INVALID_PAGE_NUM) {
+    // 空闲空间表只是一个提示(比如异常退出时没有落盘)，以页面中的实际情况为准
+    RC rc = page_handler.init(*disk_buffer_pool_, page_num);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", page_num, rc, strrc(rc));
+      free_space_map_.update(page_num, 0);
+    } else {
+      const bool usable = page_handler.slotted() == slotted_;
+      if (usable && page_handler.free_space() >= min_free) {
+        found = true;
+        return RC::SUCCESS;
+      }
+      free_space_map_.update(page_num, usable ? page_handler.free_space() : 0);
+      page_handler.cleanup();
+    }
 
+    const PageNum next_page = free_space_map_.find(min_free, exclude_page);
+    if (next_page == page_num) {
+      LOG_WARN("failed to correct free space map. page num=%d", page_num);
+      break;
+    }
+    page_num = next_page;
+  }
+  return RC::SUCCESS;
+}
 
+RC RecordFileHandler::get_insert_page(int min_free, PageNum exclude_page, int record_size,
+                                      RecordPageHandler &page_handler, bool append) {
+  RC ret = RC::SUCCESS;
+  if (!append) {
+    bool page_found = false;
+    ret = find_free_page(min_free, exclude_page, page_handler, page_found);
+    if (ret != RC::SUCCESS || page_found) {
+      return ret;
+    }
+  }
 
+  // 找不到就分配一个新的页面
+  Frame *frame = nullptr;
+  if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
+    LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
+    return ret;
+  }
 
+  const PageNum page_num = frame->page_num();
+  ret = slotted_ ? page_handler.init_empty_slotted_page(*disk_buffer_pool_, page_num)
+                 : page_handler.init_empty_page(*disk_buffer_pool_, page_num, record_size);
+  if (ret != RC::SUCCESS) {
+    LOG_ERROR("Failed to init empty page. ret:%d", ret);
+    if (RC::SUCCESS != disk_buffer_pool_->unpin_page(frame)) {
+      LOG_ERROR("Failed to unpin page. ");
+    }
+    return ret;
+  }
 
+  disk_buffer_pool_->unpin_page(frame);
+  return RC::SUCCESS;
+}
 
+void RecordFileHandler::update_free_space(RecordPageHandler &page_handler) {
+  free_space_map_.update(page_handler.get_page_num(), page_handler.free_space());
 }
+
 RC RecordFileHandler::insert_record(const char *data, int record_size,
                                     RID *rid) {
-  // if(record_size >4096){
-  //   return insert_record_text(data,record_size,rid);
-  // }
-  RC ret = RC::SUCCESS;
-  // 找到没有填满的页面
+  if (slotted_) {
+    return insert_slotted_record(data, rid);
+  }
 
+  // 找到没有填满的页面
   RecordPageHandler record_page_handler;
-  bool page_found = false;
-  PageNum current_page_num = 0;
-  while (!free_pages_.empty()) {
-    current_page_num = *free_pages_.begin();
-    ret = record_page_handler.init(*disk_buffer_pool_, current_page_num);
-    if (ret != RC::SUCCESS) {
-      LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s",
-               current_page_num, ret, strrc(ret));
-      return ret;
-    }
+  RC ret = get_insert_page(1, BP_INVALID_PAGE_NUM, record_size, record_page_handler);
+  if (ret != RC::SUCCESS) {
+    return ret;
+  }
 
-    if (!record_page_handler.is_full()) {
-      page_found = true;
+  // 找到空闲位置
+  ret = record_page_handler.insert_record(data, rid);
+  if (ret == RC::SUCCESS) {
+    last_page_ = rid->page_num;
+    update_free_space(record_page_handler);
+  }
+  return ret;
+}
+
+RC RecordFileHandler::insert_records(const char *data, int record_num, int record_size, RID *rids, bool append) {
+  std::vector<char> tuple(slotted_ ? 1 + layout_.max_encoded_size() : 0);
+  auto encode = [&](int index) {
+    tuple[0] = TUPLE_NORMAL;
+    return 1 + layout_.encode(data + index * record_size, tuple.data() + 1);
+  };
+  const int max_tuple_len = disk_buffer_pool_->page_data_size() -
+                            static_cast<int>(sizeof(SlottedPageHeader) + sizeof(RecordSlot));
+
+  RC rc = RC::SUCCESS;
+  int inserted = 0;
+  int len = slotted_ && record_num > 0 ? encode(0) : 0;
+  while (inserted < record_num) {
+    if (len > max_tuple_len) {
+      LOG_WARN("Record is too long for a page. len=%d, page size=%d", len, disk_buffer_pool_->page_data_size());
+      rc = RC::RECORD_NOMEM;
       break;
     }
-    record_page_handler.cleanup();
-    free_pages_.erase(free_pages_.begin());
-  }
 
-  // 找不到就分配一个新的页面
-  if (!page_found) {
-    Frame *frame = nullptr;
-    if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
-      LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
-      return ret;
+    RecordPageHandler page_handler;
+    const int min_free = slotted_ ? len + static_cast<int>(sizeof(RecordSlot)) : 1;
+    rc = get_insert_page(min_free, BP_INVALID_PAGE_NUM, record_size, page_handler, append);
+    if (rc != RC::SUCCESS) {
+      break;
     }
 
-    current_page_num = frame->page_num();
-    ret = record_page_handler.init_empty_page(*disk_buffer_pool_,
-                                              current_page_num, record_size);
-    if (ret != RC::SUCCESS) {
-      LOG_ERROR("Failed to init empty page. ret:%d", ret);
-      if (RC::SUCCESS != disk_buffer_pool_->unpin_page(frame)) {
-        LOG_ERROR("Failed to unpin page. ");
+    // 页面只pin一次，放满之后再换下一个页面
+    while (inserted < record_num) {
+      if (slotted_) {
+        if (page_handler.free_space() < len + static_cast<int>(sizeof(RecordSlot))) {
+          break;
+        }
+        rc = page_handler.insert_tuple(tuple.data(), len, &rids[inserted]);
+      } else {
+        if (page_handler.is_full()) {
+          break;
+        }
+        rc = page_handler.insert_record(data + inserted * record_size, &rids[inserted]);
+      }
+      if (rc != RC::SUCCESS) {
+        break;
+      }
+      inserted++;
+      if (slotted_ && inserted < record_num) {
+        len = encode(inserted);
       }
-      return ret;
     }
 
-    disk_buffer_pool_->unpin_page(frame);
-    free_pages_.insert(current_page_num);
+    last_page_ = page_handler.get_page_num();
+    update_free_space(page_handler);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
   }
 
-  // 找到空闲位置
-  return record_page_handler.insert_record(data, rid);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to insert records, rollback. inserted=%d, total=%d, rc=%s", inserted, record_num, strrc(rc));
+    for (int i = 0; i < inserted; i++) {
+      delete_record(&rids[i]);
+    }
+  }
+  return rc;
 }
 
 RC RecordFileHandler::recover_insert_record(const char *data, int record_size,
                                             RID *rid) {
+  if (slotted_) {
+    return recover_insert_slotted_record(data, rid);
+  }
+
   RC ret = RC::SUCCESS;
   RecordPageHandler record_page_handler;
 
@@ -423,11 +952,19 @@ RC RecordFileHandler::recover_insert_record(const char *data, int record_size,
     return ret;
   }
 
-  return record_page_handler.recover_insert_record(data, rid);
+  ret = record_page_handler.recover_insert_record(data, rid);
+  if (ret == RC::SUCCESS) {
+    update_free_space(record_page_handler);
+  }
+  return ret;
 }
 
 // 这里也需要实现 ? 似乎不需要了 只需要传入正确的record
 RC RecordFileHandler::update_record(const Record *rec) {
+  if (slotted_) {
+    return update_slotted_record(rec);
+  }
+
   RC ret;
   RecordPageHandler page_handler;
   if ((ret = page_handler.init(*disk_buffer_pool_, rec->rid().page_num)) !=
@@ -441,9 +978,13 @@ RC RecordFileHandler::update_record(const Record *rec) {
 }
 
 RC RecordFileHandler::delete_record(const RID *rid) {
+  if (slotted_) {
+    return delete_slotted_record(rid);
+  }
+
   RC rc = RC::SUCCESS;
   RecordPageHandler page_handler;
-  if ((rc != page_handler.init(*disk_buffer_pool_, rid->page_num)) !=
+  if ((rc = page_handler.init(*disk_buffer_pool_, rid->page_num)) !=
       RC::SUCCESS) {
     LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s",
               rid->page_num, strrc(rc));
@@ -451,7 +992,7 @@ RC RecordFileHandler::delete_record(const RID *rid) {
   }
   rc = page_handler.delete_record(rid);
   if (rc == RC::SUCCESS) {
-    free_pages_.insert(rid->page_num);
+    update_free_space(page_handler);
   }
   return rc;
 }
@@ -465,23 +1006,212 @@ RC RecordFileHandler::get_record(const RID *rid, Record *rec) {
   }
 
   RecordPageHandler page_handler;
-  if ((ret != page_handler.init(*disk_buffer_pool_, rid->page_num)) !=
+  if ((ret = page_handler.init(*disk_buffer_pool_, rid->page_num)) !=
       RC::SUCCESS) {
     LOG_ERROR("Failed to init record page handler.page number=%d",
               rid->page_num);
     return ret;
   }
 
+  if (slotted_) {
+    return read_slotted_record(*disk_buffer_pool_, layout_, page_handler, rid->slot_num, false, *rec);
+  }
   return page_handler.get_record(rid, rec);
 }
 
+RC RecordFileHandler::insert_tuple(const char *tuple, int len, PageNum exclude_page, RID *rid) {
+  if (len + static_cast<int>(sizeof(SlottedPageHeader) + sizeof(RecordSlot)) > disk_buffer_pool_->page_data_size()) {
+    LOG_WARN("Record is too long for a page. len=%d, page size=%d", len, disk_buffer_pool_->page_data_size());
+    return RC::RECORD_NOMEM;
+  }
+
+  RecordPageHandler record_page_handler;
+  RC ret = get_insert_page(len + static_cast<int>(sizeof(RecordSlot)), exclude_page, 0, record_page_handler);
+  if (ret != RC::SUCCESS) {
+    return ret;
+  }
+
+  ret = record_page_handler.insert_tuple(tuple, len, rid);
+  if (ret == RC::SUCCESS) {
+    last_page_ = rid->page_num;
+    update_free_space(record_page_handler);
+  }
+  return ret;
+}
+
+RC RecordFileHandler::delete_tuple(const RID &rid) {
+  RecordPageHandler page_handler;
+  RC rc = page_handler.init(*disk_buffer_pool_, rid.page_num);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s", rid.page_num, strrc(rc));
+    return rc;
+  }
+  rc = page_handler.delete_tuple(rid.slot_num);
+  if (rc == RC::SUCCESS) {
+    update_free_space(page_handler);
+  }
+  return rc;
+}
+
+RC RecordFileHandler::insert_slotted_record(const char *data, RID *rid) {
+  std::vector<char> tuple(1 + layout_.max_encoded_size());
+  tuple[0] = TUPLE_NORMAL;
+  const int len = 1 + layout_.encode(data, tuple.data() + 1);
+  return insert_tuple(tuple.data(), len, BP_INVALID_PAGE_NUM, rid);
+}
+
+RC RecordFileHandler::update_slotted_record(const Record *rec) {
+  const RID &rid = rec->rid();
+  std::vector<char> tuple(1 + layout_.max_encoded_size());
+  tuple[0] = TUPLE_NORMAL;
+  const int len = 1 + layout_.encode(rec->data(), tuple.data() + 1);
+
+  RecordPageHandler page_handler;
+  RC rc = page_handler.init(*disk_buffer_pool_, rid.page_num);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to init record page handler.page number=%d", rid.page_num);
+    return rc;
+  }
+
+  const char *old_tuple = nullptr;
+  int old_len = 0;
+  rc = page_handler.get_tuple(rid.slot_num, old_tuple, old_len);
+  if (rc == RC::SUCCESS && old_tuple[0] == TUPLE_MOVED) {
+    rc = RC::RECORD_RECORD_NOT_EXIST;
+  }
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to get record to update. rid=%d.%d, rc=%s", rid.page_num, rid.slot_num, strrc(rc));
+    return rc;
+  }
+  const bool forwarded = old_tuple[0] == TUPLE_FORWARD;
+  RID forward;
+  if (forwarded) {
+    memcpy(&forward, old_tuple + 1, sizeof(forward));
+  }
+
+  // 优先放在原来的页面中，之前转发出去的记录也搬回来
+  rc = page_handler.update_tuple(rid.slot_num, tuple.data(), len);
+  if (rc == RC::SUCCESS) {
+    update_free_space(page_handler);
+    return forwarded ? delete_tuple(forward) : RC::SUCCESS;
+  }
+  if (rc != RC::RECORD_NOMEM) {
+    return rc;
+  }
+
+  tuple[0] = TUPLE_MOVED;
+  if (forwarded) {
+    RecordPageHandler forward_handler;
+    rc = forward_handler.init(*disk_buffer_pool_, forward.page_num);
+    if (rc == RC::SUCCESS) {
+      rc = forward_handler.update_tuple(forward.slot_num, tuple.data(), len);
+    }
+    if (rc == RC::SUCCESS) {
+      update_free_space(forward_handler);
+    }
+    if (rc != RC::RECORD_NOMEM) {
+      return rc;
+    }
+  }
+
+  // 原来的页面放不下了，记录搬到别的页面，原来的位置上留下转发指针，RID保持不变
+  RID new_forward;
+  rc = insert_tuple(tuple.data(), len, rid.page_num, &new_forward);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to move record to another page. rid=%d.%d, rc=%s", rid.page_num, rid.slot_num, strrc(rc));
+    return rc;
+  }
+
+  char forward_tuple[FORWARD_TUPLE_SIZE];
+  forward_tuple[0] = TUPLE_FORWARD;
+  memcpy(forward_tuple + 1, &new_forward, sizeof(new_forward));
+  rc = page_handler.update_tuple(rid.slot_num, forward_tuple, sizeof(forward_tuple));
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("Failed to write forward pointer. rid=%d.%d, rc=%s", rid.page_num, rid.slot_num, strrc(rc));
+    delete_tuple(new_forward);
+    return rc;
+  }
+  update_free_space(page_handler);
+  return forwarded ? delete_tuple(forward) : RC::SUCCESS;
+}
+
+RC RecordFileHandler::delete_slotted_record(const RID *rid) {
+  RecordPageHandler page_handler;
+  RC rc = page_handler.init(*disk_buffer_pool_, rid->page_num);
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s", rid->page_num, strrc(rc));
+    return rc;
+  }
+
+  const char *tuple = nullptr;
+  int len = 0;
+  rc = page_handler.get_tuple(rid->slot_num, tuple, len);
+  if (rc == RC::SUCCESS && tuple[0] == TUPLE_MOVED) {
+    rc = RC::RECORD_RECORD_NOT_EXIST;
+  }
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  if (tuple[0] == TUPLE_FORWARD) {
+    RID forward;
+    memcpy(&forward, tuple + 1, sizeof(forward));
+    rc = delete_tuple(forward);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("Failed to delete forwarded record. rid=%d.%d, forward=%d.%d, rc=%s",
+               rid->page_num, rid->slot_num, forward.page_num, forward.slot_num, strrc(rc));
+      return rc;
+    }
+  }
+
+  rc = page_handler.delete_tuple(rid->slot_num);
+  if (rc == RC::SUCCESS) {
+    update_free_space(page_handler);
+  }
+  return rc;
+}
+
+RC RecordFileHandler::recover_insert_slotted_record(const char *data, RID *rid) {
+  RecordPageHandler page_handler;
+  RC rc = page_handler.recover_init(*disk_buffer_pool_, rid->page_num);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", rid->page_num, rc, strrc(rc));
+    return rc;
+  }
+  if (!page_handler.slotted()) {
+    LOG_WARN("page is not a slotted page while recovering. page num=%d", rid->page_num);
+    return RC::RECORD_INVALIDRID;
+  }
+
+  const char *old_tuple = nullptr;
+  int old_len = 0;
+  if (page_handler.get_tuple(rid->slot_num, old_tuple, old_len) == RC::SUCCESS && old_tuple[0] != TUPLE_NORMAL) {
+    // 槽位上已经是转发指针或者别的页面搬过来的记录，说明插入之后的修改已经落盘了
+    return RC::SUCCESS;
+  }
+
+  std::vector<char> tuple(1 + layout_.max_encoded_size());
+  tuple[0] = TUPLE_NORMAL;
+  const int len = 1 + layout_.encode(data, tuple.data() + 1);
+  rc = page_handler.insert_tuple_at(tuple.data(), len, rid->slot_num);
+  if (rc == RC::SUCCESS) {
+    update_free_space(page_handler);
+  }
+  return rc;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
+RecordFileScanner::~RecordFileScanner() { close_scan(); }
+
 RC RecordFileScanner::open_scan(DiskBufferPool &buffer_pool,
-                                ConditionFilter *condition_filter) {
+                                ConditionFilter *condition_filter,
+                                bool readonly, const RecordLayout *layout) {
   close_scan();
 
   disk_buffer_pool_ = &buffer_pool;
+  readonly_ = readonly;
+  layout_ = layout;
 
   RC rc = bp_iterator_.init(buffer_pool);
   if (rc != RC::SUCCESS) {
@@ -490,6 +1220,21 @@ RC RecordFileScanner::open_scan(DiskBufferPool &buffer_pool,
   }
   condition_filter_ = condition_filter;
 
+  will_need_pages_ = 0;
+  will_need_end_ = 0;
+  if (readonly_ && buffer_pool.mmap_scan()) {
+    // 页面不进入缓冲池，预读交给内核
+    will_need_pages_ = buffer_pool.bp_manager().read_ahead_pages();
+    batch_pages_ = 0;
+    buffer_pool.advise_sequential();
+  } else {
+    // 批量获取的页面在扫描完之前一直pin住，不能占用太多的缓冲池
+    const int pool_limit = static_cast<int>(buffer_pool.frame_manager().total_frame_num() / 8);
+    batch_pages_ = std::max(std::min(buffer_pool.bp_manager().read_ahead_pages(), pool_limit), 1);
+  }
+  // 读取都由批量获取或者内核预读完成
+  bp_iterator_.set_read_ahead_pages(0);
+
   rc = fetch_next_record();
   if (rc == RC::RECORD_EOF) {
     rc = RC::SUCCESS;
@@ -506,10 +1251,12 @@ RC RecordFileScanner::fetch_next_record() {
     }
   }
 
-  while (bp_iterator_.has_next()) {
-    PageNum page_num = bp_iterator_.next();
+  while (true) {
     record_page_handler_.cleanup();
-    rc = record_page_handler_.init(*disk_buffer_pool_, page_num);
+    rc = init_next_page();
+    if (rc == RC::RECORD_EOF) {
+      break;
+    }
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to init record page handler. rc=%d:%s", rc, strrc(rc));
       return rc;
@@ -525,6 +1272,58 @@ RC RecordFileScanner::fetch_next_record() {
   return RC::RECORD_EOF;
 }
 
+RC RecordFileScanner::init_next_page() {
+  if (batch_pages_ == 0) {
+    if (!bp_iterator_.has_next()) {
+      return RC::RECORD_EOF;
+    }
+    PageNum page_num = bp_iterator_.next();
+    if (will_need_pages_ > 0 && page_num >= will_need_end_) {
+      disk_buffer_pool_->advise_will_need(page_num, will_need_pages_);
+      will_need_end_ = page_num + will_need_pages_;
+    }
+    char *page_copy = nullptr;
+    if (disk_buffer_pool_->mmap_scan()) {
+      std::vector<char> &buffer = page_copies_[page_copy_index_ ^= 1];
+      buffer.resize(disk_buffer_pool_->page_size());
+      page_copy = buffer.data();
+    }
+    return record_page_handler_.init_readonly(*disk_buffer_pool_, page_num, page_copy);
+  }
+
+  if (batch_index_ >= batch_frames_.size()) {
+    release_batch_frames();
+    std::vector<PageNum> page_nums;
+    while (static_cast<int>(page_nums.size()) < batch_pages_ && bp_iterator_.has_next()) {
+      page_nums.push_back(bp_iterator_.next());
+    }
+    if (page_nums.empty()) {
+      return RC::RECORD_EOF;
+    }
+
+    batch_frames_.resize(page_nums.size());
+    RC rc = disk_buffer_pool_->get_pages(page_nums.data(), static_cast<int>(page_nums.size()), batch_frames_.data());
+    if (rc != RC::SUCCESS) {
+      batch_frames_.clear();
+      return rc;
+    }
+  }
+
+  Frame *frame = batch_frames_[batch_index_];
+  batch_frames_[batch_index_++] = nullptr;
+  return record_page_handler_.init_pinned(*disk_buffer_pool_, frame);
+}
+
+void RecordFileScanner::release_batch_frames() {
+  for (Frame *frame : batch_frames_) {
+    if (frame != nullptr) {
+      disk_buffer_pool_->unpin_page(frame);
+    }
+  }
+  batch_frames_.clear();
+  batch_index_ = 0;
+}
+
 RC RecordFileScanner::fetch_next_record_in_page() {
   RC rc = RC::SUCCESS;
   while (record_page_iterator_.has_next()) {
@@ -533,6 +1332,18 @@ RC RecordFileScanner::fetch_next_record_in_page() {
       return rc;
     }
 
+    if (record_page_handler_.slotted()) {
+      if (layout_ == nullptr) {
+        LOG_ERROR("Slotted page without record layout. page num=%d", record_page_handler_.get_page_num());
+        return RC::RECORD_INVALIDRECSIZE;
+      }
+      rc = read_slotted_record(*disk_buffer_pool_, *layout_, record_page_handler_,
+                               next_record_.rid().slot_num, readonly_, next_record_);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+    }
+
     if (condition_filter_ == nullptr ||
         condition_filter_->filter(next_record_)) {
       return rc;
@@ -545,6 +1356,7 @@ RC RecordFileScanner::fetch_next_record_in_page() {
 
 RC RecordFileScanner::close_scan() {
   if (disk_buffer_pool_ != nullptr) {
+    release_batch_frames();
     disk_buffer_pool_ = nullptr;
   }
 
@@ -14,9 +14,12 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <sstream>
+#include <unordered_set>
 #include <limits>
+#include <vector>
 #include "storage/default/disk_buffer_pool.h"
 #include "storage/record/record.h"
+#include "storage/record/free_space_map.h"
 #include "common/lang/bitmap.h"
 
 class ConditionFilter;
@@ -29,6 +32,60 @@ struct PageHeader {
   int32_t first_record_offset;  // 第一条记录的偏移量
 };
 
+/**
+ * 变长格式的页面头。
+ * 记录从页面头之后往后存放，槽位目录从页面末尾往前增长。RID中的slot_num是槽位的下标，
+ * 整理碎片时记录在页面中移动，槽位不变。
+ * 每条记录的第一个字节是标记：普通记录、转发指针(后面是记录现在的RID)或者从别的页面转发过来的记录。
+ * 更新之后原来的页面放不下时，记录搬到别的页面，原来的槽位留下转发指针，RID(以及索引)不变
+ */
+struct SlottedPageHeader {
+  int32_t magic;        // 区分定长格式的页面，定长格式的页面这里是记录个数
+  int32_t record_num;   // 使用中的槽位个数，包括转发指针和转发过来的记录
+  int32_t slot_num;     // 槽位目录的长度
+  int32_t free_offset;  // 空闲空间的开始位置
+  int32_t free_space;   // 页面中所有的空闲空间，包括删除和更新留下的空洞
+};
+
+struct RecordSlot {
+  uint16_t offset;  // 记录在页面中的偏移，0表示空的槽位
+  uint16_t length;  // 记录的长度，包括开头的标记
+};
+
+/**
+ * 变长格式(RecordFormat::SLOTTED)中记录的编码方式。
+ * 内存中的记录(Record::data)始终是定长的，上层按照字段的偏移访问。写到页面中时，字符串类型的字段
+ * 只保存第一个'\0'之前的部分，前面加两个字节的长度，其它字段原样保存
+ */
+class RecordLayout
+{
+public:
+  struct VarField {
+    int offset;
+    int len;
+  };
+
+public:
+  RecordLayout() = default;
+  RecordLayout(int record_size, std::vector<VarField> var_fields);
+
+  int record_size() const { return record_size_; }
+  int min_encoded_size() const { return min_encoded_size_; }
+  int max_encoded_size() const { return max_encoded_size_; }
+
+  /**
+   * 编码之后写到buf中，buf至少有max_encoded_size个字节，返回编码之后的长度
+   */
+  int encode(const char *record, char *buf) const;
+  RC decode(const char *buf, int size, char *record) const;
+
+private:
+  int record_size_ = 0;
+  int min_encoded_size_ = 0;
+  int max_encoded_size_ = 0;
+  std::vector<VarField> var_fields_;  // 按照偏移排序
+};
+
 class RecordPageHandler;
 class RecordPageIterator
 {
@@ -39,11 +96,18 @@ public:
   void init(RecordPageHandler &record_page_handler);
 
   bool has_next();
+
+  /**
+   * 变长格式的页面只返回记录的RID，由调用者读取并解码记录
+   */
   RC   next(Record &record);
 
   bool is_valid() const {
     return record_page_handler_ != nullptr;
   }
+private:
+  SlotNum next_slotted(SlotNum slot_num) const;
+
 private:
   RecordPageHandler *record_page_handler_ = nullptr;
   PageNum page_num_ = BP_INVALID_PAGE_NUM;
@@ -56,10 +120,48 @@ public:
   RecordPageHandler() = default;
   ~RecordPageHandler();
   RC init(DiskBufferPool &buffer_pool, PageNum page_num);
+
+  /**
+   * 只读方式打开页面，不能修改其中的记录。页面不在缓冲池中时从文件映射复制到page_copy中(参考DiskBufferPool::read_page)
+   * @param page_copy 至少page_size字节，nullptr时使用handler自己的缓冲区
+   */
+  RC init_readonly(DiskBufferPool &buffer_pool, PageNum page_num, char *page_copy = nullptr);
+
+  /**
+   * 使用一个已经pin住的页面(比如DiskBufferPool::get_pages批量获取的页面)，cleanup时unpin
+   */
+  RC init_pinned(DiskBufferPool &buffer_pool, Frame *frame);
   RC recover_init(DiskBufferPool &buffer_pool, PageNum page_num);
   RC init_empty_page(DiskBufferPool &buffer_pool, PageNum page_num, int record_size);
+  RC init_empty_slotted_page(DiskBufferPool &buffer_pool, PageNum page_num);
   RC cleanup();
 
+  /**
+   * 页面是不是变长格式，下面的xxx_tuple只能用于变长格式的页面。
+   * tuple是页面中存放的一条记录，包括开头的标记，编码和转发由RecordFileHandler处理
+   */
+  bool slotted() const { return slotted_header_ != nullptr; }
+  RC get_tuple(SlotNum slot_num, const char *&tuple, int &len);
+  RC insert_tuple(const char *tuple, int len, RID *rid);
+  /**
+   * 插入到指定的槽位，槽位已经在使用时覆盖原来的记录。恢复时使用
+   */
+  RC insert_tuple_at(const char *tuple, int len, SlotNum slot_num);
+  /**
+   * 页面中放不下时返回RECORD_NOMEM，原来的记录不变
+   */
+  RC update_tuple(SlotNum slot_num, const char *tuple, int len);
+  RC delete_tuple(SlotNum slot_num);
+  /**
+   * 页面中所有的空闲空间，变长格式使用新槽位时还要放下一个RecordSlot，定长格式是空闲槽位占用的空间
+   */
+  int free_space() const
+  {
+    return slotted_header_ != nullptr
+               ? slotted_header_->free_space
+               : (page_header_->record_capacity - page_header_->record_num) * page_header_->record_size;
+  }
+
   RC insert_record(const char *data, RID *rid);
   RC recover_insert_record(const char *data, RID *rid);
   RC update_record(const Record *rec);
@@ -72,7 +174,9 @@ public:
     if (rc != RC::SUCCESS) {
       return rc;
     }
+    frame_->latch().lock();
     rc = updater(record);
+    frame_->latch().unlock();
     frame_->mark_dirty();
     return rc;
   }
@@ -88,14 +192,37 @@ public:
 protected:
   char *get_record_data(SlotNum slot_num)
   {
-    return frame_->data() + page_header_->first_record_offset + (page_header_->record_size * slot_num);
+    return data_ + page_header_->first_record_offset + (page_header_->record_size * slot_num);
+  }
+
+  RecordSlot *get_slot(SlotNum slot_num) const
+  {
+    return reinterpret_cast<RecordSlot *>(data_ + page_size_) - (slot_num + 1);
   }
+  int contiguous_free_space() const
+  {
+    return page_size_ - slotted_header_->slot_num * static_cast<int>(sizeof(RecordSlot)) - slotted_header_->free_offset;
+  }
+  void init_page_header(DiskBufferPool &buffer_pool, char *data);
+  /**
+   * 整理碎片，把所有记录移到页面的前部，空闲空间连成一片。调用者持有页面的写锁
+   */
+  void compact();
+  /**
+   * 在连续的空闲空间中放下tuple，调用者保证空间足够并且持有页面的写锁
+   */
+  void put_tuple(RecordSlot *slot, const char *tuple, int len);
 
 protected:
   DiskBufferPool *disk_buffer_pool_ = nullptr;
-  Frame *frame_ = nullptr;
+  Frame *frame_ = nullptr;  // 只读打开文件映射中的页面时是nullptr
+  std::vector<char> page_copy_;  // init_readonly没有指定缓冲区时，从文件映射中复制出来的页面
+  char *data_ = nullptr;
+  PageNum page_num_ = BP_INVALID_PAGE_NUM;
   PageHeader *page_header_ = nullptr;
   char *bitmap_ = nullptr;
+  SlottedPageHeader *slotted_header_ = nullptr;  // 定长格式的页面是nullptr
+  int page_size_ = 0;
 
 private:
   friend class RecordPageIterator;
@@ -104,9 +231,19 @@ private:
 class RecordFileHandler {
 public:
   RecordFileHandler() = default;
-  RC init(DiskBufferPool *buffer_pool);
+
+  /**
+   * @param layout 不为空时使用变长格式(RecordFormat::SLOTTED)存放记录
+   * @param fsm_buffer_pool 保存空闲空间表的文件，为空时空闲空间表只保存在内存中，每次打开都要遍历数据文件重建
+   */
+  RC init(DiskBufferPool *buffer_pool, const RecordLayout *layout = nullptr, DiskBufferPool *fsm_buffer_pool = nullptr);
   void close();
 
+  /**
+   * 变长格式的记录编码方式，定长格式返回nullptr
+   */
+  const RecordLayout *layout() const { return slotted_ ? &layout_ : nullptr; }
+
   /**
    * 更新指定文件中的记录，rec指向的记录结构中的rid字段为要更新的记录的标识符，
    * pData字段指向新的记录内容
@@ -122,7 +259,13 @@ public:
    * 插入一个新的记录到指定文件中，pData为指向新纪录内容的指针，返回该记录的标识符rid
    */
   RC insert_record(const char *data, int record_size, RID *rid);
-  RC insert_record_text(const char *data, int record_size, RID *rid);
+  /**
+   * 批量插入record_num条连续存放的记录，一个页面放满之后再使用下一个页面，每个页面只pin一次。
+   * 失败时已经插入的记录都会删除
+   * @param rids 返回每条记录的标识符，至少有record_num个元素
+   * @param append 不使用已有页面的空闲空间，都放到新分配的页面中，导入数据时用来整页构建
+   */
+  RC insert_records(const char *data, int record_num, int record_size, RID *rids, bool append = false);
   RC recover_insert_record(const char *data, int record_size, RID *rid);
 
   /**
@@ -133,10 +276,22 @@ public:
   template <class RecordUpdater>  // 改成普通模式, 不使用模板
   RC update_record_in_place(const RID *rid, RecordUpdater updater)
   {
+    if (slotted_) {
+      // 页面中是编码之后的记录，修改解码出来的记录之后再写回去
+      Record record;
+      RC rc = get_record(rid, &record);
+      if (rc == RC::SUCCESS) {
+        rc = updater(record);
+      }
+      if (rc == RC::SUCCESS) {
+        rc = update_record(&record);
+      }
+      return rc;
+    }
 
     RC rc = RC::SUCCESS;
     RecordPageHandler page_handler;
-    if ((rc != page_handler.init(*disk_buffer_pool_, rid->page_num)) != RC::SUCCESS) {
+    if ((rc = page_handler.init(*disk_buffer_pool_, rid->page_num)) != RC::SUCCESS) {
       return rc;
     }
 
@@ -144,22 +299,52 @@ public:
   }
 
 private:
-  RC init_free_pages();
-  
+  RC rebuild_free_space_map();
+  /**
+   * 找一个空闲空间不少于min_free的页面，先试上次插入的页面，再查空闲空间表。
+   * 空闲空间表和页面的实际情况不一致时修正之后继续找，找不到时found是false
+   */
+  RC find_free_page(int min_free, PageNum exclude_page, RecordPageHandler &page_handler, bool &found);
+  /**
+   * 找一个空闲空间不少于min_free的页面，找不到或者append为true时分配一个新页面。record_size用来初始化定长格式的新页面
+   */
+  RC get_insert_page(int min_free, PageNum exclude_page, int record_size, RecordPageHandler &page_handler,
+                     bool append = false);
+  void update_free_space(RecordPageHandler &page_handler);
+
+  RC insert_slotted_record(const char *data, RID *rid);
+  RC update_slotted_record(const Record *rec);
+  RC delete_slotted_record(const RID *rid);
+  RC recover_insert_slotted_record(const char *data, RID *rid);
+  /**
+   * 在exclude_page之外找一个放得下的页面插入tuple，找不到就分配一个新页面
+   */
+  RC insert_tuple(const char *tuple, int len, PageNum exclude_page, RID *rid);
+  RC delete_tuple(const RID &rid);
+
 private:
   DiskBufferPool *disk_buffer_pool_ = nullptr;
-  std::unordered_set<PageNum>  free_pages_; // 没有填充满的页面集合
+  FreeSpaceMap free_space_map_;
+  PageNum last_page_ = BP_INVALID_PAGE_NUM;  // 上次插入的页面，连续插入时不用每次都查空闲空间表
+  bool slotted_ = false;
+  RecordLayout layout_;
 };
 
 class RecordFileScanner {
 public:
   RecordFileScanner() = default;
+  ~RecordFileScanner();
 
   /**
    * 打开一个文件扫描。
    * 如果条件不为空，则要对每条记录进行条件比较，只有满足所有条件的记录才被返回
+   * @param readonly 扫描出来的记录不会被修改。文件开启了mmap_scan时直接访问文件映射中的页面，
+   *                 不再预读到缓冲池中，而是通过madvise让内核预读。
+   *                 其它情况下每次通过DiskBufferPool::get_pages批量获取接下来的若干个页面(预读的页面个数)
+   * @param layout 变长格式的文件中记录的编码方式，参考RecordFileHandler::layout
    */
-  RC open_scan(DiskBufferPool &buffer_pool, ConditionFilter *condition_filter);
+  RC open_scan(DiskBufferPool &buffer_pool, ConditionFilter *condition_filter, bool readonly = false,
+               const RecordLayout *layout = nullptr);
 
   /**
    * 关闭一个文件扫描，释放相应的资源
@@ -172,6 +357,8 @@ public:
 private:
   RC fetch_next_record();
   RC fetch_next_record_in_page();
+  RC init_next_page();
+  void release_batch_frames();
 private:
   DiskBufferPool *disk_buffer_pool_ = nullptr;
 
@@ -180,4 +367,13 @@ private:
   RecordPageHandler record_page_handler_;
   RecordPageIterator record_page_iterator_;
   Record next_record_;
+  const RecordLayout *layout_ = nullptr;
+  bool readonly_ = false;
+  int will_need_pages_ = 0;        // 只读扫描文件映射时，每次提示内核预读的页面个数
+  PageNum will_need_end_ = 0;      // 已经提示过预读的页面范围的结尾
+  int batch_pages_ = 0;            // 每次批量获取的页面个数，0表示访问文件映射，不使用批量获取
+  std::vector<Frame *> batch_frames_;  // 批量获取的页面，都是pin住的，用过的位置是nullptr
+  size_t batch_index_ = 0;
+  std::vector<char> page_copies_[2];  // 从文件映射复制出来的页面，next返回的记录可能还在上一个页面中，所以轮流使用
+  int page_copy_index_ = 0;
 };
@@ -0,0 +1,180 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "storage/clog/clog.h"
+#include "storage/common/meta_util.h"
+#include "storage/common/table.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/trx/trx.h"
+
+/**
+ * 多行insert语句的插入速度(rows/s)。
+ * 表结构是 id int, name char(32), score float，id上有索引，id是随机的。
+ * 每轮插入ROW_NUM行，按照每条语句batch行拆分：
+ * - row: 以前的做法，每行调用一次insert_record，每行写一次REDO_INSERT和MTR_COMMIT(刷日志)
+ * - batch: insert_records一次插入整条语句，按页面写REDO_INSERT_BATCH，索引排序后插入，每条语句刷一次日志
+ */
+
+static const int ROW_NUM = 20000;
+static const char *BASE_DIR = "batch_insert_perf";
+
+static CLogManager *clog_manager = nullptr;
+static int table_seq = 0;
+
+struct Rows {
+  std::vector<int> ids;
+  std::vector<std::string> names;
+  std::vector<float> scores;
+  std::vector<Value> values;
+};
+
+static void make_rows(Rows &rows)
+{
+  std::mt19937 random(0);
+  rows.ids.resize(ROW_NUM);
+  rows.names.resize(ROW_NUM);
+  rows.scores.resize(ROW_NUM);
+  rows.values.resize(ROW_NUM * 3);
+  for (int i = 0; i < ROW_NUM; i++) {
+    rows.ids[i] = static_cast<int>(random());
+    rows.names[i] = "name_" + std::to_string(i);
+    rows.scores[i] = i * 0.5f;
+  }
+  for (int i = 0; i < ROW_NUM; i++) {
+    rows.values[i * 3] = Value{INTS, &rows.ids[i]};
+    rows.values[i * 3 + 1] = Value{CHARS, const_cast<char *>(rows.names[i].c_str())};
+    rows.values[i * 3 + 2] = Value{FLOATS, &rows.scores[i]};
+  }
+}
+
+static Table *create_table()
+{
+  AttrInfo attrs[3];
+  attrs[0] = AttrInfo{const_cast<char *>("id"), INTS, 4};
+  attrs[1] = AttrInfo{const_cast<char *>("name"), CHARS, 32};
+  attrs[2] = AttrInfo{const_cast<char *>("score"), FLOATS, 4};
+
+  const std::string table_name = "t" + std::to_string(table_seq++);
+  const std::string meta_file = table_meta_file(BASE_DIR, table_name.c_str());
+  Table *table = new Table();
+  if (table->create(meta_file.c_str(), table_name.c_str(), BASE_DIR, 3, attrs, clog_manager) != RC::SUCCESS) {
+    delete table;
+    return nullptr;
+  }
+
+  std::vector<char *> index_fields{const_cast<char *>("id")};
+  if (table->create_index(nullptr, "i_id", index_fields, false) != RC::SUCCESS) {
+    table->destory(BASE_DIR);
+    delete table;
+    return nullptr;
+  }
+  return table;
+}
+
+static RC log_commit(Trx &trx)
+{
+  CLogRecord *clog_record = nullptr;
+  RC rc = clog_manager->clog_gen_record(CLogType::REDO_MTR_COMMIT, trx.get_current_id(), clog_record);
+  if (rc == RC::SUCCESS) {
+    rc = clog_manager->clog_append_record(clog_record);
+  }
+  trx.next_current_id();
+  return rc;
+}
+
+/**
+ * 第一个参数是每条语句的行数，第二个参数为0表示逐行插入，1表示批量插入
+ */
+static void BM_MultiRowInsert(benchmark::State &state)
+{
+  const int batch = state.range(0);
+  const bool use_batch = state.range(1) == 1;
+  Rows rows;
+  make_rows(rows);
+
+  long inserted = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Table *table = create_table();
+    Trx trx;
+    state.ResumeTiming();
+    if (table == nullptr) {
+      state.SkipWithError("failed to create table");
+      break;
+    }
+
+    RC rc = RC::SUCCESS;
+    for (int start = 0; start < ROW_NUM && rc == RC::SUCCESS; start += batch) {
+      const int row_num = std::min(batch, ROW_NUM - start);
+      const Value *values = &rows.values[start * 3];
+      if (use_batch) {
+        rc = table->insert_records(&trx, 3, values, row_num);
+        if (rc == RC::SUCCESS) {
+          rc = log_commit(trx);
+        }
+        continue;
+      }
+      for (int i = 0; i < row_num && rc == RC::SUCCESS; i++) {
+        rc = table->insert_record(&trx, 3, values + i * 3);
+        if (rc == RC::SUCCESS) {
+          rc = log_commit(trx);
+        }
+      }
+    }
+
+    state.PauseTiming();
+    table->destory(BASE_DIR);
+    delete table;
+    state.ResumeTiming();
+    if (rc != RC::SUCCESS) {
+      state.SkipWithError("failed to insert rows");
+      break;
+    }
+    inserted += ROW_NUM;
+  }
+
+  state.SetLabel(use_batch ? "batch" : "row");
+  state.SetItemsProcessed(inserted);
+}
+BENCHMARK(BM_MultiRowInsert)
+    ->Args({100, 0})
+    ->Args({100, 1})
+    ->Args({1000, 0})
+    ->Args({1000, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+int main(int argc, char **argv)
+{
+  // Table使用全局的缓冲池管理器
+  BufferPoolManager::set_instance(new BufferPoolManager());
+  ::mkdir(BASE_DIR, 0755);
+  clog_manager = new CLogManager(BASE_DIR);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  delete clog_manager;
+  return 0;
+}
@@ -0,0 +1,350 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "storage/default/disk_buffer_pool.h"
+#include "common/os/numa.h"
+
+/**
+ * buffer pool 并发访问的性能测试
+ * 每个线程访问自己的文件(相当于访问不同的表)，所有页面都已经在内存中，
+ * 测试命中时的吞吐量随着线程数的变化。
+ * 所有线程访问同一个文件中少数几个热点页面(比如B+树的根节点)时，测试pin计数和查找的竞争。
+ * NUMA测试统计命中的页面在本地节点还是远端节点上，比较线程绑定节点前后的差别。
+ * 混合负载测试比较热点表和大表扫描共用一个缓冲池，以及各自使用自己的缓冲池时，热点表的命中率。
+ * 另外还有查找空闲页面的性能测试。
+ */
+
+static const int MAX_THREAD_NUM = 16;
+static const int MAX_HOT_THREAD_NUM = 64;
+static const int PAGE_NUM_PER_FILE = 64;
+static const int HOT_PAGE_NUM = 4;
+
+static std::map<int, BPFrameManager *> frame_managers;  // partition num -> frame manager
+static BPFrameManager *numa_frame_manager = nullptr;
+static BufferPoolManager *bp_manager = nullptr;
+static std::vector<DiskBufferPool *> buffer_pools;
+static std::vector<std::string> file_names;
+
+static const int ISOLATION_POOL_FRAME_NUM = 64;
+static const int ISOLATION_HOT_FRAME_NUM = 16;
+static const int ISOLATION_HOT_PAGE_NUM = 8;
+static const int ISOLATION_SCAN_PAGE_NUM = 4 * ISOLATION_POOL_FRAME_NUM;
+static const int ISOLATION_SCAN_PER_LOOKUP = 16;
+static DiskBufferPool *isolation_pools[2][2];  // [shared/dedicated][hot/scan]
+
+static void BM_FrameManagerGet(benchmark::State &state)
+{
+  BPFrameManager &frame_manager = *frame_managers[state.range(0)];
+  const int file_desc = state.thread_index();
+  PageNum page_num = 0;
+  for (auto _ : state) {
+    Frame *frame = frame_manager.get(file_desc, page_num);
+    benchmark::DoNotOptimize(frame);
+    page_num = (page_num + 1) % PAGE_NUM_PER_FILE;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameManagerGet)->Arg(1)->Arg(8)->Arg(32)->ThreadRange(1, MAX_THREAD_NUM)->UseRealTime();
+
+static void BM_BufferPoolFetchUnpin(benchmark::State &state)
+{
+  DiskBufferPool *buffer_pool = buffer_pools[state.thread_index()];
+  PageNum page_num = 1;
+  for (auto _ : state) {
+    Frame *frame = nullptr;
+    RC rc = buffer_pool->get_this_page(page_num, &frame);
+    if (rc != RC::SUCCESS) {
+      state.SkipWithError("failed to get page");
+      break;
+    }
+    buffer_pool->unpin_page(frame);
+    page_num = page_num % PAGE_NUM_PER_FILE + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferPoolFetchUnpin)->ThreadRange(1, MAX_THREAD_NUM)->UseRealTime();
+
+static void BM_BufferPoolHotPages(benchmark::State &state)
+{
+  DiskBufferPool *buffer_pool = buffer_pools[0];
+  PageNum page_num = state.thread_index() % HOT_PAGE_NUM + 1;
+  for (auto _ : state) {
+    Frame *frame = nullptr;
+    RC rc = buffer_pool->get_this_page(page_num, &frame);
+    if (rc != RC::SUCCESS) {
+      state.SkipWithError("failed to get page");
+      break;
+    }
+    benchmark::DoNotOptimize(frame->data()[0]);
+    buffer_pool->unpin_page(frame);
+    page_num = page_num % HOT_PAGE_NUM + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferPoolHotPages)->ThreadRange(1, MAX_HOT_THREAD_NUM)->UseRealTime();
+
+/**
+ * 每个线程先加载自己的页面，然后反复访问。range(0)为1时线程按照编号绑定到各个节点上，
+ * 页面会放在访问它的线程所在的节点上，远端命中应该接近0；不绑定时线程可能被调度到其它节点。
+ * 单节点的机器上所有的命中都是本地的
+ */
+static void BM_NumaLocalHits(benchmark::State &state)
+{
+  BPFrameManager &frame_manager = *numa_frame_manager;
+  const int node_num = frame_manager.numa_node_num();
+  if (state.range(0) == 1) {
+    common::numa_bind_thread(state.thread_index() % node_num);
+  }
+
+  // 不同的参数使用不同的文件，保证页面是当前线程第一次加载的
+  const int file_desc = static_cast<int>(state.range(0) * MAX_THREAD_NUM + state.thread_index());
+  BPFrameManager::NumaStats &stats = frame_manager.numa_stats();
+  const long local_hits = stats.local_hits.load();
+  const long remote_hits = stats.remote_hits.load();
+  PageNum page_num = 0;
+  for (auto _ : state) {
+    Frame *frame = frame_manager.pin(file_desc, page_num);
+    if (frame == nullptr) {
+      frame = frame_manager.alloc(file_desc, page_num);
+      if (frame == nullptr) {
+        state.SkipWithError("failed to alloc frame");
+        break;
+      }
+      frame_manager.finish_load(frame);
+    }
+    frame_manager.unpin_frame(frame);
+    page_num = (page_num + 1) % PAGE_NUM_PER_FILE;
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    // 所有线程都结束循环之后才会走到这里
+    const double local = static_cast<double>(stats.local_hits.load() - local_hits);
+    const double remote = static_cast<double>(stats.remote_hits.load() - remote_hits);
+    state.counters["nodes"] = node_num;
+    state.counters["local_hits"] = local;
+    state.counters["remote_hits"] = remote;
+    state.counters["remote_ratio"] = local + remote > 0 ? remote / (local + remote) : 0;
+  }
+}
+BENCHMARK(BM_NumaLocalHits)->Arg(0)->Arg(1)->ThreadRange(1, MAX_THREAD_NUM)->UseRealTime();
+
+/**
+ * 在range(0)个分组都快满了的情况下，反复释放和分配最后一个页面，测试查找空闲页面的开销。
+ * 不会随着文件变大而线性增长
+ */
+static void BM_SpaceMapFindFree(benchmark::State &state)
+{
+  const int group_num = state.range(0);
+  const int group_page_num = BPFileHeader::GROUP_PAGE_NUM;
+  const int page_count = group_num * group_page_num;
+  std::vector<std::vector<char>> bitmaps(group_num, std::vector<char>(group_page_num / 8, (char)0xFF));
+
+  BPSpaceMap space_map(group_page_num);
+  for (int group = 0; group < group_num; group++) {
+    space_map.load_group(group, bitmaps[group].data(), page_count);
+  }
+
+  const PageNum page_num = page_count - 1;
+  char *bitmap = bitmaps.back().data();
+  const int bit = page_num % group_page_num;
+  for (auto _ : state) {
+    bitmap[bit / 8] &= ~(1 << (bit % 8));
+    space_map.update(page_num, bitmap, page_count);
+
+    int group = 0, word = 0;
+    if (!space_map.first_free_word(group, word)) {
+      state.SkipWithError("failed to find free page");
+      break;
+    }
+    bitmap[bit / 8] |= (1 << (bit % 8));
+    space_map.update(page_num, bitmap, page_count);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpaceMapFindFree)->Arg(1)->Arg(64)->Arg(1024);
+
+/**
+ * 混合负载：一个只有几个页面的热点表不停地被查询，同时有一个比缓冲池大得多的表在做全表扫描。
+ * range(0)为0时两个表共用一个缓冲池，扫描会把热点表的页面挤出去；
+ * 为1时热点表使用自己的缓冲池，两种情况下缓冲池的总大小相同。
+ */
+static void BM_PoolIsolation(benchmark::State &state)
+{
+  DiskBufferPool *hot_bp = isolation_pools[state.range(0)][0];
+  DiskBufferPool *scan_bp = isolation_pools[state.range(0)][1];
+  const long hits = hot_bp->stats().hits.load();
+  const long misses = hot_bp->stats().misses.load();
+
+  PageNum hot_page_num = 1;
+  PageNum scan_page_num = 1;
+  for (auto _ : state) {
+    Frame *frame = nullptr;
+    if (hot_bp->get_this_page(hot_page_num, &frame) != RC::SUCCESS) {
+      state.SkipWithError("failed to get hot page");
+      break;
+    }
+    hot_bp->unpin_page(frame);
+    hot_page_num = hot_page_num % ISOLATION_HOT_PAGE_NUM + 1;
+
+    for (int i = 0; i < ISOLATION_SCAN_PER_LOOKUP; i++) {
+      if (scan_bp->get_this_page(scan_page_num, &frame) != RC::SUCCESS) {
+        state.SkipWithError("failed to get scan page");
+        break;
+      }
+      scan_bp->unpin_page(frame);
+      scan_page_num = scan_page_num % ISOLATION_SCAN_PAGE_NUM + 1;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  const double hot_hits = static_cast<double>(hot_bp->stats().hits.load() - hits);
+  const double hot_misses = static_cast<double>(hot_bp->stats().misses.load() - misses);
+  state.counters["hot_hit_rate"] = hot_hits + hot_misses > 0 ? hot_hits / (hot_hits + hot_misses) : 0;
+}
+BENCHMARK(BM_PoolIsolation)->Arg(0)->Arg(1);
+
+static int init_frame_managers()
+{
+  const int partition_nums[] = {1, 8, 32};
+  for (int partition_num : partition_nums) {
+    BPFrameManager *frame_manager = new BPFrameManager("Perf");
+    frame_manager->init(MAX_THREAD_NUM * PAGE_NUM_PER_FILE, partition_num);
+    for (int file_desc = 0; file_desc < MAX_THREAD_NUM; file_desc++) {
+      for (PageNum page_num = 0; page_num < PAGE_NUM_PER_FILE; page_num++) {
+        Frame *frame = frame_manager->alloc(file_desc, page_num);
+        if (frame == nullptr) {
+          return -1;
+        }
+        frame->set_file_desc(file_desc);
+        frame->set_page_num(page_num);
+        frame_manager->finish_load(frame);
+        frame_manager->unpin_frame(frame);
+      }
+    }
+    frame_managers[partition_num] = frame_manager;
+  }
+
+  // 每个线程的页面都要放得下，不会发生淘汰
+  FrameAllocator::Options options;
+  options.numa_node_num = common::numa_node_num();
+  numa_frame_manager = new BPFrameManager("PerfNuma");
+  if (numa_frame_manager->init(2 * MAX_THREAD_NUM * PAGE_NUM_PER_FILE, BPFrameManager::DEFAULT_PARTITION_NUM,
+                               BPFrameManager::DEFAULT_REPLACE_POLICY, options) != RC::SUCCESS) {
+    return -1;
+  }
+  numa_frame_manager->set_numa_hit_stats(true);
+  return 0;
+}
+
+static int init_buffer_pools()
+{
+  bp_manager = new BufferPoolManager();
+  for (int i = 0; i < MAX_THREAD_NUM; i++) {
+    std::string file_name = "bp_manager_perf_" + std::to_string(i) + ".data";
+    ::remove(file_name.c_str());
+
+    DiskBufferPool *buffer_pool = nullptr;
+    if (bp_manager->create_file(file_name.c_str()) != RC::SUCCESS ||
+        bp_manager->open_file(file_name.c_str(), buffer_pool) != RC::SUCCESS) {
+      return -1;
+    }
+    file_names.push_back(file_name);
+    buffer_pools.push_back(buffer_pool);
+
+    for (int page = 0; page < PAGE_NUM_PER_FILE; page++) {
+      Frame *frame = nullptr;
+      if (buffer_pool->allocate_page(&frame) != RC::SUCCESS) {
+        return -1;
+      }
+      buffer_pool->unpin_page(frame);
+    }
+  }
+
+  // 共用的缓冲池和分开的两个缓冲池总大小相同
+  if (bp_manager->create_pool("perf_shared", ISOLATION_POOL_FRAME_NUM, 1, "lru") != RC::SUCCESS ||
+      bp_manager->create_pool("perf_hot", ISOLATION_HOT_FRAME_NUM, 1, "lru") != RC::SUCCESS ||
+      bp_manager->create_pool("perf_scan", ISOLATION_POOL_FRAME_NUM - ISOLATION_HOT_FRAME_NUM, 1, "lru") !=
+          RC::SUCCESS) {
+    return -1;
+  }
+  const char *pool_names[2][2] = {{"perf_shared", "perf_shared"}, {"perf_hot", "perf_scan"}};
+  const int page_nums[2] = {ISOLATION_HOT_PAGE_NUM, ISOLATION_SCAN_PAGE_NUM};
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      std::string file_name = "bp_manager_perf_isolation_" + std::to_string(i) + "_" + std::to_string(j) + ".data";
+      ::remove(file_name.c_str());
+
+      DiskBufferPool *buffer_pool = nullptr;
+      if (bp_manager->create_file(file_name.c_str()) != RC::SUCCESS ||
+          bp_manager->open_file(file_name.c_str(), buffer_pool, pool_names[i][j]) != RC::SUCCESS) {
+        return -1;
+      }
+      file_names.push_back(file_name);
+      isolation_pools[i][j] = buffer_pool;
+
+      for (int page = 0; page < page_nums[j]; page++) {
+        Frame *frame = nullptr;
+        if (buffer_pool->allocate_page(&frame) != RC::SUCCESS) {
+          return -1;
+        }
+        buffer_pool->unpin_page(frame);
+      }
+    }
+  }
+  return 0;
+}
+
+static void cleanup()
+{
+  for (auto &iter : frame_managers) {
+    delete iter.second;
+  }
+  frame_managers.clear();
+  delete numa_frame_manager;
+  numa_frame_manager = nullptr;
+
+  for (const std::string &file_name : file_names) {
+    bp_manager->close_file(file_name.c_str());
+    ::remove(file_name.c_str());
+  }
+  delete bp_manager;
+  bp_manager = nullptr;
+}
+
+int main(int argc, char **argv)
+{
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  if (init_frame_managers() != 0 || init_buffer_pools() != 0) {
+    fprintf(stderr, "failed to prepare data for benchmark\n");
+    cleanup();
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  cleanup();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,211 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/string.h"
+#include "storage/common/bulk_loader.h"
+#include "storage/common/meta_util.h"
+#include "storage/common/table.h"
+#include "storage/default/disk_buffer_pool.h"
+
+/**
+ * LOAD DATA的导入速度(rows/s和MB/s)。
+ * 生成一个 id|name|score|city 格式的CSV文件，id是随机顺序的，导入到一个空表中，表在id上有索引：
+ * - row: 以前的做法，getline读取一行，split_string拆分字段，每行调用一次Table::insert_record
+ * - bulk: BulkLoader，参数是解析线程的个数，0表示按照CPU个数决定
+ * 默认生成1M行(大约40MB)，可以使用环境变量LOAD_DATA_PERF_ROWS指定行数，比如 LOAD_DATA_PERF_ROWS=60000000 大约是2.4GB
+ */
+
+static const char *BASE_DIR = "load_data_perf";
+static const char *DATA_FILE = "load_data_perf/data.csv";
+
+static int64_t row_num = 1000000;
+static int64_t file_size = 0;
+static int table_seq = 0;
+
+static RC make_file()
+{
+  std::ofstream ofs(DATA_FILE, std::ios_base::out | std::ios_base::trunc);
+  if (!ofs.is_open()) {
+    return RC::IOERR_WRITE;
+  }
+
+  const char *cities[] = {"beijing", "shanghai", "hangzhou", "shenzhen", "wuhan", "chengdu"};
+  std::mt19937 random(0);
+  std::vector<int> ids(row_num);
+  for (int64_t i = 0; i < row_num; i++) {
+    ids[i] = static_cast<int>(i);
+  }
+  std::shuffle(ids.begin(), ids.end(), random);
+
+  std::string line;
+  for (int64_t i = 0; i < row_num; i++) {
+    const int id = ids[i];
+    line = std::to_string(id);
+    line += "|name_";
+    line += std::to_string(id);
+    line += '|';
+    line += std::to_string(id % 1000) + "." + std::to_string(id % 10);
+    line += '|';
+    line += cities[id % 6];
+    line += '\n';
+    ofs.write(line.data(), line.size());
+  }
+  ofs.close();
+
+  struct stat st;
+  if (stat(DATA_FILE, &st) != 0) {
+    return RC::IOERR_ACCESS;
+  }
+  file_size = st.st_size;
+  return RC::SUCCESS;
+}
+
+static Table *create_table()
+{
+  AttrInfo attrs[4];
+  attrs[0] = AttrInfo{const_cast<char *>("id"), INTS, 4};
+  attrs[1] = AttrInfo{const_cast<char *>("name"), CHARS, 32};
+  attrs[2] = AttrInfo{const_cast<char *>("score"), FLOATS, 4};
+  attrs[3] = AttrInfo{const_cast<char *>("city"), CHARS, 16};
+
+  const std::string table_name = "t" + std::to_string(table_seq++);
+  const std::string meta_file = table_meta_file(BASE_DIR, table_name.c_str());
+  Table *table = new Table();
+  if (table->create(meta_file.c_str(), table_name.c_str(), BASE_DIR, 4, attrs, nullptr) != RC::SUCCESS) {
+    delete table;
+    return nullptr;
+  }
+
+  std::vector<char *> index_fields{const_cast<char *>("id")};
+  if (table->create_index(nullptr, "i_id", index_fields, false) != RC::SUCCESS) {
+    table->destory(BASE_DIR);
+    delete table;
+    return nullptr;
+  }
+  return table;
+}
+
+/**
+ * 以前的导入方式，类型转换和插入都按行处理
+ */
+static RC load_by_row(Table *table)
+{
+  std::ifstream ifs(DATA_FILE, std::ios_base::in | std::ios_base::binary);
+  if (!ifs.is_open()) {
+    return RC::IOERR_READ;
+  }
+
+  std::string line;
+  std::vector<std::string> file_values;
+  Value values[4];
+  RC rc = RC::SUCCESS;
+  while (rc == RC::SUCCESS && std::getline(ifs, line)) {
+    file_values.clear();
+    common::split_string(line, "|", file_values);
+    if (file_values.size() < 4) {
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    value_init_integer(&values[0], atoi(file_values[0].c_str()));
+    value_init_string(&values[1], file_values[1].c_str(), file_values[1].size());
+    value_init_float(&values[2], atof(file_values[2].c_str()));
+    value_init_string(&values[3], file_values[3].c_str(), file_values[3].size());
+    rc = table->insert_record(nullptr, 4, values);
+    for (Value &value : values) {
+      value_destroy(&value);
+    }
+  }
+  if (rc == RC::SUCCESS) {
+    rc = table->sync_data();
+  }
+  return rc;
+}
+
+/**
+ * 参数为-1表示逐行插入，否则是BulkLoader解析线程的个数
+ */
+static void BM_LoadData(benchmark::State &state)
+{
+  const int thread_num = state.range(0);
+
+  int64_t loaded = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Table *table = create_table();
+    state.ResumeTiming();
+    if (table == nullptr) {
+      state.SkipWithError("failed to create table");
+      break;
+    }
+
+    RC rc = RC::SUCCESS;
+    if (thread_num < 0) {
+      rc = load_by_row(table);
+    } else {
+      BulkLoader loader(table, thread_num);
+      rc = loader.load(DATA_FILE);
+      if (rc == RC::SUCCESS && loader.row_num() != row_num) {
+        rc = RC::GENERIC_ERROR;
+      }
+    }
+
+    state.PauseTiming();
+    table->destory(BASE_DIR);
+    delete table;
+    state.ResumeTiming();
+    if (rc != RC::SUCCESS) {
+      state.SkipWithError("failed to load data");
+      break;
+    }
+    loaded += row_num;
+  }
+
+  state.SetLabel(thread_num < 0 ? "row" : "bulk");
+  state.SetItemsProcessed(loaded);
+  state.SetBytesProcessed(loaded / row_num * file_size);
+}
+BENCHMARK(BM_LoadData)->Arg(-1)->Arg(1)->Arg(0)->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char **argv)
+{
+  const char *rows = getenv("LOAD_DATA_PERF_ROWS");
+  if (rows != nullptr && atoll(rows) > 0) {
+    row_num = atoll(rows);
+  }
+
+  // Table使用全局的缓冲池管理器
+  BufferPoolManager::set_instance(new BufferPoolManager());
+  ::mkdir(BASE_DIR, 0755);
+  if (make_file() != RC::SUCCESS) {
+    fprintf(stderr, "failed to generate data file %s\n", DATA_FILE);
+    return 1;
+  }
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  ::remove(DATA_FILE);
+  return 0;
+}
@@ -0,0 +1,195 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/record/overflow_manager.h"
+#include "storage/record/record_manager.h"
+
+/**
+ * TEXT字段放在记录中和放在溢出页面中的对比。
+ * 表结构是 id int, content text，content的实际长度在100~2000之间随机：
+ * - inline: 以前的格式，TEXT字段在记录中固定占用4096字节
+ * - overflow: 记录中只保存64字节的TextRef，超过56字节的部分放在溢出文件中，不足半页的数据共用槽位页面
+ * BM_TextScan 每轮淘汰所有页面后全表扫描，参数1表示只读取id，参数2表示同时读取完整的content
+ */
+
+static const int RECORD_NUM = 20000;
+static const int INLINE_TEXT_LEN = 4096;
+static const int MIN_TEXT_LEN = 100;
+static const int MAX_TEXT_LEN = 2000;
+static const char *FILE_NAMES[] = {"overflow_text_perf_inline.data", "overflow_text_perf_ref.data"};
+static const char *OVERFLOW_FILE_NAME = "overflow_text_perf.overflow";
+
+static BufferPoolManager *bp_manager = nullptr;
+static DiskBufferPool *buffer_pools[2] = {nullptr, nullptr};
+static DiskBufferPool *overflow_buffer_pool = nullptr;
+static RecordFileHandler *record_handlers[2] = {nullptr, nullptr};
+static OverflowFileHandler *overflow_handler = nullptr;
+
+static int record_size(int format)
+{
+  return 4 + (format == 0 ? INLINE_TEXT_LEN : (int)sizeof(TextRef));
+}
+
+static void make_record(int format, int id, const std::string &text, char *data)
+{
+  memset(data, 0, record_size(format));
+  memcpy(data, &id, sizeof(id));
+  if (format == 0) {
+    memcpy(data + 4, text.data(), text.size());
+    return;
+  }
+
+  TextRef text_ref;
+  memset(&text_ref, 0, sizeof(text_ref));
+  text_ref.length = text.size();
+  memcpy(text_ref.prefix, text.data(), TextRef::INLINE_SIZE);
+  RID rid;
+  overflow_handler->insert_data(text.data() + TextRef::INLINE_SIZE, text.size() - TextRef::INLINE_SIZE, &rid);
+  text_ref.first_page = rid.page_num;
+  text_ref.slot_num = rid.slot_num;
+  memcpy(data + 4, &text_ref, sizeof(text_ref));
+}
+
+/**
+ * 第一个参数为0表示inline格式，1表示overflow格式；第二个参数是读取的字段个数
+ */
+static void BM_TextScan(benchmark::State &state)
+{
+  const int format = state.range(0);
+  const bool read_text = state.range(1) > 1;
+  DiskBufferPool *bp = buffer_pools[format];
+  long records = 0;
+  long checksum = 0;
+  std::string text;
+  for (auto _ : state) {
+    state.PauseTiming();
+    bp->flush_all_pages();
+    bp->purge_all_pages();
+    overflow_buffer_pool->flush_all_pages();
+    overflow_buffer_pool->purge_all_pages();
+    state.ResumeTiming();
+
+    RecordFileScanner scanner;
+    if (scanner.open_scan(*bp, nullptr, true) != RC::SUCCESS) {
+      state.SkipWithError("failed to open scan");
+      break;
+    }
+    Record record;
+    while (scanner.has_next()) {
+      if (scanner.next(record) != RC::SUCCESS) {
+        state.SkipWithError("failed to scan record");
+        break;
+      }
+      checksum += *(const int *)record.data();
+      if (read_text) {
+        const char *field = record.data() + 4;
+        if (format == 0) {
+          text.assign(field, strnlen(field, INLINE_TEXT_LEN));
+        } else {
+          TextRef text_ref;
+          memcpy(&text_ref, field, sizeof(text_ref));
+          text.resize(text_ref.length);
+          memcpy(&text[0], text_ref.prefix, TextRef::INLINE_SIZE);
+          overflow_handler->get_data(
+              text_ref.overflow_rid(), &text[TextRef::INLINE_SIZE], text_ref.length - TextRef::INLINE_SIZE);
+        }
+        checksum += text.back();
+      }
+      records++;
+    }
+    scanner.close_scan();
+  }
+  benchmark::DoNotOptimize(checksum);
+
+  int page_count = 0;
+  bp->get_page_count(&page_count);
+  state.SetLabel(format == 0 ? "inline" : "overflow");
+  state.SetItemsProcessed(records);
+  state.counters["data_pages"] = page_count;
+  if (format == 1) {
+    int overflow_pages = 0;
+    overflow_buffer_pool->get_page_count(&overflow_pages);
+    state.counters["overflow_pages"] = overflow_pages;
+  }
+}
+BENCHMARK(BM_TextScan)
+    ->Args({0, 1})
+    ->Args({1, 1})
+    ->Args({0, 2})
+    ->Args({1, 2})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+int main(int argc, char **argv)
+{
+  bp_manager = new BufferPoolManager();
+  ::remove(OVERFLOW_FILE_NAME);
+  if (bp_manager->create_file(OVERFLOW_FILE_NAME) != RC::SUCCESS ||
+      bp_manager->open_file(OVERFLOW_FILE_NAME, overflow_buffer_pool) != RC::SUCCESS) {
+    return -1;
+  }
+  overflow_handler = new OverflowFileHandler();
+  overflow_handler->init(overflow_buffer_pool);
+
+  std::mt19937 random(0);
+  std::uniform_int_distribution<int> len_dist(MIN_TEXT_LEN, MAX_TEXT_LEN);
+  char data[4 + INLINE_TEXT_LEN];
+  for (int format = 0; format < 2; format++) {
+    ::remove(FILE_NAMES[format]);
+    if (bp_manager->create_file(FILE_NAMES[format]) != RC::SUCCESS ||
+        bp_manager->open_file(FILE_NAMES[format], buffer_pools[format]) != RC::SUCCESS) {
+      return -1;
+    }
+    record_handlers[format] = new RecordFileHandler();
+    if (record_handlers[format]->init(buffer_pools[format]) != RC::SUCCESS) {
+      return -1;
+    }
+
+    random.seed(0);
+    for (int i = 0; i < RECORD_NUM; i++) {
+      std::string text(len_dist(random), 'a' + i % 26);
+      make_record(format, i, text, data);
+      RID rid;
+      if (record_handlers[format]->insert_record(data, record_size(format), &rid) != RC::SUCCESS) {
+        return -1;
+      }
+    }
+    buffer_pools[format]->flush_all_pages();
+  }
+  overflow_buffer_pool->flush_all_pages();
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  for (int format = 0; format < 2; format++) {
+    record_handlers[format]->close();
+    delete record_handlers[format];
+    bp_manager->close_file(FILE_NAMES[format]);
+    ::remove(FILE_NAMES[format]);
+  }
+  overflow_handler->close();
+  delete overflow_handler;
+  bp_manager->close_file(OVERFLOW_FILE_NAME);
+  ::remove(OVERFLOW_FILE_NAME);
+  return 0;
+}
@@ -0,0 +1,763 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "common/io/io.h"
+#include "common/math/crc32c.h"
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/default/double_write_buffer.h"
+#include "storage/default/page_io.h"
+#include "storage/record/record_manager.h"
+#include "storage/index/bplus_tree.h"
+
+/**
+ * 全表扫描时页面读取的系统调用开销。
+ * 数据都在操作系统的page cache中，测试的是每个页面需要几次系统调用以及对应的耗时：
+ * - LseekRead: 以前的做法，先lseek再read，每个页面两次系统调用
+ * - Pread: 每个页面一次pread
+ * - Preadv: 连续的多个页面合并成一次preadv
+ * - PageIOBatchRead: 通过PageIO批量读取不连续的页面，对比sync和io_uring
+ * - BufferPoolScan: 通过DiskBufferPool扫描整个文件，每次扫描前淘汰所有页面，
+ *   用 /proc/thread-self/io 中的 syscr 统计实际发生的读系统调用次数。参数是预读窗口，0表示不预读
+ * - FlushPages: 一批脏页写盘并落盘的耗时，对比开启和不开启双写
+ * - DirectIO: 缓冲池未命中时从page cache读取和使用O_DIRECT直接读盘的对比，
+ *   同时统计文件在page cache中占用的内存，就是使用page cache时多缓存的那一份
+ * - MmapScan: 通过RecordFileScanner全表扫描冷表，对比复制到缓冲池中的frame和直接访问文件映射(MmapScan)
+ * - ColdRangeScan: 冷数据的全表扫描和索引范围扫描，对比逐个页面获取和通过get_pages批量获取
+ * - PageSize: 同样的记录存放在4K/16K/64K页面的文件中，缓冲池大小相同且装不下整个表，
+ *   对比随机点查和全表扫描的吞吐、命中率以及从文件读取的字节数
+ */
+
+using namespace common;
+
+static const int SCAN_PAGE_NUM = 4096;  // 64M
+static const char *SCAN_FILE_NAME = "page_io_perf.data";
+
+static const char *DIRECT_IO_DIR = "page_io_perf_direct";
+static const char *DIRECT_IO_FILE_NAME = "page_io_perf_direct/page_io_perf.data";
+
+static const char *MMAP_SCAN_DIR = "page_io_perf_mmap";
+static const char *MMAP_SCAN_FILE_NAME = "page_io_perf_mmap/page_io_perf.data";
+static const int MMAP_SCAN_RECORD_NUM = 500000;  // 64字节的记录，大约2000个页面
+
+static const char *INDEX_FILE_NAME = "page_io_perf.index";
+static const int INDEX_KEY_NUM = 300000;
+
+static const int PAGE_SIZE_RECORD_NUM = 1000000;   // 64字节的记录，64M左右，是缓冲池的两倍
+static const size_t PAGE_SIZE_POOL_BYTES = 32UL << 20;  // 与PageSizePoolSize的默认值相同
+static const int PAGE_SIZES[] = {4096, 16384, 65536};
+
+static BufferPoolManager *bp_manager = nullptr;
+static BufferPoolManager *page_size_bp_manager = nullptr;
+static std::map<int, DiskBufferPool *> page_size_buffer_pools;
+static std::map<int, std::vector<RID>> page_size_rids;
+static BplusTreeHandler *index_handler = nullptr;
+static DiskBufferPool *buffer_pool = nullptr;
+static DiskBufferPool *direct_buffer_pool = nullptr;
+static DiskBufferPool *mmap_buffer_pool = nullptr;
+
+static long read_syscall_count()
+{
+  FILE *file = fopen("/proc/thread-self/io", "r");
+  if (file == nullptr) {
+    return -1;
+  }
+
+  long count = -1;
+  char line[128];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    if (sscanf(line, "syscr: %ld", &count) == 1) {
+      break;
+    }
+  }
+  fclose(file);
+  return count;
+}
+
+static void BM_ScanLseekRead(benchmark::State &state)
+{
+  int fd = ::open(SCAN_FILE_NAME, O_RDONLY);
+  Page page;
+  long syscalls = 0;
+  for (auto _ : state) {
+    for (PageNum page_num = 0; page_num < SCAN_PAGE_NUM; page_num++) {
+      if (lseek(fd, (off_t)page_num * sizeof(Page), SEEK_SET) == -1 || readn(fd, &page, sizeof(Page)) != 0) {
+        state.SkipWithError("failed to read page");
+        break;
+      }
+      syscalls += 2;
+    }
+  }
+  ::close(fd);
+  state.SetItemsProcessed(state.iterations() * SCAN_PAGE_NUM);
+  state.counters["syscalls/page"] = (double)syscalls / (state.iterations() * SCAN_PAGE_NUM);
+}
+BENCHMARK(BM_ScanLseekRead);
+
+static void BM_ScanPread(benchmark::State &state)
+{
+  int fd = ::open(SCAN_FILE_NAME, O_RDONLY);
+  Page page;
+  long syscalls = 0;
+  for (auto _ : state) {
+    for (PageNum page_num = 0; page_num < SCAN_PAGE_NUM; page_num++) {
+      if (preadn(fd, &page, sizeof(Page), (off_t)page_num * sizeof(Page)) != 0) {
+        state.SkipWithError("failed to read page");
+        break;
+      }
+      syscalls += 1;
+    }
+  }
+  ::close(fd);
+  state.SetItemsProcessed(state.iterations() * SCAN_PAGE_NUM);
+  state.counters["syscalls/page"] = (double)syscalls / (state.iterations() * SCAN_PAGE_NUM);
+}
+BENCHMARK(BM_ScanPread);
+
+static void BM_ScanPreadv(benchmark::State &state)
+{
+  const int run_length = state.range(0);
+  int fd = ::open(SCAN_FILE_NAME, O_RDONLY);
+  std::vector<Page> pages(run_length);
+  std::vector<struct iovec> iov(run_length);
+  for (int i = 0; i < run_length; i++) {
+    iov[i].iov_base = &pages[i];
+    iov[i].iov_len = sizeof(Page);
+  }
+
+  long syscalls = 0;
+  for (auto _ : state) {
+    for (PageNum page_num = 0; page_num < SCAN_PAGE_NUM; page_num += run_length) {
+      const ssize_t size = (ssize_t)run_length * sizeof(Page);
+      if (preadv(fd, iov.data(), run_length, (off_t)page_num * sizeof(Page)) != size) {
+        state.SkipWithError("failed to read pages");
+        break;
+      }
+      syscalls += 1;
+    }
+  }
+  ::close(fd);
+  state.SetItemsProcessed(state.iterations() * SCAN_PAGE_NUM);
+  state.counters["syscalls/page"] = (double)syscalls / (state.iterations() * SCAN_PAGE_NUM);
+}
+BENCHMARK(BM_ScanPreadv)->Arg(4)->Arg(16)->Arg(64);
+
+/**
+ * 计算一个页面的校验和的开销，与上面每个页面的读取时间对比。
+ * range(0)为0时使用查表法，为1时使用crc32c(有SSE4.2时使用CPU指令)
+ */
+static void BM_PageChecksum(benchmark::State &state)
+{
+  if (state.range(0) == 1 && !common::crc32c_hardware_enabled()) {
+    state.SkipWithError("crc32c hardware is not supported");
+    return;
+  }
+
+  Page page;
+  memset(&page, 'a', sizeof(page));
+  for (auto _ : state) {
+    uint32_t checksum = state.range(0) == 0 ? common::crc32c_software(0, &page, sizeof(page))
+                                            : page_checksum(page);
+    benchmark::DoNotOptimize(checksum);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * sizeof(Page));
+}
+BENCHMARK(BM_PageChecksum)->Arg(0)->Arg(1);
+
+/**
+ * 通过PageIO批量读取，range(0)为0时使用sync，为1时使用io_uring，range(1)是一批请求的页面个数。
+ * 每批页面间隔一页，不能合并成一次向量IO，对比的是一批请求一次提交与逐个读取的差别
+ */
+static void BM_PageIOBatchRead(benchmark::State &state)
+{
+  std::unique_ptr<PageIO> page_io(PageIO::create(state.range(0) == 0 ? "sync" : "io_uring"));
+  const int batch_size = state.range(1);
+  int fd = ::open(SCAN_FILE_NAME, O_RDONLY);
+  std::vector<Page> pages(batch_size);
+  std::vector<PageIORequest> requests(batch_size);
+
+  for (auto _ : state) {
+    for (PageNum page_num = 0; page_num + batch_size * 2 <= SCAN_PAGE_NUM; page_num += batch_size * 2) {
+      for (int i = 0; i < batch_size; i++) {
+        requests[i].file_desc = fd;
+        requests[i].page_num = page_num + i * 2;
+        requests[i].page = &pages[i];
+      }
+      if (page_io->read_pages(requests.data(), batch_size) != RC::SUCCESS) {
+        state.SkipWithError("failed to read pages");
+        break;
+      }
+    }
+  }
+  ::close(fd);
+  state.SetLabel(page_io->name());
+  state.SetItemsProcessed(state.iterations() * (SCAN_PAGE_NUM / 2));
+}
+BENCHMARK(BM_PageIOBatchRead)->ArgsProduct({{0, 1}, {1, 16, 64}});
+
+static void BM_BufferPoolScan(benchmark::State &state)
+{
+  bp_manager->set_read_ahead_pages(state.range(0));
+  long syscalls = 0;
+  long pages = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    buffer_pool->purge_all_pages();
+    const long syscall_begin = read_syscall_count();
+    state.ResumeTiming();
+
+    BufferPoolIterator iterator;
+    iterator.init(*buffer_pool, 1);
+    while (iterator.has_next()) {
+      Frame *frame = nullptr;
+      if (buffer_pool->get_this_page(iterator.next(), &frame) != RC::SUCCESS) {
+        state.SkipWithError("failed to get page");
+        break;
+      }
+      buffer_pool->unpin_page(frame);
+      pages++;
+    }
+
+    state.PauseTiming();
+    syscalls += read_syscall_count() - syscall_begin;
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(pages);
+  state.counters["read_syscalls/page"] = pages > 0 ? (double)syscalls / pages : 0;
+}
+BENCHMARK(BM_BufferPoolScan)->Arg(0)->Arg(8)->Arg(32)->Arg(128);
+
+/**
+ * range(0)为1时开启双写，range(1)是一批写多少个页面。
+ * 不开启双写时也在每批之后调用一次fdatasync，与双写的落盘要求一致
+ */
+static void BM_FlushPages(benchmark::State &state)
+{
+  const char *file_name = "page_io_perf_flush.data";
+  const char *double_write_file = "page_io_perf_flush.dblwr";
+  const bool double_write = state.range(0) == 1;
+  const int batch_num = state.range(1);
+
+  int fd = ::open(file_name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+  std::unique_ptr<PageIO> page_io(PageIO::create("sync"));
+  DoubleWriteBuffer double_write_buffer;
+  if (double_write && double_write_buffer.open(double_write_file) != RC::SUCCESS) {
+    state.SkipWithError("failed to open double write file");
+    return;
+  }
+
+  const int page_num = 256;
+  std::vector<Page> pages(page_num);
+  for (int i = 0; i < page_num; i++) {
+    memset(&pages[i], 0, sizeof(Page));
+    pages[i].page_num = i;
+    stamp_page(pages[i]);
+  }
+
+  std::vector<PageIORequest> requests(batch_num);
+  long flushed = 0;
+  for (auto _ : state) {
+    for (int begin = 0; begin < page_num; begin += batch_num) {
+      const int num = std::min(batch_num, page_num - begin);
+      for (int i = 0; i < num; i++) {
+        requests[i].file_desc = fd;
+        requests[i].page_num = begin + i;
+        requests[i].page = &pages[begin + i];
+      }
+
+      RC rc = RC::SUCCESS;
+      if (double_write) {
+        rc = double_write_buffer.write_pages(*page_io, file_name, requests.data(), num);
+      } else {
+        rc = page_io->write_pages(requests.data(), num);
+        if (rc == RC::SUCCESS && fdatasync(fd) != 0) {
+          rc = RC::IOERR_FSYNC;
+        }
+      }
+      if (rc != RC::SUCCESS) {
+        state.SkipWithError("failed to flush pages");
+        break;
+      }
+      flushed += num;
+    }
+  }
+
+  // 双写时每批多写一个头页面，再加上每个页面写两次
+  const long written = double_write ? flushed * 2 + double_write_buffer.written_batches() : flushed;
+  state.SetItemsProcessed(flushed);
+  state.SetBytesProcessed(flushed * BP_PAGE_SIZE);
+  state.counters["write_amplification"] = flushed > 0 ? (double)written / flushed : 0;
+
+  ::close(fd);
+  ::remove(file_name);
+  ::remove(double_write_file);
+}
+BENCHMARK(BM_FlushPages)->ArgsProduct({{0, 1}, {1, 16, 63}});
+
+/**
+ * 文件有多少字节在page cache中
+ */
+static long page_cache_bytes(const char *file_name)
+{
+  int fd = ::open(file_name, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    return 0;
+  }
+
+  const long os_page_size = sysconf(_SC_PAGESIZE);
+  void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    return -1;
+  }
+  std::vector<unsigned char> resident((st.st_size + os_page_size - 1) / os_page_size);
+  long bytes = -1;
+  if (mincore(addr, st.st_size, resident.data()) == 0) {
+    bytes = 0;
+    for (unsigned char r : resident) {
+      bytes += (r & 1) ? os_page_size : 0;
+    }
+  }
+  munmap(addr, st.st_size);
+  return bytes;
+}
+
+/**
+ * range(0)为0时通过page cache读取，为1时使用O_DIRECT。
+ * range(1)为0时是全表扫描(带预读)，为1时是随机的单页查询。每轮开始前淘汰缓冲池中的所有页面，
+ * 测试的是缓冲池未命中时的读取：page cache中有数据时读取只是一次内存拷贝，O_DIRECT每次都要读盘，
+ * 但是不会在page cache中再缓存一份，延迟只取决于磁盘
+ */
+static void BM_DirectIO(benchmark::State &state)
+{
+  DiskBufferPool *bp = state.range(0) == 1 ? direct_buffer_pool : buffer_pool;
+  const bool scan = state.range(1) == 0;
+  const int lookup_num = 256;
+  if (state.range(0) == 1 && !bp->direct_io()) {
+    state.SkipWithError("direct io is not supported by the file system");
+    return;
+  }
+
+  std::mt19937 random(1);
+  std::uniform_int_distribution<PageNum> page_dist(1, SCAN_PAGE_NUM - 1);
+  long pages = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    bp->purge_all_pages();
+    state.ResumeTiming();
+
+    if (scan) {
+      BufferPoolIterator iterator;
+      iterator.init(*bp, 1);
+      while (iterator.has_next()) {
+        Frame *frame = nullptr;
+        if (bp->get_this_page(iterator.next(), &frame) != RC::SUCCESS) {
+          state.SkipWithError("failed to get page");
+          break;
+        }
+        bp->unpin_page(frame);
+        pages++;
+      }
+    } else {
+      for (int i = 0; i < lookup_num; i++) {
+        Frame *frame = nullptr;
+        if (bp->get_this_page(page_dist(random), &frame) != RC::SUCCESS) {
+          state.SkipWithError("failed to get page");
+          break;
+        }
+        bp->unpin_page(frame);
+        pages++;
+      }
+    }
+  }
+  state.SetItemsProcessed(pages);
+  state.SetLabel(scan ? "scan" : "point lookup");
+  state.counters["read_p99_us"] = bp->stats().read_latency.percentile_us(0.99);
+  state.counters["page_cache_mb"] = page_cache_bytes(bp->file_name().c_str()) / (1024.0 * 1024.0);
+}
+BENCHMARK(BM_DirectIO)->ArgsProduct({{0, 1}, {0, 1}})->UseRealTime();
+
+/**
+ * range(0)为0时扫描出来的页面复制到缓冲池中，为1时是只读扫描，直接访问文件映射。
+ * 每轮开始前淘汰缓冲池中的所有页面，模拟很少访问的冷表。数据都在page cache中，
+ * 测试的是每个页面复制一次的开销，以及扫描之后缓冲池中被占用的frame个数
+ */
+static void BM_MmapScan(benchmark::State &state)
+{
+  const bool readonly = state.range(0) == 1;
+  BPFrameManager &frame_manager = mmap_buffer_pool->frame_manager();
+  long records = 0;
+  long checksum = 0;
+  size_t used_frames = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    mmap_buffer_pool->purge_all_pages();
+    const size_t free_frames = frame_manager.free_frame_num();
+    state.ResumeTiming();
+
+    RecordFileScanner scanner;
+    if (scanner.open_scan(*mmap_buffer_pool, nullptr, readonly) != RC::SUCCESS) {
+      state.SkipWithError("failed to open scan");
+      break;
+    }
+    Record record;
+    while (scanner.has_next()) {
+      if (scanner.next(record) != RC::SUCCESS) {
+        state.SkipWithError("failed to scan record");
+        break;
+      }
+      checksum += *(const int *)record.data();
+      records++;
+    }
+    scanner.close_scan();
+
+    state.PauseTiming();
+    used_frames = free_frames - std::min(free_frames, frame_manager.free_frame_num());
+    state.ResumeTiming();
+  }
+  benchmark::DoNotOptimize(checksum);
+  state.SetItemsProcessed(records);
+  state.SetLabel(readonly ? "mmap" : "copy");
+  state.counters["frames_used"] = used_frames;
+  state.counters["mapped_reads"] = mmap_buffer_pool->stats().mapped_reads.load();
+}
+BENCHMARK(BM_MmapScan)->Arg(0)->Arg(1)->UseRealTime();
+
+/**
+ * range(0)为0时通过RecordFileScanner扫描整个数据文件，为1时通过BplusTreeScanner扫描索引中的一半键值。
+ * range(1)是每次批量获取的页面个数(预读的页面个数)，1表示逐个页面获取，每次未命中都是一次单独的读取。
+ * 每轮开始前淘汰所有页面，索引的内部节点也要重新读取
+ */
+static void BM_ColdRangeScan(benchmark::State &state)
+{
+  const bool index = state.range(0) == 1;
+  const char *file_name = index ? INDEX_FILE_NAME : MMAP_SCAN_FILE_NAME;
+  DiskBufferPool *bp = nullptr;
+  bp_manager->foreach_buffer_pool([&bp, file_name](DiskBufferPool &file_bp) {
+    if (file_bp.file_name() == file_name) {
+      bp = &file_bp;
+    }
+  });
+  bp_manager->set_read_ahead_pages(static_cast<int>(state.range(1)));
+
+  const int left_key = INDEX_KEY_NUM / 4;
+  const int right_key = INDEX_KEY_NUM / 4 * 3;
+  long records = 0;
+  long syscalls = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    bp->purge_all_pages();
+    const long syscall_begin = read_syscall_count();
+    state.ResumeTiming();
+
+    if (index) {
+      BplusTreeScanner scanner(*index_handler);
+      if (scanner.open((const char *)&left_key, sizeof(left_key), true,
+                       (const char *)&right_key, sizeof(right_key), true) != RC::SUCCESS) {
+        state.SkipWithError("failed to open index scan");
+        break;
+      }
+      RID rid;
+      while (scanner.next_entry(&rid) == RC::SUCCESS) {
+        records++;
+      }
+      scanner.close();
+    } else {
+      RecordFileScanner scanner;
+      if (scanner.open_scan(*bp, nullptr) != RC::SUCCESS) {
+        state.SkipWithError("failed to open scan");
+        break;
+      }
+      Record record;
+      while (scanner.has_next() && scanner.next(record) == RC::SUCCESS) {
+        records++;
+      }
+      scanner.close_scan();
+    }
+
+    state.PauseTiming();
+    syscalls += read_syscall_count() - syscall_begin;
+    state.ResumeTiming();
+  }
+  bp_manager->set_read_ahead_pages(BufferPoolManager::DEFAULT_READ_AHEAD_PAGES);
+  state.SetItemsProcessed(records);
+  state.SetLabel(index ? "index range" : "table scan");
+  state.counters["read_syscalls"] = state.iterations() > 0 ? (double)syscalls / state.iterations() : 0;
+  state.counters["read_p99_us"] = bp->stats().read_latency.percentile_us(0.99);
+}
+BENCHMARK(BM_ColdRangeScan)->ArgsProduct({{0, 1}, {1, 32}})->UseRealTime();
+
+static std::string page_size_file_name(int page_size)
+{
+  return "page_io_perf_" + std::to_string(page_size >> 10) + "k.data";
+}
+
+/**
+ * range(0)是页面大小(KB)，range(1)为0时是全表扫描，为1时是随机的单条记录查询。
+ * 三个文件中是同样的记录，每个页面大小的缓冲池都是PAGE_SIZE_POOL_BYTES，装不下整个表。
+ * 点查时每次未命中都要读一整个页面，页面越大读放大越严重；扫描时页面越大每个页面的固定开销越少
+ */
+static void BM_PageSize(benchmark::State &state)
+{
+  const int page_size = static_cast<int>(state.range(0)) << 10;
+  const bool scan = state.range(1) == 0;
+  const int lookup_num = 10000;
+  DiskBufferPool *bp = page_size_buffer_pools[page_size];
+  const std::vector<RID> &rids = page_size_rids[page_size];
+
+  RecordFileHandler record_handler;
+  if (record_handler.init(bp) != RC::SUCCESS) {
+    state.SkipWithError("failed to init record handler");
+    return;
+  }
+
+  std::mt19937 random(1);
+  std::uniform_int_distribution<size_t> rid_dist(0, rids.size() - 1);
+  const long misses = bp->stats().misses.load();
+  const long hits = bp->stats().hits.load();
+  const long prefetched = bp->stats().prefetched.load();
+  long records = 0;
+  long checksum = 0;
+  for (auto _ : state) {
+    if (scan) {
+      RecordFileScanner scanner;
+      if (scanner.open_scan(*bp, nullptr) != RC::SUCCESS) {
+        state.SkipWithError("failed to open scan");
+        break;
+      }
+      Record record;
+      while (scanner.has_next()) {
+        if (scanner.next(record) != RC::SUCCESS) {
+          state.SkipWithError("failed to scan record");
+          break;
+        }
+        checksum += *(const int *)record.data();
+        records++;
+      }
+      scanner.close_scan();
+    } else {
+      for (int i = 0; i < lookup_num; i++) {
+        Record record;
+        if (record_handler.get_record(&rids[rid_dist(random)], &record) != RC::SUCCESS) {
+          state.SkipWithError("failed to get record");
+          break;
+        }
+        checksum += *(const int *)record.data();
+        records++;
+      }
+    }
+  }
+  record_handler.close();
+
+  benchmark::DoNotOptimize(checksum);
+  const long miss_num = bp->stats().misses.load() - misses;
+  const long hit_num = bp->stats().hits.load() - hits;
+  const long read_pages = miss_num + bp->stats().prefetched.load() - prefetched;
+  state.SetItemsProcessed(records);
+  state.SetLabel(scan ? "scan" : "point lookup");
+  state.counters["hit_rate"] = hit_num + miss_num > 0 ? hit_num * 1.0 / (hit_num + miss_num) : 0.0;
+  state.counters["read_kb_per_record"] =
+      records > 0 ? (double)read_pages * page_size / 1024.0 / records : 0.0;
+}
+BENCHMARK(BM_PageSize)->ArgsProduct({{4, 16, 64}, {0, 1}})->UseRealTime();
+
+static int prepare_file(DiskBufferPool *bp)
+{
+  // 第0页是文件头
+  for (int i = 1; i < SCAN_PAGE_NUM; i++) {
+    Frame *frame = nullptr;
+    if (bp->allocate_page(&frame) != RC::SUCCESS) {
+      return -1;
+    }
+    memset(frame->data(), i, BP_PAGE_DATA_SIZE);
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  return bp->flush_all_pages() == RC::SUCCESS ? 0 : -1;
+}
+
+static int prepare()
+{
+  ::remove(SCAN_FILE_NAME);
+  bp_manager = new BufferPoolManager();
+  if (bp_manager->create_file(SCAN_FILE_NAME) != RC::SUCCESS ||
+      bp_manager->open_file(SCAN_FILE_NAME, buffer_pool) != RC::SUCCESS || prepare_file(buffer_pool) != 0) {
+    return -1;
+  }
+
+  ::remove(DIRECT_IO_FILE_NAME);
+  ::mkdir(DIRECT_IO_DIR, 0755);
+  bp_manager->set_direct_io_dir(DIRECT_IO_DIR, true);
+  if (bp_manager->create_file(DIRECT_IO_FILE_NAME) != RC::SUCCESS ||
+      bp_manager->open_file(DIRECT_IO_FILE_NAME, direct_buffer_pool) != RC::SUCCESS ||
+      prepare_file(direct_buffer_pool) != 0) {
+    return -1;
+  }
+
+  ::remove(MMAP_SCAN_FILE_NAME);
+  ::mkdir(MMAP_SCAN_DIR, 0755);
+  bp_manager->set_mmap_scan_dir(MMAP_SCAN_DIR, true);
+  if (bp_manager->create_file(MMAP_SCAN_FILE_NAME) != RC::SUCCESS ||
+      bp_manager->open_file(MMAP_SCAN_FILE_NAME, mmap_buffer_pool) != RC::SUCCESS || !mmap_buffer_pool->mmap_scan()) {
+    return -1;
+  }
+  RecordFileHandler record_handler;
+  if (record_handler.init(mmap_buffer_pool) != RC::SUCCESS) {
+    return -1;
+  }
+  char record_data[64];
+  memset(record_data, 0, sizeof(record_data));
+  for (int i = 0; i < MMAP_SCAN_RECORD_NUM; i++) {
+    memcpy(record_data, &i, sizeof(i));
+    RID rid;
+    if (record_handler.insert_record(record_data, sizeof(record_data), &rid) != RC::SUCCESS) {
+      return -1;
+    }
+  }
+  record_handler.close();
+  if (mmap_buffer_pool->flush_all_pages() != RC::SUCCESS) {
+    return -1;
+  }
+
+  // BplusTreeHandler通过BufferPoolManager::instance()打开文件
+  ::remove(INDEX_FILE_NAME);
+  BufferPoolManager::set_instance(bp_manager);
+  index_handler = new BplusTreeHandler();
+  if (index_handler->create(INDEX_FILE_NAME, INTS, sizeof(int), false) != RC::SUCCESS) {
+    return -1;
+  }
+  for (int i = 0; i < INDEX_KEY_NUM; i++) {
+    RID rid(i / 100 + 1, i % 100);
+    // insert_entry接管key的内存，和BplusTreeIndex一样传入malloc出来的"键值+RID"
+    char *key = (char *)malloc(sizeof(i) + sizeof(rid));
+    memcpy(key, &i, sizeof(i));
+    memcpy(key + sizeof(i), &rid, sizeof(rid));
+    if (index_handler->insert_entry(key, &rid) != RC::SUCCESS) {
+      return -1;
+    }
+  }
+  if (index_handler->sync() != RC::SUCCESS) {
+    return -1;
+  }
+
+  // 每种页面大小一个文件，默认页面大小的文件也使用同样大小的缓冲池
+  page_size_bp_manager = new BufferPoolManager();
+  if (page_size_bp_manager->resize(PAGE_SIZE_POOL_BYTES) != RC::SUCCESS) {
+    return -1;
+  }
+  for (int page_size : PAGE_SIZES) {
+    const std::string file_name = page_size_file_name(page_size);
+    ::remove(file_name.c_str());
+    DiskBufferPool *bp = nullptr;
+    if (page_size_bp_manager->create_file(file_name.c_str(), page_size) != RC::SUCCESS ||
+        page_size_bp_manager->open_file(file_name.c_str(), bp) != RC::SUCCESS) {
+      return -1;
+    }
+    page_size_buffer_pools[page_size] = bp;
+
+    RecordFileHandler page_size_record_handler;
+    if (page_size_record_handler.init(bp) != RC::SUCCESS) {
+      return -1;
+    }
+    std::vector<RID> &rids = page_size_rids[page_size];
+    rids.resize(PAGE_SIZE_RECORD_NUM);
+    for (int i = 0; i < PAGE_SIZE_RECORD_NUM; i++) {
+      memcpy(record_data, &i, sizeof(i));
+      if (page_size_record_handler.insert_record(record_data, sizeof(record_data), &rids[i]) != RC::SUCCESS) {
+        return -1;
+      }
+    }
+    page_size_record_handler.close();
+    if (bp->flush_all_pages() != RC::SUCCESS) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static void cleanup()
+{
+  if (buffer_pool != nullptr) {
+    bp_manager->close_file(SCAN_FILE_NAME);
+    buffer_pool = nullptr;
+  }
+  if (direct_buffer_pool != nullptr) {
+    bp_manager->close_file(DIRECT_IO_FILE_NAME);
+    direct_buffer_pool = nullptr;
+  }
+  if (mmap_buffer_pool != nullptr) {
+    bp_manager->close_file(MMAP_SCAN_FILE_NAME);
+    mmap_buffer_pool = nullptr;
+  }
+  if (index_handler != nullptr) {
+    index_handler->close();
+    delete index_handler;
+    index_handler = nullptr;
+  }
+  BufferPoolManager::set_instance(nullptr);
+  delete bp_manager;
+  bp_manager = nullptr;
+  ::remove(INDEX_FILE_NAME);
+  for (auto &iter : page_size_buffer_pools) {
+    page_size_bp_manager->close_file(page_size_file_name(iter.first).c_str());
+    ::remove(page_size_file_name(iter.first).c_str());
+  }
+  page_size_buffer_pools.clear();
+  delete page_size_bp_manager;
+  page_size_bp_manager = nullptr;
+  ::remove(SCAN_FILE_NAME);
+  ::remove(DIRECT_IO_FILE_NAME);
+  ::rmdir(DIRECT_IO_DIR);
+  ::remove(MMAP_SCAN_FILE_NAME);
+  ::rmdir(MMAP_SCAN_DIR);
+}
+
+int main(int argc, char **argv)
+{
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  if (prepare() != 0) {
+    fprintf(stderr, "failed to prepare data for benchmark\n");
+    cleanup();
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  cleanup();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,163 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/record/record_manager.h"
+
+/**
+ * 定长格式和变长(slotted)格式的对比。
+ * 表结构是 id int, name char(200), value int，name的实际长度在0~40之间随机，
+ * 两种格式分别插入同样的记录：
+ * - RecordFormatScan: 每轮淘汰所有页面后全表扫描，统计数据文件的页面个数和扫描吞吐
+ * - RecordFormatUpdate: 把随机一条记录的name改成随机长度，变长格式中可能需要整理页面或者转发到别的页面
+ */
+
+static const int RECORD_NUM = 200000;
+static const int NAME_LEN = 200;
+static const int RECORD_SIZE = 4 + NAME_LEN + 4;
+static const int MAX_NAME_SIZE = 40;
+static const char *FILE_NAMES[] = {"record_format_perf_fixed.data", "record_format_perf_slotted.data"};
+
+static BufferPoolManager *bp_manager = nullptr;
+static DiskBufferPool *buffer_pools[2] = {nullptr, nullptr};
+static RecordFileHandler *record_handlers[2] = {nullptr, nullptr};
+static RecordLayout layout(RECORD_SIZE, {{4, NAME_LEN}});
+static std::vector<RID> rids[2];
+
+static void make_record(int id, int name_size, char *data)
+{
+  memset(data, 0, RECORD_SIZE);
+  memcpy(data, &id, sizeof(id));
+  memset(data + 4, 'a' + id % 26, name_size);
+  memcpy(data + 4 + NAME_LEN, &id, sizeof(id));
+}
+
+/**
+ * 参数为0表示定长格式，1表示变长格式
+ */
+static void BM_RecordFormatScan(benchmark::State &state)
+{
+  const int format = state.range(0);
+  DiskBufferPool *bp = buffer_pools[format];
+  long records = 0;
+  long checksum = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    bp->flush_all_pages();
+    bp->purge_all_pages();
+    state.ResumeTiming();
+
+    RecordFileScanner scanner;
+    if (scanner.open_scan(*bp, nullptr, true, record_handlers[format]->layout()) != RC::SUCCESS) {
+      state.SkipWithError("failed to open scan");
+      break;
+    }
+    Record record;
+    while (scanner.has_next()) {
+      if (scanner.next(record) != RC::SUCCESS) {
+        state.SkipWithError("failed to scan record");
+        break;
+      }
+      checksum += record.data()[4];
+      records++;
+    }
+    scanner.close_scan();
+  }
+  benchmark::DoNotOptimize(checksum);
+
+  int page_count = 0;
+  bp->get_page_count(&page_count);
+  state.SetLabel(format == 0 ? "fixed" : "slotted");
+  state.SetItemsProcessed(records);
+  state.counters["pages"] = page_count;
+  state.counters["file_mb"] = (double)page_count * bp->page_size() / 1024 / 1024;
+}
+BENCHMARK(BM_RecordFormatScan)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_RecordFormatUpdate(benchmark::State &state)
+{
+  const int format = state.range(0);
+  RecordFileHandler *record_handler = record_handlers[format];
+  std::mt19937 random(format);
+  std::uniform_int_distribution<int> record_dist(0, RECORD_NUM - 1);
+  std::uniform_int_distribution<int> size_dist(0, MAX_NAME_SIZE);
+  char data[RECORD_SIZE];
+  for (auto _ : state) {
+    const int id = record_dist(random);
+    make_record(id, size_dist(random), data);
+    Record record;
+    record.set_rid(rids[format][id]);
+    record.set_data(data);
+    if (record_handler->update_record(&record) != RC::SUCCESS) {
+      state.SkipWithError("failed to update record");
+      break;
+    }
+  }
+
+  int page_count = 0;
+  buffer_pools[format]->get_page_count(&page_count);
+  state.SetLabel(format == 0 ? "fixed" : "slotted");
+  state.SetItemsProcessed(state.iterations());
+  state.counters["pages"] = page_count;
+}
+BENCHMARK(BM_RecordFormatUpdate)->Arg(0)->Arg(1);
+
+int main(int argc, char **argv)
+{
+  bp_manager = new BufferPoolManager();
+  std::mt19937 random(0);
+  std::uniform_int_distribution<int> size_dist(0, MAX_NAME_SIZE);
+  char data[RECORD_SIZE];
+  for (int format = 0; format < 2; format++) {
+    ::remove(FILE_NAMES[format]);
+    if (bp_manager->create_file(FILE_NAMES[format]) != RC::SUCCESS ||
+        bp_manager->open_file(FILE_NAMES[format], buffer_pools[format]) != RC::SUCCESS) {
+      return -1;
+    }
+    record_handlers[format] = new RecordFileHandler();
+    if (record_handlers[format]->init(buffer_pools[format], format == 0 ? nullptr : &layout) != RC::SUCCESS) {
+      return -1;
+    }
+
+    random.seed(0);
+    for (int i = 0; i < RECORD_NUM; i++) {
+      make_record(i, size_dist(random), data);
+      RID rid;
+      if (record_handlers[format]->insert_record(data, RECORD_SIZE, &rid) != RC::SUCCESS) {
+        return -1;
+      }
+      rids[format].push_back(rid);
+    }
+    buffer_pools[format]->flush_all_pages();
+  }
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  for (int format = 0; format < 2; format++) {
+    record_handlers[format]->close();
+    delete record_handlers[format];
+    bp_manager->close_file(FILE_NAMES[format]);
+    ::remove(FILE_NAMES[format]);
+  }
+  return 0;
+}
@@ -0,0 +1,129 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "storage/clog/clog.h"
+#include "storage/record/record.h"
+
+/**
+ * 启动时回放日志的耗时。
+ * 预先生成一个很大的日志文件(每个事务一条插入记录)，检查点分别位于日志的开头(没有检查点)、
+ * 中间和90%的位置，测试CLogManager::recover读取并解析日志的耗时以及读出来的日志记录个数。
+ * 不包含把记录重做到数据页面的耗时
+ */
+
+static const int TRX_NUM = 100000;
+static const int RECORD_SIZE = 100;
+static const int CHECKPOINT_PERCENTS[] = {0, 50, 90};
+
+static std::string log_dir(int checkpoint_percent)
+{
+  return "recovery_perf_" + std::to_string(checkpoint_percent);
+}
+
+static void remove_log_dir(const std::string &dir)
+{
+  std::string clog_file = dir + "/clog";
+  unlink(clog_file.c_str());
+  rmdir(dir.c_str());
+}
+
+static void build_log(int checkpoint_percent)
+{
+  const std::string dir = log_dir(checkpoint_percent);
+  remove_log_dir(dir);
+  mkdir(dir.c_str(), 0755);
+
+  CLogManager log_mgr(dir.c_str());
+  log_mgr.recover();
+
+  char data[RECORD_SIZE];
+  memset(data, 0x5A, sizeof(data));
+  const int checkpoint_trx = TRX_NUM / 100 * checkpoint_percent;
+  int64_t checkpoint_lsn = 0;
+  for (int32_t trx_id = 1; trx_id <= TRX_NUM; trx_id++) {
+    if (trx_id == checkpoint_trx) {
+      checkpoint_lsn = CLogManager::next_lsn();
+    }
+    CLogRecord *log_rec = nullptr;
+    log_mgr.clog_gen_record(REDO_MTR_BEGIN, trx_id, log_rec);
+    log_mgr.clog_append_record(log_rec);
+
+    Record record;
+    record.set_rid(trx_id / 100 + 1, trx_id % 100);
+    record.set_data(data);
+    log_mgr.clog_gen_record(REDO_INSERT, trx_id, log_rec, "table1", RECORD_SIZE, &record);
+    log_mgr.clog_append_record(log_rec);
+
+    log_mgr.clog_gen_record(REDO_MTR_COMMIT, trx_id, log_rec);
+    log_mgr.clog_append_record(log_rec);
+  }
+
+  if (checkpoint_percent > 0) {
+    log_mgr.checkpoint(checkpoint_lsn);
+  } else {
+    log_mgr.clog_sync();
+  }
+}
+
+/**
+ * 参数是检查点在日志中的位置(百分比)，0表示没有检查点，从头回放
+ */
+static void BM_Recover(benchmark::State &state)
+{
+  const std::string dir = log_dir(state.range(0));
+  int read_records = 0;
+  for (auto _ : state) {
+    CLogManager log_mgr(dir.c_str());
+    log_mgr.recover();
+    read_records = log_mgr.recovered_records();
+
+    state.PauseTiming();
+    CLogMTRManager *mtr_mgr = log_mgr.get_mtr_manager();
+    for (CLogRecord *log_rec : mtr_mgr->log_redo_list) {
+      delete log_rec;
+    }
+    mtr_mgr->log_redo_list.clear();
+    state.ResumeTiming();
+  }
+
+  struct stat st;
+  stat((dir + "/clog").c_str(), &st);
+  state.counters["log_mb"] = st.st_size / 1024.0 / 1024.0;
+  state.counters["read_records"] = read_records;
+}
+BENCHMARK(BM_Recover)->Arg(0)->Arg(50)->Arg(90)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char **argv)
+{
+  for (int checkpoint_percent : CHECKPOINT_PERCENTS) {
+    build_log(checkpoint_percent);
+  }
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  for (int checkpoint_percent : CHECKPOINT_PERCENTS) {
+    remove_log_dir(log_dir(checkpoint_percent));
+  }
+  return 0;
+}
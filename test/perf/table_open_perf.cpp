@@ -0,0 +1,145 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by wangyunlai.wyl on 2022
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include <benchmark/benchmark.h>
+
+#include "storage/default/disk_buffer_pool.h"
+#include "storage/record/record_manager.h"
+
+/**
+ * 打开表(RecordFileHandler::init)的耗时。
+ * 预先插入1M或者10M条32字节的记录，每轮关闭文件(淘汰缓冲池中的页面)之后重新打开：
+ * - scan: 没有空闲空间表文件，遍历数据文件的所有页面重建(以前的做法)
+ * - fsm: 从空闲空间表文件中读取根页面，不访问数据页面
+ * 数据文件在操作系统的page cache中，实际从磁盘读取时scan会更慢
+ */
+
+static const int RECORD_SIZE = 32;
+static const char *DATA_FILE = "table_open_perf.data";
+static const char *FSM_FILE = "table_open_perf.fsm";
+
+static BufferPoolManager *bp_manager = nullptr;
+static int prepared_rows = 0;
+
+/**
+ * 关闭文件时会刷盘并淘汰缓冲池中的页面，下次打开时从文件中读取
+ */
+static void close_files(bool close_fsm)
+{
+  bp_manager->close_file(DATA_FILE);
+  if (close_fsm) {
+    bp_manager->close_file(FSM_FILE);
+  }
+}
+
+static RC prepare_files(int rows)
+{
+  if (prepared_rows == rows) {
+    return RC::SUCCESS;
+  }
+  ::remove(DATA_FILE);
+  ::remove(FSM_FILE);
+  prepared_rows = 0;
+
+  DiskBufferPool *bp = nullptr;
+  DiskBufferPool *fsm_bp = nullptr;
+  RC rc = RC::SUCCESS;
+  if ((rc = bp_manager->create_file(DATA_FILE)) != RC::SUCCESS ||
+      (rc = bp_manager->create_file(FSM_FILE)) != RC::SUCCESS ||
+      (rc = bp_manager->open_file(DATA_FILE, bp)) != RC::SUCCESS ||
+      (rc = bp_manager->open_file(FSM_FILE, fsm_bp)) != RC::SUCCESS) {
+    return rc;
+  }
+
+  RecordFileHandler record_handler;
+  if ((rc = record_handler.init(bp, nullptr, fsm_bp)) != RC::SUCCESS) {
+    return rc;
+  }
+  char data[RECORD_SIZE];
+  memset(data, 0, sizeof(data));
+  for (int i = 0; i < rows && rc == RC::SUCCESS; i++) {
+    memcpy(data, &i, sizeof(i));
+    RID rid;
+    rc = record_handler.insert_record(data, RECORD_SIZE, &rid);
+  }
+  record_handler.close();
+  close_files(fsm_bp != nullptr);
+  if (rc == RC::SUCCESS) {
+    prepared_rows = rows;
+  }
+  return rc;
+}
+
+/**
+ * 第一个参数是记录条数，第二个参数为0表示遍历数据文件重建，1表示使用空闲空间表文件
+ */
+static void BM_TableOpen(benchmark::State &state)
+{
+  const int rows = state.range(0);
+  const bool use_fsm = state.range(1) == 1;
+  if (prepare_files(rows) != RC::SUCCESS) {
+    state.SkipWithError("failed to prepare data file");
+    return;
+  }
+
+  int page_count = 0;
+  for (auto _ : state) {
+    DiskBufferPool *bp = nullptr;
+    DiskBufferPool *fsm_bp = nullptr;
+    if (bp_manager->open_file(DATA_FILE, bp) != RC::SUCCESS ||
+        (use_fsm && bp_manager->open_file(FSM_FILE, fsm_bp) != RC::SUCCESS)) {
+      state.SkipWithError("failed to open file");
+      break;
+    }
+
+    RecordFileHandler record_handler;
+    if (record_handler.init(bp, nullptr, fsm_bp) != RC::SUCCESS) {
+      state.SkipWithError("failed to init record handler");
+      break;
+    }
+
+    state.PauseTiming();
+    bp->get_page_count(&page_count);
+    record_handler.close();
+    close_files(fsm_bp != nullptr);
+    state.ResumeTiming();
+  }
+
+  state.SetLabel(use_fsm ? "fsm" : "scan");
+  state.counters["rows"] = rows;
+  state.counters["data_pages"] = page_count;
+}
+BENCHMARK(BM_TableOpen)
+    ->Args({1000000, 0})
+    ->Args({1000000, 1})
+    ->Args({10000000, 0})
+    ->Args({10000000, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+int main(int argc, char **argv)
+{
+  bp_manager = new BufferPoolManager();
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  ::remove(DATA_FILE);
+  ::remove(FSM_FILE);
+  return 0;
+}
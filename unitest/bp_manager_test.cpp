@@ -12,7 +12,21 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai.wyl on 2021
 //
 
+#include <fcntl.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "storage/default/disk_buffer_pool.h"
+#include "storage/default/page_cleaner.h"
+#include "storage/default/page_io.h"
+#include "storage/default/double_write_buffer.h"
+#include "storage/default/buffer_pool_warmer.h"
 #include "gtest/gtest.h"
 
 void test_get(BPFrameManager &frame_manager)
@@ -111,7 +125,7 @@ void test_alloc(BPFrameManager &frame_manager)
 TEST(test_frame_manager, test_frame_manager_simple_lru)
 {
   BPFrameManager frame_manager("Test");
-  frame_manager.init(2);
+  frame_manager.init(256);
 
   test_get(frame_manager);
 
@@ -120,6 +134,1428 @@ TEST(test_frame_manager, test_frame_manager_simple_lru)
   frame_manager.cleanup();
 }
 
+TEST(test_frame_manager, test_frame_manager_replace_policy)
+{
+  const char *policies[] = {"lru", "clock", "2q"};
+  for (const char *policy : policies) {
+    BPFrameManager frame_manager("Test");
+    ASSERT_EQ(RC::SUCCESS, frame_manager.init(256, BPFrameManager::DEFAULT_PARTITION_NUM, policy));
+
+    test_get(frame_manager);
+
+    test_alloc(frame_manager);
+  }
+}
+
+TEST(test_frame_manager, test_concurrent_pin_and_evict)
+{
+  // 页面比frame多，多个线程同时访问，不停地淘汰和加载。
+  // pin住的frame一定是要访问的页面，最后所有的frame都没有被pin住
+  const char *policies[] = {"clock", "lru"};
+  for (const char *policy : policies) {
+    BPFrameManager frame_manager("Test");
+    ASSERT_EQ(RC::SUCCESS, frame_manager.init(16, 4, policy));
+
+    const int file_desc = 0;
+    const int page_num = 64;
+    const int thread_num = 8;
+    std::atomic<int> error_num{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; t++) {
+      threads.emplace_back([&, t]() {
+        unsigned int seed = t + 1;
+        for (int i = 0; i < 20000; i++) {
+          seed = seed * 1103515245 + 12345;
+          const PageNum page = (seed >> 16) % page_num;
+          Frame *frame = frame_manager.pin(file_desc, page);
+          if (frame == nullptr) {
+            frame = frame_manager.alloc(file_desc, page);
+            if (frame == nullptr) {
+              if (frame_manager.get(file_desc, page) != nullptr) {
+                continue;  // 其它线程正在加载
+              }
+              Frame *victim = frame_manager.begin_purge();
+              if (victim != nullptr &&
+                  frame_manager.free(victim->file_desc(), victim->page_num(), victim) != RC::SUCCESS) {
+                frame_manager.unpin_frame(victim);
+              }
+              continue;
+            }
+            frame_manager.finish_load(frame);
+          }
+
+          if (frame->file_desc() != file_desc || frame->page_num() != page) {
+            error_num++;
+          }
+          frame_manager.unpin_frame(frame);
+        }
+      });
+    }
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    ASSERT_EQ(0, error_num.load());
+    ASSERT_LE(frame_manager.frame_num(), 16U);
+    for (Frame *frame : frame_manager.find_list(file_desc)) {
+      ASSERT_EQ(0U, frame->pin_count());
+      ASSERT_EQ(frame, frame_manager.get(file_desc, frame->page_num()));
+    }
+    frame_manager.cleanup();
+  }
+}
+
+TEST(test_frame_allocator, test_frame_allocator_resize)
+{
+  FrameAllocator::Options options;
+  options.max_frame_num = 64;
+  FrameAllocator allocator;
+  ASSERT_EQ(RC::SUCCESS, allocator.init(16, options));
+  ASSERT_EQ(16, allocator.capacity());
+  ASSERT_EQ(64, allocator.max_capacity());
+
+  std::vector<Frame *> frames;
+  for (Frame *frame = allocator.alloc(); frame != nullptr; frame = allocator.alloc()) {
+    ASSERT_EQ(0, reinterpret_cast<size_t>(frame) % 64);
+    frames.push_back(frame);
+  }
+  ASSERT_EQ(16, frames.size());
+  ASSERT_EQ(16, allocator.used_num());
+
+  // 扩容之后可以继续分配
+  ASSERT_EQ(RC::SUCCESS, allocator.resize(32));
+  for (int i = 0; i < 16; i++) {
+    Frame *frame = allocator.alloc();
+    ASSERT_NE(frame, nullptr);
+    frames.push_back(frame);
+  }
+  ASSERT_EQ(nullptr, allocator.alloc());
+  ASSERT_NE(RC::SUCCESS, allocator.resize(65));
+
+  // 缩容之后，超出容量的frame释放之后不能再分配出来
+  ASSERT_EQ(RC::SUCCESS, allocator.resize(8));
+  int beyond_num = 0;
+  for (Frame *frame : frames) {
+    if (allocator.beyond_capacity(frame)) {
+      beyond_num++;
+    }
+    allocator.free(frame);
+  }
+  ASSERT_EQ(24, beyond_num);
+  ASSERT_EQ(0, allocator.used_num());
+
+  frames.clear();
+  for (Frame *frame = allocator.alloc(); frame != nullptr; frame = allocator.alloc()) {
+    frames.push_back(frame);
+  }
+  ASSERT_EQ(8, frames.size());
+  for (Frame *frame : frames) {
+    allocator.free(frame);
+  }
+}
+
+TEST(test_frame_allocator, test_frame_allocator_numa)
+{
+  // 单节点的机器上也可以测试，只是内存没有真正绑定到节点上
+  FrameAllocator::Options options;
+  options.numa_node_num = 2;
+  FrameAllocator allocator;
+  ASSERT_EQ(RC::SUCCESS, allocator.init(1024, options));
+  ASSERT_EQ(2, allocator.node_num());
+
+  Frame *frame0 = allocator.alloc(0);
+  Frame *frame1 = allocator.alloc(1);
+  ASSERT_EQ(0, allocator.node_of(frame0));
+  ASSERT_EQ(1, allocator.node_of(frame1));
+  allocator.free(frame0);
+  allocator.free(frame1);
+
+  // 节点1上的frame用完之后，从节点0上分配
+  std::vector<Frame *> frames;
+  int node_nums[2] = {0, 0};
+  bool fallback = false;
+  for (Frame *frame = allocator.alloc(1); frame != nullptr; frame = allocator.alloc(1)) {
+    const int node = allocator.node_of(frame);
+    if (node == 0) {
+      fallback = true;
+    } else {
+      ASSERT_FALSE(fallback);
+    }
+    node_nums[node]++;
+    frames.push_back(frame);
+  }
+  ASSERT_EQ(1024, frames.size());
+  ASSERT_GT(node_nums[0], 0);
+  ASSERT_GT(node_nums[1], 0);
+
+  for (Frame *frame : frames) {
+    allocator.free(frame);
+  }
+  ASSERT_EQ(0, allocator.used_num());
+}
+
+TEST(test_frame_replacer, test_clock_second_chance)
+{
+  const int frame_num = 4;
+  std::unique_ptr<Frame[]> frames(new Frame[frame_num]);
+  std::unique_ptr<FrameReplacer> replacer(FrameReplacer::create("clock"));
+  ASSERT_NE(replacer, nullptr);
+
+  for (int i = 0; i < frame_num; i++) {
+    replacer->insert(&frames[i]);
+  }
+
+  // 所有页面的访问位都是1，转一圈清零之后淘汰最早加入的页面
+  ASSERT_EQ(&frames[0], replacer->victim());
+  replacer->remove(&frames[0]);
+
+  // 再次访问的页面有第二次机会
+  replacer->touch(&frames[1]);
+  ASSERT_EQ(&frames[2], replacer->victim());
+  replacer->remove(&frames[2]);
+
+  ASSERT_EQ(&frames[3], replacer->victim());
+}
+
+TEST(test_frame_replacer, test_2q_scan_resistance)
+{
+  const int hot_num = 8;
+  const int scan_num = 64;
+  std::unique_ptr<Frame[]> hot_frames(new Frame[hot_num]);
+  std::unique_ptr<Frame[]> scan_frames(new Frame[scan_num]);
+  std::unique_ptr<FrameReplacer> replacer(FrameReplacer::create("2q"));
+  ASSERT_NE(replacer, nullptr);
+
+  // 热点页面(比如索引页面)被访问多次
+  for (int i = 0; i < hot_num; i++) {
+    replacer->insert(&hot_frames[i]);
+    replacer->touch(&hot_frames[i]);
+  }
+
+  // 全表扫描的页面只访问一次，淘汰的应该总是扫描的页面
+  for (int i = 0; i < scan_num; i++) {
+    replacer->insert(&scan_frames[i]);
+    if (i >= hot_num) {
+      Frame *victim = replacer->victim();
+      ASSERT_NE(victim, nullptr);
+      ASSERT_TRUE(victim >= &scan_frames[0] && victim < &scan_frames[scan_num]);
+      replacer->remove(victim);
+    }
+  }
+
+  // pin住的页面不能被淘汰
+  std::unique_ptr<FrameReplacer> lru(FrameReplacer::create("lru"));
+  lru->insert(&hot_frames[0]);
+  ASSERT_EQ(&hot_frames[0], lru->victim());
+  ASSERT_EQ(nullptr, FrameReplacer::create("unknown"));
+}
+
+TEST(test_page_cleaner, test_flush_dirty_frames)
+{
+  const char *file_name = "page_cleaner_test.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  const int page_num = 100;
+  std::vector<Frame *> frames;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    memset(frame->data(), 'a' + i % 26, 16);
+    frame->mark_dirty();
+    frames.push_back(frame);
+  }
+
+  // 被pin住的页面不会被刷盘
+  for (int i = 0; i < page_num / 2; i++) {
+    bp->unpin_page(frames[i]);
+  }
+
+  BPFrameManager &frame_manager = bpm.frame_manager();
+  int flushed_num = 0;
+  for (int i = 0; i < frame_manager.partition_num(); i++) {
+    flushed_num += bpm.flush_dirty_frames(frame_manager, i, page_num);
+  }
+  ASSERT_EQ(page_num / 2, flushed_num);
+
+  int fd = ::open(file_name, O_RDONLY);
+  ASSERT_GE(fd, 0);
+  for (int i = 0; i < page_num; i++) {
+    ASSERT_EQ(i >= page_num / 2, frames[i]->dirty());
+    if (i < page_num / 2) {
+      Page page;
+      ASSERT_EQ((ssize_t)sizeof(Page), ::pread(fd, &page, sizeof(Page), (off_t)frames[i]->page_num() * sizeof(Page)));
+      ASSERT_EQ(0, memcmp(page.data, frames[i]->data(), 16));
+    }
+  }
+  ::close(fd);
+
+  for (int i = page_num / 2; i < page_num; i++) {
+    bp->unpin_page(frames[i]);
+  }
+
+  // 缓冲池几乎是空的，没有落后于目标，不需要刷盘。前台发生淘汰等待时会刷一批
+  PageCleaner::Options options;
+  PageCleaner cleaner(bpm, options);
+  ASSERT_EQ(0, cleaner.clean_round(0, false));
+  flushed_num = cleaner.clean_round(0, true);
+  ASSERT_EQ(page_num / 2, flushed_num);
+  for (Frame *frame : frames) {
+    ASSERT_FALSE(frame->dirty());
+  }
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+}
+
+void test_page_io(PageIO &page_io)
+{
+  const char *file_name = "page_io_test.data";
+  ::remove(file_name);
+  int fd = ::open(file_name, O_RDWR | O_CREAT, 0644);
+  ASSERT_GE(fd, 0);
+
+  // 两段不连续的页面，并且顺序是乱的
+  const PageNum page_nums[] = {3, 4, 5, 9, 10, 0};
+  const int num = sizeof(page_nums) / sizeof(page_nums[0]);
+  std::vector<Page> pages(num);
+  std::vector<PageIORequest> requests(num);
+  for (int i = 0; i < num; i++) {
+    memset(&pages[i], 'a' + page_nums[i], sizeof(Page));
+    pages[i].page_num = page_nums[i];
+    requests[i].file_desc = fd;
+    requests[i].page_num = page_nums[i];
+    requests[i].page = &pages[i];
+  }
+  ASSERT_EQ(RC::SUCCESS, page_io.write_pages(requests.data(), num));
+
+  std::vector<Page> read_pages(num);
+  for (int i = 0; i < num; i++) {
+    requests[i].page = &read_pages[num - 1 - i];
+  }
+  ASSERT_EQ(RC::SUCCESS, page_io.read_pages(requests.data(), num));
+  for (int i = 0; i < num; i++) {
+    ASSERT_EQ(0, memcmp(&pages[i], &read_pages[num - 1 - i], sizeof(Page)));
+    ASSERT_EQ(RC::SUCCESS, requests[i].rc);
+  }
+
+  // 超出文件末尾的页面读取失败，不影响其它页面
+  Page page;
+  PageIORequest bad_requests[2];
+  bad_requests[0].file_desc = fd;
+  bad_requests[0].page_num = 4;
+  bad_requests[0].page = &page;
+  bad_requests[1].file_desc = fd;
+  bad_requests[1].page_num = 100;
+  bad_requests[1].page = &read_pages[0];
+  ASSERT_NE(RC::SUCCESS, page_io.read_pages(bad_requests, 2));
+  ASSERT_EQ(RC::SUCCESS, bad_requests[0].rc);
+  ASSERT_NE(RC::SUCCESS, bad_requests[1].rc);
+  ASSERT_EQ(0, memcmp(&page, &pages[1], sizeof(Page)));
+
+  ::close(fd);
+  ::remove(file_name);
+}
+
+TEST(test_page_io, test_page_io)
+{
+  std::unique_ptr<PageIO> sync_io(PageIO::create("sync"));
+  ASSERT_STREQ("sync", sync_io->name());
+  test_page_io(*sync_io);
+
+  // 不支持io_uring的环境中会退化成sync
+  std::unique_ptr<PageIO> uring_io(PageIO::create("io_uring"));
+  test_page_io(*uring_io);
+}
+
+TEST(test_page_io, test_prefetch_pages)
+{
+  const char *file_name = "prefetch_test.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  const int page_num = 32;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    memset(frame->data(), 'a' + frame->page_num() % 26, 16);
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+
+  std::vector<PageNum> page_nums;
+  for (PageNum i = 1; i <= page_num; i++) {
+    page_nums.push_back(i);
+  }
+  page_nums.push_back(page_num + 100);  // 不存在的页面会被跳过
+  int loaded_num = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->prefetch_pages(page_nums.data(), (int)page_nums.size(), loaded_num));
+  ASSERT_EQ(page_num, loaded_num);
+
+  // 已经在缓冲区中的页面不会重复读取
+  ASSERT_EQ(RC::SUCCESS, bp->prefetch_pages(page_nums.data(), (int)page_nums.size(), loaded_num));
+  ASSERT_EQ(0, loaded_num);
+
+  for (PageNum i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+    ASSERT_EQ(i, frame->page_num());
+    ASSERT_EQ('a' + i % 26, frame->data()[0]);
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->check_all_pages_unpinned());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+}
+
+TEST(test_page_io, test_get_pages)
+{
+  const char *file_name = "get_pages_test.bp";
+  ::remove(file_name);
+
+  // 缓冲池只有16个页面，文件头一直占用一个
+  const int frame_num = 16;
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_pool("small", frame_num, 1, "lru"));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp, "small"));
+
+  const int page_num = 32;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    memset(frame->data(), 'a' + frame->page_num() % 26, 16);
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+
+  // 一部分页面已经在缓冲池中，另一部分需要读取
+  Frame *cached = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(3, &cached));
+  bp->unpin_page(cached);
+
+  std::vector<PageNum> page_nums;
+  for (PageNum i = page_num - 2; i >= 1; i -= 3) {
+    page_nums.push_back(i);
+  }
+  std::vector<Frame *> frames(page_nums.size(), nullptr);
+  ASSERT_EQ(RC::SUCCESS, bp->get_pages(page_nums.data(), (int)page_nums.size(), frames.data()));
+  for (size_t i = 0; i < page_nums.size(); i++) {
+    ASSERT_EQ(page_nums[i], frames[i]->page_num());
+    ASSERT_EQ('a' + page_nums[i] % 26, frames[i]->data()[0]);
+    ASSERT_LT(0, frames[i]->pin_count());
+    bp->unpin_page(frames[i]);
+  }
+
+  // 放不下整批页面时一个都不pin住
+  page_nums.clear();
+  for (PageNum i = 1; i <= frame_num + 4; i++) {
+    page_nums.push_back(i);
+  }
+  frames.assign(page_nums.size(), nullptr);
+  ASSERT_NE(RC::SUCCESS, bp->get_pages(page_nums.data(), (int)page_nums.size(), frames.data()));
+  for (Frame *frame : frames) {
+    ASSERT_EQ(nullptr, frame);
+  }
+
+  // 有不存在的页面时也一个都不pin住
+  page_nums = {1, 2, page_num + 100, 3, 4};
+  frames.assign(page_nums.size(), nullptr);
+  ASSERT_NE(RC::SUCCESS, bp->get_pages(page_nums.data(), (int)page_nums.size(), frames.data()));
+  for (Frame *frame : frames) {
+    ASSERT_EQ(nullptr, frame);
+  }
+
+  // 前面失败的批次没有留下pin住的页面，除了文件头之外的页面都可以同时pin住
+  page_nums.clear();
+  for (PageNum i = page_num - frame_num + 2; i <= page_num; i++) {
+    page_nums.push_back(i);
+  }
+  frames.assign(page_nums.size(), nullptr);
+  ASSERT_EQ(RC::SUCCESS, bp->get_pages(page_nums.data(), (int)page_nums.size(), frames.data()));
+  for (size_t i = 0; i < page_nums.size(); i++) {
+    ASSERT_EQ(page_nums[i], frames[i]->page_num());
+    ASSERT_EQ(1, frames[i]->pin_count());
+    bp->unpin_page(frames[i]);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_page_io, test_direct_io)
+{
+  char dir[] = "/tmp/direct_io_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+  const std::string file_name = std::string(dir) + "/direct_io_test.bp";
+
+  BufferPoolManager bpm;
+  bpm.set_direct_io_dir(dir, true);
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name.c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name.c_str(), bp));
+  // 文件系统(比如老版本的tmpfs)不支持时退化成普通的读写，下面的读写仍然要正确
+  int fd = ::open(file_name.c_str(), O_RDWR | O_DIRECT);
+  if (fd < 0) {
+    ASSERT_FALSE(bp->direct_io());
+  } else {
+    ::close(fd);
+  }
+
+  const int page_num = 64;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    ASSERT_EQ((size_t)BP_PAGE_HEADER_SIZE, reinterpret_cast<size_t>(frame->data()) % BP_DIRECT_IO_ALIGN);
+    memset(frame->data(), 'a' + frame->page_num() % 26, BP_PAGE_DATA_SIZE);
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+
+  // 批量预读和单个页面的读取
+  std::vector<PageNum> page_nums;
+  for (PageNum i = 1; i <= page_num / 2; i++) {
+    page_nums.push_back(i);
+  }
+  int loaded_num = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->prefetch_pages(page_nums.data(), (int)page_nums.size(), loaded_num));
+  ASSERT_EQ(page_num / 2, loaded_num);
+  for (PageNum i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+    ASSERT_EQ('a' + i % 26, frame->data()[0]);
+    ASSERT_EQ('a' + i % 26, frame->data()[BP_PAGE_DATA_SIZE - 1]);
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name.c_str()));
+
+  // 不在指定目录下的文件不使用O_DIRECT
+  bpm.set_direct_io_dir(dir, false);
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name.c_str(), bp));
+  ASSERT_FALSE(bp->direct_io());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name.c_str()));
+  ::remove(file_name.c_str());
+  ::rmdir(dir);
+}
+
+TEST(test_page_io, test_read_ahead)
+{
+  const char *file_name = "read_ahead_test.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  bpm.set_read_ahead_pages(16);
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  const int page_num = 64;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->dispose_page(10));  // 空洞会被跳过
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+
+  BPFrameManager::PrefetchStats &stats = bpm.frame_manager().prefetch_stats();
+  const long loaded_begin = stats.loaded.load();
+  const long hit_begin = stats.hit.load();
+
+  // 顺序扫描，除了最开始的几个页面，其它的都应该是预读进来的
+  BufferPoolIterator iterator;
+  iterator.init(*bp);
+  int scanned = 0;
+  while (iterator.has_next()) {
+    PageNum current = iterator.next();
+    ASSERT_NE(10, current);
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(current, &frame));
+    ASSERT_EQ(current, frame->page_num());
+    bp->unpin_page(frame);
+    scanned++;
+  }
+  ASSERT_EQ(page_num - 1, scanned);
+  ASSERT_EQ(scanned - 3, stats.loaded.load() - loaded_begin);
+  ASSERT_EQ(scanned - 3, stats.hit.load() - hit_begin);
+
+  // 扫描提前结束，预读了但是没有访问的页面被淘汰时记为浪费
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  const long wasted_begin = stats.wasted.load();
+  iterator.reset();
+  for (int i = 0; i < 4; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(iterator.next(), &frame));
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(15, stats.wasted.load() - wasted_begin);
+
+  // 关闭预读
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  const long loaded_before_disable = stats.loaded.load();
+  iterator.set_read_ahead_pages(0);
+  iterator.reset();
+  while (iterator.has_next()) {
+    iterator.next();
+  }
+  ASSERT_EQ(loaded_before_disable, stats.loaded.load());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+}
+
+TEST(test_space_map, test_space_map_summary)
+{
+  const int group_page_num = 256;
+  BPSpaceMap space_map(group_page_num);
+  char bitmaps[3][group_page_num / 8];
+  memset(bitmaps, 0xFF, sizeof(bitmaps));
+
+  // 3个分组的页面都分配完了，最后一个分组只有一部分页面在文件中
+  const int page_count = group_page_num * 2 + 100;
+  for (int group = 0; group < 3; group++) {
+    space_map.load_group(group, bitmaps[group], page_count);
+  }
+  int group = -1, word = -1;
+  ASSERT_FALSE(space_map.first_free_word(group, word));
+
+  // 文件末尾之外的页面不算空闲页面
+  memset(bitmaps[2], 0, sizeof(bitmaps[2]));
+  bitmaps[2][0] = 0x01;
+  memset(bitmaps[2], 0xFF, 100 / 8);
+  bitmaps[2][100 / 8] = 0x0F;
+  space_map.load_group(2, bitmaps[2], page_count);
+  ASSERT_FALSE(space_map.first_free_word(group, word));
+
+  const PageNum page1 = group_page_num * 2 + 70;
+  bitmaps[2][70 / 8] &= ~(1 << (70 % 8));
+  space_map.update(page1, bitmaps[2], page_count);
+  ASSERT_TRUE(space_map.first_free_word(group, word));
+  ASSERT_EQ(2, group);
+  ASSERT_EQ(1, word);
+  ASSERT_EQ(1ULL << (70 - 64), space_map.free_mask(bitmaps[2], word, space_map.pages_in_group(2, page_count)));
+
+  // 总是找到页号最小的空闲页面
+  const PageNum page2 = group_page_num + 200;
+  bitmaps[1][200 / 8] &= ~(1 << (200 % 8));
+  space_map.update(page2, bitmaps[1], page_count);
+  ASSERT_TRUE(space_map.first_free_word(group, word));
+  ASSERT_EQ(1, group);
+  ASSERT_EQ(200 / 64, word);
+
+  bitmaps[1][200 / 8] |= (1 << (200 % 8));
+  space_map.update(page2, bitmaps[1], page_count);
+  bitmaps[2][70 / 8] |= (1 << (70 % 8));
+  space_map.update(page1, bitmaps[2], page_count);
+  ASSERT_FALSE(space_map.first_free_word(group, word));
+
+  // 增加很多分组之后摘要会增加层数
+  char empty_bitmap[group_page_num / 8];
+  memset(empty_bitmap, 0, sizeof(empty_bitmap));
+  empty_bitmap[0] = 0x01;
+  const int group_num = 1000;
+  for (int i = 3; i < group_num; i++) {
+    space_map.load_group(i, bitmaps[0], group_page_num * group_num);
+  }
+  ASSERT_FALSE(space_map.first_free_word(group, word));
+  space_map.load_group(group_num - 10, empty_bitmap, group_page_num * group_num);
+  ASSERT_TRUE(space_map.first_free_word(group, word));
+  ASSERT_EQ(group_num - 10, group);
+  ASSERT_EQ(0, word);
+  ASSERT_EQ(~1ULL, space_map.free_mask(empty_bitmap, 0, group_page_num));
+}
+
+TEST(test_space_map, test_multi_group_file)
+{
+  const char *file_name = "space_map_test.bp";
+  ::remove(file_name);
+
+  // 构造一个第0个分组已经用完的文件。文件中间都是空洞，不会真的占用磁盘空间
+  const int group_page_num = BPFileHeader::GROUP_PAGE_NUM;
+  {
+    Page page;
+    memset(&page, 0, sizeof(page));
+    BPFileHeader *file_header = (BPFileHeader *)page.data;
+    file_header->page_count = group_page_num;
+    file_header->allocated_pages = group_page_num;
+    file_header->page_size = BP_PAGE_SIZE;
+    memset(file_header->bitmap, 0xFF, group_page_num / 8);
+    stamp_page(page);
+
+    int fd = ::open(file_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ((ssize_t)sizeof(page), ::pwrite(fd, &page, sizeof(page), 0));
+    ASSERT_EQ(0, ::ftruncate(fd, (off_t)group_page_num * sizeof(Page)));
+    ::close(fd);
+  }
+
+  BufferPoolManager bpm;
+  bpm.set_read_ahead_pages(0);
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  // 第1个分组的第一个页面是位图页
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(group_page_num + 1, frame->page_num());
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(group_page_num + 2, frame->page_num());
+  bp->unpin_page(frame);
+
+  int page_count = 0;  // 已经分配的页面个数
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&page_count));
+  ASSERT_EQ(group_page_num + 3, page_count);
+  ASSERT_NE(RC::SUCCESS, bp->dispose_page(group_page_num));
+
+  // 释放的页面会被优先使用
+  ASSERT_EQ(RC::SUCCESS, bp->dispose_page(100));
+  ASSERT_EQ(RC::SUCCESS, bp->dispose_page(group_page_num + 1));
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(100, frame->page_num());
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->dispose_page(group_page_num + 2));
+
+  // 回放日志时可能会跳过一些分组
+  const PageNum recover_page_num = group_page_num * 3 + 5;
+  ASSERT_EQ(RC::SUCCESS, bp->recover_page(recover_page_num));
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&page_count));
+  ASSERT_EQ(group_page_num + 4, page_count);  // 新增了两个分组的位图页
+  ASSERT_EQ(recover_page_num, bp->next_allocated_page(group_page_num));
+  ASSERT_EQ(BP_INVALID_PAGE_NUM, bp->next_allocated_page(recover_page_num + 1));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+
+  // 重新打开之后空闲页面的信息还在
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&page_count));
+  ASSERT_EQ(group_page_num + 4, page_count);
+  ASSERT_EQ(group_page_num - 1, bp->next_allocated_page(group_page_num - 1));
+  ASSERT_EQ(recover_page_num, bp->next_allocated_page(group_page_num));
+
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(group_page_num + 1, frame->page_num());
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(group_page_num + 2, frame->page_num());
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  ASSERT_EQ(group_page_num + 3, frame->page_num());
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_page_checksum, test_page_checksum)
+{
+  const char *file_name = "page_checksum_test.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  bpm.set_read_ahead_pages(0);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  Frame *frame = nullptr;
+  // 关闭文件时只淘汰文件头页面，测试中每次关闭之前把所有页面都淘汰掉，重新打开后从磁盘读取
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+  strcpy(frame->data(), "hello");
+  frame->set_lsn(100);
+  frame->mark_dirty();
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+
+  // 页面正确写盘，LSN随页面一起保存
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+  ASSERT_STREQ("hello", frame->data());
+  ASSERT_EQ(100, frame->lsn());
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+
+  // 修改磁盘上的一个字节，模拟损坏的页面
+  int fd = ::open(file_name, O_RDWR);
+  ASSERT_GE(fd, 0);
+  const off_t offset = (off_t)page_num * sizeof(Page) + offsetof(Page, data) + 1;
+  ASSERT_EQ(1, ::pwrite(fd, "E", 1, offset));
+  ::close(fd);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_EQ(RC::BUFFERPOOL_PAGE_CORRUPTED, bp->get_this_page(page_num, &frame));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+
+  bpm.set_checksum_verify(BufferPoolManager::ChecksumVerify::WARN);
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+  ASSERT_STREQ("hEllo", frame->data());
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+
+  // 写到了错误位置的页面，虽然校验和是正确的，也认为是损坏的
+  {
+    Page page;
+    memset(&page, 0, sizeof(page));
+    page.page_num = page_num + 1;
+    stamp_page(page);
+    ASSERT_TRUE(verify_page_checksum(page));
+    fd = ::open(file_name, O_RDWR);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ((ssize_t)sizeof(page), ::pwrite(fd, &page, sizeof(page), (off_t)page_num * sizeof(Page)));
+    ::close(fd);
+  }
+  bpm.set_checksum_verify(BufferPoolManager::ChecksumVerify::STRICT);
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_EQ(RC::BUFFERPOOL_PAGE_CORRUPTED, bp->get_this_page(page_num, &frame));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+static std::atomic<int64_t> test_next_lsn{0};
+
+static int64_t test_lsn_source()
+{
+  return test_next_lsn.load();
+}
+
+TEST(test_page_lsn, test_flush_stamps_lsn)
+{
+  const char *file_name = "page_lsn_test.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  bpm.set_read_ahead_pages(0);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  BufferPoolManager::set_lsn_source(test_lsn_source);
+
+  // 刷盘时记录复制页面之前的下一条日志的LSN
+  test_next_lsn = 500;
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+  strcpy(frame->data(), "hello");
+  frame->mark_dirty();
+  ASSERT_EQ(RC::SUCCESS, bp->flush_page(*frame));
+  bp->unpin_page(frame);
+  test_next_lsn = 600;
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+
+  int64_t lsn = -1;
+  ASSERT_EQ(RC::SUCCESS, bp->page_lsn(page_num, lsn));
+  ASSERT_EQ(500, lsn);
+  // 没有分配的页面和超出文件范围的页面都是0
+  ASSERT_EQ(RC::SUCCESS, bp->page_lsn(page_num + 1, lsn));
+  ASSERT_EQ(0, lsn);
+  ASSERT_EQ(RC::SUCCESS, bp->page_lsn(page_num + 100, lsn));
+  ASSERT_EQ(0, lsn);
+
+  // 回放日志期间刷盘保留页面原来的LSN
+  BufferPoolManager::begin_redo();
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+  strcpy(frame->data(), "redo");
+  frame->mark_dirty();
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->page_lsn(page_num, lsn));
+  ASSERT_EQ(500, lsn);
+  BufferPoolManager::end_redo();
+
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+  ASSERT_STREQ("redo", frame->data());
+  frame->mark_dirty();
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->page_lsn(page_num, lsn));
+  ASSERT_EQ(600, lsn);
+
+  BufferPoolManager::set_lsn_source(nullptr);
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_double_write, test_double_write_recover)
+{
+  const char *file_name = "double_write_test.data";
+  const char *double_write_file = "double_write_test.dblwr";
+  ::remove(file_name);
+  ::remove(double_write_file);
+
+  int fd = ::open(file_name, O_RDWR | O_CREAT, 0600);
+  ASSERT_GE(fd, 0);
+  std::unique_ptr<PageIO> page_io(PageIO::create("sync"));
+
+  const int page_num = 3;
+  std::vector<Page> pages(page_num);
+  std::vector<PageIORequest> requests(page_num);
+  for (int i = 0; i < page_num; i++) {
+    memset(&pages[i], 0, sizeof(Page));
+    pages[i].page_num = i;
+    memset(pages[i].data, 'a' + i, sizeof(pages[i].data));
+    stamp_page(pages[i]);
+    requests[i].file_desc = fd;
+    requests[i].page_num = i;
+    requests[i].page = &pages[i];
+  }
+
+  {
+    DoubleWriteBuffer double_write_buffer;
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer.open(double_write_file));
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer.write_pages(*page_io, file_name, requests.data(), page_num));
+    ASSERT_EQ(page_num, double_write_buffer.written_pages());
+    ASSERT_EQ(1, double_write_buffer.written_batches());
+  }
+
+  // 模拟写了一半的页面：第1个页面的后半部分是旧数据
+  std::vector<char> garbage(BP_PAGE_SIZE / 2, 'z');
+  ASSERT_EQ((ssize_t)garbage.size(),
+            ::pwrite(fd, garbage.data(), garbage.size(), (off_t)1 * BP_PAGE_SIZE + BP_PAGE_SIZE / 2));
+  // 第2个页面没有写到磁盘上
+  ASSERT_EQ(0, ::ftruncate(fd, (off_t)2 * BP_PAGE_SIZE));
+
+  {
+    DoubleWriteBuffer double_write_buffer;
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer.open(double_write_file));
+    int repaired_num = 0;
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer.recover(repaired_num));
+    ASSERT_EQ(2, repaired_num);
+
+    // 再次恢复时页面都是好的
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer.recover(repaired_num));
+    ASSERT_EQ(0, repaired_num);
+  }
+
+  Page page;
+  for (int i = 0; i < page_num; i++) {
+    ASSERT_EQ((ssize_t)sizeof(page), ::pread(fd, &page, sizeof(page), (off_t)i * BP_PAGE_SIZE));
+    ASSERT_EQ(0, memcmp(&page, &pages[i], sizeof(page)));
+  }
+
+  // 双写文件中的页面本身不完整时不能用来修复
+  ASSERT_EQ((ssize_t)garbage.size(), ::pwrite(fd, garbage.data(), garbage.size(), BP_PAGE_SIZE / 2));
+  int double_write_fd = ::open(double_write_file, O_RDWR);
+  ASSERT_GE(double_write_fd, 0);
+  ASSERT_EQ((ssize_t)garbage.size(),
+            ::pwrite(double_write_fd, garbage.data(), garbage.size(), (off_t)1 * BP_PAGE_SIZE + BP_PAGE_SIZE / 2));
+  ::close(double_write_fd);
+  {
+    DoubleWriteBuffer double_write_buffer;
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer.open(double_write_file));
+    int repaired_num = 0;
+    ASSERT_EQ(RC::SUCCESS, double_write_buffer.recover(repaired_num));
+    ASSERT_EQ(0, repaired_num);
+  }
+  ::close(fd);
+  ::remove(file_name);
+
+  // 开启双写时，缓冲池刷盘都会经过双写文件
+  BufferPoolManager bpm;
+  bpm.set_double_write(true);
+  ASSERT_EQ(RC::SUCCESS, bpm.open_double_write(double_write_file));
+  ASSERT_NE(nullptr, bpm.double_write_buffer());
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  frame->mark_dirty();
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_LT(0, bpm.double_write_buffer()->written_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+  ::remove(double_write_file);
+}
+
+TEST(test_buffer_pool_warmer, test_dump_and_load)
+{
+  const char *file_name = "warmer_test.bp";
+  const char *list_file = "warmer_test.list";
+  ::remove(file_name);
+  ::remove(list_file);
+
+  BufferPoolManager bpm;
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  const int page_num = 32;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+    memset(frame->data(), 'a' + frame->page_num() % 26, 16);
+    frame->mark_dirty();
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+
+  BufferPoolWarmer &warmer = bpm.warmer();
+  ASSERT_EQ(RC::SUCCESS, warmer.dump(list_file));
+
+  std::vector<BufferPoolWarmer::Entry> entries;
+  ASSERT_EQ(RC::SUCCESS, BufferPoolWarmer::load_list(list_file, entries));
+  ASSERT_LE(page_num, (int)entries.size());
+  for (const BufferPoolWarmer::Entry &entry : entries) {
+    ASSERT_EQ(std::string(file_name), entry.file_name);
+    ASSERT_NE(nullptr, bpm.frame_manager().get(bp->file_desc(), entry.page_num));
+  }
+
+  // 清空缓冲池之后从列表中加载回来
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(nullptr, bpm.frame_manager().get(bp->file_desc(), 1));
+  const long misses = bpm.page_misses();
+  ASSERT_EQ(RC::SUCCESS, warmer.start(list_file));
+  ASSERT_TRUE(warmer.wait_loaded(10000));
+  ASSERT_EQ((long)entries.size(), warmer.total_pages());
+  ASSERT_EQ(warmer.total_pages(), warmer.loaded_pages() + warmer.skipped_pages());
+  ASSERT_LE(page_num, warmer.loaded_pages());
+  ASSERT_LE(0, warmer.warm_up_ms());
+
+  for (PageNum i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+    ASSERT_EQ('a' + i % 26, frame->data()[0]);
+    bp->unpin_page(frame);
+  }
+  ASSERT_EQ(misses, bpm.page_misses());
+  warmer.stop();
+
+  // 列表中没有打开的文件会被跳过
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, warmer.start(list_file));
+  ASSERT_TRUE(warmer.wait_loaded(10000));
+  ASSERT_EQ(0, warmer.loaded_pages());
+  ASSERT_EQ(warmer.total_pages(), warmer.skipped_pages());
+  warmer.stop();
+
+  ::remove(file_name);
+  ::remove(list_file);
+}
+
+TEST(test_buffer_pool_stats, test_file_stats)
+{
+  const char *file_name1 = "stats_test1.bp";
+  const char *file_name2 = "stats_test2.bp";
+  ::remove(file_name1);
+  ::remove(file_name2);
+
+  BufferPoolManager bpm;
+  DiskBufferPool *bp1 = nullptr;
+  DiskBufferPool *bp2 = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name1));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name1, bp1));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name2));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name2, bp2));
+
+  const int page_num = 8;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp1->allocate_page(&frame));
+    frame->mark_dirty();
+    bp1->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp1->flush_all_pages());
+  ASSERT_LE(page_num, bp1->stats().dirty_writes.load());
+  ASSERT_LT(0, bp1->stats().write_latency.count());
+  ASSERT_EQ(RC::SUCCESS, bp1->purge_all_pages());
+
+  // 第一次读取没有命中，第二次命中
+  for (int round = 0; round < 2; round++) {
+    for (PageNum i = 1; i <= page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp1->get_this_page(i, &frame));
+      bp1->unpin_page(frame);
+    }
+  }
+  const DiskBufferPool::Stats &stats1 = bp1->stats();
+  ASSERT_EQ(page_num, stats1.misses.load());
+  ASSERT_LE(page_num, stats1.hits.load());
+  ASSERT_LE(page_num, stats1.read_latency.count());  // 打开文件时还读取了文件头
+  ASSERT_EQ(0, bp2->stats().misses.load());
+
+  // 另一个文件占满缓冲池，淘汰的是第一个文件的页面
+  ASSERT_EQ(RC::SUCCESS, bpm.resize(32 * BP_PAGE_SIZE));
+  const int frame_num = static_cast<int>(bpm.frame_manager().total_frame_num());
+  for (int i = 0; i < frame_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bp2->allocate_page(&frame));
+    bp2->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp1->check_all_pages_unpinned());
+  ASSERT_LT(0, stats1.evictions.load());  // 缩容时淘汰的页面不算
+
+  int file_num = 0;
+  bpm.foreach_buffer_pool([&file_num](DiskBufferPool &bp) { file_num++; });
+  ASSERT_EQ(2, file_num);
+  ASSERT_NE(std::string::npos, stats1.to_string().find("misses=8"));
+
+  ASSERT_EQ(RC::SUCCESS, bp2->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name1));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name2));
+  ::remove(file_name1);
+  ::remove(file_name2);
+}
+
+TEST(test_buffer_pool_stats, test_named_pool_isolation)
+{
+  const char *hot_file_name = "named_pool_hot.bp";
+  const char *scan_file_name = "named_pool_scan.bp";
+  const char *other_file_name = "named_pool_other.bp";
+  ::remove(hot_file_name);
+  ::remove(scan_file_name);
+  ::remove(other_file_name);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_pool("hot", 16, 1, "lru"));
+  ASSERT_NE(RC::SUCCESS, bpm.create_pool("hot", 16, 1, "lru"));
+  ASSERT_NE(RC::SUCCESS, bpm.create_pool(BufferPoolManager::DEFAULT_POOL_NAME, 16, 1, "lru"));
+  ASSERT_EQ(&bpm.frame_manager(), bpm.find_pool(nullptr));
+  ASSERT_EQ(&bpm.frame_manager(), bpm.find_pool("default"));
+  ASSERT_EQ(nullptr, bpm.find_pool("cold"));
+  BPFrameManager *hot_pool = bpm.find_pool("hot");
+  ASSERT_NE(nullptr, hot_pool);
+  ASSERT_EQ(16, (int)hot_pool->total_frame_num());
+
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  bpm.all_pools(pools);
+  ASSERT_EQ(2, (int)pools.size());
+  ASSERT_EQ(std::string(BufferPoolManager::DEFAULT_POOL_NAME), pools[0].first);
+
+  DiskBufferPool *hot_bp = nullptr;
+  DiskBufferPool *scan_bp = nullptr;
+  DiskBufferPool *other_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(hot_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(hot_file_name, hot_bp, "hot"));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(scan_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(scan_file_name, scan_bp));
+  ASSERT_EQ(std::string("hot"), hot_bp->pool_name());
+  ASSERT_EQ(std::string(BufferPoolManager::DEFAULT_POOL_NAME), scan_bp->pool_name());
+
+  // 缓冲池不存在时使用默认的缓冲池
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(other_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(other_file_name, other_bp, "cold"));
+  ASSERT_EQ(&bpm.frame_manager(), &other_bp->frame_manager());
+
+  const int hot_page_num = 8;
+  for (int i = 0; i < hot_page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, hot_bp->allocate_page(&frame));
+    hot_bp->unpin_page(frame);
+  }
+  ASSERT_EQ(hot_page_num + 1, (int)(hot_pool->total_frame_num() - hot_pool->free_frame_num()));
+
+  // 扫描文件把默认的缓冲池换了好几遍，热点文件的页面都还在
+  ASSERT_EQ(RC::SUCCESS, bpm.resize(32 * BP_PAGE_SIZE));
+  for (int i = 0; i < 4 * 32; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, scan_bp->allocate_page(&frame));
+    scan_bp->unpin_page(frame);
+  }
+  ASSERT_LT(0, scan_bp->stats().evictions.load());
+
+  const long misses = hot_bp->stats().misses.load();
+  for (PageNum i = 1; i <= hot_page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, hot_bp->get_this_page(i, &frame));
+    hot_bp->unpin_page(frame);
+  }
+  ASSERT_EQ(misses, hot_bp->stats().misses.load());
+  ASSERT_EQ(0, hot_bp->stats().evictions.load());
+
+  ASSERT_EQ(RC::SUCCESS, hot_bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, scan_bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(hot_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(scan_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(other_file_name));
+  ::remove(hot_file_name);
+  ::remove(scan_file_name);
+  ::remove(other_file_name);
+}
+
+TEST(test_bp_manager, test_open_file_in_full_pool)
+{
+  const char *dirty_file_name = "full_pool_dirty.bp";
+  const char *open_file_name = "full_pool_open.bp";
+  ::remove(dirty_file_name);
+  ::remove(open_file_name);
+
+  const int frame_num = 8;
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_pool("tiny", frame_num, 1, "lru"));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(dirty_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(open_file_name));
+
+  // 缓冲池中都是脏页，打开文件读取文件头时只能淘汰脏页，淘汰时要刷盘
+  DiskBufferPool *dirty_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(dirty_file_name, dirty_bp, "tiny"));
+  BPFrameManager *pool = bpm.find_pool("tiny");
+  int page_num = 0;
+  while (pool->free_frame_num() > 0) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, dirty_bp->allocate_page(&frame));
+    memset(frame->data(), 'a' + frame->page_num() % 26, 16);
+    frame->mark_dirty();
+    dirty_bp->unpin_page(frame);
+    page_num = frame->page_num();
+  }
+  ASSERT_LT(1, page_num);
+
+  DiskBufferPool *open_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(open_file_name, open_bp, "tiny"));
+  ASSERT_EQ(RC::BUFFERPOOL_OPEN, bpm.open_file(open_file_name, open_bp, "tiny"));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(open_file_name));
+
+  // 被淘汰的脏页已经写到文件中
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(dirty_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(dirty_file_name, dirty_bp, "tiny"));
+  for (PageNum i = 1; i <= page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, dirty_bp->get_this_page(i, &frame));
+    ASSERT_EQ('a' + i % 26, frame->data()[0]);
+    dirty_bp->unpin_page(frame);
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(dirty_file_name));
+  ::remove(dirty_file_name);
+  ::remove(open_file_name);
+}
+
+TEST(test_bp_manager, test_modify_while_flush)
+{
+  const char *file_name = "modify_while_flush.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  bpm.set_read_ahead_pages(0);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+
+  // 写线程在写锁保护下把整个页面改成同一个字符，刷盘线程不停地刷这个页面，
+  // 磁盘上的页面校验和必须正确，内容必须是某一次修改之后的完整页面
+  std::atomic<bool> stop{false};
+  std::thread writer([&]() {
+    for (int i = 0; !stop.load(); i++) {
+      frame->latch().lock();
+      memset(frame->data(), 'a' + i % 26, BP_PAGE_DATA_SIZE);
+      frame->latch().unlock();
+      frame->mark_dirty();
+    }
+  });
+  std::thread flusher([&]() {
+    while (!stop.load()) {
+      bp->flush_page(*frame);
+      std::vector<Frame *> frames{frame};
+      int flushed_num = 0;
+      bp->flush_pages(frames, flushed_num);
+    }
+  });
+
+  int fd = ::open(file_name, O_RDONLY);
+  ASSERT_GE(fd, 0);
+  std::unique_ptr<Page> page(new Page);
+  int checked = 0;
+  bool torn = false;
+  for (int i = 0; i < 2000 && !torn; i++) {
+    if (::pread(fd, page.get(), sizeof(Page), (off_t)page_num * sizeof(Page)) != (ssize_t)sizeof(Page) ||
+        page->page_num != page_num) {
+      continue;  // 还没有写过
+    }
+    const char c = page->data[0];
+    torn = !verify_page_checksum(*page) ||
+           std::count(page->data, page->data + BP_PAGE_DATA_SIZE, c) != BP_PAGE_DATA_SIZE;
+    checked++;
+  }
+  ::close(fd);
+  stop = true;
+  writer.join();
+  flusher.join();
+  ASSERT_FALSE(torn);
+  ASSERT_LT(0, checked);
+
+  // 最后一次修改之后页面是脏的，关闭文件时写盘，严格校验的情况下可以正常读取
+  const char last = frame->data()[0];
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+  ASSERT_EQ(last, frame->data()[0]);
+  ASSERT_EQ(last, frame->data()[BP_PAGE_DATA_SIZE - 1]);
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_bp_manager, test_mmap_read_page_copy)
+{
+  const char *file_name = "./mmap_read_page_copy.bp";
+  ::remove(file_name);
+
+  BufferPoolManager bpm;
+  bpm.set_read_ahead_pages(0);
+  bpm.set_mmap_scan_dir(".", true);
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(file_name));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(file_name, bp));
+  ASSERT_TRUE(bp->mmap_scan());
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+  memset(frame->data(), 'a', BP_PAGE_DATA_SIZE);
+  frame->mark_dirty();
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+
+  // 页面不在缓冲池中，从映射中复制一份
+  std::vector<char> buffer(bp->page_size());
+  const Page *page = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->read_page(page_num, frame, page, buffer.data()));
+  ASSERT_EQ(nullptr, frame);
+  ASSERT_EQ((const char *)page, buffer.data());
+  ASSERT_EQ(1, bp->stats().mapped_reads.load());
+
+  // 之后修改页面并写盘，映射中的内容变了，已经读到的页面不受影响
+  ASSERT_EQ(RC::SUCCESS, bp->get_this_page(page_num, &frame));
+  frame->latch().lock();
+  memset(frame->data(), 'b', BP_PAGE_DATA_SIZE);
+  frame->latch().unlock();
+  frame->mark_dirty();
+  ASSERT_EQ(RC::SUCCESS, bp->flush_page(*frame));
+  bp->unpin_page(frame);
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(BP_PAGE_DATA_SIZE, std::count(page->data, page->data + BP_PAGE_DATA_SIZE, 'a'));
+
+  ASSERT_EQ(RC::SUCCESS, bp->read_page(page_num, frame, page, buffer.data()));
+  ASSERT_EQ(nullptr, frame);
+  ASSERT_EQ(BP_PAGE_DATA_SIZE, std::count(page->data, page->data + BP_PAGE_DATA_SIZE, 'b'));
+  ASSERT_EQ(2, bp->stats().mapped_reads.load());
+
+  // 复制出来的页面校验不通过时不使用映射，经过缓冲池按照校验模式处理
+  int fd = ::open(file_name, O_WRONLY);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(1, ::pwrite(fd, "c", 1, (off_t)page_num * sizeof(Page) + offsetof(Page, data)));
+  ::close(fd);
+  ASSERT_EQ(RC::BUFFERPOOL_PAGE_CORRUPTED, bp->read_page(page_num, frame, page, buffer.data()));
+  ASSERT_EQ(2, bp->stats().mapped_reads.load());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(file_name));
+  ::remove(file_name);
+}
+
+TEST(test_page_size, test_file_page_size)
+{
+  const char *small_file_name = "page_size_small.bp";
+  const char *large_file_name = "page_size_large.bp";
+  ::remove(small_file_name);
+  ::remove(large_file_name);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_pool("hot", 16, 1, "lru"));
+  ASSERT_NE(RC::SUCCESS, bpm.create_file(small_file_name, 3000));
+  ASSERT_NE(RC::SUCCESS, bpm.create_file(small_file_name, BP_MIN_PAGE_SIZE / 2));
+  ASSERT_NE(RC::SUCCESS, bpm.create_file(small_file_name, BP_MAX_PAGE_SIZE * 2));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(small_file_name, 4096));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(large_file_name, 65536));
+
+  struct stat st;
+  ASSERT_EQ(0, ::stat(small_file_name, &st));
+  ASSERT_EQ(4096, st.st_size);
+
+  // 页面大小不同的文件使用各自的缓冲池，即使指定了其它的缓冲池
+  DiskBufferPool *small_bp = nullptr;
+  DiskBufferPool *large_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(small_file_name, small_bp, "hot"));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(large_file_name, large_bp));
+  ASSERT_EQ(4096, small_bp->page_size());
+  ASSERT_EQ(4096 - BP_PAGE_HEADER_SIZE, small_bp->page_data_size());
+  ASSERT_EQ(65536, large_bp->page_size());
+  ASSERT_EQ(std::string("default.4K"), small_bp->pool_name());
+  ASSERT_EQ(std::string("default.64K"), large_bp->pool_name());
+  ASSERT_EQ(bpm.page_size_pool(4096), &small_bp->frame_manager());
+  ASSERT_EQ(bpm.page_size_pool(65536), &large_bp->frame_manager());
+  ASSERT_EQ(&bpm.frame_manager(), bpm.page_size_pool(BP_PAGE_SIZE));
+  ASSERT_EQ(4096, small_bp->frame_manager().page_size());
+
+  std::vector<std::pair<std::string, BPFrameManager *>> pools;
+  bpm.all_pools(pools);
+  ASSERT_EQ(4, (int)pools.size());
+
+  // 写满每个页面的数据区，重新打开之后读出来的内容相同
+  const int page_num = 10;
+  DiskBufferPool *bps[] = {small_bp, large_bp};
+  for (DiskBufferPool *bp : bps) {
+    for (int i = 0; i < page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+      memset(frame->data(), 'a' + frame->page_num(), bp->page_data_size());
+      frame->mark_dirty();
+      bp->unpin_page(frame);
+    }
+    ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(small_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(large_file_name));
+  ASSERT_EQ(0, ::stat(large_file_name, &st));
+  ASSERT_EQ((page_num + 1) * 65536, st.st_size);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(small_file_name, small_bp));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(large_file_name, large_bp));
+  DiskBufferPool *reopened_bps[] = {small_bp, large_bp};
+  for (DiskBufferPool *bp : reopened_bps) {
+    std::vector<char> expect(bp->page_data_size());
+    for (PageNum i = 1; i <= page_num; i++) {
+      Frame *frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, bp->get_this_page(i, &frame));
+      memset(expect.data(), 'a' + i, expect.size());
+      ASSERT_EQ(0, memcmp(expect.data(), frame->data(), expect.size()));
+      bp->unpin_page(frame);
+    }
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(small_file_name));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(large_file_name));
+
+  // 文件头中的页面大小被破坏了
+  int fd = ::open(small_file_name, O_RDWR);
+  ASSERT_GE(fd, 0);
+  const int bad_page_size = 1000;
+  ASSERT_EQ((ssize_t)sizeof(bad_page_size),
+            ::pwrite(fd, &bad_page_size, sizeof(bad_page_size),
+                     offsetof(Page, data) + offsetof(BPFileHeader, page_size)));
+  ::close(fd);
+  ASSERT_NE(RC::SUCCESS, bpm.open_file(small_file_name, small_bp));
+
+  ::remove(small_file_name);
+  ::remove(large_file_name);
+}
+
 int main(int argc, char **argv)
 {
 
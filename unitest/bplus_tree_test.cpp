@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <list>
+#include <vector>
 #include <iostream>
 
 #include "storage/index/bplus_tree.h"
@@ -472,6 +473,119 @@ TEST(test_bplus_tree, test_internal_index_node_handle)
   }
 }
 
+TEST(test_bplus_tree, test_insert_entries)
+{
+  LoggerFactory::init_default("test.log");
+
+  // 键值是 int + RID，连续存放，乱序插入
+  const int key_num = 1000;
+  const int key_length = sizeof(int) + sizeof(RID);
+  std::vector<char> keys(key_num * key_length);
+  for (int i = 0; i < key_num; i++) {
+    int value = (i * 7) % key_num;
+    RID rid;
+    rid.page_num = value / page_size;
+    rid.slot_num = value % page_size;
+    memcpy(keys.data() + i * key_length, &value, sizeof(value));
+    memcpy(keys.data() + i * key_length + sizeof(value), &rid, sizeof(rid));
+  }
+
+  // 空树自底向上构建
+  const char *index_name = "build.btree";
+  ::remove(index_name);
+  BplusTreeHandler *tree = new BplusTreeHandler();
+  ASSERT_EQ(RC::SUCCESS, tree->create(index_name, INTS, sizeof(int), true, ORDER, ORDER));
+  ASSERT_EQ(RC::SUCCESS, tree->insert_entries(keys.data(), key_num / 2));
+  ASSERT_EQ(true, tree->validate_tree());
+
+  // 非空树逐个插入
+  ASSERT_EQ(RC::SUCCESS, tree->insert_entries(keys.data() + key_num / 2 * key_length, key_num - key_num / 2));
+  ASSERT_EQ(true, tree->validate_tree());
+
+  // 按顺序遍历所有的键值
+  BplusTreeScanner scanner(*tree);
+  ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, false, nullptr, 0, false));
+  RID rid;
+  int count = 0;
+  while (scanner.next_entry(&rid) == RC::SUCCESS) {
+    ASSERT_EQ(count / page_size, rid.page_num);
+    ASSERT_EQ(count % page_size, rid.slot_num);
+    count++;
+  }
+  scanner.close();
+  ASSERT_EQ(key_num, count);
+
+  // 唯一索引有重复的键值时都不插入
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, tree->insert_entries(keys.data(), 2));
+  tree->close();
+  delete tree;
+  ::remove(index_name);
+
+  // 重新创建，空树构建时有重复的键值
+  tree = new BplusTreeHandler();
+  ASSERT_EQ(RC::SUCCESS, tree->create(index_name, INTS, sizeof(int), true, ORDER, ORDER));
+  std::vector<char> dup_keys(keys.begin(), keys.begin() + 10 * key_length);
+  memcpy(dup_keys.data() + 9 * key_length, dup_keys.data(), sizeof(int));
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, tree->insert_entries(dup_keys.data(), 10));
+  ASSERT_EQ(true, tree->is_empty());
+  tree->close();
+  delete tree;
+  ::remove(index_name);
+}
+
+TEST(test_bplus_tree, test_scan_leaf_batches)
+{
+  // 键值是 int + RID，乱序插入，叶子节点在文件中不是按照键值顺序存放的
+  const int key_num = 1000;
+  const int key_length = sizeof(int) + sizeof(RID);
+  std::vector<char> keys(key_num * key_length);
+  for (int i = 0; i < key_num; i++) {
+    int value = (i * 7) % key_num;
+    RID rid;
+    rid.page_num = value / page_size;
+    rid.slot_num = value % page_size;
+    memcpy(keys.data() + i * key_length, &value, sizeof(value));
+    memcpy(keys.data() + i * key_length + sizeof(value), &rid, sizeof(rid));
+  }
+
+  // 非唯一索引，右边界的键值比较时带上RID
+  const char *index_name = "scan_batch.btree";
+  ::remove(index_name);
+  BplusTreeHandler *tree = new BplusTreeHandler();
+  ASSERT_EQ(RC::SUCCESS, tree->create(index_name, INTS, sizeof(int), false, ORDER, ORDER));
+  ASSERT_EQ(RC::SUCCESS, tree->insert_entries(keys.data(), key_num / 2));
+  ASSERT_EQ(RC::SUCCESS, tree->insert_entries(keys.data() + key_num / 2 * key_length, key_num - key_num / 2));
+  tree->close();
+  delete tree;
+
+  // 重新打开之后页面都不在缓冲池中，扫描时每次批量读取3个叶子节点，批次的边界不和父节点对齐
+  const int read_ahead_pages = BufferPoolManager::instance().read_ahead_pages();
+  BufferPoolManager::instance().set_read_ahead_pages(3);
+  tree = new BplusTreeHandler();
+  ASSERT_EQ(RC::SUCCESS, tree->open(index_name, false));
+
+  const int ranges[][2] = {{0, key_num - 1}, {1, key_num - 2}, {100, 899}, {333, 334}, {500, 500}, {key_num - 1, key_num - 1}};
+  for (const auto &range : ranges) {
+    BplusTreeScanner scanner(*tree);
+    ASSERT_EQ(RC::SUCCESS, scanner.open(reinterpret_cast<const char *>(&range[0]), sizeof(int), true,
+                                        reinterpret_cast<const char *>(&range[1]), sizeof(int), true));
+    RID rid;
+    int value = range[0];
+    while (scanner.next_entry(&rid) == RC::SUCCESS) {
+      ASSERT_EQ(value / page_size, rid.page_num);
+      ASSERT_EQ(value % page_size, rid.slot_num);
+      value++;
+    }
+    scanner.close();
+    ASSERT_EQ(range[1] + 1, value);
+  }
+
+  BufferPoolManager::instance().set_read_ahead_pages(read_ahead_pages);
+  tree->close();
+  delete tree;
+  ::remove(index_name);
+}
+
 TEST(test_bplus_tree, test_chars)
 {
   LoggerFactory::init_default("test_chars.log");
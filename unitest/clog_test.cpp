@@ -14,7 +14,13 @@ See the Mulan PSL v2 for more details. */
 // Created by huhaosheng.hhs on 2022
 //
 
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "storage/clog/clog.h"
 #include "gtest/gtest.h"
@@ -118,6 +124,219 @@ TEST(test_clog, test_clog)
   }
 }
 
+/**
+ * 追加trx_num个事务，每个事务一条插入记录，返回中间那个事务开始之前的LSN
+ */
+static int64_t append_trx(CLogManager &log_mgr, int32_t first_trx_id, int trx_num, int32_t checkpoint_trx_id)
+{
+  int64_t checkpoint_lsn = 0;
+  for (int32_t trx_id = first_trx_id; trx_id < first_trx_id + trx_num; trx_id++) {
+    if (trx_id == checkpoint_trx_id) {
+      checkpoint_lsn = CLogManager::next_lsn();
+    }
+    CLogRecord *log_rec = nullptr;
+    log_mgr.clog_gen_record(REDO_MTR_BEGIN, trx_id, log_rec);
+    log_mgr.clog_append_record(log_rec);
+
+    Record *rec = gen_ins_record(trx_id, 1, 100);
+    log_mgr.clog_gen_record(REDO_INSERT, trx_id, log_rec, "table1", 100, rec);
+    log_mgr.clog_append_record(log_rec);
+    delete[] rec->data();
+    delete rec;
+
+    log_mgr.clog_gen_record(REDO_MTR_COMMIT, trx_id, log_rec);
+    log_mgr.clog_append_record(log_rec);
+  }
+  return checkpoint_lsn;
+}
+
+TEST(test_clog, test_clog_checkpoint)
+{
+  char dir[] = "/tmp/clog_checkpoint_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+
+  const int trx_num = 200;
+  int64_t checkpoint_lsn = 0;
+  {
+    CLogManager log_mgr(dir);
+    log_mgr.recover();
+    checkpoint_lsn = append_trx(log_mgr, 1, trx_num, trx_num / 2 + 1);
+    ASSERT_EQ(RC::SUCCESS, log_mgr.checkpoint(checkpoint_lsn));
+    ASSERT_EQ(checkpoint_lsn, log_mgr.checkpoint_lsn());
+
+    // 检查点不会后退
+    ASSERT_EQ(RC::SUCCESS, log_mgr.checkpoint(0));
+    ASSERT_EQ(checkpoint_lsn, log_mgr.checkpoint_lsn());
+  }
+
+  {
+    // 同一个进程中已经分配过的LSN比检查点大，恢复时不能回退
+    const int64_t lsn_before_recover = CLogManager::next_lsn();
+    CLogManager log_mgr(dir);
+    log_mgr.recover();
+    ASSERT_EQ(checkpoint_lsn, log_mgr.checkpoint_lsn());
+    ASSERT_GE(CLogManager::next_lsn(), lsn_before_recover);
+
+    // 检查点所在的block中前面的几条记录也会读出来
+    ASSERT_LT(log_mgr.recovered_records(), trx_num * 3 / 2 + 30);
+    ASSERT_GE(log_mgr.recovered_records(), trx_num * 3 / 2);
+
+    CLogMTRManager *mtr_mgr = log_mgr.get_mtr_manager();
+    for (int32_t trx_id = trx_num / 2 + 1; trx_id <= trx_num; trx_id++) {
+      ASSERT_EQ(true, mtr_mgr->trx_commited[trx_id]);
+    }
+    int32_t first_trx_id = trx_num / 2 + 1;
+    for (CLogRecord *log_rec : mtr_mgr->log_redo_list) {
+      ASSERT_EQ(REDO_INSERT, log_rec->get_log_type());
+      first_trx_id = std::min(first_trx_id, log_rec->get_trx_id());
+    }
+    ASSERT_GT(first_trx_id, 1);
+    for (CLogRecord *log_rec : mtr_mgr->log_redo_list) {
+      delete log_rec;
+    }
+    mtr_mgr->log_redo_list.clear();
+
+    // 恢复之后接着写的日志，下次恢复时同样能读到
+    ASSERT_GT(CLogManager::next_lsn(), checkpoint_lsn);
+    append_trx(log_mgr, trx_num + 1, 1, 0);
+    log_mgr.clog_sync();
+  }
+
+  {
+    CLogManager log_mgr(dir);
+    log_mgr.recover();
+    CLogMTRManager *mtr_mgr = log_mgr.get_mtr_manager();
+    ASSERT_EQ(true, mtr_mgr->trx_commited[trx_num + 1]);
+    for (CLogRecord *log_rec : mtr_mgr->log_redo_list) {
+      delete log_rec;
+    }
+    mtr_mgr->log_redo_list.clear();
+  }
+
+  std::string clog_file = std::string(dir) + "/clog";
+  unlink(clog_file.c_str());
+  rmdir(dir);
+}
+
+TEST(test_clog, test_large_lsn)
+{
+  char dir[] = "/tmp/clog_large_lsn_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+
+  // 超过int32范围的LSN在日志记录和检查点中都能正确保存
+  const int64_t base_lsn = CLogManager::gloabl_lsn_.load();
+  CLogManager::gloabl_lsn_ = std::max(base_lsn, static_cast<int64_t>(INT32_MAX) + 100);
+  int64_t checkpoint_lsn = 0;
+  {
+    CLogManager log_mgr(dir);
+    log_mgr.recover();
+    checkpoint_lsn = append_trx(log_mgr, 1, 20, 11);
+    ASSERT_GT(checkpoint_lsn, static_cast<int64_t>(INT32_MAX));
+    ASSERT_EQ(RC::SUCCESS, log_mgr.checkpoint(checkpoint_lsn));
+  }
+
+  {
+    CLogManager::gloabl_lsn_ = 0;
+    CLogManager log_mgr(dir);
+    log_mgr.recover();
+    ASSERT_EQ(checkpoint_lsn, log_mgr.checkpoint_lsn());
+    ASSERT_GT(CLogManager::next_lsn(), checkpoint_lsn);
+    CLogMTRManager *mtr_mgr = log_mgr.get_mtr_manager();
+    ASSERT_FALSE(mtr_mgr->log_redo_list.empty());
+    for (CLogRecord *log_rec : mtr_mgr->log_redo_list) {
+      ASSERT_GT(log_rec->get_lsn(), static_cast<int64_t>(INT32_MAX));
+      delete log_rec;
+    }
+    mtr_mgr->log_redo_list.clear();
+  }
+
+  std::string clog_file = std::string(dir) + "/clog";
+  unlink(clog_file.c_str());
+  rmdir(dir);
+}
+
+TEST(test_clog, test_split_record_header)
+{
+  char dir[] = "/tmp/clog_split_header_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(dir));
+
+  // 长度不同的跨block记录后面跟着短记录，总有跨block的记录结束之后block中剩下的空间放不下记录头
+  const int trx_num = 64;
+  {
+    CLogManager log_mgr(dir);
+    log_mgr.recover();
+    for (int32_t trx_id = 1; trx_id <= trx_num; trx_id++) {
+      CLogRecord *log_rec = nullptr;
+      const int data_len = 600 + trx_id * 8;
+      Record *rec = gen_ins_record(trx_id, 0, data_len);
+      ASSERT_EQ(RC::SUCCESS, log_mgr.clog_gen_record(REDO_OVERFLOW, trx_id, log_rec, "table1", data_len, rec));
+      ASSERT_EQ(RC::SUCCESS, log_mgr.clog_append_record(log_rec));
+      delete[] rec->data();
+      delete rec;
+
+      log_mgr.clog_gen_record(REDO_MTR_COMMIT, trx_id, log_rec);
+      ASSERT_EQ(RC::SUCCESS, log_mgr.clog_append_record(log_rec));
+    }
+    log_mgr.clog_sync();
+  }
+
+  {
+    CLogManager log_mgr(dir);
+    log_mgr.recover();
+    ASSERT_EQ(trx_num * 2, log_mgr.recovered_records());
+    CLogMTRManager *mtr_mgr = log_mgr.get_mtr_manager();
+    ASSERT_EQ(static_cast<size_t>(trx_num), mtr_mgr->log_redo_list.size());
+    int32_t trx_id = 1;
+    for (CLogRecord *log_rec : mtr_mgr->log_redo_list) {
+      ASSERT_EQ(trx_id, log_rec->get_trx_id());
+      ASSERT_TRUE(mtr_mgr->trx_commited[trx_id]);
+      const CLogInsertRecord &ins = log_rec->get_record()->ins;
+      ASSERT_EQ(600 + trx_id * 8, ins.data_len_);
+      ASSERT_EQ(trx_id, ins.rid_.page_num);
+      const std::string expected(ins.data_len_, static_cast<char>(ins.data_len_));
+      ASSERT_EQ(expected, std::string(ins.data_, ins.data_len_));
+      trx_id++;
+      delete log_rec;
+    }
+    mtr_mgr->log_redo_list.clear();
+  }
+
+  std::string clog_file = std::string(dir) + "/clog";
+  unlink(clog_file.c_str());
+  rmdir(dir);
+}
+
+TEST(test_clog, test_concurrent_lsn)
+{
+  // 多个线程同时分配LSN，每条日志记录的LSN区间不会重叠
+  const int thread_num = 4;
+  const int lsn_num = 10000;
+  const int rec_len = 24;
+  const int64_t base_lsn = CLogManager::next_lsn();
+  std::vector<std::vector<int64_t>> lsns(thread_num);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back([&lsns, i]() {
+      for (int j = 0; j < lsn_num; j++) {
+        lsns[i].push_back(CLogManager::get_next_lsn(rec_len));
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int64_t> all_lsns;
+  for (const std::vector<int64_t> &thread_lsns : lsns) {
+    all_lsns.insert(all_lsns.end(), thread_lsns.begin(), thread_lsns.end());
+  }
+  std::sort(all_lsns.begin(), all_lsns.end());
+  for (size_t i = 0; i < all_lsns.size(); i++) {
+    ASSERT_EQ(base_lsn + static_cast<int64_t>(i) * rec_len, all_lsns[i]);
+  }
+  ASSERT_EQ(base_lsn + static_cast<int64_t>(thread_num) * lsn_num * rec_len, CLogManager::next_lsn());
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
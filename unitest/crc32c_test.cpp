@@ -0,0 +1,69 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/07.
+//
+
+#include <string.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "common/math/crc32c.h"
+
+using namespace common;
+
+TEST(test_crc32c, test_crc32c_known_values)
+{
+  const char *check = "123456789";
+  ASSERT_EQ(0xE3069283U, crc32c(0, check, strlen(check)));
+  ASSERT_EQ(0xE3069283U, crc32c_software(0, check, strlen(check)));
+  ASSERT_EQ(0U, crc32c(0, check, 0));
+
+  // iSCSI (RFC 3720) 中的测试数据
+  char buf[32];
+  memset(buf, 0, sizeof(buf));
+  ASSERT_EQ(0x8A9136AAU, crc32c(0, buf, sizeof(buf)));
+  memset(buf, 0xFF, sizeof(buf));
+  ASSERT_EQ(0x62A8AB43U, crc32c(0, buf, sizeof(buf)));
+}
+
+TEST(test_crc32c, test_crc32c_hardware_and_software)
+{
+  // 覆盖各种长度和对齐方式，包括硬件实现中三段并行计算的情况
+  std::vector<unsigned char> data(3 * 8192 * 2 + 100);
+  unsigned int seed = 1;
+  for (unsigned char &c : data) {
+    seed = seed * 1103515245 + 12345;
+    c = static_cast<unsigned char>(seed >> 16);
+  }
+
+  const size_t sizes[] = {1, 7, 8, 63, 255, 768, 769, 4096, 16384, 3 * 8192, 3 * 8192 + 13, 3 * 8192 * 2 + 99};
+  for (size_t size : sizes) {
+    for (size_t offset = 0; offset < 8; offset++) {
+      if (offset + size > data.size()) {
+        continue;
+      }
+      const uint32_t expect = crc32c_software(0, data.data() + offset, size);
+      ASSERT_EQ(expect, crc32c(0, data.data() + offset, size)) << "size=" << size << ", offset=" << offset;
+
+      // 分成两段计算的结果相同
+      const size_t half = size / 2;
+      const uint32_t crc = crc32c(0, data.data() + offset, half);
+      ASSERT_EQ(expect, crc32c(crc, data.data() + offset + half, size - half));
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
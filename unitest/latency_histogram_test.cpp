@@ -0,0 +1,82 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/14.
+//
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "common/metrics/latency_histogram.h"
+
+using namespace common;
+
+TEST(test_latency_histogram, test_percentile)
+{
+  LatencyHistogram histogram;
+  ASSERT_EQ(0, histogram.count());
+  ASSERT_EQ(0, histogram.percentile_us(0.99));
+
+  // 90个1us，9个100us，1个10000us
+  for (int i = 0; i < 90; i++) {
+    histogram.record(1);
+  }
+  for (int i = 0; i < 9; i++) {
+    histogram.record(100);
+  }
+  histogram.record(10000);
+
+  ASSERT_EQ(100, histogram.count());
+  ASSERT_EQ(90 + 900 + 10000, histogram.sum_us());
+  ASSERT_EQ(10000, histogram.max_us());
+  ASSERT_DOUBLE_EQ(109.9, histogram.mean_us());
+
+  // 分位数返回所在桶的上界
+  ASSERT_EQ(1, histogram.percentile_us(0.5));
+  ASSERT_EQ(127, histogram.percentile_us(0.95));
+  ASSERT_EQ(127, histogram.percentile_us(0.99));
+  ASSERT_EQ(10000, histogram.percentile_us(1));
+
+  // 负数按照0处理，特别大的值落在最后一个桶
+  histogram.record(-5);
+  histogram.record(1L << 40);
+  ASSERT_EQ(1L << 40, histogram.max_us());
+  ASSERT_EQ(1L << 40, histogram.percentile_us(1));
+}
+
+TEST(test_latency_histogram, test_concurrent_record)
+{
+  LatencyHistogram histogram;
+  const int thread_num = 4;
+  const int record_num = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&histogram, t]() {
+      for (int i = 0; i < record_num; i++) {
+        histogram.record(t + 1);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(thread_num * record_num, histogram.count());
+  ASSERT_EQ((1 + 2 + 3 + 4) * record_num, histogram.sum_us());
+  ASSERT_EQ(4, histogram.max_us());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
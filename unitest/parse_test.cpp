@@ -0,0 +1,62 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/12/15.
+//
+
+#include <string>
+
+#include "sql/parser/parse.h"
+#include "gtest/gtest.h"
+
+/**
+ * 生成一条多行的insert语句，每行两个值，一共value_num个值
+ */
+static std::string make_insert(int value_num)
+{
+  std::string sql = "insert into t values";
+  for (int i = 0; i < value_num; i += 2) {
+    sql += i == 0 ? " (" : ", (";
+    sql += std::to_string(i);
+    if (i + 1 < value_num) {
+      sql += ", '" + std::to_string(i + 1) + "'";
+    }
+    sql += ")";
+  }
+  sql += ";";
+  return sql;
+}
+
+TEST(test_parse, test_insert_values)
+{
+  Query *query = query_create();
+  ASSERT_EQ(RC::SUCCESS, parse(make_insert(MAX_VALUE_NUM).c_str(), query));
+  ASSERT_EQ(SCF_INSERT, query->flag);
+  ASSERT_EQ(MAX_VALUE_NUM, (int)query->sstr.insertion.value_num);
+  query_destroy(query);
+
+  // 超过MAX_VALUE_NUM个值时返回语法错误，不能写越界
+  query = query_create();
+  ASSERT_EQ(RC::SQL_SYNTAX, parse(make_insert(MAX_VALUE_NUM + 1).c_str(), query));
+  ASSERT_EQ(SCF_ERROR, query->flag);
+  ASSERT_EQ(0, (int)query->sstr.insertion.value_num);
+  query_destroy(query);
+
+  query = query_create();
+  ASSERT_EQ(RC::SQL_SYNTAX, parse(make_insert(MAX_VALUE_NUM * 4).c_str(), query));
+  query_destroy(query);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -13,10 +13,16 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <string.h>
+#include <algorithm>
+#include <random>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "storage/default/disk_buffer_pool.h"
+#include "storage/record/free_space_map.h"
+#include "storage/record/overflow_manager.h"
 #include "storage/record/record_manager.h"
 
 using namespace common;
@@ -179,6 +185,563 @@ TEST(test_record_page_handler, test_record_file_iterator)
   bpm->close_file(record_manager_file);
 }
 
+TEST(test_record_page_handler, test_record_file_mmap_scan)
+{
+  const char *record_manager_file = "./record_mmap_scan.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  bpm->set_mmap_scan_dir(".", true);
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+  ASSERT_TRUE(bp->mmap_scan());
+
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(bp));
+
+  const int record_insert_num = 3000;
+  std::vector<RID> rids;
+  for (int i = 0; i < record_insert_num; i++) {
+    int record_data[5] = {i, i + 1, i + 2, i + 3, i + 4};
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record((const char *)record_data, sizeof(record_data), &rid));
+    rids.push_back(rid);
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+
+  // 页面都不在缓冲池中，只读扫描直接访问文件映射
+  RecordFileScanner file_scanner;
+  ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(*bp, nullptr, true));
+  int count = 0;
+  Record record;
+  while (file_scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, file_scanner.next(record));
+    const int *values = (const int *)record.data();
+    ASSERT_EQ(count, values[0]);
+    ASSERT_EQ(count + 4, values[4]);
+    count++;
+  }
+  file_scanner.close_scan();
+  ASSERT_EQ(record_insert_num, count);
+  const long mapped_reads = bp->stats().mapped_reads.load();
+  ASSERT_GT(mapped_reads, 0);
+  ASSERT_EQ(RC::SUCCESS, bp->check_all_pages_unpinned());
+
+  // 删除之后的脏页还没有写到文件中，扫描时要使用缓冲池中的页面
+  for (int i = 0; i < record_insert_num; i += 2) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+  }
+  ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(*bp, nullptr, true));
+  count = 0;
+  while (file_scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, file_scanner.next(record));
+    ASSERT_EQ(1, ((const int *)record.data())[0] % 2);
+    count++;
+  }
+  file_scanner.close_scan();
+  ASSERT_EQ(record_insert_num / 2, count);
+  ASSERT_EQ(mapped_reads, bp->stats().mapped_reads.load());
+
+  // 写到文件中之后又可以从映射中读到
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, bp->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(*bp, nullptr, true));
+  count = 0;
+  while (file_scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, file_scanner.next(record));
+    count++;
+  }
+  file_scanner.close_scan();
+  ASSERT_EQ(record_insert_num / 2, count);
+  ASSERT_GT(bp->stats().mapped_reads.load(), mapped_reads);
+
+  bpm->close_file(record_manager_file);
+  ::remove(record_manager_file);
+}
+
+TEST(test_record_page_handler, test_slotted_record_file)
+{
+  const char *record_manager_file = "./record_slotted.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+  // 记录: int id; char name[400]; int value
+  const int name_len = 400;
+  const int record_size = 4 + name_len + 4;
+  RecordLayout layout(record_size, {{4, name_len}});
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, &layout));
+
+  auto make_record = [&](int id, int name_size, char *data) {
+    memset(data, 0, record_size);
+    memcpy(data, &id, 4);
+    memset(data + 4, 'a' + id % 26, name_size);
+    memcpy(data + 4 + name_len, &id, 4);
+  };
+  auto check_record = [&](const Record &record, int id, int name_size) {
+    ASSERT_EQ(id, *(const int *)record.data());
+    ASSERT_EQ(name_size, (int)strnlen(record.data() + 4, name_len));
+    if (name_size > 0) {
+      ASSERT_EQ('a' + id % 26, record.data()[4 + name_size - 1]);
+    }
+    ASSERT_EQ(id, *(const int *)(record.data() + 4 + name_len));
+  };
+
+  const int record_num = 1000;
+  std::vector<RID> rids;
+  std::vector<int> name_sizes;
+  char data[record_size];
+  for (int i = 0; i < record_num; i++) {
+    make_record(i, 5, data);
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(data, record_size, &rid));
+    rids.push_back(rid);
+    name_sizes.push_back(5);
+  }
+  // 定长格式一个页面只能放20条记录，变长之后每条记录只需要20个字节左右
+  ASSERT_LT(rids.back().page_num, 10);
+
+  // 变长之后原来的页面放不下的记录会搬到别的页面，RID不变
+  for (int i = 0; i < record_num; i += 3) {
+    make_record(i, 300, data);
+    Record record;
+    record.set_rid(rids[i]);
+    record.set_data(data);
+    ASSERT_EQ(RC::SUCCESS, file_handler.update_record(&record));
+    name_sizes[i] = 300;
+  }
+  for (int i = 0; i < record_num; i++) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(&rids[i], &record));
+    ASSERT_EQ(rids[i], record.rid());
+    check_record(record, i, name_sizes[i]);
+  }
+
+  // 再变短时搬回原来的页面，扫描时每条记录只出现一次
+  for (int i = 0; i < record_num; i += 6) {
+    make_record(i, 0, data);
+    Record record;
+    record.set_rid(rids[i]);
+    record.set_data(data);
+    ASSERT_EQ(RC::SUCCESS, file_handler.update_record(&record));
+    name_sizes[i] = 0;
+  }
+  for (int i = 1; i < record_num; i += 4) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+    name_sizes[i] = -1;
+  }
+  for (int i = 3; i < record_num; i += 12) {
+    // 删除转发出去的记录
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+    ASSERT_EQ(RC::RECORD_RECORD_NOT_EXIST, file_handler.delete_record(&rids[i]));
+    name_sizes[i] = -1;
+  }
+
+  RecordFileScanner file_scanner;
+  ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(*bp, nullptr, false, file_handler.layout()));
+  std::vector<bool> seen(record_num, false);
+  int count = 0;
+  Record record;
+  while (file_scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, file_scanner.next(record));
+    const int id = *(const int *)record.data();
+    ASSERT_TRUE(id >= 0 && id < record_num);
+    ASSERT_FALSE(seen[id]);
+    ASSERT_EQ(rids[id], record.rid());
+    check_record(record, id, name_sizes[id]);
+    seen[id] = true;
+    count++;
+  }
+  file_scanner.close_scan();
+  ASSERT_EQ(std::count_if(name_sizes.begin(), name_sizes.end(), [](int size) { return size >= 0; }), count);
+
+  // 只读扫描时转发之后的页面也用只读的方式访问
+  ASSERT_EQ(RC::SUCCESS, bp->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(*bp, nullptr, true, file_handler.layout()));
+  int readonly_count = 0;
+  while (file_scanner.has_next()) {
+    ASSERT_EQ(RC::SUCCESS, file_scanner.next(record));
+    check_record(record, *(const int *)record.data(), name_sizes[*(const int *)record.data()]);
+    readonly_count++;
+  }
+  file_scanner.close_scan();
+  ASSERT_EQ(count, readonly_count);
+  ASSERT_EQ(RC::SUCCESS, bp->check_all_pages_unpinned());
+
+  bpm->close_file(record_manager_file);
+  ::remove(record_manager_file);
+}
+
+TEST(test_record_page_handler, test_slotted_page_compact)
+{
+  const char *record_manager_file = "./record_slotted_compact.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+  RecordPageHandler page_handler;
+  ASSERT_EQ(RC::SUCCESS, page_handler.init_empty_slotted_page(*bp, frame->page_num()));
+  ASSERT_TRUE(page_handler.slotted());
+  const int empty_space = page_handler.free_space();
+
+  // 填满页面
+  char tuple[1000];
+  std::vector<RID> rids;
+  for (int i = 0; ; i++) {
+    memset(tuple, 'a' + i, sizeof(tuple));
+    RID rid;
+    RC rc = page_handler.insert_tuple(tuple, sizeof(tuple), &rid);
+    if (rc == RC::RECORD_NOMEM) {
+      break;
+    }
+    ASSERT_EQ(RC::SUCCESS, rc);
+    rids.push_back(rid);
+  }
+  ASSERT_GT(rids.size(), 2u);
+
+  // 删除中间的记录之后空间不连续，插入更长的记录需要整理页面
+  ASSERT_EQ(RC::SUCCESS, page_handler.delete_tuple(rids[0].slot_num));
+  ASSERT_EQ(RC::SUCCESS, page_handler.delete_tuple(rids[2].slot_num));
+  ASSERT_GE(page_handler.free_space(), 2000);
+  char long_tuple[1900];
+  memset(long_tuple, 'z', sizeof(long_tuple));
+  ASSERT_EQ(RC::SUCCESS, page_handler.update_tuple(rids[1].slot_num, long_tuple, sizeof(long_tuple)));
+
+  const char *data = nullptr;
+  int len = 0;
+  ASSERT_EQ(RC::RECORD_RECORD_NOT_EXIST, page_handler.get_tuple(rids[0].slot_num, data, len));
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_tuple(rids[1].slot_num, data, len));
+  ASSERT_EQ((int)sizeof(long_tuple), len);
+  ASSERT_EQ(0, memcmp(data, long_tuple, len));
+  for (size_t i = 3; i < rids.size(); i++) {
+    ASSERT_EQ(RC::SUCCESS, page_handler.get_tuple(rids[i].slot_num, data, len));
+    ASSERT_EQ((int)sizeof(tuple), len);
+    ASSERT_EQ('a' + (int)i, data[0]);
+    ASSERT_EQ('a' + (int)i, data[len - 1]);
+  }
+
+  // 删除的槽位可以重用，全部删除之后空间都还给页面
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, page_handler.insert_tuple(tuple, 10, &rid));
+  ASSERT_EQ(rids[0].slot_num, rid.slot_num);
+  ASSERT_EQ(RC::SUCCESS, page_handler.delete_tuple(rid.slot_num));
+  for (size_t i = 1; i < rids.size(); i++) {
+    if (i != 2) {
+      ASSERT_EQ(RC::SUCCESS, page_handler.delete_tuple(rids[i].slot_num));
+    }
+  }
+  ASSERT_EQ(empty_space, page_handler.free_space());
+
+  page_handler.cleanup();
+  bp->unpin_page(frame);
+  bpm->close_file(record_manager_file);
+  ::remove(record_manager_file);
+}
+
+TEST(test_record_page_handler, test_overflow_file)
+{
+  const char *overflow_file = "./record_overflow.bp";
+  const char *recover_file = "./record_overflow_recover.bp";
+  ::remove(overflow_file);
+  ::remove(recover_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(overflow_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(overflow_file, bp));
+
+  OverflowFileHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.init(bp));
+
+  const int len = handler.page_capacity() * 3 + 100;
+  std::string data(len, 0);
+  for (int i = 0; i < len; i++) {
+    data[i] = 'a' + i % 26;
+  }
+
+  // 记录写入的页面，用来模拟重做日志
+  struct LoggedPage {
+    PageNum page_num;
+    int offset;
+    std::string data;
+  };
+  std::vector<LoggedPage> logged_pages;
+  auto logger = [&logged_pages](PageNum page_num, int offset, const char *page_data, int page_len) {
+    logged_pages.push_back({page_num, offset, std::string(page_data, page_len)});
+    return RC::SUCCESS;
+  };
+  // 整页之外的100字节放在槽位页面中，目录和数据各一条日志
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, handler.insert_data(data.data(), len, &rid, logger));
+  ASSERT_GT(rid.page_num, 0);
+  ASSERT_EQ(5u, logged_pages.size());
+
+  std::string read(len, 0);
+  ASSERT_EQ(RC::SUCCESS, handler.get_data(rid, &read[0], len));
+  ASSERT_EQ(data, read);
+
+  // 不足一页的部分超过半页时单独使用一个页面
+  const int page_len = handler.page_capacity() * 2 - 10;
+  RID page_rid;
+  ASSERT_EQ(RC::SUCCESS, handler.insert_data(data.data(), page_len, &page_rid, logger));
+  ASSERT_EQ(7u, logged_pages.size());
+  std::string page_read(page_len, 0);
+  ASSERT_EQ(RC::SUCCESS, handler.get_data(page_rid, &page_read[0], page_len));
+  ASSERT_EQ(data.substr(0, page_len), page_read);
+
+  // 释放之后页面可以重用
+  int page_count = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&page_count));
+  ASSERT_EQ(RC::SUCCESS, handler.delete_data(rid, len));
+  RID second_rid;
+  ASSERT_EQ(RC::SUCCESS, handler.insert_data(data.data(), len, &second_rid));
+  int new_page_count = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&new_page_count));
+  ASSERT_EQ(page_count, new_page_count);
+
+  // 在另外一个文件中按照日志重做，可以读出同样的数据
+  DiskBufferPool *recover_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(recover_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(recover_file, recover_bp));
+  OverflowFileHandler recover_handler;
+  ASSERT_EQ(RC::SUCCESS, recover_handler.init(recover_bp));
+  for (const LoggedPage &page : logged_pages) {
+    ASSERT_EQ(RC::SUCCESS, recover_handler.recover_page(page.page_num, page.offset, page.data.data(), page.data.size()));
+  }
+  std::string recovered(len, 0);
+  ASSERT_EQ(RC::SUCCESS, recover_handler.get_data(rid, &recovered[0], len));
+  ASSERT_EQ(data, recovered);
+  ASSERT_EQ(RC::SUCCESS, recover_handler.get_data(page_rid, &page_read[0], page_len));
+  ASSERT_EQ(data.substr(0, page_len), page_read);
+
+  handler.close();
+  recover_handler.close();
+  bpm->close_file(overflow_file);
+  bpm->close_file(recover_file);
+  ::remove(overflow_file);
+  ::remove(recover_file);
+}
+
+TEST(test_record_page_handler, test_overflow_slot_page)
+{
+  const char *overflow_file = "./record_overflow_slot.bp";
+  ::remove(overflow_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(overflow_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(overflow_file, bp));
+  OverflowFileHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.init(bp));
+
+  // 短数据共用槽位页面，不会每个占用一个页面
+  const int value_num = 500;
+  std::mt19937 random(0);
+  std::uniform_int_distribution<int> len_dist(50, 1000);
+  std::vector<std::string> values;
+  std::vector<RID> rids(value_num);
+  long total_len = 0;
+  for (int i = 0; i < value_num; i++) {
+    values.emplace_back(len_dist(random), 'a' + i % 26);
+    values.back()[0] = static_cast<char>(i);
+    total_len += values.back().size();
+    ASSERT_EQ(RC::SUCCESS, handler.insert_data(values[i].data(), values[i].size(), &rids[i]));
+  }
+  int page_count = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&page_count));
+  ASSERT_LT(page_count, total_len / handler.page_capacity() * 5 / 4 + 4);
+
+  auto check_values = [&](int step) {
+    for (int i = 0; i < value_num; i += step) {
+      std::string read(values[i].size(), 0);
+      ASSERT_EQ(RC::SUCCESS, handler.get_data(rids[i], &read[0], read.size()));
+      ASSERT_EQ(values[i], read);
+    }
+  };
+  check_values(1);
+
+  // 删除一半之后再插入，释放的空间整理之后重用，文件不会变大
+  for (int i = 0; i < value_num; i += 2) {
+    ASSERT_EQ(RC::SUCCESS, handler.delete_data(rids[i], values[i].size()));
+  }
+  for (int i = 0; i < value_num; i += 2) {
+    std::reverse(values[i].begin(), values[i].end());
+    ASSERT_EQ(RC::SUCCESS, handler.insert_data(values[i].data(), values[i].size(), &rids[i]));
+  }
+  int new_page_count = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&new_page_count));
+  ASSERT_LE(new_page_count, page_count + 1);
+  check_values(1);
+
+  // 全部删除之后空的槽位页面都释放了，可以被重新分配
+  for (int i = 0; i < value_num; i++) {
+    ASSERT_EQ(RC::SUCCESS, handler.delete_data(rids[i], values[i].size()));
+  }
+  for (int i = 0; i < value_num; i++) {
+    ASSERT_EQ(RC::SUCCESS, handler.insert_data(values[i].data(), values[i].size(), &rids[i]));
+  }
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&new_page_count));
+  ASSERT_LE(new_page_count, page_count + 1);
+  check_values(1);
+
+  handler.close();
+  bpm->close_file(overflow_file);
+  ::remove(overflow_file);
+}
+
+TEST(test_record_page_handler, test_free_space_map)
+{
+  const char *data_file = "./record_fsm.bp";
+  const char *fsm_file = "./record_fsm.fsm";
+  ::remove(data_file);
+  ::remove(fsm_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  DiskBufferPool *bp = nullptr;
+  DiskBufferPool *fsm_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(data_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(data_file, bp));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(fsm_file, fsm_bp));
+
+  // 等级是空闲空间的下限，find返回的页面一定放得下
+  FreeSpaceMap fsm;
+  ASSERT_EQ(RC::SUCCESS, fsm.open_transient(bp->page_data_size()));
+  for (int free_space = 0; free_space <= bp->page_data_size(); free_space++) {
+    const int category = fsm.category(free_space);
+    ASSERT_LE(fsm.category_min_free(category), free_space);
+    if (category + 1 < FreeSpaceMap::CATEGORY_NUM) {
+      ASSERT_GT(fsm.category_min_free(category + 1), free_space);
+    }
+  }
+  fsm.update(100000, 8000);
+  fsm.update(3, 5000);
+  ASSERT_EQ(3, fsm.find(4000));
+  ASSERT_EQ(100000, fsm.find(4000, 3));
+  ASSERT_EQ(BP_INVALID_PAGE_NUM, fsm.find(10000));
+  fsm.update(3, 0);
+  fsm.update(100000, 0);
+  ASSERT_EQ(BP_INVALID_PAGE_NUM, fsm.find(4000));
+  fsm.close();
+
+  const int record_size = 400;
+  const int record_num = 2000;
+  char data[record_size];
+  std::vector<RID> rids;
+  {
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, nullptr, fsm_bp));
+    for (int i = 0; i < record_num; i++) {
+      memset(data, 0, record_size);
+      memcpy(data, &i, sizeof(i));
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(data, record_size, &rid));
+      rids.push_back(rid);
+    }
+    // 删除中间一个页面上的记录，留出空闲空间
+    for (const RID &rid : rids) {
+      if (rid.page_num == rids[record_num / 2].page_num) {
+        ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rid));
+      }
+    }
+    file_handler.close();
+  }
+  bpm->close_file(data_file);
+  bpm->close_file(fsm_file);
+
+  // 重新打开之后不用遍历数据文件，空闲空间表中还记着删除记录留下的空间
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(data_file, bp));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(fsm_file, fsm_bp));
+  const PageNum free_page = rids[record_num / 2].page_num;
+  ASSERT_EQ(RC::SUCCESS, fsm.open(fsm_bp, bp->page_data_size()));
+  ASSERT_FALSE(fsm.need_rebuild());
+  ASSERT_EQ(free_page, fsm.find(record_size));
+  fsm.close();
+
+  RecordFileHandler file_handler;
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, nullptr, fsm_bp));
+  int page_count = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&page_count));
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(data, record_size, &rid));
+  ASSERT_EQ(free_page, rid.page_num);
+  int new_page_count = 0;
+  ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&new_page_count));
+  ASSERT_EQ(page_count, new_page_count);
+
+  file_handler.close();
+  bpm->close_file(data_file);
+  bpm->close_file(fsm_file);
+  ::remove(data_file);
+  ::remove(fsm_file);
+}
+
+TEST(test_record_page_handler, test_insert_records)
+{
+  const char *record_manager_files[] = {"./record_batch.bp", "./record_batch_slotted.bp"};
+  BufferPoolManager *bpm = new BufferPoolManager();
+
+  // 定长格式和变长格式各插入一批，批量插入的记录和逐条插入的一样可以读出来
+  const int name_len = 400;
+  const int record_size = 4 + name_len;
+  const int record_num = 500;
+  RecordLayout layout(record_size, {{4, name_len}});
+  std::vector<char> records(record_size * record_num, 0);
+  for (int i = 0; i < record_num; i++) {
+    char *data = records.data() + i * record_size;
+    memcpy(data, &i, sizeof(i));
+    memset(data + 4, 'a' + i % 26, i % 100);
+  }
+
+  for (int format = 0; format < 2; format++) {
+    const char *record_manager_file = record_manager_files[format];
+    ::remove(record_manager_file);
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+    ASSERT_EQ(RC::SUCCESS, bpm->open_file(record_manager_file, bp));
+
+    RecordFileHandler file_handler;
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(bp, format == 0 ? nullptr : &layout));
+    std::vector<RID> rids(record_num);
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_records(records.data(), record_num, record_size, rids.data()));
+
+    // 一个页面放满之后才换下一个页面，每个页面只出现在一段连续的记录中
+    int page_changes = 0;
+    for (int i = 0; i < record_num; i++) {
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, file_handler.get_record(&rids[i], &record));
+      ASSERT_EQ(0, memcmp(records.data() + i * record_size, record.data(), record_size));
+      if (i > 0 && rids[i].page_num != rids[i - 1].page_num) {
+        page_changes++;
+      }
+    }
+    int page_count = 0;
+    ASSERT_EQ(RC::SUCCESS, bp->get_page_count(&page_count));
+    ASSERT_EQ(page_count - 1, page_changes + 1);  // 第0个页面是文件头
+
+    // 再插入一条，使用最后一个页面剩下的空间
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_records(records.data(), 1, record_size, &rid));
+    ASSERT_EQ(rids.back().page_num, rid.page_num);
+    ASSERT_EQ(RC::SUCCESS, bp->check_all_pages_unpinned());
+
+    file_handler.close();
+    bpm->close_file(record_manager_file);
+    ::remove(record_manager_file);
+  }
+}
+
 int main(int argc, char **argv)
 {
   // 分析gtest程序的命令行参数
@@ -0,0 +1,64 @@
+/* Copyright (c) 2021 Xie Meiyi(xiemeiyi@hust.edu.cn) and OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+//
+// Created by Wangyunlai on 2022/11/20.
+//
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+#include "common/lang/string.h"
+
+using namespace common;
+
+TEST(test_string, test_str_to_bytes)
+{
+  size_t bytes = 0;
+  ASSERT_TRUE(str_to_bytes("4096", bytes));
+  ASSERT_EQ(4096UL, bytes);
+  ASSERT_TRUE(str_to_bytes(" 16k ", bytes));
+  ASSERT_EQ(16UL << 10, bytes);
+  ASSERT_TRUE(str_to_bytes("256M", bytes));
+  ASSERT_EQ(256UL << 20, bytes);
+  ASSERT_TRUE(str_to_bytes("2g", bytes));
+  ASSERT_EQ(2UL << 30, bytes);
+  ASSERT_TRUE(str_to_bytes("1T", bytes));
+  ASSERT_EQ(1UL << 40, bytes);
+  ASSERT_TRUE(str_to_bytes("0", bytes));
+  ASSERT_EQ(0UL, bytes);
+
+  ASSERT_FALSE(str_to_bytes("", bytes));
+  ASSERT_FALSE(str_to_bytes("M", bytes));
+  ASSERT_FALSE(str_to_bytes("-1M", bytes));
+  ASSERT_FALSE(str_to_bytes("12X", bytes));
+  ASSERT_FALSE(str_to_bytes("1.5G", bytes));
+  ASSERT_FALSE(str_to_bytes("99999999999999999999", bytes));
+}
+
+TEST(test_string, test_str_to_bytes_overflow)
+{
+  size_t bytes = 0;
+  ASSERT_FALSE(str_to_bytes("99999999999G", bytes));
+  ASSERT_FALSE(str_to_bytes("16777216T", bytes));
+  ASSERT_FALSE(str_to_bytes("18014398509481984K", bytes));
+
+  // 正好不溢出的最大值
+  ASSERT_TRUE(str_to_bytes(std::to_string(SIZE_MAX >> 40) + "T", bytes));
+  ASSERT_EQ((SIZE_MAX >> 40) << 40, bytes);
+  ASSERT_TRUE(str_to_bytes(std::to_string(SIZE_MAX), bytes));
+  ASSERT_EQ(SIZE_MAX, bytes);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}